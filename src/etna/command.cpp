@@ -3,6 +3,7 @@
 #include "etna/descriptor.hpp"
 #include "etna/image.hpp"
 #include "etna/pipeline.hpp"
+#include "etna/query.hpp"
 #include "etna/renderpass.hpp"
 
 #include <algorithm>
@@ -237,6 +238,13 @@ void CommandBuffer::PipelineBarrier(
         &image_memory_barrier);
 }
 
+void CommandBuffer::PipelineBarrier(const BarrierBatch& barrier_batch)
+{
+    assert(m_command_buffer);
+
+    barrier_batch.Record(m_command_buffer, vkCmdPipelineBarrier);
+}
+
 void CommandBuffer::CopyImage(
     Image2D     src_image,
     ImageLayout src_image_layout,
@@ -301,6 +309,34 @@ void CommandBuffer::ResetCommandBuffer(CommandBufferReset reset_flags)
     vkResetCommandBuffer(m_command_buffer, VkEnum(reset_flags));
 }
 
+void CommandBuffer::PushConstants(
+    PipelineLayout pipeline_layout,
+    ShaderStage    shader_stage_flags,
+    uint32_t       offset,
+    uint32_t       size,
+    const void*    values)
+{
+    assert(m_command_buffer);
+
+    vkCmdPushConstants(m_command_buffer, pipeline_layout, VkEnum(shader_stage_flags), offset, size, values);
+}
+
+void CommandBuffer::ResetQueryPool(QueryPool query_pool, uint32_t first_query, uint32_t query_count)
+{
+    assert(m_command_buffer);
+
+    vkCmdResetQueryPool(m_command_buffer, query_pool, first_query, query_count);
+}
+
+void CommandBuffer::WriteTimestamp(PipelineStage pipeline_stage, QueryPool query_pool, uint32_t query)
+{
+    assert(m_command_buffer);
+
+    auto vk_pipeline_stage = static_cast<VkPipelineStageFlagBits>(VkEnum(pipeline_stage));
+
+    vkCmdWriteTimestamp(m_command_buffer, vk_pipeline_stage, query_pool, query);
+}
+
 void CommandBuffer::SetViewport(Viewport viewport)
 {
     assert(m_command_buffer);
@@ -337,4 +373,131 @@ void CommandBuffer::Destroy() noexcept
     m_command_pool   = nullptr;
 }
 
+void CommandBuffer::BarrierBatch::AddMemoryBarrier(
+    PipelineStage src_stage_flags,
+    PipelineStage dst_stage_flags,
+    Access        src_access_flags,
+    Access        dst_access_flags)
+{
+    VkMemoryBarrier memory_barrier = {
+
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext         = nullptr,
+        .srcAccessMask = VkEnum(src_access_flags),
+        .dstAccessMask = VkEnum(dst_access_flags)
+    };
+
+    m_memory_barriers.push_back(memory_barrier);
+
+    AddStages(src_stage_flags, dst_stage_flags);
+}
+
+void CommandBuffer::BarrierBatch::AddBufferBarrier(
+    Buffer        buffer,
+    PipelineStage src_stage_flags,
+    PipelineStage dst_stage_flags,
+    Access        src_access_flags,
+    Access        dst_access_flags,
+    DeviceSize    offset,
+    DeviceSize    size,
+    uint32_t      src_queue_family,
+    uint32_t      dst_queue_family)
+{
+    VkBufferMemoryBarrier buffer_memory_barrier = {
+
+        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext               = nullptr,
+        .srcAccessMask       = VkEnum(src_access_flags),
+        .dstAccessMask       = VkEnum(dst_access_flags),
+        .srcQueueFamilyIndex = src_queue_family,
+        .dstQueueFamilyIndex = dst_queue_family,
+        .buffer              = buffer,
+        .offset              = offset,
+        .size                = size
+    };
+
+    m_buffer_barriers.push_back(buffer_memory_barrier);
+
+    AddStages(src_stage_flags, dst_stage_flags);
+}
+
+void CommandBuffer::BarrierBatch::AddImageBarrier(
+    Image2D               image,
+    PipelineStage         src_stage_flags,
+    PipelineStage         dst_stage_flags,
+    Access                src_access_flags,
+    Access                dst_access_flags,
+    ImageLayout           old_layout,
+    ImageLayout           new_layout,
+    ImageSubresourceRange subresource_range,
+    uint32_t              src_queue_family,
+    uint32_t              dst_queue_family)
+{
+    VkImageSubresourceRange vk_subresource_range = {
+
+        .aspectMask     = VkEnum(subresource_range.aspectMask),
+        .baseMipLevel   = subresource_range.baseMipLevel,
+        .levelCount     = subresource_range.levelCount,
+        .baseArrayLayer = subresource_range.baseArrayLayer,
+        .layerCount     = subresource_range.layerCount
+    };
+
+    VkImageMemoryBarrier image_memory_barrier = {
+
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext               = nullptr,
+        .srcAccessMask       = VkEnum(src_access_flags),
+        .dstAccessMask       = VkEnum(dst_access_flags),
+        .oldLayout           = VkEnum(old_layout),
+        .newLayout           = VkEnum(new_layout),
+        .srcQueueFamilyIndex = src_queue_family,
+        .dstQueueFamilyIndex = dst_queue_family,
+        .image               = image,
+        .subresourceRange    = vk_subresource_range
+    };
+
+    m_image_barriers.push_back(image_memory_barrier);
+
+    AddStages(src_stage_flags, dst_stage_flags);
+}
+
+void CommandBuffer::BarrierBatch::Record(
+    VkCommandBuffer          command_buffer,
+    PFN_vkCmdPipelineBarrier cmd_pipeline_barrier) const
+{
+    assert(cmd_pipeline_barrier);
+
+    if (IsEmpty()) {
+        return;
+    }
+
+    cmd_pipeline_barrier(
+        command_buffer,
+        m_src_stage_mask,
+        m_dst_stage_mask,
+        {},
+        narrow_cast<uint32_t>(m_memory_barriers.size()),
+        m_memory_barriers.data(),
+        narrow_cast<uint32_t>(m_buffer_barriers.size()),
+        m_buffer_barriers.data(),
+        narrow_cast<uint32_t>(m_image_barriers.size()),
+        m_image_barriers.data());
+}
+
+void CommandBuffer::BarrierBatch::Clear() noexcept
+{
+    m_memory_barriers.clear();
+    m_buffer_barriers.clear();
+    m_image_barriers.clear();
+
+    m_src_stage_mask = {};
+    m_dst_stage_mask = {};
+}
+
+void CommandBuffer::BarrierBatch::AddStages(PipelineStage src_stage_flags, PipelineStage dst_stage_flags) noexcept
+{
+    m_src_stage_mask |= VkEnum(src_stage_flags);
+    m_dst_stage_mask |= VkEnum(dst_stage_flags);
+}
+
 } // namespace etna
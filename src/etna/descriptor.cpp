@@ -59,9 +59,43 @@ void DescriptorSetLayout::Builder::AddDescriptorSetLayoutBinding(
     };
 
     m_descriptor_set_layout_bindings.push_back(descriptor_set_layout_binding);
+    m_descriptor_binding_flags.push_back({});
 
     state.bindingCount = narrow_cast<uint32_t>(m_descriptor_set_layout_bindings.size());
     state.pBindings    = m_descriptor_set_layout_bindings.data();
+
+    if (m_binding_flags_create_info.sType) {
+        m_binding_flags_create_info.bindingCount  = state.bindingCount;
+        m_binding_flags_create_info.pBindingFlags = m_descriptor_binding_flags.data();
+    }
+}
+
+void DescriptorSetLayout::Builder::AddDescriptorSetLayoutBinding(
+    Binding                binding,
+    DescriptorType         descriptor_type,
+    uint32_t               descriptor_count,
+    ShaderStage            shader_stage_flags,
+    DescriptorBindingFlags descriptor_binding_flags)
+{
+    if (!m_binding_flags_create_info.sType) {
+        m_binding_flags_create_info = VkDescriptorSetLayoutBindingFlagsCreateInfoEXT{
+
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+            .pNext         = state.pNext,
+            .bindingCount  = 0,
+            .pBindingFlags = nullptr
+        };
+
+        state.pNext = &m_binding_flags_create_info;
+    }
+
+    AddDescriptorSetLayoutBinding(binding, descriptor_type, descriptor_count, shader_stage_flags);
+
+    m_descriptor_binding_flags.back() = VkEnum(descriptor_binding_flags);
+
+    if (descriptor_binding_flags & DescriptorBindingFlags::UpdateAfterBind) {
+        state.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    }
 }
 
 DescriptorSet DescriptorPool::AllocateDescriptorSet(DescriptorSetLayout descriptor_set_layout)
@@ -125,7 +159,8 @@ void DescriptorPool::Destroy() noexcept
 WriteDescriptorSet::WriteDescriptorSet(
     DescriptorSet  descriptor_set,
     Binding        binding,
-    DescriptorType descriptor_type) noexcept
+    DescriptorType descriptor_type,
+    uint32_t       array_element) noexcept
 {
     state = VkWriteDescriptorSet{
 
@@ -133,7 +168,7 @@ WriteDescriptorSet::WriteDescriptorSet(
         .pNext            = nullptr,
         .dstSet           = descriptor_set,
         .dstBinding       = binding,
-        .dstArrayElement  = 0,
+        .dstArrayElement  = array_element,
         .descriptorCount  = 0,
         .descriptorType   = VkEnum(descriptor_type),
         .pImageInfo       = nullptr,
@@ -4,6 +4,7 @@
 #include "etna/descriptor.hpp"
 #include "etna/image.hpp"
 #include "etna/pipeline.hpp"
+#include "etna/query.hpp"
 #include "etna/queue.hpp"
 #include "etna/renderpass.hpp"
 #include "etna/sampler.hpp"
@@ -336,7 +337,30 @@ auto Device::CreateFramebuffer(
 UniquePipeline Device::CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& create_info)
 {
     assert(m_device);
-    return Pipeline::Create(m_device, create_info);
+    return Pipeline::Create(m_device, {}, create_info);
+}
+
+UniquePipeline
+Device::CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& create_info, PipelineCache pipeline_cache)
+{
+    assert(m_device);
+    return Pipeline::Create(m_device, pipeline_cache, create_info);
+}
+
+UniquePipelineCache Device::CreatePipelineCache(std::span<const uint8_t> initial_data)
+{
+    assert(m_device);
+
+    auto create_info = VkPipelineCacheCreateInfo{
+
+        .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext           = nullptr,
+        .flags           = {},
+        .initialDataSize = initial_data.size(),
+        .pInitialData    = initial_data.data()
+    };
+
+    return PipelineCache::Create(m_device, create_info);
 }
 
 UniquePipelineLayout Device::CreatePipelineLayout(const VkPipelineLayoutCreateInfo& create_info)
@@ -344,6 +368,23 @@ UniquePipelineLayout Device::CreatePipelineLayout(const VkPipelineLayoutCreateIn
     return PipelineLayout::Create(m_device, create_info);
 }
 
+UniqueQueryPool Device::CreateQueryPool(QueryType query_type, uint32_t query_count)
+{
+    assert(m_device);
+
+    auto create_info = VkQueryPoolCreateInfo{
+
+        .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext              = nullptr,
+        .flags              = {},
+        .queryType          = VkEnum(query_type),
+        .queryCount         = query_count,
+        .pipelineStatistics = {}
+    };
+
+    return QueryPool::Create(m_device, create_info);
+}
+
 UniqueImage2D Device::CreateImage(
     Format      format,
     Extent2D    extent,
@@ -410,6 +451,28 @@ UniqueSemaphore Device::CreateSemaphore()
     return Semaphore::Create(m_device, create_info);
 }
 
+UniqueTimelineSemaphore Device::CreateTimelineSemaphore(uint64_t initial_value)
+{
+    assert(m_device);
+
+    auto type_create_info = VkSemaphoreTypeCreateInfoKHR{
+
+        .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+        .pNext         = nullptr,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+        .initialValue  = initial_value
+    };
+
+    auto create_info = VkSemaphoreCreateInfo{
+
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_create_info,
+        .flags = {}
+    };
+
+    return TimelineSemaphore::Create(m_device, create_info);
+}
+
 Queue Device::GetQueue(uint32_t queue_family_index) const noexcept
 {
     assert(m_device);
@@ -646,4 +709,47 @@ void Device::Builder::AddEnabledExtension(const char* extension_name)
     state.ppEnabledExtensionNames = m_enabled_extension_names.data();
 }
 
+void Device::Builder::EnableTimelineSemaphore()
+{
+    if (m_timeline_semaphore_features.timelineSemaphore) {
+        return;
+    }
+
+    m_timeline_semaphore_features = VkPhysicalDeviceTimelineSemaphoreFeaturesKHR{
+
+        .sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+        .pNext             = const_cast<void*>(state.pNext),
+        .timelineSemaphore = VK_TRUE
+    };
+
+    state.pNext = &m_timeline_semaphore_features;
+
+    AddEnabledExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+}
+
+void Device::Builder::EnableDescriptorIndexing()
+{
+    if (m_descriptor_indexing_features.descriptorBindingPartiallyBound) {
+        return;
+    }
+
+    m_descriptor_indexing_features = VkPhysicalDeviceDescriptorIndexingFeaturesEXT{
+
+        .sType                                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        .pNext                                        = const_cast<void*>(state.pNext),
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending    = VK_TRUE,
+        .descriptorBindingPartiallyBound              = VK_TRUE
+    };
+
+    state.pNext = &m_descriptor_indexing_features;
+
+    m_enabled_features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+    state.pEnabledFeatures = &m_enabled_features;
+
+    AddEnabledExtension(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+    AddEnabledExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+}
+
 } // namespace etna
@@ -2,6 +2,8 @@
 
 #include "core.hpp"
 
+#include <vector>
+
 namespace etna {
 
 class CommandPool {
@@ -34,6 +36,70 @@ class CommandPool {
 
 class CommandBuffer {
   public:
+    class BarrierBatch final {
+      public:
+        BarrierBatch() noexcept = default;
+
+        void AddMemoryBarrier(
+            PipelineStage src_stage_flags,
+            PipelineStage dst_stage_flags,
+            Access        src_access_flags,
+            Access        dst_access_flags);
+
+        void AddBufferBarrier(
+            Buffer        buffer,
+            PipelineStage src_stage_flags,
+            PipelineStage dst_stage_flags,
+            Access        src_access_flags,
+            Access        dst_access_flags,
+            DeviceSize    offset           = 0,
+            DeviceSize    size             = VK_WHOLE_SIZE,
+            uint32_t      src_queue_family = VK_QUEUE_FAMILY_IGNORED,
+            uint32_t      dst_queue_family = VK_QUEUE_FAMILY_IGNORED);
+
+        void AddImageBarrier(
+            Image2D               image,
+            PipelineStage         src_stage_flags,
+            PipelineStage         dst_stage_flags,
+            Access                src_access_flags,
+            Access                dst_access_flags,
+            ImageLayout           old_layout,
+            ImageLayout           new_layout,
+            ImageSubresourceRange subresource_range = {},
+            uint32_t              src_queue_family  = VK_QUEUE_FAMILY_IGNORED,
+            uint32_t              dst_queue_family  = VK_QUEUE_FAMILY_IGNORED);
+
+        void Clear() noexcept;
+
+        bool IsEmpty() const noexcept { return BarrierCount() == 0; }
+
+        auto MemoryBarrierCount() const noexcept { return m_memory_barriers.size(); }
+        auto BufferBarrierCount() const noexcept { return m_buffer_barriers.size(); }
+        auto ImageBarrierCount() const noexcept { return m_image_barriers.size(); }
+
+        auto BarrierCount() const noexcept
+        {
+            return m_memory_barriers.size() + m_buffer_barriers.size() + m_image_barriers.size();
+        }
+
+        auto SrcStageMask() const noexcept { return PipelineStageMask(static_cast<PipelineStage>(m_src_stage_mask)); }
+        auto DstStageMask() const noexcept { return PipelineStageMask(static_cast<PipelineStage>(m_dst_stage_mask)); }
+
+        // Records the whole batch with a single call to cmd_pipeline_barrier, or none if the batch is empty.
+        // CommandBuffer::PipelineBarrier passes vkCmdPipelineBarrier; tests pass a function that counts the calls.
+        void Record(VkCommandBuffer command_buffer, PFN_vkCmdPipelineBarrier cmd_pipeline_barrier) const;
+
+      private:
+
+        void AddStages(PipelineStage src_stage_flags, PipelineStage dst_stage_flags) noexcept;
+
+        std::vector<VkMemoryBarrier>       m_memory_barriers;
+        std::vector<VkBufferMemoryBarrier> m_buffer_barriers;
+        std::vector<VkImageMemoryBarrier>  m_image_barriers;
+        VkPipelineStageFlags               m_src_stage_mask{};
+        VkPipelineStageFlags               m_dst_stage_mask{};
+    };
+
     CommandBuffer() noexcept {}
     CommandBuffer(std::nullptr_t) noexcept {}
 
@@ -85,6 +151,8 @@ class CommandBuffer {
         ImageLayout   new_layout,
         ImageAspect   aspect_flags);
 
+    void PipelineBarrier(const BarrierBatch& barrier_batch);
+
     void CopyImage(
         Image2D     src_image,
         ImageLayout src_image_layout,
@@ -103,6 +171,27 @@ class CommandBuffer {
 
     void ResetCommandBuffer(CommandBufferReset reset_flags = {});
 
+    void PushConstants(
+        PipelineLayout pipeline_layout,
+        ShaderStage    shader_stage_flags,
+        uint32_t       offset,
+        uint32_t       size,
+        const void*    values);
+
+    template <typename T>
+    void
+    PushConstants(PipelineLayout pipeline_layout, ShaderStage shader_stage_flags, const T& values, uint32_t offset = 0)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(sizeof(T) % 4 == 0, "Push constant size must be a multiple of 4");
+
+        PushConstants(pipeline_layout, shader_stage_flags, offset, sizeof(T), &values);
+    }
+
+    void ResetQueryPool(QueryPool query_pool, uint32_t first_query, uint32_t query_count);
+
+    void WriteTimestamp(PipelineStage pipeline_stage, QueryPool query_pool, uint32_t query);
+
     void SetViewport(Viewport viewport);
 
     void SetScissor(Rect2D scissor);
@@ -546,6 +546,22 @@ enum class CompareOp {
 
 ETNA_DEFINE_ENUM_ANALOGUE(CompareOp)
 
+enum class PrimitiveTopology {
+    PointList                  = VK_PRIMITIVE_TOPOLOGY_POINT_LIST,
+    LineList                   = VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+    LineStrip                  = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP,
+    TriangleList               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+    TriangleStrip              = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+    TriangleFan                = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN,
+    LineListWithAdjacency      = VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY,
+    LineStripWithAdjacency     = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY,
+    TriangleListWithAdjacency  = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST_WITH_ADJACENCY,
+    TriangleStripWithAdjacency = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP_WITH_ADJACENCY,
+    PatchList                  = VK_PRIMITIVE_TOPOLOGY_PATCH_LIST
+};
+
+ETNA_DEFINE_ENUM_ANALOGUE(PrimitiveTopology)
+
 enum class DescriptorType {
     Sampler                  = VK_DESCRIPTOR_TYPE_SAMPLER,
     CombinedImageSampler     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
@@ -600,6 +616,14 @@ enum class PipelineBindPoint {
 
 ETNA_DEFINE_ENUM_ANALOGUE(PipelineBindPoint)
 
+enum class QueryType {
+    Occlusion          = VK_QUERY_TYPE_OCCLUSION,
+    PipelineStatistics = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+    Timestamp          = VK_QUERY_TYPE_TIMESTAMP
+};
+
+ETNA_DEFINE_ENUM_ANALOGUE(QueryType)
+
 enum class DebugUtilsMessageSeverity : VkDebugUtilsMessageSeverityFlagsEXT {
     Verbose = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT,
     Info    = VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT,
@@ -851,6 +875,15 @@ ETNA_DEFINE_FLAGS_ANALOGUE(DescriptorPoolFlags, VkDescriptorPoolCreateFlags)
 
 const char* to_string(DescriptorPoolFlags value) noexcept;
 
+enum class DescriptorBindingFlags : VkDescriptorBindingFlags {
+    UpdateAfterBind          = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT,
+    UpdateUnusedWhilePending = VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT,
+    PartiallyBound           = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+    VariableDescriptorCount  = VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT
+};
+
+ETNA_DEFINE_FLAGS_ANALOGUE(DescriptorBindingFlags, VkDescriptorBindingFlags)
+
 enum class ImageAspect : VkImageAspectFlags {
     Color           = VK_IMAGE_ASPECT_COLOR_BIT,
     Depth           = VK_IMAGE_ASPECT_DEPTH_BIT,
@@ -973,6 +1006,14 @@ using ExtensionProperties            = VkExtensionProperties;
 using PhysicalDeviceLimits           = VkPhysicalDeviceLimits;
 using PhysicalDeviceSparseProperties = VkPhysicalDeviceSparseProperties;
 
+using PhysicalDeviceDescriptorIndexingFeatures = VkPhysicalDeviceDescriptorIndexingFeaturesEXT;
+
+// Device local memory, summed over the heaps that have it.
+struct DeviceMemoryBudget final {
+    DeviceSize usage  = 0; // Allocated by this process
+    DeviceSize budget = 0; // What this process can allocate without degrading performance, usage included
+};
+
 struct ImageSubresourceLayers final {
     ImageAspect aspectMask     = ImageAspect::Color;
     uint32_t    mipLevel       = 0;
@@ -982,6 +1023,16 @@ struct ImageSubresourceLayers final {
 
 static_assert(sizeof(ImageSubresourceLayers) == sizeof(VkImageSubresourceLayers));
 
+struct ImageSubresourceRange final {
+    ImageAspect aspectMask     = ImageAspect::Color;
+    uint32_t    baseMipLevel   = 0;
+    uint32_t    levelCount     = 1;
+    uint32_t    baseArrayLayer = 0;
+    uint32_t    layerCount     = 1;
+};
+
+static_assert(sizeof(ImageSubresourceRange) == sizeof(VkImageSubresourceRange));
+
 struct BufferImageCopy final {
     DeviceSize             bufferOffset{};
     uint32_t               bufferRowLength{};
@@ -1264,13 +1315,16 @@ class Image2D;
 class ImageView2D;
 class Instance;
 class Pipeline;
+class PipelineCache;
 class PipelineLayout;
+class QueryPool;
 class RenderPass;
 class Sampler;
 class Semaphore;
 class ShaderModule;
 class SurfaceKHR;
 class SwapchainKHR;
+class TimelineSemaphore;
 
 using UniqueBuffer              = UniqueHandle<Buffer>;
 using UniqueCommandBuffer       = UniqueHandle<CommandBuffer>;
@@ -1284,13 +1338,16 @@ using UniqueImage2D             = UniqueHandle<Image2D>;
 using UniqueImageView2D         = UniqueHandle<ImageView2D>;
 using UniqueInstance            = UniqueHandle<Instance>;
 using UniquePipeline            = UniqueHandle<Pipeline>;
+using UniquePipelineCache       = UniqueHandle<PipelineCache>;
 using UniquePipelineLayout      = UniqueHandle<PipelineLayout>;
+using UniqueQueryPool           = UniqueHandle<QueryPool>;
 using UniqueRenderPass          = UniqueHandle<RenderPass>;
 using UniqueSampler             = UniqueHandle<Sampler>;
 using UniqueSemaphore           = UniqueHandle<Semaphore>;
 using UniqueShaderModule        = UniqueHandle<ShaderModule>;
 using UniqueSurfaceKHR          = UniqueHandle<SurfaceKHR>;
 using UniqueSwapchainKHR        = UniqueHandle<SwapchainKHR>;
+using UniqueTimelineSemaphore   = UniqueHandle<TimelineSemaphore>;
 
 class DescriptorSet;
 class Queue;
@@ -17,10 +17,19 @@ class DescriptorSetLayout {
             uint32_t       descriptor_count,
             ShaderStage    shader_stage_flags);
 
+        void AddDescriptorSetLayoutBinding(
+            Binding                binding,
+            DescriptorType         descriptor_type,
+            uint32_t               descriptor_count,
+            ShaderStage            shader_stage_flags,
+            DescriptorBindingFlags descriptor_binding_flags);
+
         VkDescriptorSetLayoutCreateInfo state{};
 
       private:
-        std::vector<VkDescriptorSetLayoutBinding> m_descriptor_set_layout_bindings;
+        std::vector<VkDescriptorSetLayoutBinding>      m_descriptor_set_layout_bindings;
+        std::vector<VkDescriptorBindingFlags>          m_descriptor_binding_flags;
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT m_binding_flags_create_info{};
     };
 
     DescriptorSetLayout() noexcept {}
@@ -65,7 +74,11 @@ class DescriptorSet {
 
 class WriteDescriptorSet {
   public:
-    WriteDescriptorSet(DescriptorSet descriptor_set, Binding binding, DescriptorType descriptor_type) noexcept;
+    WriteDescriptorSet(
+        DescriptorSet  descriptor_set,
+        Binding        binding,
+        DescriptorType descriptor_type,
+        uint32_t       array_element = 0) noexcept;
 
     WriteDescriptorSet(const WriteDescriptorSet&) = delete;
     WriteDescriptorSet& operator=(const WriteDescriptorSet&) = delete;
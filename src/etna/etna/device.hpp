@@ -17,13 +17,18 @@ class Device {
         void AddQueue(uint32_t queue_family_index, uint32_t queue_count);
         void AddEnabledLayer(const char* layer_name);
         void AddEnabledExtension(const char* extension_name);
+        void EnableTimelineSemaphore();
+        void EnableDescriptorIndexing();
 
         VkDeviceCreateInfo state{};
 
       private:
-        std::vector<VkDeviceQueueCreateInfo> m_device_queues;
-        std::vector<const char*>             m_enabled_layer_names;
-        std::vector<const char*>             m_enabled_extension_names;
+        std::vector<VkDeviceQueueCreateInfo>          m_device_queues;
+        std::vector<const char*>                      m_enabled_layer_names;
+        std::vector<const char*>                      m_enabled_extension_names;
+        VkPhysicalDeviceFeatures                      m_enabled_features{};
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR  m_timeline_semaphore_features{};
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT m_descriptor_indexing_features{};
     };
 
     Device() noexcept {}
@@ -45,9 +50,15 @@ class Device {
         -> UniqueFramebuffer;
 
     auto CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& create_info) -> UniquePipeline;
+    auto CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& create_info, PipelineCache pipeline_cache)
+        -> UniquePipeline;
+
+    auto CreatePipelineCache(std::span<const uint8_t> initial_data = {}) -> UniquePipelineCache;
 
     auto CreatePipelineLayout(const VkPipelineLayoutCreateInfo& create_info) -> UniquePipelineLayout;
 
+    auto CreateQueryPool(QueryType query_type, uint32_t query_count) -> UniqueQueryPool;
+
     auto CreateRenderPass(const VkRenderPassCreateInfo& create_info) -> UniqueRenderPass;
 
     auto CreateSampler(const VkSamplerCreateInfo& create_info) -> UniqueSampler;
@@ -93,6 +104,8 @@ class Device {
 
     auto CreateSemaphore() -> UniqueSemaphore;
 
+    auto CreateTimelineSemaphore(uint64_t initial_value = 0) -> UniqueTimelineSemaphore;
+
     auto GetQueue(uint32_t queue_family_index) const noexcept -> Queue;
 
     auto GetSwapchainImagesKHR(SwapchainKHR swapchain) const -> std::vector<Image2D>;
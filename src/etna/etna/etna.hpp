@@ -7,6 +7,7 @@
 #include "image.hpp"
 #include "instance.hpp"
 #include "pipeline.hpp"
+#include "query.hpp"
 #include "queue.hpp"
 #include "renderpass.hpp"
 #include "sampler.hpp"
@@ -33,7 +33,9 @@ class PhysicalDevice {
     bool operator==(const PhysicalDevice&) const = default;
 
     auto GetPhysicalDeviceProperties() const -> PhysicalDeviceProperties;
+    auto GetPhysicalDeviceDescriptorIndexingFeatures() const -> PhysicalDeviceDescriptorIndexingFeatures;
     auto GetPhysicalDeviceFormatProperties(Format format) const -> FormatProperties;
+    auto GetPhysicalDeviceMemoryBudget() const -> DeviceMemoryBudget; // Requires VK_EXT_memory_budget
     auto GetPhysicalDeviceQueueFamilyProperties() const -> std::vector<QueueFamilyProperties>;
     auto GetPhysicalDeviceSurfaceCapabilitiesKHR(SurfaceKHR surface) const -> SurfaceCapabilitiesKHR;
     auto GetPhysicalDeviceSurfaceFormatsKHR(SurfaceKHR surface) const -> std::vector<SurfaceFormatKHR>;
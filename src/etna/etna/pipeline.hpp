@@ -2,6 +2,7 @@
 
 #include "core.hpp"
 
+#include <span>
 #include <vector>
 
 namespace etna {
@@ -13,10 +14,13 @@ class PipelineLayout {
 
         void AddDescriptorSetLayout(DescriptorSetLayout descriptor_set_layout);
 
+        void AddPushConstantRange(ShaderStage shader_stage_flags, uint32_t offset, uint32_t size);
+
         VkPipelineLayoutCreateInfo state{};
 
       private:
         std::vector<VkDescriptorSetLayout> m_descriptor_set_layouts;
+        std::vector<VkPushConstantRange>   m_push_constant_ranges;
     };
 
     PipelineLayout() noexcept {}
@@ -47,6 +51,39 @@ class PipelineLayout {
     VkDevice         m_device{};
 };
 
+class PipelineCache {
+  public:
+    PipelineCache() noexcept {}
+    PipelineCache(std::nullptr_t) noexcept {}
+
+    operator VkPipelineCache() const noexcept { return m_pipeline_cache; }
+
+    explicit operator bool() const noexcept { return m_pipeline_cache != nullptr; }
+
+    bool operator==(const PipelineCache&) const = default;
+
+    auto GetPipelineCacheData() const -> std::vector<uint8_t>;
+
+    static bool IsCompatible(std::span<const uint8_t> data, const PhysicalDeviceProperties& properties) noexcept;
+
+  private:
+    template <typename>
+    friend class UniqueHandle;
+
+    friend class Device;
+
+    PipelineCache(VkPipelineCache pipeline_cache, VkDevice device) noexcept
+        : m_pipeline_cache(pipeline_cache), m_device(device)
+    {}
+
+    static auto Create(VkDevice vk_device, const VkPipelineCacheCreateInfo& create_info) -> UniquePipelineCache;
+
+    void Destroy() noexcept;
+
+    VkPipelineCache m_pipeline_cache{};
+    VkDevice        m_device{};
+};
+
 class Pipeline {
   public:
     struct Builder final {
@@ -75,6 +112,8 @@ class Pipeline {
 
         void SetDepthState(DepthTest depth_test, DepthWrite depth_write, CompareOp compare_op) noexcept;
 
+        void SetPrimitiveTopology(PrimitiveTopology topology) noexcept;
+
         VkGraphicsPipelineCreateInfo state{};
 
       private:
@@ -115,7 +154,9 @@ class Pipeline {
 
     Pipeline(VkPipeline pipeline, VkDevice device) noexcept : m_pipeline(pipeline), m_device(device) {}
 
-    static auto Create(VkDevice vk_device, const VkGraphicsPipelineCreateInfo& create_info) -> UniquePipeline;
+    static auto
+    Create(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, const VkGraphicsPipelineCreateInfo& create_info)
+        -> UniquePipeline;
 
     void Destroy() noexcept;
 
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <vector>
+
+namespace etna {
+
+class QueryPool {
+  public:
+    QueryPool() noexcept {}
+    QueryPool(std::nullptr_t) noexcept {}
+
+    operator VkQueryPool() const noexcept { return m_query_pool; }
+
+    bool operator==(const QueryPool&) const = default;
+
+    auto QueryCount() const noexcept { return m_query_count; }
+
+    auto GetQueryPoolResults(uint32_t first_query, uint32_t query_count) const -> Return<std::vector<uint64_t>>;
+
+  private:
+    template <typename>
+    friend class UniqueHandle;
+
+    friend class Device;
+
+    QueryPool(VkQueryPool query_pool, VkDevice device, uint32_t query_count) noexcept
+        : m_query_pool(query_pool), m_device(device), m_query_count(query_count)
+    {}
+
+    static auto Create(VkDevice vk_device, const VkQueryPoolCreateInfo& create_info) -> UniqueQueryPool;
+
+    void Destroy() noexcept;
+
+    VkQueryPool m_query_pool{};
+    VkDevice    m_device{};
+    uint32_t    m_query_count{};
+};
+
+} // namespace etna
@@ -2,10 +2,68 @@
 
 #include "core.hpp"
 
+#include <array>
+
 namespace etna {
 
 class Queue {
   public:
+    class SubmitBatch final {
+      public:
+        SubmitBatch() noexcept = default;
+
+        void AddCommandBuffer(CommandBuffer command_buffer);
+        void AddWaitSemaphore(Semaphore semaphore, PipelineStage wait_stage);
+        void AddWaitSemaphore(TimelineSemaphore semaphore, PipelineStage wait_stage, uint64_t value);
+        void AddSignalSemaphore(Semaphore semaphore);
+        void AddSignalSemaphore(TimelineSemaphore semaphore, uint64_t value);
+
+        void NextSubmit();
+
+        void Clear() noexcept;
+
+        bool IsEmpty() const noexcept
+        {
+            return m_command_buffer_count == 0 && m_wait_semaphore_count == 0 && m_signal_semaphore_count == 0;
+        }
+
+        auto CommandBufferCount() const noexcept { return m_command_buffer_count; }
+
+      private:
+        friend class Queue;
+
+        static constexpr size_t kMaxSubmits        = 4;
+        static constexpr size_t kMaxCommandBuffers = 16;
+        static constexpr size_t kMaxSemaphores     = 16;
+
+        struct SubmitRange final {
+            uint32_t first_command_buffer;
+            uint32_t first_wait_semaphore;
+            uint32_t first_signal_semaphore;
+        };
+
+        auto End() const noexcept
+        {
+            return SubmitRange{ m_command_buffer_count, m_wait_semaphore_count, m_signal_semaphore_count };
+        }
+
+        void AddWait(VkSemaphore semaphore, PipelineStage wait_stage, uint64_t value);
+        void AddSignal(VkSemaphore semaphore, uint64_t value);
+
+        std::array<SubmitRange, kMaxSubmits>             m_submits{};
+        std::array<VkCommandBuffer, kMaxCommandBuffers>  m_command_buffers{};
+        std::array<VkSemaphore, kMaxSemaphores>          m_wait_semaphores{};
+        std::array<VkPipelineStageFlags, kMaxSemaphores> m_wait_stages{};
+        std::array<uint64_t, kMaxSemaphores>             m_wait_values{};
+        std::array<VkSemaphore, kMaxSemaphores>          m_signal_semaphores{};
+        std::array<uint64_t, kMaxSemaphores>             m_signal_values{};
+        uint32_t                                         m_submit_count           = 1;
+        uint32_t                                         m_command_buffer_count   = 0;
+        uint32_t                                         m_wait_semaphore_count   = 0;
+        uint32_t                                         m_signal_semaphore_count = 0;
+        bool                                             m_has_timeline_values    = false;
+    };
+
     Queue() noexcept {}
     Queue(std::nullptr_t) noexcept {}
     Queue(VkQueue queue, uint32_t family_index) noexcept : m_queue(queue), m_family_index(family_index) {}
@@ -28,6 +86,10 @@ class Queue {
         std::initializer_list<Semaphore>     signal_semaphores,
         Fence                                fence);
 
+    void Submit(const SubmitBatch& submit_batch);
+
+    void Submit(const SubmitBatch& submit_batch, Fence fence);
+
   private:
     VkQueue  m_queue{};
     uint32_t m_family_index{};
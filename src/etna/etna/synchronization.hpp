@@ -58,4 +58,46 @@ class Fence {
 
 inline const Fence Fence::Null = Fence{};
 
+class TimelineSemaphore {
+  public:
+    TimelineSemaphore() noexcept = default;
+    TimelineSemaphore(std::nullptr_t) noexcept {}
+
+    operator VkSemaphore() const noexcept { return m_semaphore; }
+
+    bool operator==(const TimelineSemaphore&) const = default;
+
+    auto GetCounterValue() const -> uint64_t;
+
+    void Signal(uint64_t value);
+
+    auto Wait(uint64_t value, uint64_t timeout = UINT64_MAX) const -> Result;
+
+  private:
+    template <typename>
+    friend class UniqueHandle;
+
+    friend class Device;
+
+    struct Functions final {
+        PFN_vkGetSemaphoreCounterValueKHR get_counter_value;
+        PFN_vkSignalSemaphoreKHR          signal;
+        PFN_vkWaitSemaphoresKHR           wait;
+
+        bool operator==(const Functions&) const = default;
+    };
+
+    TimelineSemaphore(VkSemaphore semaphore, VkDevice device, Functions functions) noexcept
+        : m_semaphore(semaphore), m_device(device), m_functions(functions)
+    {}
+
+    static auto Create(VkDevice vk_device, const VkSemaphoreCreateInfo& create_info) -> UniqueTimelineSemaphore;
+
+    void Destroy() noexcept;
+
+    VkSemaphore m_semaphore{};
+    VkDevice    m_device{};
+    Functions   m_functions{};
+};
+
 } // namespace etna
@@ -229,6 +229,57 @@ PhysicalDeviceProperties PhysicalDevice::GetPhysicalDeviceProperties() const
     return properties;
 }
 
+PhysicalDeviceDescriptorIndexingFeatures PhysicalDevice::GetPhysicalDeviceDescriptorIndexingFeatures() const
+{
+    assert(m_physical_device);
+
+    auto descriptor_indexing_features = PhysicalDeviceDescriptorIndexingFeatures{};
+
+    descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+    auto features = VkPhysicalDeviceFeatures2{
+
+        .sType    = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext    = &descriptor_indexing_features,
+        .features = {}
+    };
+
+    vkGetPhysicalDeviceFeatures2(m_physical_device, &features);
+
+    descriptor_indexing_features.pNext = nullptr;
+
+    return descriptor_indexing_features;
+}
+
+DeviceMemoryBudget PhysicalDevice::GetPhysicalDeviceMemoryBudget() const
+{
+    assert(m_physical_device);
+
+    auto budget_properties = VkPhysicalDeviceMemoryBudgetPropertiesEXT{};
+
+    budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    auto properties = VkPhysicalDeviceMemoryProperties2{
+
+        .sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+        .pNext            = &budget_properties,
+        .memoryProperties = {}
+    };
+
+    vkGetPhysicalDeviceMemoryProperties2(m_physical_device, &properties);
+
+    auto memory_budget = DeviceMemoryBudget{};
+
+    for (uint32_t heap = 0; heap < properties.memoryProperties.memoryHeapCount; ++heap) {
+        if (properties.memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            memory_budget.usage += budget_properties.heapUsage[heap];
+            memory_budget.budget += budget_properties.heapBudget[heap];
+        }
+    }
+
+    return memory_budget;
+}
+
 FormatProperties PhysicalDevice::GetPhysicalDeviceFormatProperties(Format format) const
 {
     assert(m_physical_device);
@@ -4,6 +4,7 @@
 #include "etna/shader.hpp"
 
 #include <cassert>
+#include <cstring>
 
 namespace etna {
 
@@ -29,6 +30,14 @@ void PipelineLayout::Builder::AddDescriptorSetLayout(DescriptorSetLayout descrip
     state.pSetLayouts    = m_descriptor_set_layouts.data();
 }
 
+void PipelineLayout::Builder::AddPushConstantRange(ShaderStage shader_stage_flags, uint32_t offset, uint32_t size)
+{
+    m_push_constant_ranges.push_back({ VkEnum(shader_stage_flags), offset, size });
+
+    state.pushConstantRangeCount = narrow_cast<uint32_t>(m_push_constant_ranges.size());
+    state.pPushConstantRanges    = m_push_constant_ranges.data();
+}
+
 Pipeline::Builder::Builder()
 {
     m_vertex_input_state = VkPipelineVertexInputStateCreateInfo{
@@ -277,6 +286,60 @@ void Pipeline::Builder::SetDepthState(DepthTest depth_test, DepthWrite depth_wri
     m_depth_stencil_state.depthCompareOp   = VkEnum(compare_op);
 }
 
+void Pipeline::Builder::SetPrimitiveTopology(PrimitiveTopology topology) noexcept
+{
+    m_input_assembly_state.topology = VkEnum(topology);
+}
+
+auto PipelineCache::GetPipelineCacheData() const -> std::vector<uint8_t>
+{
+    assert(m_pipeline_cache);
+
+    size_t data_size{};
+
+    if (auto result = vkGetPipelineCacheData(m_device, m_pipeline_cache, &data_size, nullptr); result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+
+    auto data = std::vector<uint8_t>(data_size);
+
+    if (auto result = vkGetPipelineCacheData(m_device, m_pipeline_cache, &data_size, data.data());
+        result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+
+    data.resize(data_size);
+
+    return data;
+}
+
+bool PipelineCache::IsCompatible(std::span<const uint8_t> data, const PhysicalDeviceProperties& properties) noexcept
+{
+    // Pipeline cache header, version one (Vulkan spec, vkGetPipelineCacheData).
+    struct Header final {
+        uint32_t header_size;
+        uint32_t header_version;
+        uint32_t vendor_id;
+        uint32_t device_id;
+        uint8_t  pipeline_cache_uuid[VK_UUID_SIZE];
+    };
+
+    static_assert(sizeof(Header) == 16 + VK_UUID_SIZE);
+
+    if (data.size() < sizeof(Header)) {
+        return false;
+    }
+
+    auto header = Header{};
+
+    memcpy(&header, data.data(), sizeof(Header));
+
+    return header.header_size >= sizeof(Header) && header.header_size <= data.size() &&
+           header.header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && header.vendor_id == properties.vendorID &&
+           header.device_id == properties.deviceID &&
+           memcmp(header.pipeline_cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
 UniquePipelineLayout PipelineLayout::Create(VkDevice vk_device, const VkPipelineLayoutCreateInfo& create_info)
 {
     VkPipelineLayout vk_pipeline_layout{};
@@ -299,11 +362,36 @@ void PipelineLayout::Destroy() noexcept
     m_device          = nullptr;
 }
 
-UniquePipeline Pipeline::Create(VkDevice vk_device, const VkGraphicsPipelineCreateInfo& create_info)
+UniquePipelineCache PipelineCache::Create(VkDevice vk_device, const VkPipelineCacheCreateInfo& create_info)
+{
+    VkPipelineCache vk_pipeline_cache{};
+
+    if (auto result = vkCreatePipelineCache(vk_device, &create_info, nullptr, &vk_pipeline_cache);
+        result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+
+    return UniquePipelineCache(PipelineCache(vk_pipeline_cache, vk_device));
+}
+
+void PipelineCache::Destroy() noexcept
+{
+    assert(m_pipeline_cache);
+
+    vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
+
+    m_pipeline_cache = nullptr;
+    m_device         = nullptr;
+}
+
+UniquePipeline Pipeline::Create(
+    VkDevice                            vk_device,
+    VkPipelineCache                     vk_pipeline_cache,
+    const VkGraphicsPipelineCreateInfo& create_info)
 {
     VkPipeline vk_pipeline{};
 
-    if (auto result = vkCreateGraphicsPipelines(vk_device, {}, 1, &create_info, nullptr, &vk_pipeline);
+    if (auto result = vkCreateGraphicsPipelines(vk_device, vk_pipeline_cache, 1, &create_info, nullptr, &vk_pipeline);
         result != VK_SUCCESS) {
         throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
     }
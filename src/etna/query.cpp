@@ -0,0 +1,56 @@
+#include "etna/query.hpp"
+
+#include <cassert>
+
+namespace etna {
+
+auto QueryPool::GetQueryPoolResults(uint32_t first_query, uint32_t query_count) const -> Return<std::vector<uint64_t>>
+{
+    assert(m_query_pool);
+
+    auto results = std::vector<uint64_t>(query_count);
+
+    auto vk_result = vkGetQueryPoolResults(
+        m_device,
+        m_query_pool,
+        first_query,
+        query_count,
+        results.size() * sizeof(uint64_t),
+        results.data(),
+        sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT);
+
+    if (vk_result == VK_NOT_READY) {
+        return Return<std::vector<uint64_t>>(Result::NotReady);
+    }
+
+    if (vk_result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(vk_result));
+    }
+
+    return Return(std::move(results));
+}
+
+UniqueQueryPool QueryPool::Create(VkDevice vk_device, const VkQueryPoolCreateInfo& create_info)
+{
+    VkQueryPool vk_query_pool{};
+
+    if (auto result = vkCreateQueryPool(vk_device, &create_info, nullptr, &vk_query_pool); result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+
+    return UniqueQueryPool(QueryPool(vk_query_pool, vk_device, create_info.queryCount));
+}
+
+void QueryPool::Destroy() noexcept
+{
+    assert(m_query_pool);
+
+    vkDestroyQueryPool(m_device, m_query_pool, nullptr);
+
+    m_query_pool  = nullptr;
+    m_device      = nullptr;
+    m_query_count = 0;
+}
+
+} // namespace etna
@@ -93,4 +93,132 @@ void Queue::Submit(
     vkQueueSubmit(m_queue, 1, &submit_info, fence);
 }
 
+void Queue::Submit(const SubmitBatch& submit_batch)
+{
+    Submit(submit_batch, {});
+}
+
+void Queue::Submit(const SubmitBatch& submit_batch, Fence fence)
+{
+    assert(m_queue);
+
+    using Batch = SubmitBatch;
+
+    std::array<VkSubmitInfo, Batch::kMaxSubmits>                  submit_infos;
+    std::array<VkTimelineSemaphoreSubmitInfo, Batch::kMaxSubmits> timeline_infos;
+
+    for (uint32_t i = 0; i < submit_batch.m_submit_count; ++i) {
+        const auto& submit = submit_batch.m_submits[i];
+        const auto  next   = i + 1 < submit_batch.m_submit_count ? submit_batch.m_submits[i + 1] : submit_batch.End();
+
+        auto command_buffer_count   = next.first_command_buffer - submit.first_command_buffer;
+        auto wait_semaphore_count   = next.first_wait_semaphore - submit.first_wait_semaphore;
+        auto signal_semaphore_count = next.first_signal_semaphore - submit.first_signal_semaphore;
+
+        timeline_infos[i] = VkTimelineSemaphoreSubmitInfo{
+
+            .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .pNext                     = nullptr,
+            .waitSemaphoreValueCount   = wait_semaphore_count,
+            .pWaitSemaphoreValues      = submit_batch.m_wait_values.data() + submit.first_wait_semaphore,
+            .signalSemaphoreValueCount = signal_semaphore_count,
+            .pSignalSemaphoreValues    = submit_batch.m_signal_values.data() + submit.first_signal_semaphore
+        };
+
+        submit_infos[i] = VkSubmitInfo{
+
+            .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext                = submit_batch.m_has_timeline_values ? &timeline_infos[i] : nullptr,
+            .waitSemaphoreCount   = wait_semaphore_count,
+            .pWaitSemaphores      = submit_batch.m_wait_semaphores.data() + submit.first_wait_semaphore,
+            .pWaitDstStageMask    = submit_batch.m_wait_stages.data() + submit.first_wait_semaphore,
+            .commandBufferCount   = command_buffer_count,
+            .pCommandBuffers      = submit_batch.m_command_buffers.data() + submit.first_command_buffer,
+            .signalSemaphoreCount = signal_semaphore_count,
+            .pSignalSemaphores    = submit_batch.m_signal_semaphores.data() + submit.first_signal_semaphore
+        };
+    }
+
+    if (auto result = vkQueueSubmit(m_queue, submit_batch.m_submit_count, submit_infos.data(), fence);
+        result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+}
+
+void Queue::SubmitBatch::AddCommandBuffer(CommandBuffer command_buffer)
+{
+    if (m_command_buffer_count == m_command_buffers.size()) {
+        throw_etna_error(__FILE__, __LINE__, "Too many command buffers in Queue::SubmitBatch");
+    }
+
+    m_command_buffers[m_command_buffer_count++] = command_buffer;
+}
+
+void Queue::SubmitBatch::AddWaitSemaphore(Semaphore semaphore, PipelineStage wait_stage)
+{
+    AddWait(static_cast<VkSemaphore>(semaphore), wait_stage, 0);
+}
+
+void Queue::SubmitBatch::AddWaitSemaphore(TimelineSemaphore semaphore, PipelineStage wait_stage, uint64_t value)
+{
+    AddWait(static_cast<VkSemaphore>(semaphore), wait_stage, value);
+
+    m_has_timeline_values = true;
+}
+
+void Queue::SubmitBatch::AddSignalSemaphore(Semaphore semaphore)
+{
+    AddSignal(static_cast<VkSemaphore>(semaphore), 0);
+}
+
+void Queue::SubmitBatch::AddSignalSemaphore(TimelineSemaphore semaphore, uint64_t value)
+{
+    AddSignal(static_cast<VkSemaphore>(semaphore), value);
+
+    m_has_timeline_values = true;
+}
+
+void Queue::SubmitBatch::AddWait(VkSemaphore semaphore, PipelineStage wait_stage, uint64_t value)
+{
+    if (m_wait_semaphore_count == m_wait_semaphores.size()) {
+        throw_etna_error(__FILE__, __LINE__, "Too many wait semaphores in Queue::SubmitBatch");
+    }
+
+    m_wait_semaphores[m_wait_semaphore_count] = semaphore;
+    m_wait_stages[m_wait_semaphore_count]     = VkEnum(wait_stage);
+    m_wait_values[m_wait_semaphore_count]     = value;
+
+    ++m_wait_semaphore_count;
+}
+
+void Queue::SubmitBatch::AddSignal(VkSemaphore semaphore, uint64_t value)
+{
+    if (m_signal_semaphore_count == m_signal_semaphores.size()) {
+        throw_etna_error(__FILE__, __LINE__, "Too many signal semaphores in Queue::SubmitBatch");
+    }
+
+    m_signal_semaphores[m_signal_semaphore_count] = semaphore;
+    m_signal_values[m_signal_semaphore_count]     = value;
+
+    ++m_signal_semaphore_count;
+}
+
+void Queue::SubmitBatch::NextSubmit()
+{
+    if (m_submit_count == m_submits.size()) {
+        throw_etna_error(__FILE__, __LINE__, "Too many submits in Queue::SubmitBatch");
+    }
+
+    m_submits[m_submit_count++] = End();
+}
+
+void Queue::SubmitBatch::Clear() noexcept
+{
+    m_submit_count           = 1;
+    m_command_buffer_count   = 0;
+    m_wait_semaphore_count   = 0;
+    m_signal_semaphore_count = 0;
+    m_has_timeline_values    = false;
+}
+
 } // namespace etna
@@ -46,4 +46,91 @@ void Fence::Destroy() noexcept
     m_device = nullptr;
 }
 
+uint64_t TimelineSemaphore::GetCounterValue() const
+{
+    assert(m_semaphore);
+
+    uint64_t value{};
+
+    if (auto result = m_functions.get_counter_value(m_device, m_semaphore, &value); result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+
+    return value;
+}
+
+void TimelineSemaphore::Signal(uint64_t value)
+{
+    assert(m_semaphore);
+
+    auto signal_info = VkSemaphoreSignalInfoKHR{
+
+        .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR,
+        .pNext     = nullptr,
+        .semaphore = m_semaphore,
+        .value     = value
+    };
+
+    if (auto result = m_functions.signal(m_device, &signal_info); result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+}
+
+Result TimelineSemaphore::Wait(uint64_t value, uint64_t timeout) const
+{
+    assert(m_semaphore);
+
+    auto wait_info = VkSemaphoreWaitInfoKHR{
+
+        .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+        .pNext          = nullptr,
+        .flags          = {},
+        .semaphoreCount = 1,
+        .pSemaphores    = &m_semaphore,
+        .pValues        = &value
+    };
+
+    auto result = m_functions.wait(m_device, &wait_info, timeout);
+
+    if (result != VK_SUCCESS && result != VK_TIMEOUT) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+
+    return static_cast<Result>(result);
+}
+
+UniqueTimelineSemaphore TimelineSemaphore::Create(VkDevice vk_device, const VkSemaphoreCreateInfo& create_info)
+{
+    auto functions = Functions{
+
+        .get_counter_value = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+            vkGetDeviceProcAddr(vk_device, "vkGetSemaphoreCounterValueKHR")),
+        .signal = reinterpret_cast<PFN_vkSignalSemaphoreKHR>(vkGetDeviceProcAddr(vk_device, "vkSignalSemaphoreKHR")),
+        .wait   = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(vk_device, "vkWaitSemaphoresKHR"))
+    };
+
+    if (!functions.get_counter_value || !functions.signal || !functions.wait) {
+        throw_etna_error(__FILE__, __LINE__, "VK_KHR_timeline_semaphore is not enabled");
+    }
+
+    VkSemaphore vk_semaphore{};
+
+    if (auto result = vkCreateSemaphore(vk_device, &create_info, nullptr, &vk_semaphore); result != VK_SUCCESS) {
+        throw_etna_error(__FILE__, __LINE__, static_cast<Result>(result));
+    }
+
+    return UniqueTimelineSemaphore(TimelineSemaphore(vk_semaphore, vk_device, functions));
+}
+
+void TimelineSemaphore::Destroy() noexcept
+{
+    assert(m_semaphore);
+
+    vkDestroySemaphore(m_device, m_semaphore, nullptr);
+
+    m_semaphore = nullptr;
+    m_device    = nullptr;
+    m_functions = {};
+}
+
 } // namespace etna
@@ -23,4 +23,5 @@ void main() {
     gl_Position = proj * view * model * vec4(inPosition, 1.0);
     outNormal = inNormal;
     outTexCoord = inTexCoord;
+    gl_PointSize = 1.0;
 }
@@ -0,0 +1,28 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (push_constant) uniform DrawConstants
+{
+    mat4 model;
+    uint textureIndex;
+};
+
+layout (set = 0, binding = 1) uniform CameraTransform
+{
+    mat4 view;
+    mat4 proj;
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec2 outTexCoord;
+
+void main() {
+    gl_Position = proj * view * model * vec4(inPosition, 1.0);
+    outNormal = inNormal;
+    outTexCoord = inTexCoord;
+    gl_PointSize = 1.0;
+}
@@ -0,0 +1,60 @@
+#include "utils/atom.hpp"
+
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+class AtomTable final {
+  public:
+    static AtomTable& Instance()
+    {
+        static AtomTable table;
+        return table;
+    }
+
+    std::string_view Intern(uint64_t hash, std::string_view name)
+    {
+        {
+            auto lock = std::shared_lock(m_mutex);
+            if (auto iter = m_names.find(hash); iter != m_names.end()) {
+                return CheckName(iter->second, name);
+            }
+        }
+
+        auto lock = std::unique_lock(m_mutex);
+
+        auto [iter, inserted] = m_names.try_emplace(hash, name);
+
+        return CheckName(iter->second, name);
+    }
+
+  private:
+    // Atoms compare by hash alone, so a name whose hash is already taken by another name must not become an atom.
+    static std::string_view CheckName(const std::string& stored, std::string_view name)
+    {
+        if (stored != name) {
+            throw std::runtime_error(
+                "Cannot create atom \"" + std::string(name) + "\": its hash collides with \"" + stored + "\"");
+        }
+        return stored;
+    }
+
+    AtomTable()                 = default;
+    AtomTable(const AtomTable&) = delete;
+    AtomTable& operator=(const AtomTable&) = delete;
+
+    // Nodes of an unordered_map never move, so views into the mapped strings stay valid across rehashing.
+    std::shared_mutex                         m_mutex;
+    std::unordered_map<uint64_t, std::string> m_names;
+};
+
+} // namespace
+
+std::string_view detail::intern_atom(uint64_t hash, std::string_view name)
+{
+    return AtomTable::Instance().Intern(hash, name);
+}
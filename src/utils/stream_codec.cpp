@@ -0,0 +1,472 @@
+#include "utils/stream_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// SSE2 is part of every x86-64 target; other targets decode with the portable loops.
+#if defined(__SSE2__) || defined(_M_X64)
+#define VEGA_STREAM_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#ifdef VEGA_STREAM_CODEC_SSE2
+constexpr bool kHasSse2 = true;
+#else
+constexpr bool kHasSse2 = false;
+#endif
+
+constexpr uint32_t kMagic       = 0x43534756; // "VGSC"
+constexpr size_t   kHeaderSize  = 16;
+constexpr size_t   kChunkSize   = 4096; // Elements per chunk; the planes of one chunk stay in L1
+constexpr size_t   kGroupSize   = 16;
+constexpr size_t   kMaxStride   = 256;
+constexpr size_t   kSampleSize  = 16384;
+constexpr size_t   kPlaneCount  = 4;
+constexpr size_t   kGroupWidths = 4;
+
+using Plane = std::array<uint8_t, kChunkSize>;
+
+struct Header final {
+    uint32_t magic;
+    uint32_t stride;
+    uint64_t size;
+};
+
+[[noreturn]] void ThrowMalformed()
+{
+    throw std::runtime_error("Cannot decode stream: data is malformed");
+}
+
+uint32_t ZigZag(uint32_t delta) noexcept
+{
+    return (delta << 1) ^ (0U - (delta >> 31));
+}
+
+uint32_t UnZigZag(uint32_t value) noexcept
+{
+    return (value >> 1) ^ (0U - (value & 1));
+}
+
+uint32_t LoadWord(const std::byte* src) noexcept
+{
+    auto word = uint32_t{};
+    std::memcpy(&word, src, sizeof(word));
+    return word;
+}
+
+// Width codes 0, 1, 2 and 3 stand for 0, 2, 4 and 8 bits per byte.
+constexpr size_t GroupBytes(uint32_t code) noexcept
+{
+    return code == 0 ? 0 : (size_t{ 2 } << code);
+}
+
+uint32_t GroupCode(const uint8_t* values) noexcept
+{
+    auto bits = uint8_t{ 0 };
+    for (size_t i = 0; i < kGroupSize; ++i) {
+        bits |= values[i];
+    }
+    return bits == 0 ? 0 : bits < 4 ? 1 : bits < 16 ? 2 : 3;
+}
+
+void EncodePlane(const uint8_t* plane, size_t count, std::vector<std::byte>* out)
+{
+    auto group_count = (count + kGroupSize - 1) / kGroupSize;
+    auto header      = out->size();
+
+    out->resize(header + (group_count + kGroupWidths - 1) / kGroupWidths);
+
+    for (size_t group = 0; group < group_count; ++group) {
+        auto values = plane + group * kGroupSize;
+        auto code   = GroupCode(values);
+        auto packed = std::array<uint8_t, kGroupSize>{};
+
+        (*out)[header + group / kGroupWidths] |= static_cast<std::byte>(code << (2 * (group % kGroupWidths)));
+
+        switch (code) {
+        case 1:
+            for (size_t i = 0; i < 4; ++i) {
+                auto v    = values + 4 * i;
+                packed[i] = static_cast<uint8_t>(v[0] | (v[1] << 2) | (v[2] << 4) | (v[3] << 6));
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < 8; ++i) {
+                packed[i] = static_cast<uint8_t>(values[2 * i] | (values[2 * i + 1] << 4));
+            }
+            break;
+        case 3: std::memcpy(packed.data(), values, kGroupSize); break;
+        }
+
+        auto bytes = reinterpret_cast<const std::byte*>(packed.data());
+        out->insert(out->end(), bytes, bytes + GroupBytes(code));
+    }
+}
+
+void DecodeGroup(uint32_t code, const uint8_t* data, uint8_t* values) noexcept
+{
+#ifdef VEGA_STREAM_CODEC_SSE2
+    auto out = __m128i{};
+
+    switch (code) {
+    case 0: out = _mm_setzero_si128(); break;
+    case 1: {
+        // Each packed byte is spread over four bytes, whose two bits are tested by masks 0x01/0x02 to 0x40/0x80.
+        auto lo    = _mm_set1_epi32(0x40100401);
+        auto hi    = _mm_set1_epi32(static_cast<int>(0x80200802));
+        auto bytes = _mm_cvtsi32_si128(static_cast<int>(LoadWord(reinterpret_cast<const std::byte*>(data))));
+
+        bytes = _mm_unpacklo_epi8(bytes, bytes);
+        bytes = _mm_unpacklo_epi16(bytes, bytes);
+
+        auto lo_bits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(bytes, lo), lo), _mm_set1_epi8(1));
+        auto hi_bits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(bytes, hi), hi), _mm_set1_epi8(2));
+
+        out = _mm_or_si128(lo_bits, hi_bits);
+        break;
+    }
+    case 2: {
+        auto bytes  = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+        auto nibble = _mm_set1_epi8(15);
+
+        out = _mm_unpacklo_epi8(_mm_and_si128(bytes, nibble), _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+        break;
+    }
+    default: out = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)); break;
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), out);
+#else
+    switch (code) {
+    case 0: std::memset(values, 0, kGroupSize); break;
+    case 1:
+        for (size_t i = 0; i < kGroupSize; ++i) {
+            values[i] = (data[i / 4] >> (2 * (i % 4))) & 3;
+        }
+        break;
+    case 2:
+        for (size_t i = 0; i < kGroupSize; ++i) {
+            values[i] = (data[i / 2] >> (4 * (i % 2))) & 15;
+        }
+        break;
+    default: std::memcpy(values, data, kGroupSize); break;
+    }
+#endif
+}
+
+const std::byte* DecodePlane(const std::byte* src, const std::byte* end, uint8_t* plane, size_t count)
+{
+    auto group_count = (count + kGroupSize - 1) / kGroupSize;
+    auto header_size = (group_count + kGroupWidths - 1) / kGroupWidths;
+
+    if (static_cast<size_t>(end - src) < header_size) {
+        ThrowMalformed();
+    }
+
+    auto header = reinterpret_cast<const uint8_t*>(src);
+    auto data   = reinterpret_cast<const uint8_t*>(src + header_size);
+    auto last   = reinterpret_cast<const uint8_t*>(end);
+
+    for (size_t group = 0; group < group_count; ++group) {
+        auto code   = static_cast<uint32_t>(header[group / kGroupWidths] >> (2 * (group % kGroupWidths))) & 3;
+        auto values = plane + group * kGroupSize;
+
+        if (static_cast<size_t>(last - data) < GroupBytes(code)) {
+            ThrowMalformed();
+        }
+
+        DecodeGroup(code, data, values);
+
+        data += GroupBytes(code);
+    }
+
+    return reinterpret_cast<const std::byte*>(data);
+}
+
+// Joins the planes of one lane back into words, undoes the zigzag mapping and the deltas, and writes the words to every
+// stride bytes of dst. Returns the last word, which the next chunk continues from.
+uint32_t DecodeLane(
+    const std::array<Plane, kPlaneCount>& planes,
+    size_t                                count,
+    std::byte*                            dst,
+    size_t                                stride,
+    uint32_t                              word) noexcept
+{
+    auto i = size_t{ 0 };
+
+#ifdef VEGA_STREAM_CODEC_SSE2
+    auto one   = _mm_set1_epi32(1);
+    auto carry = _mm_set1_epi32(static_cast<int>(word));
+
+    for (; i + kGroupSize <= count; i += kGroupSize) {
+        auto p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0].data() + i));
+        auto p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1].data() + i));
+        auto p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2].data() + i));
+        auto p3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[3].data() + i));
+
+        auto p01_lo = _mm_unpacklo_epi8(p0, p1);
+        auto p01_hi = _mm_unpackhi_epi8(p0, p1);
+        auto p23_lo = _mm_unpacklo_epi8(p2, p3);
+        auto p23_hi = _mm_unpackhi_epi8(p2, p3);
+
+        auto values = std::array{ _mm_unpacklo_epi16(p01_lo, p23_lo),
+                                  _mm_unpackhi_epi16(p01_lo, p23_lo),
+                                  _mm_unpacklo_epi16(p01_hi, p23_hi),
+                                  _mm_unpackhi_epi16(p01_hi, p23_hi) };
+
+        for (auto value : values) {
+            // Four deltas become four words with a prefix sum in two shifted adds, on top of the previous word.
+            auto sign  = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, one));
+            auto delta = _mm_xor_si128(_mm_srli_epi32(value, 1), sign);
+
+            delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+            delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+
+            auto words = _mm_add_epi32(delta, carry);
+
+            carry = _mm_shuffle_epi32(words, 0xFF);
+
+            if (stride == 4) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), words);
+            } else {
+                alignas(16) uint32_t lanes[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), words);
+                for (size_t k = 0; k < 4; ++k) {
+                    std::memcpy(dst + k * stride, &lanes[k], sizeof(uint32_t));
+                }
+            }
+
+            dst += 4 * stride;
+        }
+    }
+
+    word = static_cast<uint32_t>(_mm_cvtsi128_si32(carry));
+#endif
+
+    for (; i < count; ++i) {
+        auto value = uint32_t{ planes[0][i] } | (uint32_t{ planes[1][i] } << 8) | (uint32_t{ planes[2][i] } << 16) |
+                     (uint32_t{ planes[3][i] } << 24);
+        word += UnZigZag(value);
+        std::memcpy(dst, &word, sizeof(word));
+        dst += stride;
+    }
+
+    return word;
+}
+
+// Writes the words of each lane, kChunkSize apart in words, to their place in the elements of dst. Four lanes of four
+// elements are transposed at a time, so that every store is a whole 16 bytes of one element.
+void InterleaveLanes(const uint32_t* words, size_t lane_count, size_t count, std::byte* dst) noexcept
+{
+    auto stride = lane_count * 4;
+    auto lane   = size_t{ 0 };
+
+#ifdef VEGA_STREAM_CODEC_SSE2
+    for (; lane + 4 <= lane_count; lane += 4) {
+        auto w0 = words + lane * kChunkSize;
+        auto w1 = w0 + kChunkSize;
+        auto w2 = w1 + kChunkSize;
+        auto w3 = w2 + kChunkSize;
+        auto i  = size_t{ 0 };
+
+        for (; i + 4 <= count; i += 4) {
+            auto r0  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w0 + i));
+            auto r1  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w1 + i));
+            auto r2  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w2 + i));
+            auto r3  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w3 + i));
+            auto t0  = _mm_unpacklo_epi32(r0, r1);
+            auto t1  = _mm_unpacklo_epi32(r2, r3);
+            auto t2  = _mm_unpackhi_epi32(r0, r1);
+            auto t3  = _mm_unpackhi_epi32(r2, r3);
+            auto out = dst + i * stride + lane * 4;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi64(t0, t1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + stride), _mm_unpackhi_epi64(t0, t1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * stride), _mm_unpacklo_epi64(t2, t3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 3 * stride), _mm_unpackhi_epi64(t2, t3));
+        }
+        for (; i < count; ++i) {
+            for (size_t k = 0; k < 4; ++k) {
+                std::memcpy(dst + i * stride + (lane + k) * 4, words + (lane + k) * kChunkSize + i, 4);
+            }
+        }
+    }
+#endif
+
+    for (; lane < lane_count; ++lane) {
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(dst + i * stride + lane * 4, words + lane * kChunkSize + i, 4);
+        }
+    }
+}
+
+auto ReadHeader(std::span<const std::byte> encoded) -> Header
+{
+    auto header = Header{};
+
+    if (encoded.size() < kHeaderSize) {
+        ThrowMalformed();
+    }
+
+    std::memcpy(&header.magic, encoded.data(), 4);
+    std::memcpy(&header.stride, encoded.data() + 4, 4);
+    std::memcpy(&header.size, encoded.data() + 8, 8);
+
+    if (header.magic != kMagic || header.stride == 0 || header.stride % 4 != 0 || header.stride > kMaxStride) {
+        ThrowMalformed();
+    }
+    if (header.size > std::numeric_limits<size_t>::max()) {
+        ThrowMalformed();
+    }
+
+    return header;
+}
+
+} // namespace
+
+namespace utils {
+
+std::vector<std::byte> EncodeStream(std::span<const std::byte> data, size_t stride)
+{
+    if (stride == 0 || stride % 4 != 0 || stride > kMaxStride) {
+        throw std::invalid_argument("Cannot encode stream: stride is not valid");
+    }
+
+    auto header = Header{ kMagic, static_cast<uint32_t>(stride), data.size() };
+    auto out    = std::vector<std::byte>(kHeaderSize);
+
+    std::memcpy(out.data(), &header.magic, 4);
+    std::memcpy(out.data() + 4, &header.stride, 4);
+    std::memcpy(out.data() + 8, &header.size, 8);
+
+    // Compressible data shrinks well below this, and incompressible data grows only by the group headers.
+    out.reserve(kHeaderSize + data.size() + data.size() / 64 + 64);
+
+    auto lane_count    = stride / 4;
+    auto element_count = data.size() / stride;
+    auto previous      = std::array<uint32_t, kMaxStride / 4>{};
+    auto planes        = std::array<Plane, kPlaneCount>{};
+
+    for (size_t first = 0; first < element_count; first += kChunkSize) {
+        auto count  = std::min(kChunkSize, element_count - first);
+        auto padded = (count + kGroupSize - 1) / kGroupSize * kGroupSize;
+
+        for (size_t lane = 0; lane < lane_count; ++lane) {
+            auto src  = data.data() + first * stride + lane * 4;
+            auto last = previous[lane];
+
+            for (size_t i = 0; i < count; ++i) {
+                auto word  = LoadWord(src + i * stride);
+                auto value = ZigZag(word - last);
+                last       = word;
+                for (size_t p = 0; p < kPlaneCount; ++p) {
+                    planes[p][i] = static_cast<uint8_t>(value >> (8 * p));
+                }
+            }
+
+            previous[lane] = last;
+
+            for (auto& plane : planes) {
+                std::fill(plane.data() + count, plane.data() + padded, uint8_t{ 0 });
+                EncodePlane(plane.data(), count, &out);
+            }
+        }
+    }
+
+    auto tail = data.subspan(element_count * stride);
+    out.insert(out.end(), tail.begin(), tail.end());
+
+    return out;
+}
+
+size_t GetDecodedStreamSize(std::span<const std::byte> encoded)
+{
+    return static_cast<size_t>(ReadHeader(encoded).size);
+}
+
+void DecodeStream(std::span<const std::byte> encoded, std::span<std::byte> data)
+{
+    auto header = ReadHeader(encoded);
+
+    if (data.size() != header.size) {
+        throw std::invalid_argument("Cannot decode stream: destination size does not match");
+    }
+
+    auto stride        = size_t{ header.stride };
+    auto lane_count    = stride / 4;
+    auto element_count = data.size() / stride;
+    auto previous      = std::array<uint32_t, kMaxStride / 4>{};
+    auto planes        = std::array<Plane, kPlaneCount>{};
+    auto src           = encoded.data() + kHeaderSize;
+    auto end           = encoded.data() + encoded.size();
+
+    // Writing one lane at a time touches every cache line of a chunk once per lane. With SSE2, wider elements are
+    // decoded into the words of the chunk first and written one element at a time.
+    auto is_transposed = kHasSse2 && lane_count > 1;
+    auto words         = std::vector<uint32_t>(is_transposed ? lane_count * kChunkSize : 0);
+
+    for (size_t first = 0; first < element_count; first += kChunkSize) {
+        auto count = std::min(kChunkSize, element_count - first);
+
+        for (size_t lane = 0; lane < lane_count; ++lane) {
+            for (auto& plane : planes) {
+                src = DecodePlane(src, end, plane.data(), count);
+            }
+
+            if (is_transposed) {
+                auto dst       = reinterpret_cast<std::byte*>(words.data() + lane * kChunkSize);
+                previous[lane] = DecodeLane(planes, count, dst, 4, previous[lane]);
+            } else {
+                auto dst       = data.data() + first * stride + lane * 4;
+                previous[lane] = DecodeLane(planes, count, dst, stride, previous[lane]);
+            }
+        }
+
+        if (is_transposed) {
+            InterleaveLanes(words.data(), lane_count, count, data.data() + first * stride);
+        }
+    }
+
+    auto tail_size = data.size() - element_count * stride;
+
+    if (static_cast<size_t>(end - src) != tail_size) {
+        ThrowMalformed();
+    }
+
+    if (tail_size) {
+        std::memcpy(data.data() + element_count * stride, src, tail_size);
+    }
+}
+
+size_t FindStreamStride(std::span<const std::byte> data, size_t max_stride)
+{
+    auto best        = size_t{ 4 };
+    auto best_size   = size_t{ 1 };
+    auto best_sample = size_t{ 0 };
+
+    for (size_t stride = 4; stride <= std::min(max_stride, kMaxStride); stride += 4) {
+        if (data.size() % stride != 0) {
+            continue;
+        }
+
+        // Samples are cut to whole elements, so their lengths differ slightly; compare bytes per sample byte.
+        auto sample = std::min(data.size(), kSampleSize) / stride * stride;
+        auto size   = EncodeStream(data.first(sample), stride).size();
+
+        if (best_sample == 0 || size * best_sample < best_size * sample) {
+            best        = stride;
+            best_size   = size;
+            best_sample = sample;
+        }
+    }
+
+    return best;
+}
+
+} // namespace utils
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace detail {
+
+auto intern_atom(uint64_t hash, std::string_view name) -> std::string_view;
+
+constexpr uint64_t hash_atom(std::string_view name) noexcept
+{
+    auto hash = uint64_t{ 0xcbf29ce484222325 };
+    for (auto c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * uint64_t{ 0x100000001b3 };
+    }
+    return hash;
+}
+
+} // namespace detail
+
+namespace utils {
+
+// An interned name that compares, orders and hashes as a single integer. Atoms built in a constant expression
+// refer to their string literal directly, so built-in names can be compile-time constants. Atoms built at runtime
+// register their name once in a global table; later atoms with the same name only look it up and never allocate.
+// Registering a name whose hash is already taken by a different name throws.
+class Atom final {
+  public:
+    constexpr Atom() noexcept = default;
+
+    constexpr Atom(std::string_view name) : m_hash(detail::hash_atom(name)), m_name(name)
+    {
+        if (!std::is_constant_evaluated()) {
+            m_name = detail::intern_atom(m_hash, name);
+        }
+    }
+
+    constexpr Atom(const char* name) : Atom(std::string_view(name)) {}
+
+    Atom(const std::string& name) : Atom(std::string_view(name)) {}
+
+    constexpr auto Name() const noexcept { return m_name; }
+
+    constexpr auto Hash() const noexcept { return m_hash; }
+
+    constexpr bool Empty() const noexcept { return m_name.empty(); }
+
+    constexpr bool operator==(const Atom& rhs) const noexcept { return m_hash == rhs.m_hash; }
+
+    constexpr auto operator<=>(const Atom& rhs) const noexcept { return m_hash <=> rhs.m_hash; }
+
+    struct Hasher {
+        constexpr size_t operator()(Atom atom) const noexcept { return static_cast<size_t>(atom.m_hash); }
+    };
+
+  private:
+    uint64_t         m_hash = detail::hash_atom({});
+    std::string_view m_name;
+};
+
+} // namespace utils
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace utils {
+
+// Keeps released values alive until the timeline value they were released at has completed, for resources that
+// submissions still in flight may use. Values are destroyed in the order they were pushed.
+template <typename T>
+class DeletionQueue {
+  public:
+    void Push(uint64_t timeline_value, T value)
+    {
+        // Retiring pops from the front only, so the timeline values must not decrease along the queue.
+        if (!m_entries.empty()) {
+            timeline_value = std::max(timeline_value, m_entries.back().timeline_value);
+        }
+        m_entries.push_back({ timeline_value, std::move(value) });
+    }
+
+    // Destroys every value whose timeline value has completed. Visit sees each value just before it is destroyed.
+    template <typename Visit>
+    void Retire(uint64_t completed_timeline_value, Visit&& visit)
+    {
+        while (!m_entries.empty() && m_entries.front().timeline_value <= completed_timeline_value) {
+            visit(m_entries.front().value);
+            m_entries.pop_front();
+        }
+    }
+
+    void Retire(uint64_t completed_timeline_value)
+    {
+        Retire(completed_timeline_value, [](T&) {});
+    }
+
+    auto Size() const noexcept { return m_entries.size(); }
+
+    bool Empty() const noexcept { return m_entries.empty(); }
+
+  private:
+    struct Entry final {
+        uint64_t timeline_value = 0;
+        T        value;
+    };
+
+    std::deque<Entry> m_entries;
+};
+
+} // namespace utils
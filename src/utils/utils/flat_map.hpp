@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// Associative container stored as a vector of pairs sorted by key. Lookups are a binary search over contiguous
+// memory and never allocate; iteration yields the entries in key order.
+template <typename Key, typename Value, typename Allocator = std::allocator<std::pair<Key, Value>>>
+class FlatMap {
+  public:
+    using value_type     = std::pair<Key, Value>;
+    using const_iterator = typename std::vector<value_type, Allocator>::const_iterator;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Allocator& allocator) : m_entries(allocator) {}
+
+    auto Find(const Key& key) const noexcept -> const Value*
+    {
+        auto iter = LowerBound(key);
+        return iter != m_entries.end() && iter->first == key ? &iter->second : nullptr;
+    }
+
+    auto Find(const Key& key) noexcept -> Value*
+    {
+        return const_cast<Value*>(std::as_const(*this).Find(key));
+    }
+
+    bool Contains(const Key& key) const noexcept { return Find(key) != nullptr; }
+
+    // Returns true if the key was inserted and false if an existing value was replaced.
+    template <typename V>
+    bool InsertOrAssign(const Key& key, V&& value)
+    {
+        auto iter = m_entries.begin() + (LowerBound(key) - m_entries.cbegin());
+        if (iter != m_entries.end() && iter->first == key) {
+            iter->second = std::forward<V>(value);
+            return false;
+        }
+        m_entries.emplace(iter, key, std::forward<V>(value));
+        return true;
+    }
+
+    bool Erase(const Key& key)
+    {
+        auto iter = LowerBound(key);
+        if (iter != m_entries.end() && iter->first == key) {
+            m_entries.erase(iter);
+            return true;
+        }
+        return false;
+    }
+
+    void Reserve(size_t size) { m_entries.reserve(size); }
+
+    auto begin() const noexcept { return m_entries.begin(); }
+    auto end() const noexcept { return m_entries.end(); }
+    auto data() const noexcept { return m_entries.data(); }
+    auto size() const noexcept { return m_entries.size(); }
+    bool empty() const noexcept { return m_entries.empty(); }
+
+  private:
+    auto LowerBound(const Key& key) const noexcept -> const_iterator
+    {
+        auto less = [](const value_type& entry, const Key& k) { return entry.first < k; };
+        return std::lower_bound(m_entries.begin(), m_entries.end(), key, less);
+    }
+
+    std::vector<value_type, Allocator> m_entries;
+};
+
+} // namespace utils
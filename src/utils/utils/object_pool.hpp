@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// Fixed-size allocator for objects of a single type. Memory is carved from slabs of SlabSize blocks and freed
+// blocks are kept on an intrusive free list, so allocation and deallocation are a pointer swap. Slabs are only
+// released when the pool itself is destroyed.
+template <typename T, size_t SlabSize = 1024>
+class ObjectPool {
+  public:
+    ObjectPool() noexcept = default;
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // The free list points into the slabs, so a moved-from pool must forget it along with them.
+    ObjectPool(ObjectPool&& other) noexcept
+        : m_slabs(std::move(other.m_slabs)), m_free(std::exchange(other.m_free, nullptr)),
+          m_size(std::exchange(other.m_size, 0))
+    {}
+
+    ObjectPool& operator=(ObjectPool&& other) noexcept
+    {
+        if (this != &other) {
+            m_slabs = std::move(other.m_slabs);
+            m_free  = std::exchange(other.m_free, nullptr);
+            m_size  = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    auto Allocate() -> void*
+    {
+        if (m_free == nullptr) {
+            AddSlab();
+        }
+
+        auto block = m_free;
+        m_free     = block->next;
+        m_size++;
+
+        return block->storage;
+    }
+
+    void Deallocate(void* ptr) noexcept
+    {
+        auto block  = static_cast<Block*>(ptr);
+        block->next = m_free;
+        m_free      = block;
+        m_size--;
+    }
+
+    template <typename... Args>
+    auto Create(Args&&... args) -> T*
+    {
+        auto memory = Allocate();
+        try {
+            return new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Deallocate(memory);
+            throw;
+        }
+    }
+
+    void Destroy(T* object) noexcept
+    {
+        object->~T();
+        Deallocate(object);
+    }
+
+    auto Size() const noexcept { return m_size; }
+
+    auto Capacity() const noexcept { return m_slabs.size() * SlabSize; }
+
+  private:
+    union Block {
+        Block* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    void AddSlab()
+    {
+        auto slab = std::make_unique<Block[]>(SlabSize);
+
+        for (size_t i = 0; i != SlabSize; ++i) {
+            slab[i].next = i + 1 != SlabSize ? &slab[i + 1] : m_free;
+        }
+
+        m_free = &slab[0];
+        m_slabs.push_back(std::move(slab));
+    }
+
+    std::vector<std::unique_ptr<Block[]>> m_slabs;
+    Block*                                m_free = nullptr;
+    size_t                                m_size = 0;
+};
+
+} // namespace utils
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+inline size_t HardwareThreadCount() noexcept
+{
+    return std::max(size_t{ 1 }, size_t{ std::thread::hardware_concurrency() });
+}
+
+// Calls work(index) for every index below count on up to thread_count threads, the calling thread included. Indices
+// are handed out one at a time, so items of uneven cost balance out. The first exception stops further items from
+// starting and is rethrown once every thread has finished.
+template <typename Work>
+void ParallelFor(size_t count, size_t thread_count, Work&& work)
+{
+    auto next   = std::atomic<size_t>(0);
+    auto failed = std::atomic<bool>(false);
+    auto error  = std::exception_ptr();
+    auto mutex  = std::mutex();
+
+    auto run = [&] {
+        for (auto index = next++; index < count && !failed; index = next++) {
+            try {
+                work(index);
+            } catch (...) {
+                auto lock = std::scoped_lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    {
+        auto threads = std::vector<std::jthread>();
+        auto helpers = std::min(thread_count, count);
+
+        threads.reserve(helpers);
+        for (size_t i = 1; i < helpers; ++i) {
+            threads.emplace_back(run);
+        }
+
+        run();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace utils
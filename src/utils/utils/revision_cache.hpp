@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace utils {
+
+// Caches one record per dense slot and rebuilds it only when the revision of its source changes. Revision 0 marks
+// a slot that has never been compiled, so sources must start counting revisions at 1. Once every slot has been
+// compiled, Get is a vector index plus a comparison and never allocates.
+template <typename Record, typename Allocator = std::allocator<Record>>
+class RevisionCache {
+  public:
+    RevisionCache() = default;
+
+    explicit RevisionCache(const Allocator& allocator) : m_entries(EntryAllocator(allocator)) {}
+
+    template <typename Compile>
+    auto Get(size_t slot, uint64_t revision, Compile&& compile) -> const Record&
+    {
+        if (slot >= m_entries.size()) {
+            m_entries.resize(slot + 1);
+        }
+
+        auto& entry = m_entries[slot];
+
+        if (entry.revision != revision) {
+            entry.record   = compile();
+            entry.revision = revision;
+            m_compile_count++;
+        }
+
+        return entry.record;
+    }
+
+    void Invalidate() noexcept
+    {
+        for (auto& entry : m_entries) {
+            entry.revision = 0;
+        }
+    }
+
+    // Forces the next Get of the slot to compile, for a slot whose source was destroyed and may be reused.
+    void Invalidate(size_t slot) noexcept
+    {
+        if (slot < m_entries.size()) {
+            m_entries[slot].revision = 0;
+        }
+    }
+
+    auto Size() const noexcept { return m_entries.size(); }
+
+    auto CompileCount() const noexcept { return m_compile_count; }
+
+  private:
+    struct Entry final {
+        uint64_t revision = 0;
+        Record   record{};
+    };
+
+    using EntryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>;
+
+    std::vector<Entry, EntryAllocator> m_entries;
+    uint64_t                           m_compile_count = 0;
+};
+
+} // namespace utils
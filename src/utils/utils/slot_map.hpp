@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+struct SlotHandle final {
+    uint32_t index      = 0;
+    uint32_t generation = 0;
+
+    constexpr bool operator==(const SlotHandle&) const noexcept = default;
+};
+
+// Dense storage addressed through generational handles. Values live contiguously and are iterated in dense order;
+// erasing moves the last value into the hole. Every erase bumps the generation of the slot, so a handle to an
+// erased value no longer resolves even after its slot has been reused. Generation 0 is never handed out.
+template <typename T>
+class SlotMap {
+  public:
+    auto Insert(T value) -> SlotHandle
+    {
+        auto slot_index = uint32_t{};
+
+        if (m_free_slots.empty()) {
+            slot_index = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back({});
+        } else {
+            slot_index = m_free_slots.back();
+            m_free_slots.pop_back();
+        }
+
+        auto& slot = m_slots[slot_index];
+
+        slot.dense_index = static_cast<uint32_t>(m_values.size());
+
+        m_values.push_back(std::move(value));
+        m_dense_to_slot.push_back(slot_index);
+
+        return { slot_index, slot.generation };
+    }
+
+    bool Erase(SlotHandle handle)
+    {
+        if (!Contains(handle)) {
+            return false;
+        }
+
+        auto& slot       = m_slots[handle.index];
+        auto  dense_last = static_cast<uint32_t>(m_values.size() - 1);
+
+        if (slot.dense_index != dense_last) {
+            m_values[slot.dense_index]        = std::move(m_values[dense_last]);
+            m_dense_to_slot[slot.dense_index] = m_dense_to_slot[dense_last];
+
+            m_slots[m_dense_to_slot[slot.dense_index]].dense_index = slot.dense_index;
+        }
+
+        m_values.pop_back();
+        m_dense_to_slot.pop_back();
+
+        slot.dense_index = kFree;
+        slot.generation  = slot.generation == std::numeric_limits<uint32_t>::max() ? 1 : slot.generation + 1;
+
+        m_free_slots.push_back(handle.index);
+
+        return true;
+    }
+
+    bool Contains(SlotHandle handle) const noexcept
+    {
+        return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation &&
+               m_slots[handle.index].dense_index != kFree;
+    }
+
+    auto Get(SlotHandle handle) noexcept -> T*
+    {
+        return Contains(handle) ? &m_values[m_slots[handle.index].dense_index] : nullptr;
+    }
+
+    auto Get(SlotHandle handle) const noexcept -> const T*
+    {
+        return Contains(handle) ? &m_values[m_slots[handle.index].dense_index] : nullptr;
+    }
+
+    void Reserve(size_t size)
+    {
+        m_slots.reserve(size);
+        m_values.reserve(size);
+        m_dense_to_slot.reserve(size);
+    }
+
+    auto begin() noexcept { return m_values.begin(); }
+    auto end() noexcept { return m_values.end(); }
+    auto begin() const noexcept { return m_values.begin(); }
+    auto end() const noexcept { return m_values.end(); }
+    auto size() const noexcept { return m_values.size(); }
+    bool empty() const noexcept { return m_values.empty(); }
+
+  private:
+    static constexpr uint32_t kFree = std::numeric_limits<uint32_t>::max();
+
+    struct Slot final {
+        uint32_t generation  = 1;
+        uint32_t dense_index = kFree;
+    };
+
+    std::vector<Slot>     m_slots;
+    std::vector<uint32_t> m_free_slots;
+    std::vector<T>        m_values;
+    std::vector<uint32_t> m_dense_to_slot;
+};
+
+} // namespace utils
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace utils {
+
+// Lossless codec for vertex and index streams. The data is read as elements of stride bytes, and every 32-bit word is
+// delta coded against the same word of the previous element and zigzag mapped, so that similar neighbours give small
+// values. The four bytes of those values are split into separate planes, where each group of 16 bytes is packed into
+// 0, 2, 4 or 8 bits per byte. Bytes past the last whole element are stored as they are.
+//
+// The stride must be a multiple of 4, no larger than 256.
+auto EncodeStream(std::span<const std::byte> data, size_t stride) -> std::vector<std::byte>;
+
+// Size of the data an encoded stream decodes to. Throws if the stream header is not valid.
+auto GetDecodedStreamSize(std::span<const std::byte> encoded) -> size_t;
+
+// The destination must be exactly GetDecodedStreamSize bytes. Malformed streams throw rather than read out of bounds.
+void DecodeStream(std::span<const std::byte> encoded, std::span<std::byte> data);
+
+// Tries every stride up to max_stride that divides the data on a sample from its start, and returns the one that
+// compresses best. Used when the layout of the elements is not known.
+auto FindStreamStride(std::span<const std::byte> data, size_t max_stride = 64) -> size_t;
+
+} // namespace utils
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// Case-insensitive substring index over short texts such as object names, keyed by small dense integers. Each text
+// is split into trigrams and every trigram keeps a posting list of the keys containing it. A query only walks the
+// shortest posting list among its own trigrams and verifies those candidates, so its cost follows the selectivity
+// of the query rather than the number of indexed texts. Queries shorter than a trigram fall back to a full scan.
+//
+// Updates never search posting lists. Replacing or erasing a text bumps the generation of its key, which turns its
+// old postings stale; stale postings are swept out once they outnumber the live ones.
+template <typename Value>
+class TextIndex {
+  public:
+    void Insert(uint32_t key, std::string_view text, Value value)
+    {
+        if (key >= m_entries.size()) {
+            m_entries.resize(size_t{ key } + 1);
+        }
+
+        auto& entry = m_entries[key];
+
+        if (entry.alive) {
+            Retire(entry);
+        }
+
+        entry.text  = ToLower(text);
+        entry.value = std::move(value);
+        entry.alive = true;
+        m_size++;
+
+        AddPostings(key, entry);
+        SweepIfStale();
+    }
+
+    bool Erase(uint32_t key)
+    {
+        if (!Contains(key)) {
+            return false;
+        }
+
+        auto& entry = m_entries[key];
+
+        Retire(entry);
+        entry.text.clear();
+        entry.value = {};
+        SweepIfStale();
+
+        return true;
+    }
+
+    bool Contains(uint32_t key) const noexcept { return key < m_entries.size() && m_entries[key].alive; }
+
+    auto Search(std::string_view query, size_t max_count = std::numeric_limits<size_t>::max()) const
+        -> std::vector<Value>
+    {
+        auto needle  = ToLower(query);
+        auto results = std::vector<Value>();
+
+        auto visit = [&](const Entry& entry) {
+            if (entry.text.find(needle) != std::string::npos) {
+                results.push_back(entry.value);
+            }
+            return results.size() < max_count;
+        };
+
+        if (needle.size() < 3) {
+            for (const auto& entry : m_entries) {
+                if (entry.alive && !visit(entry)) {
+                    break;
+                }
+            }
+            return results;
+        }
+
+        const std::vector<Posting>* shortest = nullptr;
+
+        for (size_t i = 0; i + 3 <= needle.size(); ++i) {
+            auto iter = m_postings.find(Trigram(needle, i));
+            if (iter == m_postings.end()) {
+                return results;
+            }
+            if (shortest == nullptr || iter->second.size() < shortest->size()) {
+                shortest = &iter->second;
+            }
+        }
+
+        for (auto posting : *shortest) {
+            const auto& entry = m_entries[posting.key];
+            if (entry.alive && entry.generation == posting.generation && !visit(entry)) {
+                break;
+            }
+        }
+
+        return results;
+    }
+
+    auto Size() const noexcept { return m_size; }
+
+    auto PostingCount() const noexcept { return m_live_postings + m_stale_postings; }
+
+  private:
+    struct Posting final {
+        uint32_t key        = 0;
+        uint32_t generation = 0;
+    };
+
+    struct Entry final {
+        std::string text;
+        Value       value{};
+        uint32_t    generation    = 0;
+        uint32_t    posting_count = 0;
+        bool        alive         = false;
+    };
+
+    static std::string ToLower(std::string_view text)
+    {
+        auto lower = std::string(text);
+        for (auto& c : lower) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return lower;
+    }
+
+    static uint32_t Trigram(std::string_view text, size_t offset) noexcept
+    {
+        auto byte = [&](size_t i) { return uint32_t{ static_cast<uint8_t>(text[offset + i]) }; };
+        return byte(0) << 16 | byte(1) << 8 | byte(2);
+    }
+
+    void AddPostings(uint32_t key, Entry& entry)
+    {
+        m_trigrams.clear();
+        for (size_t i = 0; i + 3 <= entry.text.size(); ++i) {
+            m_trigrams.push_back(Trigram(entry.text, i));
+        }
+
+        std::ranges::sort(m_trigrams);
+        m_trigrams.erase(std::unique(m_trigrams.begin(), m_trigrams.end()), m_trigrams.end());
+
+        for (auto trigram : m_trigrams) {
+            m_postings[trigram].push_back({ key, entry.generation });
+        }
+
+        entry.posting_count = static_cast<uint32_t>(m_trigrams.size());
+        m_live_postings += entry.posting_count;
+    }
+
+    void Retire(Entry& entry) noexcept
+    {
+        m_live_postings -= entry.posting_count;
+        m_stale_postings += entry.posting_count;
+        m_size--;
+
+        entry.generation++;
+        entry.posting_count = 0;
+        entry.alive         = false;
+    }
+
+    void SweepIfStale()
+    {
+        static constexpr size_t kMinStalePostings = 4096;
+
+        if (m_stale_postings < kMinStalePostings || m_stale_postings < m_live_postings) {
+            return;
+        }
+
+        auto is_stale = [this](Posting posting) {
+            const auto& entry = m_entries[posting.key];
+            return !entry.alive || entry.generation != posting.generation;
+        };
+
+        for (auto iter = m_postings.begin(); iter != m_postings.end();) {
+            std::erase_if(iter->second, is_stale);
+            iter = iter->second.empty() ? m_postings.erase(iter) : std::next(iter);
+        }
+
+        m_stale_postings = 0;
+    }
+
+    std::vector<Entry>                                 m_entries;
+    std::unordered_map<uint32_t, std::vector<Posting>> m_postings;
+    std::vector<uint32_t>                              m_trigrams;
+    size_t                                             m_size           = 0;
+    size_t                                             m_live_postings  = 0;
+    size_t                                             m_stale_postings = 0;
+};
+
+} // namespace utils
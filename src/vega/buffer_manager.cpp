@@ -2,74 +2,173 @@
 
 #include "etna/command.hpp"
 
-BufferManager::BufferManager(etna::Device device, etna::Queue transfer_queue)
-    : m_device(device), m_transfer_queue(transfer_queue)
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <exception>
+
+// Buffers staged per frame; a view that needs more streams in over several frames instead of stalling one.
+static constexpr size_t kUploadBytesPerFrame = size_t{ 64 } << 20;
+
+BufferManager::BufferManager(
+    etna::Device         device,
+    etna::Queue          transfer_queue,
+    etna::PhysicalDevice gpu,
+    size_t               memory_budget)
+    : m_device(device), m_transfer_queue(transfer_queue), m_gpu(gpu), m_memory_budget(memory_budget),
+      m_residency(memory_budget)
 {
     using namespace etna;
 
     auto command_pool_flags = CommandPoolCreate::Transient | CommandPoolCreate::ResetCommandBuffer;
 
-    m_command_pool   = m_device.CreateCommandPool(m_transfer_queue.FamilyIndex(), command_pool_flags);
-    m_command_buffer = m_command_pool->AllocateCommandBuffer();
+    m_command_pool = m_device.CreateCommandPool(m_transfer_queue.FamilyIndex(), command_pool_flags);
 }
 
 void BufferManager::CreateBuffer(BufferPtr buffer, etna::BufferUsage buffer_usage)
+{
+    assert(buffer);
+
+    m_records.try_emplace(buffer->GetID(), Record{ buffer, buffer_usage, {}, false });
+}
+
+etna::Buffer BufferManager::RequestBuffer(BufferPtr buffer, float priority)
+{
+    auto it = m_records.find(buffer->GetID());
+    if (it == m_records.end() || it->second.is_unreadable) {
+        return {};
+    }
+
+    if (m_residency.Request(it->first, buffer->Size(), priority) && it->second.gpu_buffer) {
+        return *it->second.gpu_buffer;
+    }
+
+    return {};
+}
+
+void BufferManager::RecordUpload(etna::Queue::SubmitBatch& submit_batch, uint64_t timeline_value)
 {
     using namespace etna;
 
-    assert(buffer);
+    UpdateBudget();
+
+    auto plan = m_residency.Update(kUploadBytesPerFrame);
+
+    for (auto id : plan.evictions) {
+        if (auto it = m_records.find(id); it != m_records.end() && it->second.gpu_buffer) {
+            m_deletion_queue.Push(timeline_value, std::move(it->second.gpu_buffer));
+        }
+    }
 
-    if (std::ranges::find(m_records, buffer->GetID(), &Record::id) != m_records.end()) {
+    if (plan.uploads.empty()) {
         return;
     }
 
-    auto host_buffer = m_device.CreateBuffer(buffer->Size(), BufferUsage::TransferSrc, MemoryUsage::CpuOnly);
+    auto upload = Upload{};
+
+    if (m_free_command_buffers.empty()) {
+        upload.command_buffer = m_command_pool->AllocateCommandBuffer();
+    } else {
+        upload.command_buffer = std::move(m_free_command_buffers.back());
+        m_free_command_buffers.pop_back();
+        upload.command_buffer->ResetCommandBuffer(CommandBufferReset::ReleaseResources);
+    }
+
+    upload.command_buffer->Begin(CommandBufferUsage::OneTimeSubmit);
+
+    for (auto id : plan.uploads) {
+        auto& record = m_records.at(id);
+        auto  size   = record.buffer->Size();
 
-    auto buffer_data = host_buffer->MapMemory();
-    memcpy(buffer_data, buffer->Data(), buffer->Size());
-    host_buffer->UnmapMemory();
+        auto host_buffer = m_device.CreateBuffer(size, BufferUsage::TransferSrc, MemoryUsage::CpuOnly);
 
-    m_records.push_back({ buffer->GetID(), buffer_usage, std::move(host_buffer), {} });
+        // Reads the buffer back from its source or decodes it if the scene no longer keeps it in memory. A source
+        // file that was moved or edited since it was loaded cannot be read; its draws are skipped from then on.
+        auto mapped_data = host_buffer->MapMemory();
+        try {
+            record.buffer->CopyTo(mapped_data);
+        } catch (const std::exception& exception) {
+            spdlog::error("Cannot upload buffer {}: {}", id.index, exception.what());
+            record.is_unreadable = true;
+        }
+        host_buffer->UnmapMemory();
+
+        if (record.is_unreadable) {
+            m_residency.Remove(id);
+            continue;
+        }
+
+        record.gpu_buffer = m_device.CreateBuffer(size, record.usage | BufferUsage::TransferDst, MemoryUsage::GpuOnly);
+
+        upload.command_buffer->CopyBuffer(*host_buffer, *record.gpu_buffer, size);
+        upload.staging_buffers.push_back(std::move(host_buffer));
+    }
+
+    // Draws recorded after the copies in the same submission read the buffers once they are written.
+    auto barriers = CommandBuffer::BarrierBatch();
+
+    barriers.AddMemoryBarrier(
+        PipelineStage::Transfer,
+        PipelineStage::VertexInput,
+        Access::TransferWrite,
+        Access::VertexAttributeRead | Access::IndexRead);
+
+    upload.command_buffer->PipelineBarrier(barriers);
+    upload.command_buffer->End();
+
+    submit_batch.AddCommandBuffer(*upload.command_buffer);
+
+    m_uploads.push_back(std::move(upload));
 }
 
-etna::Buffer BufferManager::GetBuffer(BufferPtr buffer) const noexcept
+void BufferManager::UploadSubmitted(uint64_t timeline_value)
 {
-    if (auto it = std::ranges::find(m_records, buffer->GetID(), &Record::id); it != m_records.end()) {
-        return *it->gpu_buffer;
+    for (auto& upload : m_uploads) {
+        if (upload.timeline_value == 0) {
+            upload.timeline_value = timeline_value;
+        }
     }
-    return {};
 }
 
-void BufferManager::UploadAsync()
+void BufferManager::ReleaseBuffer(ID id, uint64_t timeline_value)
 {
-    using namespace etna;
-
-    auto is_set = [](auto& buffer) { return buffer.get(); };
-
-    if (auto count = std::ranges::count_if(m_records, is_set, &Record::host_buffer); count == 0) {
+    auto it = m_records.find(id);
+    if (it == m_records.end()) {
         return;
     }
 
-    m_command_buffer->ResetCommandBuffer(CommandBufferReset::ReleaseResources);
+    if (it->second.gpu_buffer) {
+        m_deletion_queue.Push(timeline_value, std::move(it->second.gpu_buffer));
+    }
 
-    m_command_buffer->Begin(CommandBufferUsage::OneTimeSubmit);
+    m_residency.Remove(id);
+    m_records.erase(it);
+}
 
-    for (auto& [id, usage, host_buffer, gpu_buffer] : m_records) {
-        if (gpu_buffer) {
-            continue;
+void BufferManager::ReleaseRetiredBuffers(uint64_t completed_timeline_value)
+{
+    for (auto& upload : m_uploads) {
+        if (upload.timeline_value != 0 && upload.timeline_value <= completed_timeline_value) {
+            m_free_command_buffers.push_back(std::move(upload.command_buffer));
         }
-        gpu_buffer = m_device.CreateBuffer(host_buffer->Size(), usage | BufferUsage::TransferDst, MemoryUsage::GpuOnly);
-        m_command_buffer->CopyBuffer(*host_buffer, *gpu_buffer, host_buffer->Size());
     }
 
-    m_command_buffer->End();
+    std::erase_if(m_uploads, [](const Upload& upload) { return !upload.command_buffer; });
 
-    m_transfer_queue.Submit(*m_command_buffer);
+    m_deletion_queue.Retire(completed_timeline_value);
 }
 
-void BufferManager::CleanAfterUpload()
+// Memory that others use, such as images or buffers waiting for deletion, is not available for streaming.
+void BufferManager::UpdateBudget()
 {
-    for (auto& record : m_records) {
-        record.host_buffer.reset();
+    if (!m_gpu) {
+        return;
     }
+
+    auto memory   = m_gpu.GetPhysicalDeviceMemoryBudget();
+    auto resident = m_residency.GetResidentBytes();
+    auto others   = memory.usage > resident ? memory.usage - resident : 0;
+    auto budget   = memory.budget > others ? memory.budget - others : 0;
+
+    m_residency.SetBudget(std::min(m_memory_budget, static_cast<size_t>(budget)));
 }
@@ -3,13 +3,25 @@
 #include "etna/buffer.hpp"
 #include "etna/command.hpp"
 #include "etna/device.hpp"
+#include "etna/instance.hpp"
 #include "etna/queue.hpp"
 
+#include "gpu_residency.hpp"
 #include "scene.hpp"
 
+#include "utils/deletion_queue.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+// Streams scene buffers into device memory as the renderer asks for them, keeping them under the memory budget. A
+// buffer is copied from the scene, which may read it back from its source file, only when it is uploaded, so a scene
+// larger than the budget pages in and out as the view moves.
 class BufferManager {
   public:
-    BufferManager(etna::Device device, etna::Queue transfer_queue);
+    // The budget is memory_budget, further limited by what VK_EXT_memory_budget reports if gpu is set; the extension
+    // must be enabled on the device then.
+    BufferManager(etna::Device device, etna::Queue transfer_queue, etna::PhysicalDevice gpu, size_t memory_budget);
 
     BufferManager(const BufferManager&) = delete;
     BufferManager& operator=(const BufferManager&) = delete;
@@ -19,24 +31,52 @@ class BufferManager {
 
     void CreateBuffer(BufferPtr buffer, etna::BufferUsage buffer_usage);
 
-    auto GetBuffer(BufferPtr buffer) const noexcept -> etna::Buffer;
+    // Returns the device buffer if it is resident, and a null buffer otherwise; a missing buffer is uploaded by a later
+    // RecordUpload, larger priorities first.
+    auto RequestBuffer(BufferPtr buffer, float priority) -> etna::Buffer;
+
+    // Evicts and uploads buffers for the requests made since the last call. The copies are added to submit_batch, ahead
+    // of the draws that read them. Evicted buffers stay alive until the submissions up to timeline_value are done.
+    void RecordUpload(etna::Queue::SubmitBatch& submit_batch, uint64_t timeline_value);
+
+    void UploadSubmitted(uint64_t timeline_value);
+
+    // Hands the buffers of a released scene buffer to the deletion queue; submissions up to timeline_value may
+    // still read them.
+    void ReleaseBuffer(ID id, uint64_t timeline_value);
 
-    void UploadAsync();
+    // Frees staging buffers of completed uploads and released buffers that no pending submission uses.
+    void ReleaseRetiredBuffers(uint64_t completed_timeline_value);
 
-    void CleanAfterUpload();
+    auto GetBufferCount() const noexcept { return m_records.size(); }
+
+    auto GetResidency() const noexcept -> const GpuResidency& { return m_residency; }
 
   private:
     struct Record final {
-        ID                 id{};
+        BufferPtr          buffer{};
         etna::BufferUsage  usage{};
-        etna::UniqueBuffer host_buffer{};
         etna::UniqueBuffer gpu_buffer{};
+        bool               is_unreadable{}; // Its contents could not be read, so it is no longer requested
+    };
+
+    struct Upload final {
+        uint64_t                        timeline_value{};
+        etna::UniqueCommandBuffer       command_buffer{};
+        std::vector<etna::UniqueBuffer> staging_buffers;
     };
 
-    etna::Device              m_device;
-    etna::Queue               m_transfer_queue;
-    etna::UniqueCommandPool   m_command_pool;
-    etna::UniqueCommandBuffer m_command_buffer;
+    void UpdateBudget();
+
+    etna::Device            m_device;
+    etna::Queue             m_transfer_queue;
+    etna::PhysicalDevice    m_gpu;
+    size_t                  m_memory_budget = 0;
+    etna::UniqueCommandPool m_command_pool;
 
-    std::vector<Record> m_records;
+    std::unordered_map<ID, Record, ID::Hash> m_records;
+    std::vector<Upload>                      m_uploads;
+    std::vector<etna::UniqueCommandBuffer>   m_free_command_buffers;
+    GpuResidency                             m_residency;
+    utils::DeletionQueue<etna::UniqueBuffer> m_deletion_queue;
 };
@@ -9,6 +9,7 @@ DescriptorManager::DescriptorManager(
     uint32_t                          num_frames,
     etna::DescriptorSetLayout         transforms_set_layout,
     etna::DescriptorSetLayout         textures_set_layout,
+    etna::DescriptorSetLayout         bindless_textures_set_layout,
     const etna::PhysicalDeviceLimits& gpu_limits)
     : m_device(device), m_transforms_set_layout(transforms_set_layout), m_textures_set_layout(textures_set_layout)
 {
@@ -75,6 +76,17 @@ DescriptorManager::DescriptorManager(
     auto builder = Sampler::Builder(Filter::Nearest, Filter::Nearest, SamplerMipmapMode::Nearest);
 
     m_sampler = m_device.CreateSampler(builder.state);
+
+    if (bindless_textures_set_layout) {
+        m_bindless_descriptor_pool = device.CreateDescriptorPool(
+            DescriptorPoolFlags::UpdateAfterBind,
+            { DescriptorPoolSize{ DescriptorType::CombinedImageSampler, kMaxBindlessTextures } },
+            1);
+
+        m_bindless_textures_set = m_bindless_descriptor_pool->AllocateDescriptorSet(bindless_textures_set_layout);
+
+        m_bindless_textures.resize(kMaxBindlessTextures);
+    }
 }
 
 DescriptorManager::~DescriptorManager() noexcept
@@ -124,7 +136,12 @@ void DescriptorManager::Set(size_t frame_index, const LightsUniform& lights) noe
 void DescriptorManager::Set(etna::ImageView2D image_view) noexcept
 {
     if (auto [it, emplaced] = m_textures.try_emplace(image_view, etna::DescriptorSet{}); emplaced) {
-        it->second = m_descriptor_pool->AllocateDescriptorSets(1, m_textures_set_layout).front();
+        if (m_free_texture_sets.empty()) {
+            it->second = m_descriptor_pool->AllocateDescriptorSets(1, m_textures_set_layout).front();
+        } else {
+            it->second = m_free_texture_sets.back();
+            m_free_texture_sets.pop_back();
+        }
 
         auto descriptor_type      = etna::DescriptorType::CombinedImageSampler;
         auto write_descriptor_set = etna::WriteDescriptorSet(it->second, etna::Binding{ 10 }, descriptor_type);
@@ -135,6 +152,39 @@ void DescriptorManager::Set(etna::ImageView2D image_view) noexcept
     }
 }
 
+void DescriptorManager::Set(uint32_t texture_index, etna::ImageView2D image_view)
+{
+    utils::throw_runtime_error_if(!m_bindless_textures_set, "Bindless textures are not enabled");
+    utils::throw_runtime_error_if(texture_index >= kMaxBindlessTextures, "Too many bindless textures");
+
+    if (m_bindless_textures[texture_index] == image_view) {
+        return;
+    }
+
+    auto descriptor_type = etna::DescriptorType::CombinedImageSampler;
+    auto write_descriptor_set =
+        etna::WriteDescriptorSet(m_bindless_textures_set, etna::Binding{ 10 }, descriptor_type, texture_index);
+
+    write_descriptor_set.AddImage(*m_sampler, image_view, etna::ImageLayout::ShaderReadOnlyOptimal);
+
+    m_device.UpdateDescriptorSets({ write_descriptor_set });
+
+    m_bindless_textures[texture_index] = image_view;
+}
+
+void DescriptorManager::Release(uint32_t texture_index, etna::ImageView2D image_view) noexcept
+{
+    if (auto it = m_textures.find(image_view); it != m_textures.end()) {
+        m_free_texture_sets.push_back(it->second);
+        m_textures.erase(it);
+    }
+
+    // A new view may get the same handle, which must not be mistaken for the one already written.
+    if (texture_index < m_bindless_textures.size() && m_bindless_textures[texture_index] == image_view) {
+        m_bindless_textures[texture_index] = {};
+    }
+}
+
 void DescriptorManager::Flush(size_t frame_index)
 {
     using namespace etna;
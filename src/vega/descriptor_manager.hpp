@@ -22,6 +22,11 @@ struct ModelUniform final {
     glm::mat4 model;
 };
 
+struct DrawConstants final {
+    glm::mat4 model;
+    uint32_t  texture_index;
+};
+
 struct CameraUniform final {
     glm::mat4 view;
     glm::mat4 projection;
@@ -39,6 +44,9 @@ struct LightsUniform final {
 
 class DescriptorManager {
   public:
+    static constexpr uint32_t kMaxBindlessTextures = 4096;
+    static constexpr uint32_t kMaxTransforms       = 128;
+
     DescriptorManager() noexcept = default;
 
     DescriptorManager(const DescriptorManager&) = delete;
@@ -52,6 +60,7 @@ class DescriptorManager {
         uint32_t                          num_frames,
         etna::DescriptorSetLayout         transforms_set_layout,
         etna::DescriptorSetLayout         textures_set_layout,
+        etna::DescriptorSetLayout         bindless_textures_set_layout,
         const etna::PhysicalDeviceLimits& gpu_limits);
 
     ~DescriptorManager() noexcept;
@@ -60,6 +69,8 @@ class DescriptorManager {
 
     auto GetTextureSet(etna::ImageView2D image_view) const noexcept -> etna::DescriptorSet;
 
+    auto GetBindlessTextureSet() const noexcept { return m_bindless_textures_set; }
+
     auto Set(size_t frame_index, size_t transform_index, const ModelUniform& model) -> uint32_t;
 
     void Set(size_t frame_index, const CameraUniform& camera) noexcept;
@@ -68,11 +79,15 @@ class DescriptorManager {
 
     void Set(etna::ImageView2D image_view) noexcept;
 
+    void Set(uint32_t texture_index, etna::ImageView2D image_view);
+
+    // Forgets a retired image view. Its texture set is recycled by the next view that needs one, so the set must no
+    // longer be used by any pending submission.
+    void Release(uint32_t texture_index, etna::ImageView2D image_view) noexcept;
+
     void Flush(size_t frame_index);
 
   private:
-    static constexpr int kMaxTransforms = 128;
-
     struct FrameState final {
         etna::DescriptorSet transforms_set;
 
@@ -94,12 +109,16 @@ class DescriptorManager {
 
     using TextureMap = std::map<etna::ImageView2D, etna::DescriptorSet>;
 
-    etna::Device               m_device;
-    etna::DescriptorSetLayout  m_transforms_set_layout;
-    etna::DescriptorSetLayout  m_textures_set_layout;
-    etna::UniqueDescriptorPool m_descriptor_pool;
-    etna::UniqueSampler        m_sampler;
-    std::vector<FrameState>    m_frame_states;
-    etna::DeviceSize           m_offset_multiplier;
-    TextureMap                 m_textures;
+    etna::Device                     m_device;
+    etna::DescriptorSetLayout        m_transforms_set_layout;
+    etna::DescriptorSetLayout        m_textures_set_layout;
+    etna::UniqueDescriptorPool       m_descriptor_pool;
+    etna::UniqueDescriptorPool       m_bindless_descriptor_pool;
+    etna::DescriptorSet              m_bindless_textures_set;
+    etna::UniqueSampler              m_sampler;
+    std::vector<FrameState>          m_frame_states;
+    etna::DeviceSize                 m_offset_multiplier;
+    TextureMap                       m_textures;
+    std::vector<etna::DescriptorSet> m_free_texture_sets;
+    std::vector<etna::ImageView2D>   m_bindless_textures;
 };
@@ -1,7 +1,13 @@
 #include "frame_manager.hpp"
 
-FrameManager::FrameManager(etna::Device device, uint32_t queue_family_index, uint32_t frame_count)
-    : m_device(device), m_frame_count(frame_count), m_next_frame(0)
+#include "gpu_timeline.hpp"
+
+FrameManager::FrameManager(
+    etna::Device device,
+    uint32_t     queue_family_index,
+    uint32_t     frame_count,
+    GpuTimeline* gpu_timeline)
+    : m_device(device), m_gpu_timeline(gpu_timeline), m_frame_count(frame_count), m_next_frame(0)
 {
     m_command_pool = device.CreateCommandPool(queue_family_index, etna::CommandPoolCreate::ResetCommandBuffer);
 
@@ -10,28 +16,30 @@ FrameManager::FrameManager(etna::Device device, uint32_t queue_family_index, uin
         m_gui_command_buffers.push_back(m_command_pool->AllocateCommandBuffer());
         m_image_acquired_sempahores.push_back(device.CreateSemaphore());
         m_draw_completed_sempahores.push_back(device.CreateSemaphore());
-        m_gui_completed_sempahores.push_back(device.CreateSemaphore());
-        m_frame_available_fences.push_back(device.CreateFence(etna::FenceCreate::Signaled));
+        m_timestamp_query_pools.push_back(device.CreateQueryPool(etna::QueryType::Timestamp, kTimestampCount));
         m_frame_info.push_back(FrameInfo{
             frame_index,
             { *m_draw_command_buffers.back(), *m_gui_command_buffers.back() },
-            { *m_image_acquired_sempahores.back(),
-              *m_draw_completed_sempahores.back(),
-              *m_gui_completed_sempahores.back() },
-            { *m_frame_available_fences.back() },
+            { *m_image_acquired_sempahores.back(), *m_draw_completed_sempahores.back() },
+            *m_timestamp_query_pools.back(),
         });
     }
+
+    m_frame_timeline_values.resize(frame_count, 0);
 }
 
 const FrameInfo FrameManager::NextFrame()
 {
-    auto frame_index       = m_next_frame;
-    auto image_ready_fence = m_frame_info[frame_index].fence.image_ready;
+    auto frame_index = m_next_frame;
 
     m_next_frame = (m_next_frame + 1) % m_frame_count;
 
-    m_device.WaitForFence(image_ready_fence);
-    m_device.ResetFence(image_ready_fence);
+    m_gpu_timeline->Wait(m_frame_timeline_values[frame_index]);
 
     return m_frame_info[frame_index];
 }
+
+void FrameManager::FrameSubmitted(uint32_t frame_index, uint64_t timeline_value)
+{
+    m_frame_timeline_values[frame_index] = timeline_value;
+}
@@ -2,8 +2,11 @@
 
 #include "etna/command.hpp"
 #include "etna/device.hpp"
+#include "etna/query.hpp"
 #include "etna/synchronization.hpp"
 
+class GpuTimeline;
+
 struct FrameInfo {
     uint32_t index;
     struct {
@@ -13,29 +16,31 @@ struct FrameInfo {
     struct {
         etna::Semaphore image_acquired;
         etna::Semaphore draw_completed;
-        etna::Semaphore gui_completed;
     } semaphores;
-    struct {
-        etna::Fence image_ready;
-    } fence;
+    etna::QueryPool timestamps;
 };
 
 class FrameManager {
   public:
-    FrameManager(etna::Device device, uint32_t queue_family_index, uint32_t frame_count);
+    static constexpr uint32_t kTimestampCount = 3;
+
+    FrameManager(etna::Device device, uint32_t queue_family_index, uint32_t frame_count, GpuTimeline* gpu_timeline);
 
     auto NextFrame() -> const FrameInfo;
 
+    void FrameSubmitted(uint32_t frame_index, uint64_t timeline_value);
+
   private:
     etna::Device                           m_device;
+    GpuTimeline*                           m_gpu_timeline = nullptr;
     etna::UniqueCommandPool                m_command_pool;
     std::vector<etna::UniqueCommandBuffer> m_draw_command_buffers;
     std::vector<etna::UniqueCommandBuffer> m_gui_command_buffers;
     std::vector<etna::UniqueSemaphore>     m_image_acquired_sempahores;
     std::vector<etna::UniqueSemaphore>     m_draw_completed_sempahores;
-    std::vector<etna::UniqueSemaphore>     m_gui_completed_sempahores;
-    std::vector<etna::UniqueFence>         m_frame_available_fences;
+    std::vector<etna::UniqueQueryPool>     m_timestamp_query_pools;
     std::vector<FrameInfo>                 m_frame_info;
+    std::vector<uint64_t>                  m_frame_timeline_values;
     uint32_t                               m_frame_count;
     uint32_t                               m_next_frame;
 };
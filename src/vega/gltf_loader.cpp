@@ -0,0 +1,907 @@
+#include "meshlet.hpp"
+#include "model_loader.hpp"
+
+#include "utils/cast.hpp"
+#include "utils/mapped_file.hpp"
+#include "utils/misc.hpp"
+
+BEGIN_DISABLE_WARNINGS
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+END_DISABLE_WARNINGS
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+
+using Json  = nlohmann::json;
+using Bytes = std::span<const std::byte>;
+
+static constexpr uint32_t kGlbMagic     = 0x46546C67; // "glTF"
+static constexpr uint32_t kGlbJsonChunk = 0x4E4F534A; // "JSON"
+static constexpr uint32_t kGlbBinChunk  = 0x004E4942; // "BIN\0"
+
+static constexpr int kByte          = 5120;
+static constexpr int kUnsignedByte  = 5121;
+static constexpr int kShort         = 5122;
+static constexpr int kUnsignedShort = 5123;
+static constexpr int kUnsignedInt   = 5125;
+static constexpr int kFloat         = 5126;
+
+static constexpr int kTriangles = 4;
+
+static constexpr int kNone = -1;
+
+// Where a buffer lives on disk, so that its contents can be read again after the document is gone. Buffers decoded
+// from data URIs have no file.
+struct GltfOrigin final {
+    int    file = kNone;
+    size_t offset{};
+};
+
+// Keeps alive everything the buffer spans point into.
+struct GltfDocument final {
+    Json                                         json;
+    std::vector<utils::MappedFile>               files;
+    std::vector<std::filesystem::path>           paths;       // Of the mapped files
+    std::vector<std::filesystem::file_time_type> write_times; // Of the mapped files, when they were mapped
+    std::vector<std::vector<std::byte>>          decoded;
+    std::vector<Bytes>                           buffers;
+    std::vector<GltfOrigin>                      origins;
+};
+
+struct GltfAccessor final {
+    const std::byte* data{};      // First element
+    size_t           buffer{};    // Index of the buffer the data is in
+    size_t           offset{};    // Of the first element in that buffer
+    size_t           available{}; // Bytes from the first element to the end of the buffer view
+    size_t           count{};
+    size_t           stride{};
+    size_t           components{};
+    int              component_type{};
+    bool             normalized{};
+};
+
+struct GltfPrimitive final {
+    SceneBuilder::Handle mesh{};
+    SceneBuilder::Handle material{};
+};
+
+struct GltfVertices final {
+    SceneBuilder::Handle handle{};
+    Bytes                data; // In the layout of ModelVertex; meshlets are built from it
+};
+
+struct GltfIndices final {
+    SceneBuilder::Handle handle{};
+    size_t               count{};
+    std::vector<Meshlet> meshlets;
+};
+
+struct GltfContext final {
+    const GltfDocument*                         document{};
+    SceneBuilder*                               builder{};
+    std::filesystem::path                       parent_dir;
+    std::vector<SceneBuilder::Handle>           materials;
+    SceneBuilder::Handle                        default_material{};
+    std::map<int, std::vector<GltfPrimitive>>   meshes;
+    std::map<std::array<int, 4>, GltfVertices> vertex_buffers;
+    std::map<std::array<int, 2>, GltfIndices>   index_buffers;
+    std::vector<char>                           node_state;
+};
+
+static uint32_t ReadU32(Bytes bytes, size_t offset) noexcept
+{
+    auto value = uint32_t{};
+    std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+
+static auto ParseJson(Bytes bytes) -> Json
+{
+    auto begin = reinterpret_cast<const char*>(bytes.data());
+    return Json::parse(begin, begin + bytes.size());
+}
+
+static auto DecodeBase64(std::string_view text) -> std::vector<std::byte>
+{
+    auto decoded = std::vector<std::byte>{};
+    decoded.reserve(text.size() / 4 * 3);
+
+    auto bits  = uint32_t{ 0 };
+    auto count = 0;
+
+    for (auto c : text) {
+        auto value = uint32_t{};
+        if (c >= 'A' && c <= 'Z') {
+            value = static_cast<uint32_t>(c - 'A');
+        } else if (c >= 'a' && c <= 'z') {
+            value = static_cast<uint32_t>(c - 'a' + 26);
+        } else if (c >= '0' && c <= '9') {
+            value = static_cast<uint32_t>(c - '0' + 52);
+        } else if (c == '+') {
+            value = 62;
+        } else if (c == '/') {
+            value = 63;
+        } else if (c == '=') {
+            break;
+        } else {
+            utils::throw_runtime_error("Cannot load glTF file: data URI is not valid base64");
+        }
+        bits = (bits << 6) | value;
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            decoded.push_back(static_cast<std::byte>((bits >> count) & 0xFF));
+        }
+    }
+
+    return decoded;
+}
+
+static auto DecodeUri(std::string_view uri) -> std::string
+{
+    auto decoded = std::string{};
+    decoded.reserve(uri.size());
+
+    for (size_t i = 0; i < uri.size(); ++i) {
+        if (uri[i] == '%' && i + 2 < uri.size()) {
+            auto hex = std::string(uri.substr(i + 1, 2));
+            decoded.push_back(static_cast<char>(std::stoi(hex, nullptr, 16)));
+            i += 2;
+        } else {
+            decoded.push_back(uri[i]);
+        }
+    }
+
+    return decoded;
+}
+
+static auto ReadDocument(const std::filesystem::path& filepath) -> GltfDocument
+{
+    auto document = GltfDocument{};
+    auto bytes    = document.files.emplace_back(filepath).Bytes();
+    auto bin      = Bytes{};
+
+    document.paths.push_back(filepath);
+    document.write_times.push_back(std::filesystem::last_write_time(filepath));
+
+    if (bytes.size() >= 12 && ReadU32(bytes, 0) == kGlbMagic) {
+        auto length = size_t{ ReadU32(bytes, 8) };
+        utils::throw_runtime_error_if(length > bytes.size(), "Cannot load glTF file: file is truncated");
+
+        auto json_chunk = Bytes{};
+        for (size_t offset = 12; offset + 8 <= length;) {
+            auto chunk_length = size_t{ ReadU32(bytes, offset) };
+            auto chunk_type   = ReadU32(bytes, offset + 4);
+            offset += 8;
+            utils::throw_runtime_error_if(chunk_length > length - offset, "Cannot load glTF file: chunk is truncated");
+            if (chunk_type == kGlbJsonChunk && json_chunk.empty()) {
+                json_chunk = bytes.subspan(offset, chunk_length);
+            } else if (chunk_type == kGlbBinChunk && bin.empty()) {
+                bin = bytes.subspan(offset, chunk_length);
+            }
+            offset += chunk_length;
+        }
+
+        utils::throw_runtime_error_if(json_chunk.empty(), "Cannot load glTF file: JSON chunk is missing");
+        document.json = ParseJson(json_chunk);
+    } else {
+        document.json = ParseJson(bytes);
+    }
+
+    auto version = document.json.at("asset").at("version").get<std::string>();
+    utils::throw_runtime_error_if(!version.starts_with("2."), "Cannot load glTF file: only version 2 is supported");
+
+    auto parent_dir = filepath.parent_path();
+
+    for (const auto& buffer : document.json.value("buffers", Json::array())) {
+        auto byte_length = buffer.at("byteLength").get<size_t>();
+        auto data        = Bytes{};
+        auto origin      = GltfOrigin{};
+
+        if (!buffer.contains("uri")) {
+            data   = bin;
+            origin = { 0, static_cast<size_t>(bin.data() - bytes.data()) };
+        } else if (auto uri = buffer["uri"].get<std::string>(); uri.starts_with("data:")) {
+            auto base64 = uri.find(";base64,");
+            utils::throw_runtime_error_if(base64 == std::string::npos, "Cannot load glTF file: data URI is not base64");
+            data = document.decoded.emplace_back(DecodeBase64(std::string_view(uri).substr(base64 + 8)));
+        } else {
+            auto path = parent_dir / DecodeUri(uri);
+            data      = document.files.emplace_back(path).Bytes();
+            origin    = { utils::narrow_cast<int>(document.paths.size()), 0 };
+            document.paths.push_back(path);
+            document.write_times.push_back(std::filesystem::last_write_time(path));
+        }
+
+        utils::throw_runtime_error_if(data.size() < byte_length, "Cannot load glTF file: buffer is truncated");
+        document.buffers.push_back(data.first(byte_length));
+        document.origins.push_back(origin);
+    }
+
+    return document;
+}
+
+static size_t ComponentSize(int component_type)
+{
+    switch (component_type) {
+    case kByte:
+    case kUnsignedByte: return 1;
+    case kShort:
+    case kUnsignedShort: return 2;
+    case kUnsignedInt:
+    case kFloat: return 4;
+    }
+    utils::throw_runtime_error("Cannot load glTF file: unknown accessor component type");
+    return 0;
+}
+
+static size_t ComponentCount(std::string_view type)
+{
+    if (type == "SCALAR") {
+        return 1;
+    }
+    if (type == "VEC2") {
+        return 2;
+    }
+    if (type == "VEC3") {
+        return 3;
+    }
+    if (type == "VEC4") {
+        return 4;
+    }
+    utils::throw_runtime_error("Cannot load glTF file: matrix accessors are not supported");
+    return 0;
+}
+
+static auto GetAccessor(const GltfDocument& document, int index) -> GltfAccessor
+{
+    const auto& accessor = document.json.at("accessors").at(utils::narrow_cast<size_t>(index));
+
+    utils::throw_runtime_error_if(
+        accessor.contains("sparse"),
+        "Cannot load glTF file: sparse accessors are not supported");
+    utils::throw_runtime_error_if(
+        !accessor.contains("bufferView"),
+        "Cannot load glTF file: accessors without buffer view are not supported");
+
+    auto result           = GltfAccessor{};
+    result.count          = accessor.at("count").get<size_t>();
+    result.component_type = accessor.at("componentType").get<int>();
+    result.components     = ComponentCount(accessor.at("type").get<std::string>());
+    result.normalized     = accessor.value("normalized", false);
+
+    const auto& view         = document.json.at("bufferViews").at(accessor["bufferView"].get<size_t>());
+    const auto  buffer_index = view.at("buffer").get<size_t>();
+    const auto  buffer       = document.buffers.at(buffer_index);
+
+    auto element_size = ComponentSize(result.component_type) * result.components;
+    auto view_offset  = view.value("byteOffset", size_t{ 0 });
+    auto view_length  = view.at("byteLength").get<size_t>();
+    auto offset       = accessor.value("byteOffset", size_t{ 0 });
+
+    result.stride = view.value("byteStride", element_size);
+
+    utils::throw_runtime_error_if(
+        view_offset > buffer.size() || view_length > buffer.size() - view_offset,
+        "Cannot load glTF file: buffer view is out of range");
+    utils::throw_runtime_error_if(
+        result.stride < element_size,
+        "Cannot load glTF file: buffer view stride is too small");
+
+    if (result.count > 0) {
+        auto extent = offset + (result.count - 1) * result.stride + element_size;
+        utils::throw_runtime_error_if(extent > view_length, "Cannot load glTF file: accessor is out of range");
+    }
+
+    result.data      = buffer.data() + view_offset + offset;
+    result.buffer    = buffer_index;
+    result.offset    = view_offset + offset;
+    result.available = view_length - offset;
+
+    return result;
+}
+
+static float ReadFloat(const GltfAccessor& accessor, size_t index, size_t component)
+{
+    auto size = ComponentSize(accessor.component_type);
+    auto src  = accessor.data + index * accessor.stride + component * size;
+
+    switch (accessor.component_type) {
+    case kFloat: {
+        auto value = float{};
+        std::memcpy(&value, src, sizeof(value));
+        return value;
+    }
+    case kUnsignedByte: {
+        auto value = uint8_t{};
+        std::memcpy(&value, src, sizeof(value));
+        return accessor.normalized ? value / 255.0f : value;
+    }
+    case kUnsignedShort: {
+        auto value = uint16_t{};
+        std::memcpy(&value, src, sizeof(value));
+        return accessor.normalized ? value / 65535.0f : value;
+    }
+    case kByte: {
+        auto value = int8_t{};
+        std::memcpy(&value, src, sizeof(value));
+        return accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case kShort: {
+        auto value = int16_t{};
+        std::memcpy(&value, src, sizeof(value));
+        return accessor.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    }
+    utils::throw_runtime_error("Cannot load glTF file: unsupported vertex attribute type");
+    return 0;
+}
+
+static uint32_t ReadIndex(const GltfAccessor& accessor, size_t index)
+{
+    auto src = accessor.data + index * accessor.stride;
+
+    switch (accessor.component_type) {
+    case kUnsignedByte: {
+        auto value = uint8_t{};
+        std::memcpy(&value, src, sizeof(value));
+        return value;
+    }
+    case kUnsignedShort: {
+        auto value = uint16_t{};
+        std::memcpy(&value, src, sizeof(value));
+        return value;
+    }
+    case kUnsignedInt: {
+        auto value = uint32_t{};
+        std::memcpy(&value, src, sizeof(value));
+        return value;
+    }
+    }
+    utils::throw_runtime_error("Cannot load glTF file: unsupported index type");
+    return 0;
+}
+
+static auto ReadVec3(const GltfAccessor& accessor, size_t index) -> glm::vec3
+{
+    return { ReadFloat(accessor, index, 0), ReadFloat(accessor, index, 1), ReadFloat(accessor, index, 2) };
+}
+
+static size_t GetIndexCount(const GltfDocument& document, int index, size_t vertex_count)
+{
+    return index == kNone ? vertex_count : GetAccessor(document, index).count;
+}
+
+// Non-indexed primitives draw their vertices in order. The destination holds GetIndexCount indices.
+static void ReadIndices(const GltfDocument& document, int index, std::span<uint32_t> indices)
+{
+    if (index == kNone) {
+        for (size_t i = 0; i < indices.size(); ++i) {
+            indices[i] = utils::narrow_cast<uint32_t>(i);
+        }
+    } else if (auto accessor = GetAccessor(document, index);
+               accessor.component_type == kUnsignedInt && accessor.stride == sizeof(uint32_t)) {
+        std::memcpy(indices.data(), accessor.data, indices.size_bytes());
+    } else {
+        for (size_t i = 0; i < indices.size(); ++i) {
+            indices[i] = ReadIndex(accessor, i);
+        }
+    }
+}
+
+// Data that is stored in the layout the renderer uses is not read at load time. The buffer is filled from the file
+// when it is uploaded, straight into the staging memory, and again whenever the scene needs its contents.
+static auto MakeFileSource(const GltfDocument& document, const GltfAccessor& accessor) -> Buffer::Source
+{
+    auto origin = document.origins.at(accessor.buffer);
+
+    if (origin.file == kNone) {
+        return {};
+    }
+
+    auto file_index = utils::narrow_cast<size_t>(origin.file);
+    auto path       = document.paths[file_index];
+    auto size       = document.files[file_index].Bytes().size();
+    auto write_time = document.write_times[file_index];
+    auto offset     = origin.offset + accessor.offset;
+
+    // A file of the same size may still have been rewritten, so its modification time has to match too.
+    return [path, size, write_time, offset](std::span<std::byte> dst) {
+        auto error = std::error_code{};
+        utils::throw_runtime_error_if(
+            std::filesystem::last_write_time(path, error) != write_time || error,
+            "Cannot read glTF buffer: file has changed since it was loaded");
+
+        auto file  = utils::MappedFile(path);
+        auto bytes = file.Bytes();
+        utils::throw_runtime_error_if(
+            bytes.size() != size || offset > bytes.size() || dst.size() > bytes.size() - offset,
+            "Cannot read glTF buffer: file has changed since it was loaded");
+        std::memcpy(dst.data(), bytes.data() + offset, dst.size());
+    };
+}
+
+// Vertex buffers are shared by primitives that use the same attribute accessors. Generated normals depend on the
+// indices too, so the index accessor is part of the key only when normals are missing.
+static auto AddVertexBuffer(GltfContext* context, const Json& attributes, int indices) -> GltfVertices
+{
+    const auto& document = *context->document;
+
+    utils::throw_runtime_error_if(
+        !attributes.contains("POSITION"),
+        "Cannot load glTF file: primitive has no positions");
+
+    auto position_index = attributes["POSITION"].get<int>();
+    auto normal_index   = attributes.value("NORMAL", kNone);
+    auto texcoord_index = attributes.value("TEXCOORD_0", kNone);
+    auto key = std::array{ position_index, normal_index, texcoord_index, normal_index == kNone ? indices : kNone };
+
+    if (auto it = context->vertex_buffers.find(key); it != context->vertex_buffers.end()) {
+        return it->second;
+    }
+
+    auto position = GetAccessor(document, position_index);
+    auto count    = position.count;
+
+    utils::throw_runtime_error_if(
+        position.components != 3 || position.component_type != kFloat,
+        "Cannot load glTF file: positions must be float triples");
+
+    auto& builder = *context->builder;
+    auto  size    = count * sizeof(ModelVertex);
+
+    if (normal_index != kNone && texcoord_index != kNone) {
+        auto normal   = GetAccessor(document, normal_index);
+        auto texcoord = GetAccessor(document, texcoord_index);
+
+        utils::throw_runtime_error_if(
+            normal.count != count || texcoord.count != count,
+            "Cannot load glTF file: vertex attributes differ in length");
+
+        bool interleaved = normal.component_type == kFloat && texcoord.component_type == kFloat &&
+                           normal.components == 3 && texcoord.components == 2 &&
+                           position.stride == sizeof(ModelVertex) && normal.stride == sizeof(ModelVertex) &&
+                           texcoord.stride == sizeof(ModelVertex) &&
+                           normal.data == position.data + offsetof(ModelVertex, normal) &&
+                           texcoord.data == position.data + offsetof(ModelVertex, uv) &&
+                           position.available >= count * sizeof(ModelVertex);
+
+        if (interleaved) {
+            auto vertices = GltfVertices{ {}, Bytes(position.data, size) };
+            if (auto source = MakeFileSource(document, position)) {
+                vertices.handle = builder.AddVertexBuffer(std::move(source), size, std::align_val_t(32));
+            } else {
+                vertices.handle = builder.AddVertexBuffer(position.data, size, std::align_val_t(32));
+            }
+            return context->vertex_buffers.emplace(key, vertices).first->second;
+        }
+    }
+
+    // Converted vertices are written into the memory the scene adopts.
+    auto data     = Buffer::Allocate(size, std::align_val_t(32));
+    auto vertices = std::span(static_cast<ModelVertex*>(data.get()), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        std::construct_at(&vertices[i], ReadVec3(position, i), glm::vec3{}, glm::vec2{});
+    }
+
+    if (normal_index != kNone) {
+        auto normal = GetAccessor(document, normal_index);
+        utils::throw_runtime_error_if(
+            normal.count != count,
+            "Cannot load glTF file: vertex attributes differ in length");
+        for (size_t i = 0; i < count; ++i) {
+            vertices[i].normal = ReadVec3(normal, i);
+        }
+    } else {
+        auto triangles = std::vector<uint32_t>(GetIndexCount(document, indices, count));
+        ReadIndices(document, indices, triangles);
+        for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+            auto i0 = triangles[i];
+            auto i1 = triangles[i + 1];
+            auto i2 = triangles[i + 2];
+            utils::throw_runtime_error_if(
+                i0 >= count || i1 >= count || i2 >= count,
+                "Cannot load glTF file: index is out of range");
+            auto& v0   = vertices[i0];
+            auto& v1   = vertices[i1];
+            auto& v2   = vertices[i2];
+            auto  face = glm::cross(v1.position - v0.position, v2.position - v0.position);
+            v0.normal  = v0.normal + face;
+            v1.normal  = v1.normal + face;
+            v2.normal  = v2.normal + face;
+        }
+        for (auto& vertex : vertices) {
+            if (auto length = glm::length(vertex.normal); length > 0) {
+                vertex.normal = (1.0f / length) * vertex.normal;
+            }
+        }
+    }
+
+    if (texcoord_index != kNone) {
+        auto texcoord = GetAccessor(document, texcoord_index);
+        utils::throw_runtime_error_if(
+            texcoord.count != count || texcoord.components != 2,
+            "Cannot load glTF file: texture coordinates are not valid");
+        for (size_t i = 0; i < count; ++i) {
+            vertices[i].uv = glm::vec2(ReadFloat(texcoord, i, 0), ReadFloat(texcoord, i, 1));
+        }
+    }
+
+    // The scene adopts the memory, so it stays where it is.
+    auto bytes  = Bytes(static_cast<const std::byte*>(data.get()), size);
+    auto handle = builder.AddVertexBuffer(std::move(data), size);
+
+    return context->vertex_buffers.emplace(key, GltfVertices{ handle, bytes }).first->second;
+}
+
+// Indices are always read at load time: building meshlets reorders the triangles, so they no longer match the file.
+static auto AddIndexBuffer(GltfContext* context, int index, int position_index, const GltfVertices& vertices)
+    -> const GltfIndices&
+{
+    const auto& document = *context->document;
+
+    auto key = std::array{ index, position_index };
+
+    if (auto it = context->index_buffers.find(key); it != context->index_buffers.end()) {
+        return it->second;
+    }
+
+    if (index != kNone) {
+        utils::throw_runtime_error_if(
+            GetAccessor(document, index).components != 1,
+            "Cannot load glTF file: indices must be scalars");
+    }
+
+    auto count   = GetIndexCount(document, index, vertices.data.size() / sizeof(ModelVertex));
+    auto size    = count * sizeof(uint32_t);
+    auto data    = Buffer::Allocate(size, std::align_val_t(32));
+    auto indices = std::span(static_cast<uint32_t*>(data.get()), count);
+
+    ReadIndices(document, index, indices);
+
+    auto meshlets = BuildMeshlets(vertices.data, sizeof(ModelVertex), indices);
+    auto handle   = context->builder->AddIndexBuffer(std::move(data), size);
+
+    return context->index_buffers.emplace(key, GltfIndices{ handle, count, std::move(meshlets) }).first->second;
+}
+
+static auto ComputeBounds(const GltfDocument& document, int position_index) -> AABB
+{
+    const auto& accessor = document.json.at("accessors").at(utils::narrow_cast<size_t>(position_index));
+
+    if (accessor.contains("min") && accessor.contains("max")) {
+        auto min = accessor["min"].get<std::array<float, 3>>();
+        auto max = accessor["max"].get<std::array<float, 3>>();
+        return AABB{ Float3(min[0], min[1], min[2]), Float3(max[0], max[1], max[2]) };
+    }
+
+    auto position = GetAccessor(document, position_index);
+    auto aabb     = AABB::Empty();
+    for (size_t i = 0; i < position.count; ++i) {
+        auto point = ReadVec3(position, i);
+        aabb.Expand(Float3(point.x, point.y, point.z));
+    }
+
+    return aabb;
+}
+
+static auto AddMesh(GltfContext* context, int mesh_index) -> const std::vector<GltfPrimitive>&
+{
+    if (auto it = context->meshes.find(mesh_index); it != context->meshes.end()) {
+        return it->second;
+    }
+
+    const auto& document   = *context->document;
+    const auto& mesh       = document.json.at("meshes").at(utils::narrow_cast<size_t>(mesh_index));
+    auto        primitives = std::vector<GltfPrimitive>{};
+
+    for (const auto& primitive : mesh.at("primitives")) {
+        if (primitive.value("mode", kTriangles) != kTriangles) {
+            spdlog::warn("Skipping glTF primitive: only triangle lists are supported");
+            continue;
+        }
+
+        const auto& attributes = primitive.at("attributes");
+
+        auto indices        = primitive.value("indices", kNone);
+        auto position_index = attributes["POSITION"].get<int>();
+        auto vertex_buffer  = AddVertexBuffer(context, attributes, indices);
+
+        const auto& triangles = AddIndexBuffer(context, indices, position_index, vertex_buffer);
+
+        auto aabb   = ComputeBounds(document, position_index);
+        auto handle = context->builder->AddMesh(
+            aabb,
+            vertex_buffer.handle,
+            triangles.handle,
+            0,
+            triangles.count,
+            triangles.meshlets);
+
+        auto material = context->default_material;
+
+        if (auto material_index = primitive.value("material", kNone); material_index != kNone) {
+            material = context->materials.at(utils::narrow_cast<size_t>(material_index));
+        }
+
+        primitives.push_back({ handle, material });
+    }
+
+    return context->meshes.emplace(mesh_index, std::move(primitives)).first->second;
+}
+
+static void AddMaterials(ModelFile* file, GltfContext* context)
+{
+    const auto& json    = context->document->json;
+    auto&       builder = file->builder;
+    auto        shader  = builder.AddShader();
+
+    context->default_material = builder.AddMaterial(shader);
+
+    for (const auto& gltf_material : json.value("materials", Json::array())) {
+        auto material = builder.AddMaterial(shader);
+
+        if (gltf_material.contains("name")) {
+            builder.SetProperty(material, kNameAtom, gltf_material["name"].get<std::string>());
+        }
+
+        auto pbr = gltf_material.value("pbrMetallicRoughness", Json::object());
+
+        if (pbr.contains("baseColorFactor")) {
+            auto color = pbr["baseColorFactor"].get<std::array<float, 4>>();
+            builder.SetProperty(material, kDiffuseColorAtom, Float3(color[0], color[1], color[2]));
+        }
+
+        if (pbr.contains("baseColorTexture")) {
+            const auto& texture = json.at("textures").at(pbr["baseColorTexture"].at("index").get<size_t>());
+            if (texture.contains("source")) {
+                const auto& image = json.at("images").at(texture["source"].get<size_t>());
+                auto        uri   = image.value("uri", std::string{});
+                if (uri.empty() || uri.starts_with("data:")) {
+                    spdlog::warn("Skipping glTF texture: embedded images are not supported");
+                } else {
+                    auto filepath = (context->parent_dir / DecodeUri(uri)).string();
+                    builder.SetProperty(material, kDiffuseTextureAtom, filepath);
+                    file->textures.push_back(std::move(filepath));
+                }
+            }
+        }
+
+        context->materials.push_back(material);
+    }
+}
+
+struct GltfTransform final {
+    std::array<float, 3> translation{ 0, 0, 0 };
+    std::array<float, 4> rotation{ 0, 0, 0, 1 };
+    std::array<float, 3> scale{ 1, 1, 1 };
+};
+
+static auto DecomposeMatrix(const std::array<float, 16>& m) -> GltfTransform
+{
+    auto transform        = GltfTransform{};
+    transform.translation = { m[12], m[13], m[14] };
+
+    auto column = [&m](size_t c) { return glm::vec3(m[4 * c], m[4 * c + 1], m[4 * c + 2]); };
+    auto x      = column(0);
+    auto y      = column(1);
+    auto z      = column(2);
+    auto sx     = glm::length(x);
+    auto sy     = glm::length(y);
+    auto sz     = glm::length(z);
+
+    if (glm::dot(glm::cross(x, y), z) < 0) {
+        sx = -sx;
+    }
+
+    transform.scale = { sx, sy, sz };
+
+    if (sx == 0 || sy == 0 || sz == 0) {
+        return transform;
+    }
+
+    x = (1.0f / sx) * x;
+    y = (1.0f / sy) * y;
+    z = (1.0f / sz) * z;
+
+    // Quaternion from an orthonormal basis, picking the largest component to keep the division well conditioned.
+    auto trace = x.x + y.y + z.z;
+    auto q     = std::array<float, 4>{};
+
+    if (trace > 0) {
+        auto s = 2.0f * std::sqrt(trace + 1.0f);
+        q      = { (y.z - z.y) / s, (z.x - x.z) / s, (x.y - y.x) / s, 0.25f * s };
+    } else if (x.x > y.y && x.x > z.z) {
+        auto s = 2.0f * std::sqrt(1.0f + x.x - y.y - z.z);
+        q      = { 0.25f * s, (y.x + x.y) / s, (z.x + x.z) / s, (y.z - z.y) / s };
+    } else if (y.y > z.z) {
+        auto s = 2.0f * std::sqrt(1.0f + y.y - x.x - z.z);
+        q      = { (y.x + x.y) / s, 0.25f * s, (z.y + y.z) / s, (z.x - x.z) / s };
+    } else {
+        auto s = 2.0f * std::sqrt(1.0f + z.z - x.x - y.y);
+        q      = { (z.x + x.z) / s, (z.y + y.z) / s, 0.25f * s, (x.y - y.x) / s };
+    }
+
+    transform.rotation = q;
+
+    return transform;
+}
+
+static auto GetTransform(const Json& node) -> GltfTransform
+{
+    if (node.contains("matrix")) {
+        return DecomposeMatrix(node["matrix"].get<std::array<float, 16>>());
+    }
+
+    auto transform = GltfTransform{};
+    if (node.contains("translation")) {
+        transform.translation = node["translation"].get<std::array<float, 3>>();
+    }
+    if (node.contains("rotation")) {
+        transform.rotation = node["rotation"].get<std::array<float, 4>>();
+    }
+    if (node.contains("scale")) {
+        transform.scale = node["scale"].get<std::array<float, 3>>();
+    }
+
+    return transform;
+}
+
+// A glTF node becomes a chain of translate, rotate and scale nodes, outermost first, skipping identity steps. Returns
+// the outermost and innermost node of the chain.
+static auto AddTransformNodes(SceneBuilder* builder, SceneBuilder::Handle parent, const Json& node)
+    -> std::pair<SceneBuilder::Handle, SceneBuilder::Handle>
+{
+    auto [translation, rotation, scale] = GetTransform(node);
+
+    auto outer = SceneBuilder::kNoParent;
+    auto inner = parent;
+
+    auto add = [&](SceneBuilder::Handle handle) {
+        if (outer == SceneBuilder::kNoParent) {
+            outer = handle;
+        }
+        inner = handle;
+    };
+
+    if (translation[0] != 0 || translation[1] != 0 || translation[2] != 0) {
+        add(builder->AddTranslateNode(inner, Float3(translation[0], translation[1], translation[2])));
+    }
+
+    auto [qx, qy, qz, qw] = rotation;
+    if (auto length = std::sqrt(qx * qx + qy * qy + qz * qz); length > 1e-6f) {
+        auto angle = 2.0f * std::atan2(length, qw);
+        add(builder->AddRotateNode(inner, Float3(qx / length, qy / length, qz / length), Radians(angle)));
+    }
+
+    if (scale[0] != 1 || scale[1] != 1 || scale[2] != 1) {
+        if (scale[0] != scale[1] || scale[0] != scale[2]) {
+            spdlog::warn("Approximating non-uniform glTF scale with a uniform one");
+        }
+        add(builder->AddScaleNode(inner, std::cbrt(scale[0] * scale[1] * scale[2])));
+    }
+
+    if (outer == SceneBuilder::kNoParent) {
+        add(builder->AddGroupNode(parent));
+    }
+
+    return { outer, inner };
+}
+
+static void AddNode(GltfContext* context, SceneBuilder::Handle parent, int node_index)
+{
+    enum : char { kUnvisited, kVisiting, kVisited };
+
+    auto& state = context->node_state.at(utils::narrow_cast<size_t>(node_index));
+    utils::throw_runtime_error_if(state == kVisiting, "Cannot load glTF file: node hierarchy contains a cycle");
+    state = kVisiting;
+
+    const auto& json    = context->document->json;
+    const auto& node    = json["nodes"][utils::narrow_cast<size_t>(node_index)];
+    auto&       builder = *context->builder;
+
+    auto [outer, inner] = AddTransformNodes(&builder, parent, node);
+
+    if (node.contains("name")) {
+        builder.SetProperty(outer, kNameAtom, node["name"].get<std::string>());
+    }
+
+    if (node.contains("mesh")) {
+        auto        mesh_index = node["mesh"].get<int>();
+        const auto& primitives = AddMesh(context, mesh_index);
+        const auto& mesh       = json["meshes"][utils::narrow_cast<size_t>(mesh_index)];
+        auto        name       = mesh.value("name", std::string("Mesh ") + std::to_string(mesh_index + 1));
+
+        auto primitive_num = 1;
+        for (const auto& [mesh_handle, material] : primitives) {
+            auto instance = builder.AddInstanceNode(inner, mesh_handle, material);
+            if (primitives.size() == 1) {
+                builder.SetProperty(instance, kNameAtom, name);
+            } else {
+                auto suffix = std::string(" (") + std::to_string(primitive_num++) + (")");
+                builder.SetProperty(instance, kNameAtom, name + suffix);
+            }
+        }
+    }
+
+    for (const auto& child : node.value("children", Json::array())) {
+        AddNode(context, inner, child.get<int>());
+    }
+
+    context->node_state[utils::narrow_cast<size_t>(node_index)] = kVisited;
+}
+
+static auto GetRootNodes(const Json& json) -> std::vector<int>
+{
+    auto scenes = json.value("scenes", Json::array());
+
+    if (!scenes.empty()) {
+        auto scene = json.value("scene", size_t{ 0 });
+        return scenes.at(scene).value("nodes", std::vector<int>{});
+    }
+
+    // Without scenes, every node that is nobody's child is a root.
+    auto nodes   = json.value("nodes", Json::array());
+    auto is_root = std::vector<bool>(nodes.size(), true);
+
+    for (const auto& node : nodes) {
+        for (const auto& child : node.value("children", Json::array())) {
+            is_root.at(child.get<size_t>()) = false;
+        }
+    }
+
+    auto roots = std::vector<int>{};
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (is_root[i]) {
+            roots.push_back(utils::narrow_cast<int>(i));
+        }
+    }
+
+    return roots;
+}
+
+ModelFile LoadGltf(const std::filesystem::path& filepath)
+{
+    namespace fs = std::filesystem;
+
+    if (false == fs::exists(filepath)) {
+        throw std::runtime_error("File does not exist");
+    }
+
+    spdlog::info("Parsing {}", filepath.string());
+
+    auto document = ReadDocument(filepath);
+    auto file     = ModelFile{};
+    auto context  = GltfContext{};
+
+    context.document   = &document;
+    context.builder    = &file.builder;
+    context.parent_dir = filepath.parent_path();
+    context.node_state.resize(document.json.value("nodes", Json::array()).size());
+
+    AddMaterials(&file, &context);
+
+    auto file_node = file.builder.AddGroupNode();
+
+    file.builder.SetProperty(file_node, kNameAtom, filepath.filename().string());
+    file.builder.SetProperty(file_node, "Path", filepath.string());
+
+    for (auto root : GetRootNodes(document.json)) {
+        AddNode(&context, file_node, root);
+    }
+
+    return file;
+}
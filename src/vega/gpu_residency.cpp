@@ -0,0 +1,127 @@
+#include "gpu_residency.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+auto ComputeScreenRadius(const AABB& aabb, const MeshletView& view, float pixel_scale) noexcept -> float
+{
+    if (aabb.IsEmpty()) {
+        return 0;
+    }
+
+    auto center = glm::vec3(aabb.Center().x, aabb.Center().y, aabb.Center().z);
+    auto radius = 0.5f * glm::length(glm::vec3(aabb.ExtentX(), aabb.ExtentY(), aabb.ExtentZ()));
+
+    if (!IsSphereVisible(center, radius, view)) {
+        return 0;
+    }
+
+    auto distance = glm::length(center - view.camera) - radius;
+
+    return distance > 0 ? radius * pixel_scale / distance : std::numeric_limits<float>::max();
+}
+
+bool GpuResidency::Request(ID id, size_t size, float priority)
+{
+    auto& entry = m_entries[id];
+
+    if (entry.is_resident) {
+        entry.last_frame = m_frame;
+        return true;
+    }
+
+    if (entry.last_frame != m_frame) {
+        entry.size       = size;
+        entry.last_frame = m_frame;
+        entry.priority   = priority;
+        m_missing.push_back(id);
+    } else {
+        entry.priority = std::max(entry.priority, priority);
+    }
+
+    return false;
+}
+
+auto GpuResidency::Update(size_t upload_limit) -> Plan
+{
+    auto plan = Plan{};
+
+    // Eviction candidates, least recently used first; buffers of the current frame are in use.
+    auto candidates = std::vector<std::pair<uint64_t, ID>>{};
+    auto evictable  = size_t{ 0 };
+    for (const auto& [id, entry] : m_entries) {
+        if (entry.is_resident && entry.last_frame != m_frame) {
+            candidates.emplace_back(entry.last_frame, id);
+            evictable += entry.size;
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    auto next_candidate = candidates.begin();
+
+    auto make_room = [&](size_t size) {
+        while (m_resident_bytes + size > m_budget && next_candidate != candidates.end()) {
+            auto& entry = m_entries[next_candidate->second];
+
+            entry.is_resident = false;
+            m_resident_bytes -= entry.size;
+            evictable -= entry.size;
+
+            plan.evictions.push_back(next_candidate->second);
+            ++next_candidate;
+        }
+    };
+
+    make_room(0);
+
+    std::sort(m_missing.begin(), m_missing.end(), [this](ID lhs, ID rhs) {
+        auto lhs_priority = m_entries[lhs].priority;
+        auto rhs_priority = m_entries[rhs].priority;
+        return lhs_priority != rhs_priority ? lhs_priority > rhs_priority : lhs < rhs;
+    });
+
+    auto planned = size_t{ 0 };
+
+    for (auto id : m_missing) {
+        auto& entry = m_entries[id];
+
+        if (planned != 0 && planned + entry.size > upload_limit) {
+            break;
+        }
+
+        // A buffer that does not fit even after every eviction may still leave room for a smaller one further down.
+        if (m_resident_bytes - evictable + entry.size > m_budget) {
+            continue;
+        }
+
+        make_room(entry.size);
+
+        entry.is_resident = true;
+        m_resident_bytes += entry.size;
+        planned += entry.size;
+        plan.uploads.push_back(id);
+    }
+
+    m_missing.clear();
+    m_frame++;
+
+    m_upload_count += plan.uploads.size();
+    m_eviction_count += plan.evictions.size();
+
+    return plan;
+}
+
+void GpuResidency::Remove(ID id)
+{
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    if (it->second.is_resident) {
+        m_resident_bytes -= it->second.size;
+    }
+
+    std::erase(m_missing, id);
+    m_entries.erase(it);
+}
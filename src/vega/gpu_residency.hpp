@@ -0,0 +1,63 @@
+#pragma once
+
+#include "meshlet.hpp"
+#include "scene.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Size of a mesh on screen, as the projected radius of its bounding sphere in pixels; 0 if the sphere is outside the
+// view. Pixel scale is as for SelectPointNodes. Meshes that contain the camera get the largest float.
+auto ComputeScreenRadius(const AABB& aabb, const MeshletView& view, float pixel_scale) noexcept -> float;
+
+// Decides which buffers live in device memory when they do not all fit in the budget. Every frame the renderer requests
+// the buffers it draws; Update then admits the missing ones, largest on screen first, and makes room by evicting the
+// buffers that have gone longest without a request. A buffer requested in the current frame is never evicted, so a
+// view that needs more than the budget draws what fits instead of reloading the same buffers every frame.
+class GpuResidency {
+  public:
+    struct Plan final {
+        std::vector<ID> uploads;   // In priority order
+        std::vector<ID> evictions; // Least recently used first
+    };
+
+    explicit GpuResidency(size_t budget = std::numeric_limits<size_t>::max()) noexcept : m_budget(budget) {}
+
+    // A lower budget takes effect on the next Update, which evicts down to it.
+    void SetBudget(size_t budget) noexcept { m_budget = budget; }
+
+    // Returns whether the buffer is resident. Priority orders the uploads; a buffer requested by several draws takes
+    // the highest of their priorities.
+    bool Request(ID id, size_t size, float priority);
+
+    // Ends the frame and returns the buffers to upload and to evict. Uploads stop once upload_limit bytes are planned,
+    // so that a large view streams in over several frames; the first upload is always planned if it fits the budget.
+    auto Update(size_t upload_limit) -> Plan;
+
+    // Forgets a buffer that no longer exists.
+    void Remove(ID id);
+
+    auto GetBudget() const noexcept { return m_budget; }
+    auto GetResidentBytes() const noexcept { return m_resident_bytes; }
+    auto GetUploadCount() const noexcept { return m_upload_count; }
+    auto GetEvictionCount() const noexcept { return m_eviction_count; }
+
+  private:
+    struct Entry final {
+        size_t   size        = 0;
+        uint64_t last_frame  = 0; // Frame of the last request
+        float    priority    = 0;
+        bool     is_resident = false;
+    };
+
+    std::unordered_map<ID, Entry, ID::Hash> m_entries;
+    std::vector<ID>                         m_missing; // Requested in this frame but not resident
+    size_t                                  m_budget;
+    size_t                                  m_resident_bytes = 0;
+    uint64_t                                m_frame          = 1;
+    uint64_t                                m_upload_count   = 0;
+    uint64_t                                m_eviction_count = 0;
+};
@@ -0,0 +1,58 @@
+#include "gpu_timeline.hpp"
+
+#include <algorithm>
+
+GpuTimeline::GpuTimeline(etna::Device device)
+{
+    m_semaphore = device.CreateTimelineSemaphore(0);
+}
+
+uint64_t GpuTimeline::Submit(etna::Queue queue, etna::Queue::SubmitBatch& submit_batch)
+{
+    auto value = m_submitted_value + 1;
+
+    if (m_pending_wait.value > m_completed_value) {
+        submit_batch.AddWaitSemaphore(*m_semaphore, m_pending_wait.stages, m_pending_wait.value);
+    }
+
+    submit_batch.AddSignalSemaphore(*m_semaphore, value);
+
+    queue.Submit(submit_batch);
+
+    m_pending_wait    = {};
+    m_submitted_value = value;
+    m_submit_count++;
+
+    return value;
+}
+
+void GpuTimeline::WaitOnNextSubmit(uint64_t value, etna::PipelineStage wait_stage)
+{
+    m_pending_wait.value  = std::max(m_pending_wait.value, value);
+    m_pending_wait.stages = m_pending_wait.stages | wait_stage;
+}
+
+uint64_t GpuTimeline::CompletedValue()
+{
+    if (m_completed_value < m_submitted_value) {
+        m_completed_value = m_semaphore->GetCounterValue();
+    }
+    return m_completed_value;
+}
+
+bool GpuTimeline::IsCompleted(uint64_t value)
+{
+    return value <= m_completed_value || value <= CompletedValue();
+}
+
+void GpuTimeline::Wait(uint64_t value)
+{
+    if (IsCompleted(value)) {
+        return;
+    }
+
+    m_semaphore->Wait(value);
+    m_blocking_wait_count++;
+
+    m_completed_value = std::max(m_completed_value, value);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "etna/device.hpp"
+#include "etna/queue.hpp"
+#include "etna/synchronization.hpp"
+
+// Tags every queue submission with a monotonically increasing value of a single timeline semaphore, so that
+// resources can be recycled by polling the completed value instead of waiting on fences or the device.
+class GpuTimeline {
+  public:
+    GpuTimeline(etna::Device device);
+
+    GpuTimeline(const GpuTimeline&) = delete;
+    GpuTimeline& operator=(const GpuTimeline&) = delete;
+
+    auto Submit(etna::Queue queue, etna::Queue::SubmitBatch& submit_batch) -> uint64_t;
+
+    void WaitOnNextSubmit(uint64_t value, etna::PipelineStage wait_stage);
+
+    auto SubmittedValue() const noexcept { return m_submitted_value; }
+
+    auto CompletedValue() -> uint64_t;
+
+    bool IsCompleted(uint64_t value);
+
+    void Wait(uint64_t value);
+
+    void WaitIdle() { Wait(m_submitted_value); }
+
+    auto SubmitCount() const noexcept { return m_submit_count; }
+
+    auto BlockingWaitCount() const noexcept { return m_blocking_wait_count; }
+
+  private:
+    struct PendingWait final {
+        uint64_t                value = 0;
+        etna::PipelineStageMask stages;
+    };
+
+    etna::UniqueTimelineSemaphore m_semaphore;
+    PendingWait                   m_pending_wait;
+    uint64_t                      m_submitted_value     = 0;
+    uint64_t                      m_completed_value     = 0;
+    uint64_t                      m_submit_count        = 0;
+    uint64_t                      m_blocking_wait_count = 0;
+};
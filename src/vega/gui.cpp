@@ -25,8 +25,11 @@ BEGIN_DISABLE_WARNINGS
 
 END_DISABLE_WARNINGS
 
+#include <algorithm>
 #include <charconv>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 static constexpr int kMaxStringSize = 128;
 
@@ -63,24 +66,53 @@ class SceneWindow : public Window {
     static constexpr bool VisibilityDefault = true;
 
   private:
+    // One line of the flattened tree view. Rows have a uniform height, so only the visible ones need to be drawn.
+    struct Row final {
+        enum class Kind { Node, Property, Field };
+
+        Kind      kind   = Kind::Node;
+        int       depth  = 0;
+        ObjectPtr object = nullptr;
+        size_t    index  = 0;
+    };
+
+    static constexpr size_t kMaxSearchResults = 1000;
+
+    void BuildRows();
+    void SearchNodes(bool reveal);
+    void AppendNodeRows(NodePtr node, int depth, bool filtered);
+    void AppendPropertyRows(ObjectPtr object, int depth);
+
     bool DrawTreeNode(NodePtr node);
-    auto DrawContextMenu(NodePtr node) -> NodePtr;
+    void DrawContextMenu(NodePtr node);
     void DrawNode(NodePtr node);
-    void DrawProperties(ObjectPtr object, int* ptr_id);
-    void DrawField(ObjectPtr object, std::string_view field, int* ptr_id);
-
-    char        m_buffer[kMaxStringSize] = {};
-    const void* m_selected_node          = nullptr;
-    const void* m_rename_node            = 0;
-    Scene*      m_scene                  = nullptr;
+    void DrawProperty(ObjectPtr object, size_t property_index);
+    void DrawField(ObjectPtr object, size_t field_index);
+
+    char                        m_buffer[kMaxStringSize] = {};
+    char                        m_search[kMaxStringSize] = {};
+    const void*                 m_selected_node          = nullptr;
+    const void*                 m_rename_node            = 0;
+    NodePtr                     m_destroy_node           = nullptr;
+    Scene*                      m_scene                  = nullptr;
+    std::vector<Row>            m_rows;
+    std::unordered_set<NodePtr> m_expanded_nodes;
+    std::unordered_set<NodePtr> m_search_matches;
+    std::unordered_set<NodePtr> m_search_paths;
+    uint64_t                    m_rows_revision  = 0;
+    bool                        m_rows_dirty     = true;
+    bool                        m_search_changed = false;
 };
 
 class FileBrowserWindow {
   public:
-    FileBrowserWindow() noexcept
+    FileBrowserWindow(const char* title, ImGuiFileBrowserFlags flags) noexcept
+        : m_file_browser(ImGuiFileBrowserFlags_CloseOnEsc | flags)
     {
-        m_file_browser.SetTitle("Import");
-        m_file_browser.SetTypeFilters({ ".obj" });
+        m_file_browser.SetTitle(title);
+        if ((flags & ImGuiFileBrowserFlags_SelectDirectory) == 0) {
+            m_file_browser.SetTypeFilters({ ".obj", ".gltf", ".glb" });
+        }
         m_file_browser.SetWindowSize(1000, 800);
     }
 
@@ -98,7 +130,7 @@ class FileBrowserWindow {
     }
 
   private:
-    ImGui::FileBrowser m_file_browser = ImGui::FileBrowser(ImGuiFileBrowserFlags_CloseOnEsc);
+    ImGui::FileBrowser m_file_browser;
 };
 
 static Gui& Self(GLFWwindow* window)
@@ -107,12 +139,12 @@ static Gui& Self(GLFWwindow* window)
 }
 
 template <size_t N>
-static void CopyToBuffer(char (&buffer)[N], const std::string& s)
+static void CopyToBuffer(char (&buffer)[N], std::string_view s)
 {
     size_t size  = std::min(s.size(), sizeof(buffer) - 1);
     buffer[size] = 0;
 
-    std::memcpy(buffer, s.c_str(), size);
+    std::memcpy(buffer, s.data(), size);
 }
 
 static ImFont* LoadFont(const char* font_name, float font_size)
@@ -265,7 +297,7 @@ Gui::Gui(
             .Device          = parameters.device,
             .QueueFamily     = parameters.graphics_queue.FamilyIndex(),
             .Queue           = parameters.graphics_queue,
-            .PipelineCache   = nullptr,
+            .PipelineCache   = parameters.pipeline_cache,
             .DescriptorPool  = *m_descriptor_pool,
             .MinImageCount   = min_image_count,
             .ImageCount      = image_count,
@@ -294,9 +326,11 @@ Gui::Gui(
         UploadFonts(parameters.device, parameters.graphics_queue);
     }
 
-    m_windows.camera      = std::make_unique<CameraWindow>(camera, lights);
-    m_windows.scene       = std::make_unique<SceneWindow>(scene);
-    m_windows.filebrowser = std::make_unique<FileBrowserWindow>();
+    m_windows.camera        = std::make_unique<CameraWindow>(camera, lights);
+    m_windows.scene         = std::make_unique<SceneWindow>(scene);
+    m_windows.filebrowser   = std::make_unique<FileBrowserWindow>("Import", 0);
+    m_windows.folderbrowser =
+        std::make_unique<FileBrowserWindow>("Import Folder", ImGuiFileBrowserFlags_SelectDirectory);
 
     auto settings_handler = ImGuiSettingsHandler{};
     {
@@ -392,6 +426,9 @@ void Gui::ShowMenuBar()
             if (ImGui::MenuItem("Import")) {
                 m_windows.filebrowser->Open();
             }
+            if (ImGui::MenuItem("Import Folder")) {
+                m_windows.folderbrowser->Open();
+            }
             if (ImGui::MenuItem("Exit")) {
                 m_callbacks.OnWindowClose();
             }
@@ -406,15 +443,8 @@ void Gui::ShowMenuBar()
     }
 }
 
-void Gui::Draw(
-    etna::CommandBuffer cmd_buffer,
-    etna::Framebuffer   framebuffer,
-    etna::Semaphore     wait_semaphore,
-    etna::Semaphore     signal_semaphore,
-    etna::Fence         finished_fence)
+void Gui::Draw(etna::CommandBuffer cmd_buffer)
 {
-    using namespace etna;
-
     if (m_content_scale_changed) {
         UpdateContentScale();
     }
@@ -428,30 +458,18 @@ void Gui::Draw(
     m_windows.camera->Draw();
     m_windows.scene->Draw();
     m_windows.filebrowser->Draw();
+    m_windows.folderbrowser->Draw();
 
-    if (m_windows.filebrowser->HasSelectedPath()) {
-        m_callbacks.OnFileOpen(m_windows.filebrowser->GetSelectedPath().string());
+    // A folder is opened like a file; the loader imports every model inside it.
+    for (auto browser : { m_windows.filebrowser.get(), m_windows.folderbrowser.get() }) {
+        if (browser->HasSelectedPath()) {
+            m_callbacks.OnFileOpen(browser->GetSelectedPath().string());
+        }
     }
 
     ImGui::Render();
 
-    auto  render_area = Rect2D{ Offset2D{ 0, 0 }, m_extent };
-    auto  clear_color = ClearColor::Transparent;
-    auto* draw_data   = ImGui::GetDrawData();
-
-    cmd_buffer.ResetCommandBuffer();
-    cmd_buffer.Begin();
-    cmd_buffer.BeginRenderPass(framebuffer, render_area, { clear_color });
-    ImGui_ImplVulkan_RenderDrawData(draw_data, cmd_buffer);
-    cmd_buffer.EndRenderPass();
-    cmd_buffer.End();
-
-    m_graphics_queue.Submit(
-        cmd_buffer,
-        { wait_semaphore },
-        { PipelineStage::ColorAttachmentOutput },
-        { signal_semaphore },
-        finished_fence);
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd_buffer);
 
     m_mouse_state.cursor.delta.x = 0;
     m_mouse_state.cursor.delta.y = 0;
@@ -816,12 +834,13 @@ void CameraWindow::Draw()
     PostEnd();
 }
 
-void SceneWindow::DrawField(ObjectPtr object, std::string_view field, int* ptr_id)
+void SceneWindow::DrawField(ObjectPtr object, size_t field_index)
 {
     static constexpr auto writable = ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_EnterReturnsTrue;
     static constexpr auto readonly = ImGuiInputTextFlags_ReadOnly;
 
-    auto temp  = std::get<std::string>(object->GetProperty('_' + std::string(field) + ".meta"));
+    auto field = kFieldAtoms[field_index];
+    auto temp  = std::get<std::string>(object->GetProperty(kFieldMetaAtoms[field_index]));
     auto name  = std::string_view(temp);
     auto value = object->GetProperty(field);
     auto flags = name.starts_with("w:") ? writable : readonly;
@@ -841,10 +860,6 @@ void SceneWindow::DrawField(ObjectPtr object, std::string_view field, int* ptr_i
         ImGui::PushStyleVar(ImGuiStyleVar_Alpha, 0.5f);
     }
 
-    auto& id = *ptr_id;
-
-    ImGui::PushID(id++);
-
     if (auto ivalue = std::get_if<int>(&value)) {
         if (ImGui::InputInt(name.data(), ivalue, int_step, int_step_fast, flags)) {
             object->SetProperty(field, *ivalue);
@@ -857,68 +872,57 @@ void SceneWindow::DrawField(ObjectPtr object, std::string_view field, int* ptr_i
         if (ImGui::InputFloat3(name.data(), &f3value->x, "%.3f", flags)) {
             object->SetProperty(field, *f3value);
         }
-    } else if (auto pvalue = std::get_if<ObjectPtr>(&value)) {
-        DrawProperties(*pvalue, ptr_id);
     }
 
     if (flags == readonly) {
         ImGui::PopStyleVar();
     }
-
-    ImGui::PopID();
 }
 
-void SceneWindow::DrawProperties(ObjectPtr object, int* ptr_id)
+void SceneWindow::DrawProperty(ObjectPtr object, size_t property_index)
 {
     static constexpr auto readonly = ImGuiInputTextFlags_ReadOnly;
 
-    auto& id = *ptr_id;
-
+    // Rows are only rebuilt on structural changes, so the property may have been removed since.
     auto properties = object->GetProperties();
+    if (property_index >= properties.size()) {
+        return;
+    }
 
-    for (auto& [name, value] : properties) {
-        if (name.starts_with('_') || name == "name") {
-            continue;
-        }
-
-        auto is_field = name.starts_with("field.");
-
-        if (!is_field) {
-            ImGui::PushStyleVar(ImGuiStyleVar_Alpha, 0.5f);
-        }
+    const auto& [atom, value] = properties[property_index];
 
-        ImGui::PushID(id++);
-
-        if (is_field) {
-            DrawField(object, name, ptr_id);
-        } else if (auto ivalue = std::get_if<int>(&value)) {
-            ImGui::InputInt(name.c_str(), ivalue, 0, 0, readonly);
-        } else if (auto fvalue = std::get_if<float>(&value)) {
-            ImGui::InputFloat(name.c_str(), fvalue, 0, 0, "%.3f", readonly);
-        } else if (auto f3value = std::get_if<Float3>(&value)) {
-            ImGui::InputFloat3(name.c_str(), &f3value->x, "%.3f", readonly);
-        } else if (auto svalue = std::get_if<std::string>(&value)) {
-            char buffer[kMaxStringSize];
-            CopyToBuffer(buffer, *svalue);
-            ImGui::InputText(name.c_str(), buffer, sizeof(buffer), readonly);
-        } else if (auto pvalue = std::get_if<ObjectPtr>(&value)) {
-            auto idvalue = GetID(*pvalue).value;
-            ImGui::InputInt(name.c_str(), &idvalue, 0, 0, readonly);
-        }
+    // Atom names are interned views; copy into a terminated buffer for ImGui labels.
+    char name[kMaxStringSize];
+    CopyToBuffer(name, atom.Name());
 
-        ImGui::PopID();
+    ImGui::PushStyleVar(ImGuiStyleVar_Alpha, 0.5f);
 
-        if (!is_field) {
-            ImGui::PopStyleVar();
-        }
+    if (auto ivalue = std::get_if<int>(&value)) {
+        auto temp = *ivalue;
+        ImGui::InputInt(name, &temp, 0, 0, readonly);
+    } else if (auto fvalue = std::get_if<float>(&value)) {
+        auto temp = *fvalue;
+        ImGui::InputFloat(name, &temp, 0, 0, "%.3f", readonly);
+    } else if (auto f3value = std::get_if<Float3>(&value)) {
+        auto temp = *f3value;
+        ImGui::InputFloat3(name, &temp.x, "%.3f", readonly);
+    } else if (auto svalue = std::get_if<std::string>(&value)) {
+        char buffer[kMaxStringSize];
+        CopyToBuffer(buffer, *svalue);
+        ImGui::InputText(name, buffer, sizeof(buffer), readonly);
+    } else if (auto pvalue = std::get_if<ObjectPtr>(&value)) {
+        auto idvalue = static_cast<int>(GetID(*pvalue).index);
+        ImGui::InputInt(name, &idvalue, 0, 0, readonly);
     }
+
+    ImGui::PopStyleVar();
 }
 
 bool SceneWindow::DrawTreeNode(NodePtr node)
 {
     ImGui::AlignTextToFramePadding();
 
-    int flags = ImGuiTreeNodeFlags_OpenOnArrow;
+    int flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_NoTreePushOnOpen;
     if (m_selected_node == node) {
         flags |= ImGuiTreeNodeFlags_Selected;
     }
@@ -926,7 +930,7 @@ bool SceneWindow::DrawTreeNode(NodePtr node)
     bool opened = false;
 
     if (node == m_rename_node) {
-        CopyToBuffer(m_buffer, std::get<std::string>(node->GetProperty("name", "_name")));
+        CopyToBuffer(m_buffer, std::get<std::string>(node->GetProperty(kNameAtom, kDefaultNameAtom)));
 
         opened = ImGui::TreeNodeEx(node, flags, "%s", "");
 
@@ -946,22 +950,25 @@ bool SceneWindow::DrawTreeNode(NodePtr node)
                 m_buffer,
                 sizeof(m_buffer),
                 ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_EnterReturnsTrue)) {
-            node->SetProperty("name", std::string(m_buffer));
+            node->SetProperty(kNameAtom, std::string(m_buffer));
             m_rename_node = 0;
+            m_rows_dirty  = m_search[0] != 0;
         }
 
         ImGui::PopStyleColor(2);
         ImGui::PopStyleVar(2);
 
     } else {
-        auto name = std::get<std::string>(node->GetProperty("name", "_name"));
-        opened    = ImGui::TreeNodeEx(node, flags, "%s", name.c_str());
+        // Drawn every frame, so a user name is read in place and only the short class default is copied.
+        auto name         = node->FindProperty<std::string>(kNameAtom);
+        auto default_name = name ? std::string() : std::get<std::string>(node->GetProperty(kDefaultNameAtom));
+        opened            = ImGui::TreeNodeEx(node, flags, "%s", name ? name->c_str() : default_name.c_str());
     }
 
     if (false == node->IsRoot()) {
         if (ImGui::BeginDragDropSource()) {
             ImGui::SetDragDropPayload("MOVE", &node, sizeof(node));
-            ImGui::TextUnformatted(std::get<std::string>(node->GetProperty("name", "_name")).c_str());
+            ImGui::TextUnformatted(std::get<std::string>(node->GetProperty(kNameAtom, kDefaultNameAtom)).c_str());
             ImGui::EndDragDropSource();
         }
     }
@@ -984,7 +991,7 @@ bool SceneWindow::DrawTreeNode(NodePtr node)
     return opened;
 }
 
-NodePtr SceneWindow::DrawContextMenu(NodePtr node)
+void SceneWindow::DrawContextMenu(NodePtr node)
 {
     if (ImGui::BeginPopupContextItem()) {
         if (ImGui::MenuItem("Rename Node")) {
@@ -1009,14 +1016,92 @@ NodePtr SceneWindow::DrawContextMenu(NodePtr node)
         }
         if (!node->IsRoot()) {
             if (ImGui::MenuItem("Delete Node")) {
-                node->DetachNode();
-                node = nullptr;
+                m_destroy_node = node;
             }
         }
 
         ImGui::EndPopup();
     }
-    return node;
+}
+
+void SceneWindow::BuildRows()
+{
+    auto root     = m_scene->GetRootNode();
+    auto filtered = m_search[0] != 0;
+
+    if (filtered) {
+        SearchNodes(m_search_changed);
+    }
+
+    m_rows.clear();
+
+    AppendNodeRows(root, 0, filtered);
+
+    m_rows_revision  = root->GetStructureRevision();
+    m_rows_dirty     = false;
+    m_search_changed = false;
+}
+
+// Collects the matching nodes and every node on the path from the root to them. When the query has just changed,
+// the paths are also expanded so that the matches become visible.
+void SceneWindow::SearchNodes(bool reveal)
+{
+    m_search_matches.clear();
+    m_search_paths.clear();
+
+    for (auto node : m_scene->FindNodes(m_search, kMaxSearchResults)) {
+        m_search_matches.insert(node);
+        for (auto current = node; current && m_search_paths.insert(current).second; current = current->GetParent()) {
+            if (reveal && current != node) {
+                m_expanded_nodes.insert(current);
+            }
+        }
+    }
+}
+
+void SceneWindow::AppendNodeRows(NodePtr node, int depth, bool filtered)
+{
+    m_rows.push_back({ Row::Kind::Node, depth, node, 0 });
+
+    if (m_expanded_nodes.contains(node)) {
+        AppendPropertyRows(node, depth + 1);
+
+        // Above a match only the paths leading to matches are shown; below it, the whole subtree is.
+        auto filter_children = filtered && !m_search_matches.contains(node);
+
+        auto children = node->GetChildren();
+        std::ranges::sort(children, {}, &Node::GetAttachOrder);
+
+        for (auto child : children) {
+            if (!filter_children || m_search_paths.contains(child)) {
+                AppendNodeRows(child, depth + 1, filter_children);
+            }
+        }
+    }
+}
+
+void SceneWindow::AppendPropertyRows(ObjectPtr object, int depth)
+{
+    auto properties = object->GetProperties();
+
+    for (size_t index = 0; index != properties.size(); ++index) {
+        auto atom = properties[index].first;
+        if (!atom.Name().starts_with('_') && atom != kNameAtom) {
+            m_rows.push_back({ Row::Kind::Property, depth, object, index });
+        }
+    }
+
+    for (size_t field_index = 0; field_index != kFieldAtoms.size(); ++field_index) {
+        auto value = object->GetProperty(kFieldAtoms[field_index]);
+        if (value.index() == 0) {
+            break;
+        }
+        if (auto pvalue = std::get_if<ObjectPtr>(&value)) {
+            AppendPropertyRows(*pvalue, depth);
+        } else {
+            m_rows.push_back({ Row::Kind::Field, depth, object, field_index });
+        }
+    }
 }
 
 void SceneWindow::DrawNode(NodePtr node)
@@ -1026,12 +1111,25 @@ void SceneWindow::DrawNode(NodePtr node)
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
     }
 
+    bool expanded = m_expanded_nodes.contains(node);
+
+    ImGui::SetNextItemOpen(expanded);
+
     bool opened = DrawTreeNode(node);
 
     if (is_dangling_node) {
         ImGui::PopStyleColor();
     }
 
+    if (opened != expanded) {
+        if (opened) {
+            m_expanded_nodes.insert(node);
+        } else {
+            m_expanded_nodes.erase(node);
+        }
+        m_rows_dirty = true;
+    }
+
     if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) || ImGui::IsMouseClicked(ImGuiMouseButton_Right)) {
         if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenBlockedByPopup)) {
             m_selected_node = node;
@@ -1040,16 +1138,7 @@ void SceneWindow::DrawNode(NodePtr node)
         }
     }
 
-    node = DrawContextMenu(node);
-
-    if (opened) {
-        if (node) {
-            auto id = GetID(node).value << 8;
-            DrawProperties(node, &id);
-            std::ranges::for_each(node->GetChildren(), [this](NodePtr node) { DrawNode(node); });
-        }
-        ImGui::TreePop();
-    }
+    DrawContextMenu(node);
 }
 
 void SceneWindow::Draw()
@@ -1067,7 +1156,62 @@ void SceneWindow::Draw()
 
     SetDefaultSize(4.0f, 5.0f);
 
-    DrawNode(m_scene->GetRootNode());
+    if (ImGui::InputTextWithHint("##search", "Search name or class", m_search, sizeof(m_search))) {
+        m_rows_dirty     = true;
+        m_search_changed = true;
+    }
+
+    if (m_rows_dirty || m_rows_revision != m_scene->GetRootNode()->GetStructureRevision()) {
+        BuildRows();
+    }
+
+    if (m_search[0] != 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled(
+            "%zu%s matches",
+            m_search_matches.size(),
+            m_search_matches.size() == kMaxSearchResults ? "+" : "");
+    }
+
+    auto clipper = ImGuiListClipper();
+
+    clipper.Begin(static_cast<int>(m_rows.size()), ImGui::GetFrameHeightWithSpacing());
+
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i != clipper.DisplayEnd; ++i) {
+            const auto& row    = m_rows[static_cast<size_t>(i)];
+            auto        indent = static_cast<float>(row.depth) * ImGui::GetStyle().IndentSpacing;
+
+            if (row.depth != 0) {
+                ImGui::Indent(indent);
+            }
+
+            if (row.kind == Row::Kind::Node) {
+                DrawNode(static_cast<NodePtr>(row.object));
+            } else {
+                ImGui::PushID(i);
+                if (row.kind == Row::Kind::Property) {
+                    DrawProperty(row.object, row.index);
+                } else {
+                    DrawField(row.object, row.index);
+                }
+                ImGui::PopID();
+            }
+
+            if (row.depth != 0) {
+                ImGui::Unindent(indent);
+            }
+        }
+    }
+
+    clipper.End();
+
+    // Destroying the node while drawing would leave later rows pointing at freed objects.
+    if (m_destroy_node) {
+        m_expanded_nodes.erase(m_destroy_node);
+        m_scene->DestroySubtree(m_destroy_node);
+        m_destroy_node = nullptr;
+    }
 
     if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !ImGui::IsAnyItemHovered()) {
         m_selected_node = 0;
@@ -4,6 +4,7 @@
 #include "etna/device.hpp"
 #include "etna/image.hpp"
 #include "etna/instance.hpp"
+#include "etna/pipeline.hpp"
 #include "etna/queue.hpp"
 #include "etna/renderpass.hpp"
 
@@ -33,6 +34,7 @@ class Gui {
         etna::Device         device;
         etna::Queue          graphics_queue;
         etna::RenderPass     renderpass;
+        etna::PipelineCache  pipeline_cache;
         etna::Extent2D       extent;
     };
 
@@ -68,12 +70,7 @@ class Gui {
 
     void UpdateViewport(etna::Extent2D extent, uint32_t min_image_count);
 
-    void Draw(
-        etna::CommandBuffer cmd_buffer,
-        etna::Framebuffer   framebuffer,
-        etna::Semaphore     wait_semaphore,
-        etna::Semaphore     signal_semaphore,
-        etna::Fence         finished_fence);
+    void Draw(etna::CommandBuffer cmd_buffer);
 
     auto GetMouseState() const noexcept { return m_mouse_state; }
     bool IsAnyWindowHovered() const noexcept;
@@ -133,6 +130,7 @@ class Gui {
         UniqueSceneWindow       scene;
         UniqueCameraWindow      camera;
         UniqueFileBrowserWindow filebrowser;
+        UniqueFileBrowserWindow folderbrowser;
     };
 
     Callbacks                  m_callbacks;
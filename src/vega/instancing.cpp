@@ -0,0 +1,350 @@
+#include "instancing.hpp"
+
+#include "utils/misc.hpp"
+#include "utils/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <unordered_map>
+
+static constexpr float kEigenGap       = 0.05f; // Spreads closer than this, relative to the largest, share their axes
+static constexpr float kAnchorDistance = 0.25f; // Vertices nearer than this, relative to the farthest, orient no axis
+static constexpr float kMinimumSpread  = 1e-3f; // Directions with less spread, relative to the radius, orient no axis
+static constexpr float kSpreadQuantum  = 64.0f; // Steps per unit of spread in the hash
+
+namespace {
+
+struct CanonicalShape final {
+    glm::vec3             centroid{};
+    glm::mat3             axes{ 1 }; // Orthonormal and right handed, one axis per column
+    float                 radius = 0; // Root mean square distance of the vertices from the centroid; 0 without a frame
+    size_t                hash   = 0;
+    std::vector<uint32_t> vertices; // In order of first use
+    std::vector<uint32_t> indices;  // Into vertices
+};
+
+using Matrix3 = std::array<std::array<double, 3>, 3>;
+
+void HashCombine(size_t* hash, size_t value) noexcept
+{
+    *hash ^= value + 0x9e3779b97f4a7c15 + (*hash << 6) + (*hash >> 2);
+}
+
+// Eigenvalues of a symmetric matrix, largest first, and their unit eigenvectors, by Jacobi rotations.
+auto SolveSymmetricEigen(Matrix3 a) -> std::pair<std::array<double, 3>, std::array<glm::vec3, 3>>
+{
+    auto v = Matrix3{ { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } } };
+
+    for (int sweep = 0; sweep < 32; ++sweep) {
+        auto off_diagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        auto diagonal     = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+        if (off_diagonal <= 1e-30 * diagonal) {
+            break;
+        }
+
+        for (size_t p = 0; p < 2; ++p) {
+            for (size_t q = p + 1; q < 3; ++q) {
+                if (a[p][q] == 0) {
+                    continue;
+                }
+
+                auto theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                auto t     = std::copysign(1.0, theta) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+                auto c     = 1 / std::sqrt(t * t + 1);
+                auto s     = t * c;
+
+                for (size_t k = 0; k < 3; ++k) {
+                    auto akp = a[k][p];
+                    auto akq = a[k][q];
+                    a[k][p]  = c * akp - s * akq;
+                    a[k][q]  = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < 3; ++k) {
+                    auto apk = a[p][k];
+                    auto aqk = a[q][k];
+                    a[p][k]  = c * apk - s * aqk;
+                    a[q][k]  = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < 3; ++k) {
+                    auto vkp = v[k][p];
+                    auto vkq = v[k][q];
+                    v[k][p]  = c * vkp - s * vkq;
+                    v[k][q]  = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    auto order = std::array<size_t, 3>{ 0, 1, 2 };
+    std::sort(order.begin(), order.end(), [&a](size_t lhs, size_t rhs) { return a[lhs][lhs] > a[rhs][rhs]; });
+
+    auto values  = std::array<double, 3>{};
+    auto vectors = std::array<glm::vec3, 3>{};
+    for (size_t i = 0; i < 3; ++i) {
+        auto k     = order[i];
+        values[i]  = a[k][k];
+        vectors[i] = glm::normalize(glm::vec3(
+            static_cast<float>(v[0][k]),
+            static_cast<float>(v[1][k]),
+            static_cast<float>(v[2][k])));
+    }
+
+    return { values, vectors };
+}
+
+// Principal axes only orient a shape up to sign, and not at all where two spreads are equal, as for anything turned on
+// a lathe. The vertex order settles both: an axis points at the first vertex that lies well off the centroid along it,
+// and a plane of equal spread is spanned by the first vertices that lie well off the axes already chosen.
+auto ComputeCanonicalShape(std::span<const ModelVertex> vertices, std::span<const uint32_t> indices) -> CanonicalShape
+{
+    auto shape = CanonicalShape{};
+    auto local = std::unordered_map<uint32_t, uint32_t>{};
+
+    local.reserve(indices.size());
+    shape.indices.reserve(indices.size());
+
+    for (auto index : indices) {
+        utils::throw_runtime_error_if(index >= vertices.size(), "Cannot instance shape: index is out of range");
+        auto [it, inserted] = local.try_emplace(index, static_cast<uint32_t>(shape.vertices.size()));
+        if (inserted) {
+            shape.vertices.push_back(index);
+        }
+        shape.indices.push_back(it->second);
+    }
+
+    if (shape.vertices.empty()) {
+        return shape;
+    }
+
+    auto sum = std::array<double, 3>{};
+    for (auto index : shape.vertices) {
+        const auto& position = vertices[index].position;
+        for (int i = 0; i < 3; ++i) {
+            sum[static_cast<size_t>(i)] += position[i];
+        }
+    }
+
+    auto count     = static_cast<double>(shape.vertices.size());
+    shape.centroid = glm::vec3(
+        static_cast<float>(sum[0] / count),
+        static_cast<float>(sum[1] / count),
+        static_cast<float>(sum[2] / count));
+
+    auto covariance = Matrix3{};
+    for (auto index : shape.vertices) {
+        auto offset = vertices[index].position - shape.centroid;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                covariance[static_cast<size_t>(i)][static_cast<size_t>(j)] += double{ offset[i] } * offset[j];
+            }
+        }
+    }
+    for (auto& row : covariance) {
+        for (auto& value : row) {
+            value /= count;
+        }
+    }
+
+    auto [spreads, principal] = SolveSymmetricEigen(covariance);
+
+    auto variance = spreads[0] + spreads[1] + spreads[2];
+    if (!(variance > 0) || !std::isfinite(variance)) {
+        return shape;
+    }
+
+    auto radius      = static_cast<float>(std::sqrt(variance));
+    auto distinct_01 = spreads[0] - spreads[1] > kEigenGap * spreads[0];
+    auto distinct_12 = spreads[1] - spreads[2] > kEigenGap * spreads[0];
+
+    auto identity = glm::mat3(1);
+    auto project0 = distinct_01 ? glm::outerProduct(principal[0], principal[0])
+                    : distinct_12 ? identity - glm::outerProduct(principal[2], principal[2])
+                                  : identity;
+    auto project1 = !distinct_12  ? identity
+                    : distinct_01 ? glm::outerProduct(principal[1], principal[1])
+                                  : identity - glm::outerProduct(principal[2], principal[2]);
+
+    auto anchor = [&](const glm::mat3& project, const glm::vec3& chosen) -> std::optional<glm::vec3> {
+        auto offset = [&](uint32_t index) {
+            auto offset = project * (vertices[index].position - shape.centroid);
+            return offset - glm::dot(offset, chosen) * chosen;
+        };
+        auto farthest = 0.0f;
+        for (auto index : shape.vertices) {
+            farthest = std::max(farthest, glm::length(offset(index)));
+        }
+        if (farthest <= kMinimumSpread * radius) {
+            return std::nullopt;
+        }
+        for (auto index : shape.vertices) {
+            if (auto direction = offset(index); glm::length(direction) > kAnchorDistance * farthest) {
+                return glm::normalize(direction);
+            }
+        }
+        return std::nullopt;
+    };
+
+    auto axis0 = anchor(project0, glm::vec3(0));
+    if (!axis0) {
+        return shape;
+    }
+
+    auto axis1 = anchor(project1, *axis0);
+    if (!axis1) {
+        return shape;
+    }
+
+    shape.axes   = glm::mat3(*axis0, *axis1, glm::cross(*axis0, *axis1));
+    shape.radius = radius;
+
+    shape.hash = shape.vertices.size();
+    for (auto index : shape.indices) {
+        HashCombine(&shape.hash, index);
+    }
+    for (auto spread : spreads) {
+        HashCombine(&shape.hash, static_cast<size_t>(std::lround(spread / variance * kSpreadQuantum)));
+    }
+
+    return shape;
+}
+
+bool IsCopy(
+    std::span<const ModelVertex> vertices,
+    const CanonicalShape&        prototype,
+    const CanonicalShape&        shape,
+    float                        tolerance)
+{
+    if (prototype.indices != shape.indices || prototype.vertices.size() != shape.vertices.size()) {
+        return false;
+    }
+
+    auto prototype_inverse = glm::transpose(prototype.axes);
+    auto shape_inverse     = glm::transpose(shape.axes);
+
+    for (size_t i = 0; i < shape.vertices.size(); ++i) {
+        const auto& lhs = vertices[prototype.vertices[i]];
+        const auto& rhs = vertices[shape.vertices[i]];
+
+        auto lhs_position = prototype_inverse * (lhs.position - prototype.centroid) / prototype.radius;
+        auto rhs_position = shape_inverse * (rhs.position - shape.centroid) / shape.radius;
+
+        if (glm::length(lhs_position - rhs_position) > tolerance) {
+            return false;
+        }
+        if (glm::length(prototype_inverse * lhs.normal - shape_inverse * rhs.normal) > tolerance) {
+            return false;
+        }
+        if (std::abs(lhs.uv.x - rhs.uv.x) > tolerance || std::abs(lhs.uv.y - rhs.uv.y) > tolerance) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+auto FindDuplicateShapes(
+    std::span<const ModelVertex> vertices,
+    std::span<const uint32_t>    indices,
+    std::span<const IndexRange>  shapes,
+    float                        tolerance) -> std::vector<ShapeMatch>
+{
+    for (const auto& range : shapes) {
+        auto end = size_t{ range.first_index } + range.index_count;
+        utils::throw_runtime_error_if(end > indices.size(), "Cannot instance shape: range is out of bounds");
+    }
+
+    auto canonical = std::vector<CanonicalShape>(shapes.size());
+
+    utils::ParallelFor(shapes.size(), utils::HardwareThreadCount(), [&](size_t i) {
+        canonical[i] = ComputeCanonicalShape(vertices, indices.subspan(shapes[i].first_index, shapes[i].index_count));
+    });
+
+    auto matches    = std::vector<ShapeMatch>(shapes.size());
+    auto prototypes = std::unordered_map<size_t, std::vector<size_t>>{};
+
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const auto& shape = canonical[i];
+
+        matches[i].prototype = i;
+
+        if (shape.radius == 0) {
+            continue;
+        }
+
+        auto& candidates = prototypes[shape.hash];
+        auto  it         = std::find_if(candidates.begin(), candidates.end(), [&](size_t candidate) {
+            return IsCopy(vertices, canonical[candidate], shape, tolerance);
+        });
+
+        if (it == candidates.end()) {
+            candidates.push_back(i);
+            continue;
+        }
+
+        const auto& prototype = canonical[*it];
+
+        auto rotation = shape.axes * glm::transpose(prototype.axes);
+        auto scale    = shape.radius / prototype.radius;
+
+        // Copies that are only moved should not pay for rotate and scale nodes that round-off leaves behind.
+        if (GetAxisAngle(rotation).second < 0.1f * tolerance) {
+            rotation = glm::mat3(1);
+        }
+        if (std::abs(scale - 1) < 0.1f * tolerance) {
+            scale = 1;
+        }
+
+        matches[i].prototype             = *it;
+        matches[i].placement.rotation    = rotation;
+        matches[i].placement.scale       = scale;
+        matches[i].placement.translation = shape.centroid - scale * (rotation * prototype.centroid);
+    }
+
+    return matches;
+}
+
+auto GetAxisAngle(const glm::mat3& rotation) noexcept -> std::pair<glm::vec3, float>
+{
+    // The skew-symmetric part holds the axis scaled by twice the sine of the angle, the trace the cosine.
+    auto skew = glm::vec3(
+        rotation[1][2] - rotation[2][1],
+        rotation[2][0] - rotation[0][2],
+        rotation[0][1] - rotation[1][0]);
+
+    auto sine   = 0.5f * glm::length(skew);
+    auto cosine = 0.5f * (rotation[0][0] + rotation[1][1] + rotation[2][2] - 1);
+    auto angle  = std::atan2(sine, cosine);
+
+    if (sine == 0 && cosine > 0) {
+        return { glm::vec3(0, 0, 1), 0.0f };
+    }
+
+    if (cosine > 0) {
+        return { skew / (2 * sine), angle };
+    }
+
+    // Near a half turn the sine vanishes; the symmetric part, (1 - cosine) times the outer product of the axis with
+    // itself, gives the axis from its largest column instead.
+    auto column = 0;
+    for (int k = 1; k < 3; ++k) {
+        if (rotation[k][k] > rotation[column][column]) {
+            column = k;
+        }
+    }
+
+    auto axis = glm::vec3{};
+    for (int j = 0; j < 3; ++j) {
+        axis[j] = 0.5f * (rotation[column][j] + rotation[j][column]) - (j == column ? cosine : 0.0f);
+    }
+
+    axis = glm::normalize(axis);
+    if (glm::dot(axis, skew) < 0) {
+        axis = -axis;
+    }
+
+    return { axis, angle };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "meshlet.hpp"
+#include "model_loader.hpp"
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Where a shape sits relative to the shape whose geometry it reuses: a vertex at position p of that shape maps to
+// translation + scale * rotation * p.
+struct ShapePlacement final {
+    glm::vec3 translation{};
+    glm::mat3 rotation{ 1 };
+    float     scale = 1;
+};
+
+struct ShapeMatch final {
+    size_t         prototype{}; // The shape itself if it is not a copy of an earlier one
+    ShapePlacement placement{};
+};
+
+// Finds the shapes that are copies of an earlier shape under rotation, uniform scale and translation, and returns a
+// match for every shape. Each shape is brought into a canonical frame, centered on its centroid, aligned with its
+// principal axes and scaled to unit radius; shapes are hashed by their triangles and the spread along those axes. A
+// copy must list its vertices in the same order as the shape it matches, and every canonical position, normal and
+// texture coordinate must agree within tolerance, in units of the shape radius. Canonical frames are computed in
+// parallel.
+auto FindDuplicateShapes(
+    std::span<const ModelVertex> vertices,
+    std::span<const uint32_t>    indices,
+    std::span<const IndexRange>  shapes,
+    float                        tolerance) -> std::vector<ShapeMatch>;
+
+// Axis and angle in radians of a rotation matrix; the axis is arbitrary if the angle is 0.
+auto GetAxisAngle(const glm::mat3& rotation) noexcept -> std::pair<glm::vec3, float>;
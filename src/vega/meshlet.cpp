@@ -0,0 +1,312 @@
+#include "meshlet.hpp"
+
+#include "utils/cast.hpp"
+#include "utils/misc.hpp"
+#include "utils/parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+static constexpr size_t kBlockTriangles = 32768; // Clustered on one thread
+
+// Below this the triangles of a meshlet face too many ways for a cone to cull any of them.
+static constexpr float kMinConeDot = 0.1f;
+
+static auto ReadPosition(std::span<const std::byte> vertices, size_t stride, uint32_t index) -> glm::vec3
+{
+    auto offset = size_t{ index } * stride;
+
+    utils::throw_runtime_error_if(
+        offset > vertices.size() || vertices.size() - offset < sizeof(glm::vec3),
+        "Cannot build meshlets: index is out of range");
+
+    auto position = glm::vec3{};
+    std::memcpy(&position, vertices.data() + offset, sizeof(position));
+    return position;
+}
+
+static void ComputeBounds(const std::vector<glm::vec3>& positions, Meshlet* meshlet)
+{
+    auto aabb = AABB::Empty();
+    for (const auto& position : positions) {
+        aabb.Expand(Float3(position.x, position.y, position.z));
+    }
+
+    auto center = glm::vec3(aabb.Center().x, aabb.Center().y, aabb.Center().z);
+    auto radius = 0.0f;
+    for (const auto& position : positions) {
+        radius = std::max(radius, glm::length(position - center));
+    }
+
+    meshlet->center = Float3(center.x, center.y, center.z);
+    meshlet->radius = radius;
+}
+
+static void ComputeCone(const std::vector<glm::vec3>& normals, Meshlet* meshlet)
+{
+    auto sum = glm::vec3{};
+    for (const auto& normal : normals) {
+        sum += normal;
+    }
+
+    auto length = glm::length(sum);
+    auto axis   = length > 0 ? sum / length : glm::vec3{};
+    auto dot    = length > 0 ? 1.0f : -1.0f;
+
+    for (const auto& normal : normals) {
+        dot = std::min(dot, glm::dot(axis, normal));
+    }
+
+    meshlet->cone_axis   = Float3(axis.x, axis.y, axis.z);
+    meshlet->cone_cutoff = dot < kMinConeDot ? 1.0f : std::sqrt(1.0f - dot * dot);
+}
+
+// Clusters one block of triangles, reordering its indices in place. Meshlet offsets are relative to the block.
+static auto ClusterBlock(std::span<const std::byte> vertices, size_t stride, std::span<uint32_t> indices)
+    -> std::vector<Meshlet>
+{
+    auto triangle_count = indices.size() / 3;
+
+    // Local vertex numbers and, for each of them, the triangles that use it.
+    auto local  = std::unordered_map<uint32_t, uint32_t>{};
+    auto corner = std::vector<uint32_t>(indices.size());
+
+    local.reserve(indices.size() / 2);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        auto [it, added] = local.try_emplace(indices[i], utils::narrow_cast<uint32_t>(local.size()));
+        corner[i]        = it->second;
+    }
+
+    auto vertex_count = local.size();
+    auto offsets      = std::vector<uint32_t>(vertex_count + 1);
+    auto adjacency    = std::vector<uint32_t>(indices.size());
+
+    for (auto vertex : corner) {
+        offsets[vertex + 1]++;
+    }
+    for (size_t v = 0; v < vertex_count; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    {
+        auto fill = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < corner.size(); ++i) {
+            adjacency[fill[corner[i]]++] = utils::narrow_cast<uint32_t>(i / 3);
+        }
+    }
+
+    auto assigned   = std::vector<bool>(triangle_count, false);
+    auto stamp      = std::vector<uint32_t>(vertex_count, 0); // Meshlet number + 1 of the vertices in a meshlet
+    auto candidates = std::vector<uint32_t>{};
+    auto order      = std::vector<uint32_t>{}; // Triangles in meshlet order
+    auto sizes      = std::vector<uint32_t>{}; // Triangles per meshlet
+    auto cursor     = size_t{ 0 };
+
+    order.reserve(triangle_count);
+
+    auto new_vertices = [&](size_t triangle, uint32_t id) {
+        auto count = 0u;
+        for (size_t k = 0; k < 3; ++k) {
+            count += stamp[corner[3 * triangle + k]] != id;
+        }
+        return count;
+    };
+
+    while (order.size() < triangle_count) {
+        auto id            = utils::narrow_cast<uint32_t>(sizes.size() + 1);
+        auto used_vertices = size_t{ 0 };
+        auto triangles     = size_t{ 0 };
+
+        candidates.clear();
+
+        while (triangles < Meshlet::kMaxTriangles) {
+            auto best       = triangle_count;
+            auto best_score = 4u;
+
+            std::erase_if(candidates, [&](uint32_t triangle) { return assigned[triangle]; });
+
+            for (auto triangle : candidates) {
+                auto score  = new_vertices(triangle, id);
+                bool fits   = used_vertices + score <= Meshlet::kMaxVertices;
+                bool better = score < best_score || (score == best_score && triangle < best);
+                if (fits && better) {
+                    best       = triangle;
+                    best_score = score;
+                }
+            }
+
+            // Without a neighbour that fits, the meshlet continues with the next triangle in index order.
+            if (best == triangle_count) {
+                while (cursor < triangle_count && assigned[cursor]) {
+                    cursor++;
+                }
+                if (cursor == triangle_count) {
+                    break;
+                }
+                best       = cursor;
+                best_score = new_vertices(best, id);
+                if (used_vertices + best_score > Meshlet::kMaxVertices) {
+                    break;
+                }
+            }
+
+            assigned[best] = true;
+            order.push_back(utils::narrow_cast<uint32_t>(best));
+            triangles++;
+            used_vertices += best_score;
+
+            for (size_t k = 0; k < 3; ++k) {
+                auto vertex = corner[3 * best + k];
+                if (stamp[vertex] != id) {
+                    stamp[vertex] = id;
+                    for (auto i = offsets[vertex]; i != offsets[vertex + 1]; ++i) {
+                        if (!assigned[adjacency[i]]) {
+                            candidates.push_back(adjacency[i]);
+                        }
+                    }
+                }
+            }
+        }
+
+        sizes.push_back(utils::narrow_cast<uint32_t>(triangles));
+    }
+
+    auto reordered = std::vector<uint32_t>(indices.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        std::copy_n(indices.data() + 3 * size_t{ order[i] }, 3, reordered.data() + 3 * i);
+    }
+    std::copy(reordered.begin(), reordered.end(), indices.begin());
+
+    auto meshlets  = std::vector<Meshlet>(sizes.size());
+    auto first     = size_t{ 0 };
+    auto positions = std::vector<glm::vec3>{};
+    auto normals   = std::vector<glm::vec3>{};
+
+    for (size_t m = 0; m < sizes.size(); ++m) {
+        auto& meshlet = meshlets[m];
+        auto  count   = size_t{ sizes[m] } * 3;
+
+        positions.clear();
+        normals.clear();
+
+        for (size_t i = first; i < first + count; i += 3) {
+            auto p0 = ReadPosition(vertices, stride, indices[i]);
+            auto p1 = ReadPosition(vertices, stride, indices[i + 1]);
+            auto p2 = ReadPosition(vertices, stride, indices[i + 2]);
+            positions.insert(positions.end(), { p0, p1, p2 });
+            if (auto normal = glm::cross(p1 - p0, p2 - p0); glm::length(normal) > 0) {
+                normals.push_back(glm::normalize(normal));
+            }
+        }
+
+        ComputeBounds(positions, &meshlet);
+        ComputeCone(normals, &meshlet);
+
+        meshlet.first_index = utils::narrow_cast<uint32_t>(first);
+        meshlet.index_count = utils::narrow_cast<uint32_t>(count);
+
+        first += count;
+    }
+
+    return meshlets;
+}
+
+std::vector<Meshlet> BuildMeshlets(std::span<const std::byte> vertices, size_t stride, std::span<uint32_t> indices)
+{
+    if (indices.empty() || indices.size() % 3 != 0) {
+        return {};
+    }
+
+    auto block_size  = 3 * kBlockTriangles;
+    auto block_count = (indices.size() + block_size - 1) / block_size;
+    auto blocks      = std::vector<std::vector<Meshlet>>(block_count);
+
+    utils::ParallelFor(block_count, std::min(block_count, utils::HardwareThreadCount()), [&](size_t block) {
+        auto first    = block * block_size;
+        auto count    = std::min(block_size, indices.size() - first);
+        blocks[block] = ClusterBlock(vertices, stride, indices.subspan(first, count));
+    });
+
+    auto meshlets = std::vector<Meshlet>{};
+    for (size_t block = 0; block < block_count; ++block) {
+        for (auto meshlet : blocks[block]) {
+            meshlet.first_index += utils::narrow_cast<uint32_t>(block * block_size);
+            meshlets.push_back(meshlet);
+        }
+    }
+
+    return meshlets;
+}
+
+MeshletView MeshletView::Create(
+    const glm::mat4& projection,
+    const glm::mat4& view,
+    const glm::mat4& model,
+    bool             cull_backfaces)
+{
+    auto model_view = view * model;
+    auto matrix     = projection * model_view;
+    auto row        = [&matrix](int i) { return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]); };
+
+    // The clip space planes, pulled back into mesh space; depth runs from 0 to 1.
+    auto result   = MeshletView{};
+    result.planes = { row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2) };
+
+    for (auto& plane : result.planes) {
+        if (auto length = glm::length(glm::vec3(plane)); length > 0) {
+            plane /= length;
+        }
+    }
+
+    result.camera         = glm::vec3(glm::inverse(model_view) * glm::vec4(0, 0, 0, 1));
+    result.cull_backfaces = cull_backfaces;
+
+    return result;
+}
+
+bool IsSphereVisible(const glm::vec3& center, float radius, const MeshletView& view) noexcept
+{
+    return std::all_of(view.planes.begin(), view.planes.end(), [&](const glm::vec4& plane) {
+        return glm::dot(glm::vec3(plane), center) + plane.w >= -radius;
+    });
+}
+
+bool IsMeshletVisible(const Meshlet& meshlet, const MeshletView& view) noexcept
+{
+    auto center = glm::vec3(meshlet.center.x, meshlet.center.y, meshlet.center.z);
+
+    if (!IsSphereVisible(center, meshlet.radius, view)) {
+        return false;
+    }
+
+    if (view.cull_backfaces && meshlet.cone_cutoff < 1.0f) {
+        auto axis      = glm::vec3(meshlet.cone_axis.x, meshlet.cone_axis.y, meshlet.cone_axis.z);
+        auto direction = center - view.camera;
+        if (glm::dot(direction, axis) >= meshlet.cone_cutoff * glm::length(direction) + meshlet.radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t CullMeshlets(std::span<const Meshlet> meshlets, const MeshletView& view, std::vector<IndexRange>* ranges)
+{
+    auto culled = size_t{ 0 };
+    auto open   = false; // Whether the last range ends where the next meshlet starts
+
+    for (const auto& meshlet : meshlets) {
+        if (!IsMeshletVisible(meshlet, view)) {
+            culled += meshlet.index_count;
+            open = false;
+        } else if (open) {
+            ranges->back().index_count += meshlet.index_count;
+        } else {
+            ranges->push_back({ meshlet.first_index, meshlet.index_count });
+            open = true;
+        }
+    }
+
+    return culled;
+}
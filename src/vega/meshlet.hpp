@@ -0,0 +1,41 @@
+#pragma once
+
+#include "platform.hpp"
+#include "scene.hpp"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Reorders the triangles of indices so that every meshlet is a contiguous range, and returns the meshlets in index
+// order. Positions are read as three floats at the start of every stride bytes of vertices. Triangles are grouped
+// greedily, each step taking the neighbour that adds the fewest vertices; long index ranges are split into blocks that
+// are clustered in parallel.
+auto BuildMeshlets(std::span<const std::byte> vertices, size_t stride, std::span<uint32_t> indices)
+    -> std::vector<Meshlet>;
+
+// The frustum and camera of one draw, in the space of its mesh.
+struct MeshletView final {
+    std::array<glm::vec4, 6> planes{}; // Normalized; a point is inside if it is on the positive side of all six
+    glm::vec3                camera{};
+    bool                     cull_backfaces{};
+
+    // Cone culling only holds if the pipeline culls back faces too.
+    static auto Create(const glm::mat4& projection, const glm::mat4& view, const glm::mat4& model, bool cull_backfaces)
+        -> MeshletView;
+};
+
+bool IsSphereVisible(const glm::vec3& center, float radius, const MeshletView& view) noexcept;
+
+bool IsMeshletVisible(const Meshlet& meshlet, const MeshletView& view) noexcept;
+
+struct IndexRange final {
+    uint32_t first_index{};
+    uint32_t index_count{};
+};
+
+// Appends the index ranges of the meshlets that may be visible, merging neighbours into one range. Ranges are relative
+// to the mesh, like the meshlets. Returns the number of indices culled.
+auto CullMeshlets(std::span<const Meshlet> meshlets, const MeshletView& view, std::vector<IndexRange>* ranges)
+    -> size_t;
@@ -0,0 +1,62 @@
+#include "model_loader.hpp"
+
+#include "utils/misc.hpp"
+#include "utils/parallel.hpp"
+
+#include <algorithm>
+
+static auto GetExtension(const std::filesystem::path& filepath) -> std::string
+{
+    auto extension = filepath.extension().string();
+    utils::to_lower(extension.data());
+    return extension;
+}
+
+static bool IsModelFile(const std::filesystem::path& filepath)
+{
+    auto extension = GetExtension(filepath);
+    return extension == ".obj" || extension == ".gltf" || extension == ".glb";
+}
+
+ModelFile LoadModel(const std::filesystem::path& filepath)
+{
+    auto extension = GetExtension(filepath);
+
+    if (extension == ".gltf" || extension == ".glb") {
+        return LoadGltf(filepath);
+    }
+
+    return LoadObj(filepath);
+}
+
+std::vector<std::filesystem::path> CollectModelFiles(const std::filesystem::path& path)
+{
+    namespace fs = std::filesystem;
+
+    if (false == fs::is_directory(path)) {
+        return { path };
+    }
+
+    auto filepaths = std::vector<fs::path>{};
+
+    for (const auto& entry : fs::directory_iterator(path)) {
+        if (entry.is_regular_file() && IsModelFile(entry.path())) {
+            filepaths.push_back(entry.path());
+        }
+    }
+
+    std::sort(filepaths.begin(), filepaths.end());
+
+    return filepaths;
+}
+
+std::vector<ModelFile> LoadModelFiles(const std::vector<std::filesystem::path>& filepaths)
+{
+    auto files = std::vector<ModelFile>(filepaths.size());
+
+    utils::ParallelFor(filepaths.size(), utils::HardwareThreadCount(), [&](size_t index) {
+        files[index] = LoadModel(filepaths[index]);
+    });
+
+    return files;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "platform.hpp"
+#include "scene.hpp"
+
+BEGIN_DISABLE_WARNINGS
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+END_DISABLE_WARNINGS
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Layout of every vertex buffer the loaders create.
+struct ModelVertex final {
+    constexpr ModelVertex(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv) noexcept
+        : position(position), normal(normal), uv(uv)
+    {}
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+// A parsed file, ready to be committed to the scene, and the textures its materials sample.
+struct ModelFile final {
+    SceneBuilder             builder;
+    std::vector<std::string> textures;
+};
+
+// The loaders touch no shared state, so files can be parsed on several threads at once.
+auto LoadObj(const std::filesystem::path& filepath) -> ModelFile;
+
+// Loads .gltf and .glb files. Buffers are mapped rather than read, and accessors whose layout already matches
+// ModelVertex or 32-bit indices are copied from the mapping into the scene buffer without conversion.
+auto LoadGltf(const std::filesystem::path& filepath) -> ModelFile;
+
+// Picks the loader by extension.
+auto LoadModel(const std::filesystem::path& filepath) -> ModelFile;
+
+// A directory stands for the model files directly inside it, in path order.
+auto CollectModelFiles(const std::filesystem::path& path) -> std::vector<std::filesystem::path>;
+
+// Parses the files on all cores. If any file fails, its error is rethrown and none of the files is returned.
+auto LoadModelFiles(const std::vector<std::filesystem::path>& filepaths) -> std::vector<ModelFile>;
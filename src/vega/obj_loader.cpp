@@ -0,0 +1,504 @@
+#include "instancing.hpp"
+#include "meshlet.hpp"
+#include "model_loader.hpp"
+#include "point_cloud.hpp"
+
+#include "utils/cast.hpp"
+#include "utils/misc.hpp"
+
+BEGIN_DISABLE_WARNINGS
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include <spdlog/spdlog.h>
+
+END_DISABLE_WARNINGS
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <map>
+#include <span>
+#include <unordered_map>
+
+// Largest difference, in shape radii, between a shape and the one it is instanced from.
+static constexpr float kInstanceTolerance = 1e-3f;
+
+struct TinyIndex final {
+    struct Hash final {
+        size_t operator()(const tinyobj::index_t& index) const noexcept { return index.vertex_index; }
+    };
+    struct Equal final {
+        bool operator()(const tinyobj::index_t& lhs, const tinyobj::index_t& rhs) const noexcept
+        {
+            return (lhs.vertex_index == rhs.vertex_index) && (lhs.normal_index == rhs.normal_index) &&
+                   (lhs.texcoord_index == rhs.texcoord_index);
+        }
+    };
+};
+
+using IndexMap = std::unordered_map<tinyobj::index_t, size_t, TinyIndex::Hash, TinyIndex::Equal>;
+
+struct MeshRecord final {
+    AABB                 aabb{};
+    int                  material_id{};
+    size_t               first_index{};
+    size_t               index_count{};
+    std::vector<Meshlet> meshlets;
+    ShapeMatch           match{}; // Prototypes are numbered across the file, in mesh map order
+};
+
+using MeshRecords = std::vector<MeshRecord>;
+
+static MeshRecords GenerateMeshRecords(
+    const tinyobj::attrib_t&  attributes,
+    const tinyobj::mesh_t&    mesh,
+    IndexMap*                 index_map,
+    std::vector<ModelVertex>* vertices,
+    std::vector<uint32_t>*    indices)
+{
+    const auto& [positions, normals, texcoords, colors] = attributes;
+
+    auto mesh_map = std::map<int, std::vector<uint32_t>>{};
+
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        const auto& index       = mesh.indices[i];
+        const auto  material_id = mesh.material_ids[i / 3];
+        const auto  pindex      = 3 * index.vertex_index;
+        const auto  nindex      = 3 * index.normal_index;
+        const auto  tindex      = 2 * index.texcoord_index;
+        const auto  position    = glm::vec3(positions[pindex + 0], positions[pindex + 1], positions[pindex + 2]);
+        const auto  normal      = glm::vec3(normals[nindex + 0], normals[nindex + 1], normals[nindex + 2]);
+        const auto  texcoord    = glm::vec2(texcoords[tindex + 0], texcoords[tindex + 1]);
+
+        auto new_index = vertices->size();
+
+        if (auto [it, success] = index_map->try_emplace(index, vertices->size()); success) {
+            vertices->emplace_back(position, normal, texcoord);
+        } else {
+            new_index = it->second;
+        }
+
+        auto& index_buffer = mesh_map[material_id];
+        if (index_buffer.empty()) {
+            index_buffer.reserve(mesh.indices.size());
+        }
+        index_buffer.push_back(utils::narrow_cast<uint32_t>(new_index));
+    }
+
+    auto mesh_records = MeshRecords{};
+
+    for (auto& [material_id, index_buffer] : mesh_map) {
+        auto record = MeshRecord{
+
+            .aabb        = AABB{ { FLT_MAX, FLT_MAX, FLT_MAX }, { FLT_MIN, FLT_MIN, FLT_MIN } },
+            .material_id = material_id,
+            .first_index = indices->size(),
+            .index_count = index_buffer.size(),
+            .meshlets    = {},
+            .match       = {}
+        };
+
+        for (uint32_t index : index_buffer) {
+            auto position = (*vertices)[index].position;
+
+            record.aabb.min = { std::min(record.aabb.min.x, position.x),
+                                std::min(record.aabb.min.y, position.y),
+                                std::min(record.aabb.min.z, position.z) };
+
+            record.aabb.max = { std::max(record.aabb.max.x, position.x),
+                                std::max(record.aabb.max.y, position.y),
+                                std::max(record.aabb.max.z, position.z) };
+
+            indices->push_back(index);
+        }
+
+        mesh_records.push_back(record);
+    }
+
+    return mesh_records;
+}
+
+// CAD exports repeat every screw and bracket as its own shape. Shapes that copy an earlier one are matched to it, and
+// only the geometry of the shapes they copy is kept.
+static void InstanceDuplicateShapes(
+    std::map<size_t, MeshRecords>* mesh_map,
+    std::vector<ModelVertex>*      vertices,
+    std::vector<uint32_t>*         indices)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    auto records = std::vector<MeshRecord*>{};
+    auto ranges  = std::vector<IndexRange>{};
+    for (auto& [shape_index, mesh_records] : *mesh_map) {
+        for (auto& record : mesh_records) {
+            records.push_back(&record);
+            ranges.push_back({ utils::narrow_cast<uint32_t>(record.first_index),
+                               utils::narrow_cast<uint32_t>(record.index_count) });
+        }
+    }
+
+    auto matches    = FindDuplicateShapes(*vertices, *indices, ranges, kInstanceTolerance);
+    auto duplicates = size_t{ 0 };
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i]->match = matches[i];
+        duplicates += matches[i].prototype != i;
+    }
+
+    if (duplicates == 0) {
+        return;
+    }
+
+    auto kept_vertices = std::vector<ModelVertex>{};
+    auto kept_indices  = std::vector<uint32_t>{};
+    auto vertex_map    = std::vector<uint32_t>(vertices->size(), UINT32_MAX);
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        auto& record = *records[i];
+        if (record.match.prototype != i) {
+            continue;
+        }
+
+        auto first_index = kept_indices.size();
+        for (auto index : std::span(*indices).subspan(record.first_index, record.index_count)) {
+            if (vertex_map[index] == UINT32_MAX) {
+                vertex_map[index] = utils::narrow_cast<uint32_t>(kept_vertices.size());
+                kept_vertices.push_back((*vertices)[index]);
+            }
+            kept_indices.push_back(vertex_map[index]);
+        }
+        record.first_index = first_index;
+    }
+
+    auto size_before = sizeof(ModelVertex) * vertices->size() + sizeof(uint32_t) * indices->size();
+    auto size_after  = sizeof(ModelVertex) * kept_vertices.size() + sizeof(uint32_t) * kept_indices.size();
+    auto elapsed     = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    spdlog::info(
+        "Instanced {} of {} shapes in {:.3f} ms, geometry reduced from {:.2f} MiB to {:.2f} MiB",
+        duplicates,
+        records.size(),
+        elapsed,
+        static_cast<double>(size_before) / (1 << 20),
+        static_cast<double>(size_after) / (1 << 20));
+
+    *vertices = std::move(kept_vertices);
+    *indices  = std::move(kept_indices);
+}
+
+// Places an instance of a copied shape where the copy was: the translation, rotation and scale nodes apply in that
+// order from the parent down.
+static SceneBuilder::Handle AddPlacementNodes(
+    SceneBuilder*         builder,
+    SceneBuilder::Handle  parent,
+    const ShapePlacement& placement)
+{
+    const auto& [translation, rotation, scale] = placement;
+
+    auto [axis, angle] = GetAxisAngle(rotation);
+
+    parent = builder->AddTranslateNode(parent, Float3(translation.x, translation.y, translation.z));
+    if (angle != 0) {
+        parent = builder->AddRotateNode(parent, Float3(axis.x, axis.y, axis.z), Radians(angle));
+    }
+    if (scale != 1) {
+        parent = builder->AddScaleNode(parent, scale);
+    }
+
+    return parent;
+}
+
+static void GenerateNormals(tinyobj::attrib_t* attributes, std::vector<tinyobj::shape_t>* shapes)
+{
+    using namespace glm;
+    using utils::narrow_cast;
+
+    static constexpr float kMinDot = 0.999847695f;
+
+    auto& [positions, out_normals, texcoords, colors] = *attributes;
+
+    auto normals   = std::vector<tinyobj::real_t>{};
+    auto index_map = std::unordered_map<int, int>{};
+
+    index_map.reserve(positions.size());
+
+    for (auto& [name, mesh, path] : *shapes) {
+        for (size_t index = 0; index < mesh.indices.size(); index += 3) {
+            auto indices = std::array{ &mesh.indices[index + 0], &mesh.indices[index + 1], &mesh.indices[index + 2] };
+            auto pindex0 = 3 * narrow_cast<size_t>(indices[0]->vertex_index);
+            auto pindex1 = 3 * narrow_cast<size_t>(indices[1]->vertex_index);
+            auto pindex2 = 3 * narrow_cast<size_t>(indices[2]->vertex_index);
+            auto p0      = vec3(positions[pindex0 + 0], positions[pindex0 + 1], positions[pindex0 + 2]);
+            auto p1      = vec3(positions[pindex1 + 0], positions[pindex1 + 1], positions[pindex1 + 2]);
+            auto p2      = vec3(positions[pindex2 + 0], positions[pindex2 + 1], positions[pindex2 + 2]);
+            auto normal  = normalize(cross(p1 - p0, p2 - p0));
+
+            for (size_t i = 0; i < indices.size(); ++i) {
+                auto normal_index = narrow_cast<int>(normals.size());
+                if (auto [it, emplaced] = index_map.try_emplace(indices[i]->vertex_index, normal_index); emplaced) {
+                    normals.insert(normals.end(), { normal.x, normal.y, normal.z });
+                } else {
+                    auto current = vec3(normals[it->second + 0], normals[it->second + 1], normals[it->second + 2]);
+                    if (dot(normal, current) >= kMinDot) {
+                        normal_index = it->second;
+                    } else {
+                        normals.insert(normals.end(), { normal.x, normal.y, normal.z });
+                    }
+                }
+                indices[i]->normal_index = normal_index / 3;
+            }
+        }
+    }
+
+    out_normals = std::move(normals);
+}
+
+static void GenerateTexcoords(tinyobj::attrib_t* attributes, std::vector<tinyobj::shape_t>* shapes)
+{
+    attributes->texcoords.clear();
+    attributes->texcoords.push_back(0.0f);
+    attributes->texcoords.push_back(0.0f);
+
+    for (auto& [name, mesh, path] : *shapes) {
+        for (auto& index : mesh.indices) {
+            index.texcoord_index = 0;
+        }
+    }
+}
+
+// Scans that only list vertices become a point cloud. Vertex normals are paired with vertices if there is one for each;
+// otherwise points face away from the center of the cloud, so that they are lit at all.
+static void GeneratePointCloud(
+    const tinyobj::attrib_t& attributes,
+    SceneBuilder*            builder,
+    SceneBuilder::Handle     parent,
+    SceneBuilder::Handle     material,
+    const std::string&       name)
+{
+    const auto& [positions, normals, texcoords, colors] = attributes;
+
+    auto point_count = positions.size() / 3;
+    auto has_normals = normals.size() == positions.size();
+    auto vertices    = std::vector<ModelVertex>{};
+    auto indices     = std::vector<uint32_t>(point_count);
+    auto aabb        = AABB::Empty();
+
+    vertices.reserve(point_count);
+
+    for (size_t i = 0; i < point_count; ++i) {
+        aabb.Expand(Float3(positions[3 * i + 0], positions[3 * i + 1], positions[3 * i + 2]));
+    }
+
+    auto center = glm::vec3(aabb.Center().x, aabb.Center().y, aabb.Center().z);
+
+    for (size_t i = 0; i < point_count; ++i) {
+        auto position = glm::vec3(positions[3 * i + 0], positions[3 * i + 1], positions[3 * i + 2]);
+        auto normal   = has_normals ? glm::vec3(normals[3 * i + 0], normals[3 * i + 1], normals[3 * i + 2])
+                                    : position - center;
+        if (auto length = glm::length(normal); length > 0) {
+            normal = (1.0f / length) * normal;
+        }
+        vertices.emplace_back(position, normal, glm::vec2{});
+        indices[i] = utils::narrow_cast<uint32_t>(i);
+    }
+
+    auto nodes         = BuildPointOctree(std::as_bytes(std::span(vertices)), sizeof(ModelVertex), indices);
+    auto vertices_size = sizeof(ModelVertex) * point_count;
+    auto indices_size  = sizeof(uint32_t) * point_count;
+    auto vertex_buffer = builder->AddVertexBuffer(vertices.data(), vertices_size, std::align_val_t(32));
+    auto index_buffer  = builder->AddIndexBuffer(indices.data(), indices_size, std::align_val_t(32));
+    auto point_cloud   = builder->AddPointCloud(aabb, vertex_buffer, index_buffer, 0, point_count, std::move(nodes));
+    auto instance      = builder->AddInstanceNode(parent, point_cloud, material);
+
+    builder->SetProperty(instance, kNameAtom, name);
+}
+
+static std::map<int, SceneBuilder::Handle> GenerateMaterials(
+    ModelFile*                                file,
+    const std::vector<tinyobj::material_t>& tiny_materials,
+    const std::filesystem::path&            parent_dir)
+{
+    auto& builder      = file->builder;
+    auto  shader       = builder.AddShader();
+    auto  material_map = std::map<int, SceneBuilder::Handle>{};
+    {
+        auto default_material = builder.AddMaterial(shader);
+        material_map[-1]      = default_material;
+
+        auto material_index = 0;
+        for (const auto& tiny_material : tiny_materials) {
+            auto material = builder.AddMaterial(shader);
+            builder.SetProperty(material, kNameAtom, tiny_material.name);
+            if (tiny_material.diffuse[0] > 0 || tiny_material.diffuse[1] > 0 || tiny_material.diffuse[2] > 0) {
+                builder.SetProperty(material, kDiffuseColorAtom, Float3(tiny_material.diffuse));
+            }
+            if (false == tiny_material.diffuse_texname.empty()) {
+                auto filepath = (parent_dir / tiny_material.diffuse_texname).string();
+                builder.SetProperty(material, kDiffuseTextureAtom, filepath);
+                file->textures.push_back(std::move(filepath));
+            }
+
+            auto index          = utils::narrow_cast<int>(material_index);
+            material_map[index] = material;
+            ++material_index;
+        }
+    }
+
+    return material_map;
+}
+
+ModelFile LoadObj(const std::filesystem::path& filepath)
+{
+    namespace fs = std::filesystem;
+
+    if (false == fs::exists(filepath)) {
+        throw std::runtime_error("File does not exist");
+    }
+
+    auto parent_dir = fs::path(filepath).parent_path();
+
+    auto attributes = tinyobj::attrib_t{};
+    auto shapes     = std::vector<tinyobj::shape_t>{};
+    auto materials  = std::vector<tinyobj::material_t>{};
+    auto warning    = std::string{};
+    auto error      = std::string{};
+
+    spdlog::info("Parsing {}", filepath.string());
+
+    bool success = tinyobj::LoadObj(
+        &attributes,
+        &shapes,
+        &materials,
+        &warning,
+        &error,
+        filepath.string().c_str(),
+        parent_dir.string().c_str(),
+        true,
+        false);
+
+    if (!success || !error.empty()) {
+        spdlog::error("{}", error);
+        utils::throw_runtime_error("Failed to load object file");
+    }
+
+    auto extension = filepath.extension().string();
+    utils::to_lower(extension.data());
+
+    if (extension != ".obj") {
+        throw std::runtime_error("File is not an .obj file");
+    }
+
+    if (!warning.empty()) {
+        spdlog::warn("{}", warning);
+    }
+
+    if (attributes.normals.empty()) {
+        spdlog::info("Generating normals");
+        GenerateNormals(&attributes, &shapes);
+    }
+
+    if (attributes.texcoords.empty()) {
+        GenerateTexcoords(&attributes, &shapes);
+    }
+
+    auto  file         = ModelFile{};
+    auto  material_map = GenerateMaterials(&file, materials, parent_dir);
+    auto& builder      = file.builder;
+
+    auto file_node = builder.AddGroupNode();
+
+    builder.SetProperty(file_node, kNameAtom, filepath.filename().string());
+    builder.SetProperty(file_node, "Path", filepath.string());
+
+    if (shapes.empty() && !attributes.vertices.empty()) {
+        spdlog::info("Generating point cloud");
+        GeneratePointCloud(attributes, &builder, file_node, material_map[-1], filepath.stem().string());
+        return file;
+    }
+
+    auto mesh_map      = std::map<size_t, MeshRecords>{};
+    auto vertex_buffer = SceneBuilder::Handle{};
+    auto index_buffer  = SceneBuilder::Handle{};
+
+    {
+        auto index_count = size_t{ 0 };
+        for (auto& shape : shapes) {
+            index_count += shape.mesh.indices.size();
+        }
+
+        auto vertices = std::vector<ModelVertex>{};
+        vertices.reserve(2 * attributes.vertices.size());
+
+        auto indices = std::vector<uint32_t>{};
+        indices.reserve(index_count);
+
+        auto index_map = IndexMap{};
+        index_map.reserve(2 * attributes.vertices.size());
+
+        for (size_t shape_index = 0; shape_index < shapes.size(); ++shape_index) {
+            auto records = GenerateMeshRecords(attributes, shapes[shape_index].mesh, &index_map, &vertices, &indices);
+            mesh_map[shape_index] = std::move(records);
+        }
+
+        InstanceDuplicateShapes(&mesh_map, &vertices, &indices);
+
+        // Clustering reorders the triangles of each mesh, so it runs before the indices are handed to the builder.
+        auto vertex_bytes = std::as_bytes(std::span(vertices));
+        auto record_index = size_t{ 0 };
+        for (auto& [shape_index, records] : mesh_map) {
+            for (auto& record : records) {
+                if (record.match.prototype != record_index++) {
+                    continue;
+                }
+                auto range      = std::span(indices).subspan(record.first_index, record.index_count);
+                record.meshlets = BuildMeshlets(vertex_bytes, sizeof(ModelVertex), range);
+            }
+        }
+
+        auto vertices_size = sizeof(vertices[0]) * vertices.size();
+        vertex_buffer      = builder.AddVertexBuffer(vertices.data(), vertices_size, std::align_val_t(32));
+
+        auto indices_size = sizeof(indices[0]) * indices.size();
+        index_buffer      = builder.AddIndexBuffer(indices.data(), indices_size, std::align_val_t(32));
+    }
+
+    auto shape_num = 1;
+    auto meshes    = std::vector<SceneBuilder::Handle>{};
+
+    for (auto& [shape_index, mesh_records] : mesh_map) {
+        auto parent = file_node;
+        auto name   = shapes[shape_index].name;
+        if (name.empty()) {
+            name = std::string("Mesh ") + std::to_string(shape_num++);
+        }
+        if (mesh_records.size() > 1) {
+            parent = builder.AddGroupNode(file_node);
+            builder.SetProperty(parent, kNameAtom, name);
+        }
+        auto mesh_num = 1;
+        for (auto& [aabb, material_id, first, count, meshlets, match] : mesh_records) {
+            auto mesh = SceneBuilder::Handle{};
+            auto node = parent;
+            if (match.prototype == meshes.size()) {
+                mesh = builder.AddMesh(aabb, vertex_buffer, index_buffer, first, count, std::move(meshlets));
+            } else {
+                mesh = meshes[match.prototype];
+                node = AddPlacementNodes(&builder, parent, match.placement);
+            }
+            meshes.push_back(mesh);
+            auto material = material_map[material_id];
+            auto instance = builder.AddInstanceNode(node, mesh, material);
+            if (mesh_records.size() == 1) {
+                builder.SetProperty(instance, kNameAtom, name);
+            } else {
+                auto suffix = std::string(" (") + std::to_string(mesh_num++) + (")");
+                builder.SetProperty(instance, kNameAtom, name + suffix);
+            }
+        }
+    }
+
+    return file;
+}
+
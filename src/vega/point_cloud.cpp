@@ -0,0 +1,275 @@
+#include "point_cloud.hpp"
+
+#include "utils/cast.hpp"
+#include "utils/misc.hpp"
+#include "utils/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <queue>
+
+static constexpr size_t   kLeafPoints = 4096; // Nodes with no more points than this keep all of them
+static constexpr uint32_t kGridSize   = 32;   // Cells per side of the sampling grid of an inner node
+static constexpr uint32_t kMaxDepth   = 24;   // Coincident points would otherwise be split forever
+
+namespace {
+
+struct OctreeNode final {
+    PointNode               node;
+    std::vector<OctreeNode> children;
+};
+
+struct Positions final {
+    std::span<const std::byte> vertices;
+    size_t                     stride{};
+
+    auto operator[](uint32_t index) const noexcept
+    {
+        auto position = glm::vec3{};
+        std::memcpy(&position, vertices.data() + size_t{ index } * stride, sizeof(position));
+        return position;
+    }
+};
+
+struct Cube final {
+    glm::vec3 center{};
+    float     half{};
+};
+
+uint32_t GetOctant(const glm::vec3& point, const glm::vec3& center) noexcept
+{
+    return (point.x >= center.x ? 1u : 0u) | (point.y >= center.y ? 2u : 0u) | (point.z >= center.z ? 4u : 0u);
+}
+
+auto GetChildCube(const Cube& cube, uint32_t octant) noexcept -> Cube
+{
+    auto quarter = 0.5f * cube.half;
+    auto offset  = [quarter, octant](uint32_t bit) { return octant & bit ? quarter : -quarter; };
+    return { cube.center + glm::vec3(offset(1), offset(2), offset(4)), quarter };
+}
+
+uint32_t GetCell(const glm::vec3& point, const Cube& cube) noexcept
+{
+    auto cell = [&cube](float value, float center) {
+        auto t = (value - center + cube.half) / (2 * cube.half) * static_cast<float>(kGridSize);
+        return static_cast<uint32_t>(std::clamp(t, 0.0f, static_cast<float>(kGridSize - 1)));
+    };
+
+    auto x = cell(point.x, cube.center.x);
+    auto y = cell(point.y, cube.center.y);
+    auto z = cell(point.z, cube.center.z);
+
+    return x + kGridSize * (y + kGridSize * z);
+}
+
+// Moves the sample of the node to the front of indices and the rest into octant order. Returns the sample size and the
+// point count of every octant.
+auto SplitNode(const Positions& positions, std::span<uint32_t> indices, const Cube& cube)
+    -> std::pair<size_t, std::array<size_t, 8>>
+{
+    auto occupied = std::vector<bool>(size_t{ kGridSize } * kGridSize * kGridSize, false);
+    auto sorted   = std::vector<uint32_t>(indices.size());
+    auto counts   = std::array<size_t, 8>{};
+    auto sampled  = size_t{ 0 };
+
+    for (auto index : indices) {
+        auto position = positions[index];
+        auto cell     = GetCell(position, cube);
+        if (!occupied[cell]) {
+            occupied[cell]    = true;
+            sorted[sampled++] = index;
+        } else {
+            counts[GetOctant(position, cube.center)]++;
+        }
+    }
+
+    auto offsets = std::array<size_t, 8>{ sampled };
+    for (size_t octant = 1; octant < 8; ++octant) {
+        offsets[octant] = offsets[octant - 1] + counts[octant - 1];
+    }
+
+    std::fill(occupied.begin(), occupied.end(), false);
+
+    for (auto index : indices) {
+        auto position = positions[index];
+        if (auto cell = GetCell(position, cube); !occupied[cell]) {
+            occupied[cell] = true;
+        } else {
+            sorted[offsets[GetOctant(position, cube.center)]++] = index;
+        }
+    }
+
+    std::copy(sorted.begin(), sorted.end(), indices.begin());
+
+    return { sampled, counts };
+}
+
+// Builds the subtree of the points in indices, which start at first_index in the mesh.
+void BuildNode(
+    const Positions&    positions,
+    std::span<uint32_t> indices,
+    size_t              first_index,
+    const Cube&         cube,
+    uint32_t            depth,
+    OctreeNode*         result)
+{
+    auto& node = result->node;
+
+    node.center      = Float3(cube.center.x, cube.center.y, cube.center.z);
+    node.radius      = cube.half * std::sqrt(3.0f);
+    node.spacing     = 2 * cube.half / static_cast<float>(kGridSize);
+    node.first_index = utils::narrow_cast<uint32_t>(first_index);
+    node.index_count = utils::narrow_cast<uint32_t>(indices.size());
+
+    if (indices.size() <= kLeafPoints || depth == kMaxDepth) {
+        return;
+    }
+
+    auto [sampled, counts] = SplitNode(positions, indices, cube);
+    node.index_count       = utils::narrow_cast<uint32_t>(sampled);
+
+    auto octants = std::vector<std::pair<uint32_t, size_t>>{}; // Octant and offset of every child
+    auto next    = sampled;
+    for (uint32_t octant = 0; octant < 8; ++octant) {
+        if (counts[octant] != 0) {
+            octants.emplace_back(octant, next);
+        }
+        next += counts[octant];
+    }
+
+    result->children.resize(octants.size());
+
+    auto build_child = [&](size_t child) {
+        auto [octant, offset] = octants[child];
+        auto child_indices    = indices.subspan(offset, counts[octant]);
+        auto child_cube       = GetChildCube(cube, octant);
+        BuildNode(positions, child_indices, first_index + offset, child_cube, depth + 1, &result->children[child]);
+    };
+
+    if (depth == 0) {
+        utils::ParallelFor(octants.size(), std::min(octants.size(), utils::HardwareThreadCount()), build_child);
+    } else {
+        for (size_t child = 0; child < octants.size(); ++child) {
+            build_child(child);
+        }
+    }
+}
+
+} // namespace
+
+std::vector<PointNode> BuildPointOctree(std::span<const std::byte> vertices, size_t stride, std::span<uint32_t> indices)
+{
+    if (indices.empty()) {
+        return {};
+    }
+
+    auto vertex_count = vertices.size() < sizeof(glm::vec3) ? 0 : (vertices.size() - sizeof(glm::vec3)) / stride + 1;
+    auto positions    = Positions{ vertices, stride };
+    auto aabb         = AABB::Empty();
+
+    for (auto index : indices) {
+        utils::throw_runtime_error_if(index >= vertex_count, "Cannot build point octree: index is out of range");
+        auto position = positions[index];
+        aabb.Expand(Float3(position.x, position.y, position.z));
+    }
+
+    auto extent = std::max({ aabb.max.x - aabb.min.x, aabb.max.y - aabb.min.y, aabb.max.z - aabb.min.z });
+    auto center = aabb.Center();
+    auto root   = OctreeNode{};
+    auto cube   = Cube{ glm::vec3(center.x, center.y, center.z), 0.5f * extent + FLT_EPSILON };
+
+    BuildNode(positions, indices, 0, cube, 0, &root);
+
+    // Nodes are stored breadth first, so that the children of every node are next to each other.
+    auto nodes = std::vector<PointNode>{ root.node };
+    auto queue = std::deque<std::pair<const OctreeNode*, size_t>>{ { &root, 0 } };
+
+    while (!queue.empty()) {
+        auto [octree_node, node_index] = queue.front();
+        queue.pop_front();
+
+        nodes[node_index].first_child = utils::narrow_cast<uint32_t>(nodes.size());
+        nodes[node_index].child_count = utils::narrow_cast<uint32_t>(octree_node->children.size());
+
+        for (const auto& child : octree_node->children) {
+            queue.emplace_back(&child, nodes.size());
+            nodes.push_back(child.node);
+        }
+    }
+
+    return nodes;
+}
+
+size_t SelectPointNodes(
+    std::span<const PointNode> nodes,
+    const MeshletView&         view,
+    float                      pixel_scale,
+    size_t                     point_budget,
+    std::vector<IndexRange>*   ranges)
+{
+    auto first_range = ranges->size();
+    auto points      = size_t{ 0 };
+
+    // Point spacing of a node in pixels, as seen from the nearest point of its bounding sphere.
+    auto priority = [&](const PointNode& node) {
+        auto center   = glm::vec3(node.center.x, node.center.y, node.center.z);
+        auto distance = std::max(glm::length(center - view.camera) - node.radius, node.spacing);
+        return node.spacing * pixel_scale / distance;
+    };
+
+    auto visible = [&](const PointNode& node) {
+        return IsSphereVisible(glm::vec3(node.center.x, node.center.y, node.center.z), node.radius, view);
+    };
+
+    auto queue = std::priority_queue<std::pair<float, uint32_t>>{};
+
+    if (!nodes.empty() && visible(nodes[0])) {
+        queue.emplace(priority(nodes[0]), 0);
+    }
+
+    while (!queue.empty()) {
+        auto [spacing, index] = queue.top();
+        const auto& node      = nodes[index];
+        queue.pop();
+
+        if (points + node.index_count > point_budget) {
+            break;
+        }
+
+        ranges->push_back({ node.first_index, node.index_count });
+        points += node.index_count;
+
+        if (spacing <= 1.0f) {
+            continue;
+        }
+
+        for (auto child = node.first_child; child != node.first_child + node.child_count; ++child) {
+            if (visible(nodes[child])) {
+                queue.emplace(priority(nodes[child]), child);
+            }
+        }
+    }
+
+    // A node is followed by its first child in the index buffer, so sorting merges most parents with a child.
+    auto selected = std::span(*ranges).subspan(first_range);
+    std::sort(selected.begin(), selected.end(), [](const IndexRange& lhs, const IndexRange& rhs) {
+        return lhs.first_index < rhs.first_index;
+    });
+
+    auto merged = first_range;
+    for (auto range : selected) {
+        auto last = merged > first_range ? &(*ranges)[merged - 1] : nullptr;
+        if (last && last->first_index + last->index_count == range.first_index) {
+            last->index_count += range.index_count;
+        } else {
+            (*ranges)[merged++] = range;
+        }
+    }
+    ranges->resize(merged);
+
+    return points;
+}
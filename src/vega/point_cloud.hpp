@@ -0,0 +1,26 @@
+#pragma once
+
+#include "meshlet.hpp"
+#include "platform.hpp"
+#include "scene.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Reorders indices so that the points of every octree node are contiguous, and returns the nodes, root first. Positions
+// are read as three floats at the start of every stride bytes of vertices. Inner nodes keep one point per cell of a
+// regular grid over their cube and hand the rest to their children; the subtrees below the root are built in parallel.
+auto BuildPointOctree(std::span<const std::byte> vertices, size_t stride, std::span<uint32_t> indices)
+    -> std::vector<PointNode>;
+
+// Appends the index ranges of the nodes to draw, merging neighbours into one range, and returns the number of points in
+// them. Visible nodes are refined in order of their point spacing on screen, largest first, until the spacing drops
+// below a pixel or the next node would exceed the budget. Pixel scale is the height of the viewport in pixels over the
+// height of the view frustum at unit distance.
+auto SelectPointNodes(
+    std::span<const PointNode> nodes,
+    const MeshletView&         view,
+    float                      pixel_scale,
+    size_t                     point_budget,
+    std::vector<IndexRange>*   ranges) -> size_t;
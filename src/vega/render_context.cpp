@@ -3,6 +3,8 @@
 #include "buffer_manager.hpp"
 #include "camera.hpp"
 #include "descriptor_manager.hpp"
+#include "gpu_residency.hpp"
+#include "gpu_timeline.hpp"
 #include "gui.hpp"
 #include "lights.hpp"
 #include "scene.hpp"
@@ -10,12 +12,26 @@
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cmath>
+
 RenderContext::RenderContext(
     etna::Device         device,
     etna::Queue          graphics_queue,
     etna::Pipeline       pipeline,
+    etna::Pipeline       point_pipeline,
     etna::PipelineLayout pipeline_layout,
+    GuiPass              gui_pass,
+    ModelTransform       model_transform,
+    TextureBinding       texture_binding,
+    MeshletCulling       meshlet_culling,
+    RecordingBenchmark   recording_benchmark,
+    size_t               point_budget,
+    float                timestamp_period,
     GLFWwindow*          window,
+    GpuTimeline*         gpu_timeline,
     SwapchainManager*    swapchain_manager,
     FrameManager*        frame_manager,
     DescriptorManager*   descriptor_manager,
@@ -25,10 +41,13 @@ RenderContext::RenderContext(
     BufferManager*       buffer_manager,
     TextureLoader*       texture_loader,
     Scene*               scene)
-    : m_device(device), m_graphics_queue(graphics_queue), m_pipeline(pipeline), m_pipeline_layout(pipeline_layout),
-      m_window(window), m_swapchain_manager(swapchain_manager), m_frame_manager(frame_manager),
-      m_descriptor_manager(descriptor_manager), m_gui(gui), m_camera(camera), m_lights(lights),
-      m_buffer_manager(buffer_manager), m_texture_loader(texture_loader), m_scene(scene)
+    : m_device(device), m_graphics_queue(graphics_queue), m_pipeline(pipeline), m_point_pipeline(point_pipeline),
+      m_pipeline_layout(pipeline_layout), m_gui_pass(gui_pass), m_model_transform(model_transform),
+      m_texture_binding(texture_binding), m_meshlet_culling(meshlet_culling),
+      m_recording_benchmark(recording_benchmark), m_point_budget(point_budget), m_timestamp_period(timestamp_period),
+      m_window(window), m_gpu_timeline(gpu_timeline), m_swapchain_manager(swapchain_manager),
+      m_frame_manager(frame_manager), m_descriptor_manager(descriptor_manager), m_gui(gui), m_camera(camera),
+      m_lights(lights), m_buffer_manager(buffer_manager), m_texture_loader(texture_loader), m_scene(scene)
 {}
 
 void RenderContext::ProcessUserInput()
@@ -86,7 +105,11 @@ RenderContext::Status RenderContext::StartRenderLoop()
     auto status  = Status::GuiEvent;
     m_is_running = true;
 
-    auto image_ready_fences = std::vector<Fence>(m_swapchain_manager->ImageCount());
+    m_statistics.submit_count        = m_gpu_timeline->SubmitCount();
+    m_statistics.blocking_wait_count = m_gpu_timeline->BlockingWaitCount();
+    m_statistics.material_compiles   = m_gpu_materials.CompileCount();
+    m_statistics.buffer_uploads      = m_buffer_manager->GetResidency().GetUploadCount();
+    m_statistics.buffer_evictions    = m_buffer_manager->GetResidency().GetEvictionCount();
 
     while (m_is_running) {
         if (glfwWindowShouldClose(m_window)) {
@@ -100,13 +123,24 @@ RenderContext::Status RenderContext::StartRenderLoop()
         auto frame       = m_frame_manager->NextFrame();
         auto image_index = uint32_t{};
 
+        UpdateFrameStatistics(frame);
+
+        auto completed_value = m_gpu_timeline->CompletedValue();
+
+        m_buffer_manager->ReleaseRetiredBuffers(completed_value);
+        m_texture_loader->ReleaseRetiredImages(completed_value);
+
+        // Retired views are forgotten before new ones are set, since a new view may reuse the handle of an old one.
+        for (const auto& [texture_index, image_view] : m_texture_loader->TakeRetiredImages()) {
+            m_descriptor_manager->Release(texture_index, image_view);
+        }
+
+        ReleaseUnusedAssets();
+
         if (auto next_image = m_swapchain_manager->AcquireNextImage(frame.semaphores.image_acquired); next_image) {
+            // The per-image framebuffers are only touched by the GPU, and the queue runs submissions in order, so the
+            // frame wait in NextFrame is the only host wait needed.
             image_index = next_image.value();
-            if (image_ready_fences[image_index] != Fence::Null &&
-                image_ready_fences[image_index] != frame.fence.image_ready) {
-                m_device.WaitForFence(image_ready_fences[image_index]);
-            }
-            image_ready_fences[image_index] = frame.fence.image_ready;
         } else if (next_image.result() == Result::ErrorOutOfDateKHR) {
             m_is_running = false;
             status       = Status::SwapchainOutOfDate;
@@ -119,6 +153,12 @@ RenderContext::Status RenderContext::StartRenderLoop()
 
         ProcessUserInput();
 
+        // The buffers that the previous frame could not draw are copied at the start of this submission, as far as the
+        // budget allows. Buffers evicted to make room were last drawn by a frame already submitted.
+        auto submit_batch = Queue::SubmitBatch();
+
+        m_buffer_manager->RecordUpload(submit_batch, m_gpu_timeline->SubmittedValue());
+
         auto draw_list = m_scene->ComputeDrawList();
         auto extent    = framebuffers.extent;
 
@@ -146,14 +186,18 @@ RenderContext::Status RenderContext::StartRenderLoop()
 
         m_descriptor_manager->Set(frame.index, lights);
 
-        auto image_views = std::vector<ImageView2D>{};
-
-        for (const auto& [index, mesh, material, transform] : draw_list) {
-            const auto& value   = material->GetProperty("diffuse.texture");
-            const auto  texture = std::get_if<std::string>(&value);
-            auto image_view     = texture ? m_texture_loader->GetImage(*texture) : m_texture_loader->GetDefaultImage();
-            m_descriptor_manager->Set(image_view);
-            image_views.push_back(image_view);
+        if (auto uploaded_images = m_texture_loader->TakeUploadedImages(); !uploaded_images.empty()) {
+            for (const auto& [texture_index, image_view] : uploaded_images) {
+                if (m_texture_binding == TextureBinding::Bindless) {
+                    if (texture_index != TextureLoader::kNoImageIndex) {
+                        m_descriptor_manager->Set(texture_index, image_view);
+                    }
+                } else {
+                    m_descriptor_manager->Set(image_view);
+                }
+            }
+            // Materials that resolved to the default image while their texture was loading must pick it up now.
+            m_gpu_materials.Invalidate();
         }
 
         auto clear_color    = ClearColor::Transparent;
@@ -166,48 +210,192 @@ RenderContext::Status RenderContext::StartRenderLoop()
         auto viewport       = Viewport{ 0, height, width, -height, 0, 1 };
         auto scissor        = Rect2D{ Offset2D{ 0, 0 }, extent };
 
+        auto write_timestamp = [&frame, this](CommandBuffer cmd_buffer, PipelineStage stage, uint32_t query) {
+            if (m_timestamp_period > 0) {
+                cmd_buffer.WriteTimestamp(stage, frame.timestamps, query);
+            }
+        };
+
         frame.cmd_buffers.draw.ResetCommandBuffer(CommandBufferReset::ReleaseResources);
         frame.cmd_buffers.draw.Begin(CommandBufferUsage::OneTimeSubmit);
+
+        if (m_timestamp_period > 0) {
+            frame.cmd_buffers.draw.ResetQueryPool(frame.timestamps, 0, FrameManager::kTimestampCount);
+        }
+
+        write_timestamp(frame.cmd_buffers.draw, PipelineStage::TopOfPipe, 0);
+
         frame.cmd_buffers.draw.BeginRenderPass(framebuffer, render_area, { clear_color, clear_depth });
         frame.cmd_buffers.draw.BindPipeline(PipelineBindPoint::Graphics, m_pipeline);
         frame.cmd_buffers.draw.SetViewport(viewport);
         frame.cmd_buffers.draw.SetScissor(scissor);
 
+        auto record_start = std::chrono::steady_clock::now();
+
+        // The dynamic model uniform is unused by the push constant shaders; offset 0 is always valid.
+        if (m_texture_binding == TextureBinding::Bindless) {
+            auto graphics        = PipelineBindPoint::Graphics;
+            auto descriptor_sets = { transforms_set, m_descriptor_manager->GetBindlessTextureSet() };
+            frame.cmd_buffers.draw.BindDescriptorSets(graphics, m_pipeline_layout, 0, descriptor_sets, { 0 });
+        } else if (m_model_transform == ModelTransform::PushConstant) {
+            auto graphics = PipelineBindPoint::Graphics;
+            frame.cmd_buffers.draw.BindDescriptorSets(graphics, m_pipeline_layout, 0, { transforms_set }, { 0 });
+        }
+
+        auto draw_count     = size_t{ 0 };
+        auto bound_pipeline = m_pipeline;
+        auto point_budget   = m_point_budget;                           // Shared by the point clouds in draw order
+        auto pixel_scale    = std::abs(perspective[1][1]) * height / 2; // Pixels per unit at unit distance
+        auto cull_cones     = m_meshlet_culling == MeshletCulling::FrustumAndCone;
+
+        // Both model transform paths are benchmarked over the mesh draws that fit in the dynamic model uniform.
+        auto is_benchmark = m_recording_benchmark == RecordingBenchmark::Enable &&
+                            m_texture_binding == TextureBinding::PerTextureSet;
+
+        m_benchmark_draws.clear();
+        m_benchmark_ranges.clear();
+
         for (const auto& [index, mesh, material, transform] : draw_list) {
+            auto meshlets  = mesh->GetMeshlets();
+            auto is_points = mesh->GetTopology() == MeshTopology::Points;
+            auto frustum   = MeshletView::Create(perspective, view, transform, !is_points && cull_cones);
+            auto points    = size_t{ 0 };
+
+            m_index_ranges.clear();
+
+            if (is_points) {
+                points = SelectPointNodes(mesh->GetPointNodes(), frustum, pixel_scale, point_budget, &m_index_ranges);
+            } else if (m_meshlet_culling == MeshletCulling::Disable || meshlets.empty()) {
+                // Meshes without meshlets, or with culling disabled, are drawn as one range.
+                m_index_ranges.push_back({ 0, narrow_cast<uint32_t>(mesh->GetIndexCount()) });
+                m_statistics.triangles += mesh->GetIndexCount() / 3;
+            } else {
+                m_statistics.culled_triangles += CullMeshlets(meshlets, frustum, &m_index_ranges) / 3;
+                m_statistics.triangles += mesh->GetIndexCount() / 3;
+            }
+
+            if (m_index_ranges.empty()) {
+                continue;
+            }
+
+            // Meshes that are larger on screen are streamed in first; until both buffers arrive the mesh is skipped.
+            auto priority      = ComputeScreenRadius(mesh->GetBoundingBox(), frustum, pixel_scale);
+            auto vertex_buffer = m_buffer_manager->RequestBuffer(mesh->GetVertexBuffer(), priority);
+            auto index_buffer  = m_buffer_manager->RequestBuffer(mesh->GetIndexBuffer(), priority);
+
+            if (!vertex_buffer || !index_buffer) {
+                m_statistics.streaming_draws++;
+                continue;
+            }
+
+            point_budget -= points;
+            m_statistics.points += points;
+
+            if (auto pipeline = is_points ? m_point_pipeline : m_pipeline; pipeline != bound_pipeline) {
+                frame.cmd_buffers.draw.BindPipeline(PipelineBindPoint::Graphics, pipeline);
+                bound_pipeline = pipeline;
+            }
+
+            const auto& gpu_material = m_gpu_materials.Get(
+                material->GetIndex(),
+                material->GetRevision(),
+                [this, material] { return CompileMaterial(material); });
+
             auto graphics        = PipelineBindPoint::Graphics;
-            auto material_set    = m_descriptor_manager->GetTextureSet(image_views[index]);
-            auto descriptor_sets = { transforms_set, material_set };
             auto model_transform = ModelUniform{ transform };
-            auto offsets         = { m_descriptor_manager->Set(frame.index, index, model_transform) };
-            auto vertex_buffer   = m_buffer_manager->GetBuffer(mesh->GetVertexBuffer());
-            auto index_buffer    = m_buffer_manager->GetBuffer(mesh->GetIndexBuffer());
 
             frame.cmd_buffers.draw.BindVertexBuffers(vertex_buffer);
             frame.cmd_buffers.draw.BindIndexBuffer(index_buffer, IndexType::Uint32);
-            frame.cmd_buffers.draw.BindDescriptorSets(graphics, m_pipeline_layout, 0, descriptor_sets, offsets);
-            frame.cmd_buffers.draw.DrawIndexed(mesh->GetIndexCount(), 1, mesh->GetFirstIndex());
+
+            if (m_texture_binding == TextureBinding::Bindless) {
+                auto draw_constants = DrawConstants{ transform, gpu_material.texture_index };
+                auto stages         = ShaderStage::Vertex | ShaderStage::Fragment;
+                frame.cmd_buffers.draw.PushConstants(m_pipeline_layout, stages, draw_constants);
+                draw_count += DrawIndexRanges(frame.cmd_buffers.draw, mesh->GetFirstIndex());
+                continue;
+            }
+
+            auto material_set = gpu_material.texture_set;
+
+            if (is_benchmark && !is_points && index < DescriptorManager::kMaxTransforms) {
+                m_benchmark_draws.push_back({ vertex_buffer,
+                                              index_buffer,
+                                              material_set,
+                                              model_transform,
+                                              narrow_cast<uint32_t>(index),
+                                              mesh->GetFirstIndex(),
+                                              m_benchmark_ranges.size(),
+                                              m_index_ranges.size() });
+                m_benchmark_ranges.insert(m_benchmark_ranges.end(), m_index_ranges.begin(), m_index_ranges.end());
+            }
+
+            if (m_model_transform == ModelTransform::PushConstant) {
+                frame.cmd_buffers.draw.BindDescriptorSets(graphics, m_pipeline_layout, 1, { material_set });
+                frame.cmd_buffers.draw.PushConstants(m_pipeline_layout, ShaderStage::Vertex, model_transform);
+            } else {
+                auto descriptor_sets = { transforms_set, material_set };
+                auto offsets         = { m_descriptor_manager->Set(frame.index, index, model_transform) };
+                frame.cmd_buffers.draw.BindDescriptorSets(graphics, m_pipeline_layout, 0, descriptor_sets, offsets);
+            }
+
+            draw_count += DrawIndexRanges(frame.cmd_buffers.draw, mesh->GetFirstIndex());
+        }
+
+        auto record_end = std::chrono::steady_clock::now();
+
+        m_statistics.record_us += std::chrono::duration<double, std::micro>(record_end - record_start).count();
+        m_statistics.draws += draw_count;
+
+        if (is_benchmark) {
+            BenchmarkRecording(frame, framebuffer, render_area);
+        }
+
+        write_timestamp(frame.cmd_buffers.draw, PipelineStage::BottomOfPipe, 1);
+
+        submit_batch.AddWaitSemaphore(frame.semaphores.image_acquired, PipelineStage::ColorAttachmentOutput);
+        submit_batch.AddCommandBuffer(frame.cmd_buffers.draw);
+
+        if (m_gui_pass == GuiPass::Merged) {
+            // The GUI is recorded into the scene render pass, so the color attachment is never stored and reloaded
+            // between the two passes.
+            m_gui->Draw(frame.cmd_buffers.draw);
+
+            frame.cmd_buffers.draw.EndRenderPass();
+
+            write_timestamp(frame.cmd_buffers.draw, PipelineStage::BottomOfPipe, 2);
+
+            frame.cmd_buffers.draw.End();
+        } else {
+            frame.cmd_buffers.draw.EndRenderPass();
+            frame.cmd_buffers.draw.End();
+
+            frame.cmd_buffers.gui.ResetCommandBuffer();
+            frame.cmd_buffers.gui.Begin();
+            frame.cmd_buffers.gui.BeginRenderPass(framebuffers.gui, render_area, { clear_color });
+
+            m_gui->Draw(frame.cmd_buffers.gui);
+
+            frame.cmd_buffers.gui.EndRenderPass();
+
+            write_timestamp(frame.cmd_buffers.gui, PipelineStage::BottomOfPipe, 2);
+
+            frame.cmd_buffers.gui.End();
+
+            submit_batch.AddCommandBuffer(frame.cmd_buffers.gui);
         }
 
-        frame.cmd_buffers.draw.EndRenderPass();
-        frame.cmd_buffers.draw.End();
+        submit_batch.AddSignalSemaphore(frame.semaphores.draw_completed);
 
         m_descriptor_manager->Flush(frame.index);
 
-        m_graphics_queue.Submit(
-            frame.cmd_buffers.draw,
-            { frame.semaphores.image_acquired },
-            { PipelineStage::ColorAttachmentOutput },
-            { frame.semaphores.draw_completed },
-            {});
+        auto timeline_value = m_gpu_timeline->Submit(m_graphics_queue, submit_batch);
 
-        m_gui->Draw(
-            frame.cmd_buffers.gui,
-            framebuffers.gui,
-            frame.semaphores.draw_completed,
-            frame.semaphores.gui_completed,
-            frame.fence.image_ready);
+        m_frame_manager->FrameSubmitted(frame.index, timeline_value);
+        m_buffer_manager->UploadSubmitted(timeline_value);
 
-        m_swapchain_manager->QueuePresent(image_index, { frame.semaphores.gui_completed });
+        m_timestamps_written[frame.index] = true;
+
+        m_swapchain_manager->QueuePresent(image_index, { frame.semaphores.draw_completed });
     }
 
     return status;
@@ -217,3 +405,257 @@ void RenderContext::StopRenderLoop()
 {
     m_is_running = false;
 }
+
+auto RenderContext::CompileMaterial(const Material* material) -> GpuMaterial
+{
+    auto gpu_material = GpuMaterial{};
+
+    const auto texture = material->FindProperty<std::string>(kDiffuseTextureAtom);
+
+    if (m_texture_binding == TextureBinding::Bindless) {
+        if (texture) {
+            gpu_material.texture_index = m_texture_loader->GetImageIndex(*texture);
+        }
+        return gpu_material;
+    }
+
+    auto image_view = texture ? m_texture_loader->GetImage(*texture) : m_texture_loader->GetDefaultImage();
+
+    gpu_material.texture_set = m_descriptor_manager->GetTextureSet(image_view);
+
+    // Textures still in flight are drawn with the default image until their upload is recorded.
+    if (!gpu_material.texture_set) {
+        gpu_material.texture_set = m_descriptor_manager->GetTextureSet(m_texture_loader->GetDefaultImage());
+    }
+
+    return gpu_material;
+}
+
+// Nodes are only ever destroyed after being detached, which changes the structure revision of the root, so assets
+// can only become unused when it changes. Frames already submitted may still draw the released assets.
+void RenderContext::ReleaseUnusedAssets()
+{
+    auto revision = m_scene->GetRootNode()->GetStructureRevision();
+    if (revision == m_released_revision) {
+        return;
+    }
+
+    m_released_revision = revision;
+
+    auto released       = m_scene->ReleaseUnusedAssets();
+    auto timeline_value = m_gpu_timeline->SubmittedValue();
+
+    for (auto id : released.buffers) {
+        m_buffer_manager->ReleaseBuffer(id, timeline_value);
+    }
+    for (const auto& texture : released.textures) {
+        m_texture_loader->Release(texture, timeline_value);
+    }
+    for (auto material_index : released.materials) {
+        m_gpu_materials.Invalidate(material_index);
+    }
+
+    if (!released.buffers.empty() || !released.materials.empty()) {
+        spdlog::info(
+            "Released {} buffers and {} materials; {} buffers and {} images remain",
+            released.buffers.size(),
+            released.materials.size(),
+            m_buffer_manager->GetBufferCount(),
+            m_texture_loader->GetImageCount());
+    }
+}
+
+// Draws the ranges left by meshlet culling, relative to the first index of the mesh. Returns the number of draws.
+auto RenderContext::DrawIndexRanges(etna::CommandBuffer cmd_buffer, size_t first_index) -> size_t
+{
+    for (const auto& range : m_index_ranges) {
+        cmd_buffer.DrawIndexed(range.index_count, 1, first_index + range.first_index);
+    }
+
+    return m_index_ranges.size();
+}
+
+void RenderContext::BenchmarkRecording(
+    const FrameInfo&  frame,
+    etna::Framebuffer framebuffer,
+    etna::Rect2D      render_area)
+{
+    using namespace etna;
+
+    // The benchmark command buffer is recorded and reset but never submitted.
+    if (!m_benchmark_cmd_buffer) {
+        auto queue_family        = m_graphics_queue.FamilyIndex();
+        m_benchmark_command_pool = m_device.CreateCommandPool(queue_family, CommandPoolCreate::ResetCommandBuffer);
+        m_benchmark_cmd_buffer   = m_benchmark_command_pool->AllocateCommandBuffer();
+    }
+
+    auto cmd_buffer     = *m_benchmark_cmd_buffer;
+    auto graphics       = PipelineBindPoint::Graphics;
+    auto transforms_set = m_descriptor_manager->GetTransformsSet(frame.index);
+
+    // Mirrors the draw loop in StartRenderLoop; the dynamic path writes the same transforms the frame already wrote.
+    auto record = [&](ModelTransform model_transform) {
+        cmd_buffer.ResetCommandBuffer();
+        cmd_buffer.Begin(CommandBufferUsage::OneTimeSubmit);
+        cmd_buffer.BeginRenderPass(framebuffer, render_area, { ClearColor::Transparent, ClearDepthStencil::Default });
+        cmd_buffer.BindPipeline(graphics, m_pipeline);
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (model_transform == ModelTransform::PushConstant) {
+            cmd_buffer.BindDescriptorSets(graphics, m_pipeline_layout, 0, { transforms_set }, { 0 });
+        }
+
+        for (const auto& draw : m_benchmark_draws) {
+            cmd_buffer.BindVertexBuffers(draw.vertex_buffer);
+            cmd_buffer.BindIndexBuffer(draw.index_buffer, IndexType::Uint32);
+
+            if (model_transform == ModelTransform::PushConstant) {
+                cmd_buffer.BindDescriptorSets(graphics, m_pipeline_layout, 1, { draw.material_set });
+                cmd_buffer.PushConstants(m_pipeline_layout, ShaderStage::Vertex, draw.model);
+            } else {
+                auto descriptor_sets = { transforms_set, draw.material_set };
+                auto offsets         = { m_descriptor_manager->Set(frame.index, draw.transform_index, draw.model) };
+                cmd_buffer.BindDescriptorSets(graphics, m_pipeline_layout, 0, descriptor_sets, offsets);
+            }
+
+            for (size_t i = 0; i != draw.range_count; ++i) {
+                const auto& range = m_benchmark_ranges[draw.first_range + i];
+                cmd_buffer.DrawIndexed(range.index_count, 1, draw.first_index + range.first_index);
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        cmd_buffer.EndRenderPass();
+        cmd_buffer.End();
+
+        return std::chrono::duration<double, std::micro>(end - start).count();
+    };
+
+    // The order alternates between frames so that neither path always runs with warmer caches.
+    if (m_statistics.frames % 2 == 0) {
+        m_statistics.push_constant_us += record(ModelTransform::PushConstant);
+        m_statistics.dynamic_uniform_us += record(ModelTransform::DynamicUniform);
+    } else {
+        m_statistics.dynamic_uniform_us += record(ModelTransform::DynamicUniform);
+        m_statistics.push_constant_us += record(ModelTransform::PushConstant);
+    }
+
+    m_statistics.benchmark_draws += m_benchmark_draws.size();
+}
+
+void RenderContext::UpdateFrameStatistics(const FrameInfo& frame)
+{
+    constexpr uint32_t kReportFrameCount = 500;
+
+    if (m_timestamps_written.size() <= frame.index) {
+        m_timestamps_written.resize(frame.index + 1, false);
+    }
+
+    if (m_timestamp_period > 0 && m_timestamps_written[frame.index]) {
+        m_timestamps_written[frame.index] = false;
+
+        if (auto timestamps = frame.timestamps.GetQueryPoolResults(0, FrameManager::kTimestampCount); timestamps) {
+            auto ticks  = timestamps.value();
+            auto period = static_cast<double>(m_timestamp_period);
+            auto to_ms  = [period](uint64_t begin, uint64_t end) {
+                return static_cast<double>(end - begin) * period * 1e-6;
+            };
+
+            m_statistics.scene_ms += to_ms(ticks[0], ticks[1]);
+            m_statistics.gui_ms += to_ms(ticks[1], ticks[2]);
+            m_statistics.total_ms += to_ms(ticks[0], ticks[2]);
+            m_statistics.timed_frames++;
+        }
+    }
+
+    if (++m_statistics.frames < kReportFrameCount) {
+        return;
+    }
+
+    auto frames         = static_cast<double>(m_statistics.frames);
+    auto mode           = m_gui_pass == GuiPass::Merged ? "merged" : "separate";
+    auto submits        = m_gpu_timeline->SubmitCount() - m_statistics.submit_count;
+    auto blocking_waits = m_gpu_timeline->BlockingWaitCount() - m_statistics.blocking_wait_count;
+
+    spdlog::info(
+        "Frame statistics ({} gui pass): {:.2f} submits per frame, {:.2f} blocking waits per frame",
+        mode,
+        submits / frames,
+        blocking_waits / frames);
+
+    if (m_statistics.draws > 0) {
+        auto path     = m_model_transform == ModelTransform::PushConstant ? "push constant" : "dynamic uniform";
+        auto textures = m_texture_binding == TextureBinding::Bindless ? "bindless" : "per texture set";
+        auto compiles = m_gpu_materials.CompileCount() - m_statistics.material_compiles;
+        spdlog::info(
+            "CPU draw recording ({} model transform, {} textures): {:.3f} us per draw, {:.2f} draws per frame, "
+            "{} material compiles",
+            path,
+            textures,
+            m_statistics.record_us / static_cast<double>(m_statistics.draws),
+            static_cast<double>(m_statistics.draws) / frames,
+            compiles);
+    }
+
+    if (m_statistics.benchmark_draws > 0) {
+        auto draws = static_cast<double>(m_statistics.benchmark_draws);
+        spdlog::info(
+            "Recording benchmark over the same draws: {:.3f} us per draw with push constants, {:.3f} us per draw with "
+            "dynamic uniforms, {:.2f} draws per frame",
+            m_statistics.push_constant_us / draws,
+            m_statistics.dynamic_uniform_us / draws,
+            draws / frames);
+    }
+
+    if (m_meshlet_culling != MeshletCulling::Disable && m_statistics.triangles > 0) {
+        auto culling = m_meshlet_culling == MeshletCulling::FrustumAndCone ? "frustum and cone" : "frustum";
+        spdlog::info(
+            "Meshlet culling ({}): {:.1f}% of {:.0f} triangles per frame culled",
+            culling,
+            100.0 * static_cast<double>(m_statistics.culled_triangles) / static_cast<double>(m_statistics.triangles),
+            static_cast<double>(m_statistics.triangles) / frames);
+    }
+
+    if (m_statistics.points > 0) {
+        spdlog::info(
+            "Point clouds: {:.0f} points per frame, budget {}",
+            static_cast<double>(m_statistics.points) / frames,
+            m_point_budget);
+    }
+
+    if (m_statistics.timed_frames > 0) {
+        auto timed_frames = static_cast<double>(m_statistics.timed_frames);
+        spdlog::info(
+            "GPU frame time: scene {:.3f} ms, gui {:.3f} ms, total {:.3f} ms",
+            m_statistics.scene_ms / timed_frames,
+            m_statistics.gui_ms / timed_frames,
+            m_statistics.total_ms / timed_frames);
+    }
+
+    const auto& residency = m_buffer_manager->GetResidency();
+
+    auto uploads   = residency.GetUploadCount() - m_statistics.buffer_uploads;
+    auto evictions = residency.GetEvictionCount() - m_statistics.buffer_evictions;
+
+    if (uploads > 0 || evictions > 0 || m_statistics.streaming_draws > 0) {
+        constexpr double kMiB = 1 << 20;
+        spdlog::info(
+            "Geometry streaming: {:.1f} of {:.1f} MiB resident, {} uploads, {} evictions, {:.2f} draws per frame "
+            "waiting for buffers",
+            static_cast<double>(residency.GetResidentBytes()) / kMiB,
+            static_cast<double>(residency.GetBudget()) / kMiB,
+            uploads,
+            evictions,
+            static_cast<double>(m_statistics.streaming_draws) / frames);
+    }
+
+    m_statistics = {};
+
+    m_statistics.submit_count        = m_gpu_timeline->SubmitCount();
+    m_statistics.blocking_wait_count = m_gpu_timeline->BlockingWaitCount();
+    m_statistics.material_compiles   = m_gpu_materials.CompileCount();
+    m_statistics.buffer_uploads      = residency.GetUploadCount();
+    m_statistics.buffer_evictions    = residency.GetEvictionCount();
+}
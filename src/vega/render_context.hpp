@@ -6,21 +6,32 @@
 
 #include "descriptor_manager.hpp"
 #include "frame_manager.hpp"
+#include "meshlet.hpp"
+#include "point_cloud.hpp"
 #include "swapchain_manager.hpp"
 #include "texture_loader.hpp"
 
+#include "utils/revision_cache.hpp"
+
 struct GLFWwindow;
 
 class Gui;
+class GpuTimeline;
 class Camera;
 class Lights;
 class BufferManager;
+class Material;
 class Scene;
 
 class RenderContext {
   public:
     enum class Status { WindowClosed, SwapchainOutOfDate, GuiEvent };
     enum class MouseLook { None, Orbit, Zoom, Track };
+    enum class GuiPass { Separate, Merged };
+    enum class ModelTransform { DynamicUniform, PushConstant };
+    enum class TextureBinding { PerTextureSet, Bindless };
+    enum class MeshletCulling { Disable, Frustum, FrustumAndCone };
+    enum class RecordingBenchmark { Disable, Enable };
 
     RenderContext() noexcept = default;
 
@@ -28,8 +39,17 @@ class RenderContext {
         etna::Device         device,
         etna::Queue          graphics_queue,
         etna::Pipeline       pipeline,
+        etna::Pipeline       point_pipeline,
         etna::PipelineLayout pipeline_layout,
+        GuiPass              gui_pass,
+        ModelTransform       model_transform,
+        TextureBinding       texture_binding,
+        MeshletCulling       meshlet_culling,
+        RecordingBenchmark   recording_benchmark,
+        size_t               point_budget,
+        float                timestamp_period,
         GLFWwindow*          window,
+        GpuTimeline*         gpu_timeline,
         SwapchainManager*    swapchain_manager,
         FrameManager*        frame_manager,
         DescriptorManager*   descriptor_manager,
@@ -52,21 +72,91 @@ class RenderContext {
     void StopRenderLoop();
 
   private:
-    etna::Device         m_device;
-    etna::Queue          m_graphics_queue;
-    etna::Pipeline       m_pipeline;
-    etna::PipelineLayout m_pipeline_layout;
-    GLFWwindow*          m_window                = nullptr;
-    SwapchainManager*    m_swapchain_manager     = nullptr;
-    FrameManager*        m_frame_manager         = nullptr;
-    DescriptorManager*   m_descriptor_manager    = nullptr;
-    Gui*                 m_gui                   = nullptr;
-    Camera*              m_camera                = nullptr;
-    Lights*              m_lights                = nullptr;
-    BufferManager*       m_buffer_manager        = nullptr;
-    TextureLoader*       m_texture_loader        = nullptr;
-    Scene*               m_scene                 = nullptr;
-    MouseLook            m_mouse_look            = MouseLook::None;
-    bool                 m_is_any_window_hovered = false;
-    bool                 m_is_running            = false;
+    struct GpuMaterial final {
+        uint32_t            texture_index = TextureLoader::kDefaultImageIndex;
+        etna::DescriptorSet texture_set;
+    };
+
+    auto CompileMaterial(const Material* material) -> GpuMaterial;
+
+    void ReleaseUnusedAssets();
+
+    auto DrawIndexRanges(etna::CommandBuffer cmd_buffer, size_t first_index) -> size_t;
+
+    void BenchmarkRecording(const FrameInfo& frame, etna::Framebuffer framebuffer, etna::Rect2D render_area);
+
+    void UpdateFrameStatistics(const FrameInfo& frame);
+
+    using GpuMaterialCache = utils::RevisionCache<GpuMaterial>;
+    using IndexRanges      = std::vector<IndexRange>;
+
+    // A mesh draw of the current frame, recorded again by BenchmarkRecording with both model transform paths.
+    struct BenchmarkDraw final {
+        etna::Buffer        vertex_buffer;
+        etna::Buffer        index_buffer;
+        etna::DescriptorSet material_set;
+        ModelUniform        model;
+        uint32_t            transform_index;
+        size_t              first_index;
+        size_t              first_range;
+        size_t              range_count;
+    };
+
+    struct FrameStatistics final {
+        double   scene_ms            = 0;
+        double   gui_ms              = 0;
+        double   total_ms            = 0;
+        double   record_us           = 0;
+        uint64_t draws               = 0;
+        uint64_t triangles           = 0;
+        uint64_t culled_triangles    = 0;
+        uint64_t points              = 0;
+        uint64_t streaming_draws     = 0; // Skipped until their buffers are resident
+        uint32_t timed_frames        = 0;
+        uint32_t frames              = 0;
+        uint64_t submit_count        = 0;
+        uint64_t blocking_wait_count = 0;
+        uint64_t material_compiles   = 0;
+        uint64_t buffer_uploads      = 0;
+        uint64_t buffer_evictions    = 0;
+        double   push_constant_us    = 0; // Recording benchmark, both paths over the same draws
+        double   dynamic_uniform_us  = 0;
+        uint64_t benchmark_draws     = 0;
+    };
+
+    etna::Device               m_device;
+    etna::Queue                m_graphics_queue;
+    etna::Pipeline             m_pipeline;
+    etna::Pipeline             m_point_pipeline;
+    etna::PipelineLayout       m_pipeline_layout;
+    GuiPass                    m_gui_pass              = GuiPass::Separate;
+    ModelTransform             m_model_transform       = ModelTransform::DynamicUniform;
+    TextureBinding             m_texture_binding       = TextureBinding::PerTextureSet;
+    MeshletCulling             m_meshlet_culling       = MeshletCulling::Disable;
+    RecordingBenchmark         m_recording_benchmark   = RecordingBenchmark::Disable;
+    size_t                     m_point_budget          = 0;
+    float                      m_timestamp_period      = 0;
+    FrameStatistics            m_statistics;
+    GpuMaterialCache           m_gpu_materials;
+    IndexRanges                m_index_ranges;
+    std::vector<BenchmarkDraw> m_benchmark_draws;
+    IndexRanges                m_benchmark_ranges;
+    etna::UniqueCommandPool    m_benchmark_command_pool;
+    etna::UniqueCommandBuffer  m_benchmark_cmd_buffer;
+    std::vector<bool>          m_timestamps_written;
+    GLFWwindow*                m_window                = nullptr;
+    GpuTimeline*               m_gpu_timeline          = nullptr;
+    SwapchainManager*          m_swapchain_manager     = nullptr;
+    FrameManager*              m_frame_manager         = nullptr;
+    DescriptorManager*         m_descriptor_manager    = nullptr;
+    Gui*                       m_gui                   = nullptr;
+    Camera*                    m_camera                = nullptr;
+    Lights*                    m_lights                = nullptr;
+    BufferManager*             m_buffer_manager        = nullptr;
+    TextureLoader*             m_texture_loader        = nullptr;
+    Scene*                     m_scene                 = nullptr;
+    uint64_t                   m_released_revision     = 0;
+    MouseLook                  m_mouse_look            = MouseLook::None;
+    bool                       m_is_any_window_hovered = false;
+    bool                       m_is_running            = false;
 };
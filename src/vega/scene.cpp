@@ -1,13 +1,38 @@
 #include "scene.hpp"
 
 #include "utils/cast.hpp"
-
-#include <atomic>
+#include "utils/object_pool.hpp"
+#include "utils/slot_map.hpp"
+#include "utils/stream_codec.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <istream>
+#include <iterator>
+#include <new>
+#include <ostream>
 #include <ranges>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 
 static constexpr auto NullParent = nullptr;
 
+// Transforms the box by its center and half extent; the extent goes through the absolute value of the linear part,
+// which gives the same box as transforming all eight corners.
+static AABB TransformBoundingBox(const glm::mat4& matrix, const AABB& aabb) noexcept
+{
+    auto min    = glm::vec3(aabb.min.x, aabb.min.y, aabb.min.z);
+    auto max    = glm::vec3(aabb.max.x, aabb.max.y, aabb.max.z);
+    auto center = glm::vec3(matrix * glm::vec4(0.5f * (min + max), 1.0f));
+    auto column = [&matrix](int i) { return glm::abs(glm::vec3(matrix[i])); };
+    auto extent = glm::mat3(column(0), column(1), column(2)) * (0.5f * (max - min));
+
+    return AABB{ { center.x - extent.x, center.y - extent.y, center.z - extent.z },
+                 { center.x + extent.x, center.y + extent.y, center.z + extent.z } };
+}
+
 static void to_json(json& json, const Float3& vec)
 {
     json = { vec.x, vec.y, vec.z };
@@ -15,7 +40,7 @@ static void to_json(json& json, const Float3& vec)
 
 static void to_json(json& json, ID id)
 {
-    json = id.value;
+    json = id.index;
 }
 
 struct ValueToJson final {
@@ -23,8 +48,8 @@ struct ValueToJson final {
     void operator()(ObjectPtr value) { j[key] = value->GetID(); }
     void operator()(auto& value) { j[key] = value; }
 
-    json&              j;
-    const std::string& key;
+    json&       j;
+    std::string key;
 };
 
 static void to_json(json& json, const UniqueNode& node)
@@ -57,11 +82,21 @@ static void to_json(json& json, InstanceNodePtr instance_node)
     json = GetID(instance_node);
 }
 
+static void to_json(json& json, ReferenceNodePtr reference_node)
+{
+    json = GetID(reference_node);
+}
+
 static void to_json(json& json, MeshPtr mesh)
 {
     json = mesh->ToJson();
 }
 
+static void to_json(json& json, PrototypePtr prototype)
+{
+    json = prototype->ToJson();
+}
+
 struct Properties final {
     const PropertyStore* ptr = nullptr;
 };
@@ -69,7 +104,7 @@ struct Properties final {
 static void to_json(json& json, const Properties& properties)
 {
     for (const auto& [key, value] : *properties.ptr) {
-        std::visit(ValueToJson{ json, key }, value);
+        std::visit(ValueToJson{ json, std::string(key.Name()) }, value);
     }
 }
 
@@ -108,18 +143,11 @@ struct MeshValues final {
     const IndexBuffer*  indices;
 };
 
-static ID GetUniqueID() noexcept
-{
-    static std::atomic_int id = 0;
-    id++;
-    return ID(id);
-}
-
 struct ObjectAccess final {
     template <typename T, typename... Args>
-    static auto MakeUnique(Args&&... args)
+    static auto Construct(void* memory, Args&&... args) -> T*
     {
-        return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+        return new (memory) T(std::forward<Args>(args)...);
     }
 
     template <typename T>
@@ -129,54 +157,54 @@ struct ObjectAccess final {
     }
 
     template <typename T, typename Fields>
-    static PropertyValue GetProperty(std::string_view name, const T& object, const Fields& fields)
+    static PropertyValue GetProperty(PropertyAtom name, const T& object, const Fields& fields)
     {
-        if (name == "_class") {
+        if (name == kClassAtom) {
             return std::string(object.kClassName);
         }
-        if (name == "_name") {
+        if (name == kDefaultNameAtom) {
             return std::string(object.kDefaultName);
         }
-        if (name == "_id") {
-            return object.GetID().value;
+        if (name == kIdAtom) {
+            return object.GetID().index;
         }
         if constexpr (std::tuple_size<Fields>::value > 0) {
-            if (name == "_field.1.meta") {
+            if (name == kFieldMetaAtoms[0]) {
                 return GenerateFieldMetadata(object, 0);
-            } else if (name == "field.1") {
+            } else if (name == kFieldAtoms[0]) {
                 return std::get<0>(fields);
             }
         }
         if constexpr (std::tuple_size<Fields>::value > 1) {
-            if (name == "_field.2.meta") {
+            if (name == kFieldMetaAtoms[1]) {
                 return GenerateFieldMetadata(object, 1);
-            } else if (name == "field.2") {
+            } else if (name == kFieldAtoms[1]) {
                 return std::get<1>(fields);
             }
         }
         if constexpr (std::tuple_size<Fields>::value > 2) {
-            if (name == "_field.3.meta") {
+            if (name == kFieldMetaAtoms[2]) {
                 return GenerateFieldMetadata(object, 2);
-            } else if (name == "field.3") {
+            } else if (name == kFieldAtoms[2]) {
                 return std::get<2>(fields);
             }
         }
         if constexpr (std::tuple_size<Fields>::value > 3) {
-            if (name == "_field.4.meta") {
+            if (name == kFieldMetaAtoms[3]) {
                 return GenerateFieldMetadata(object, 3);
-            } else if (name == "field.4") {
+            } else if (name == kFieldAtoms[3]) {
                 return std::get<3>(fields);
             }
         }
-        if (auto it = object.m_properties.find(std::string(name)); it != object.m_properties.end()) {
-            return it->second;
+        if (auto value = object.m_properties.Find(name)) {
+            return *value;
         }
         return {};
     }
 
     template <typename T, typename Fields>
     static PropertyValue
-    GetProperty(std::string_view primary, std::string_view alternative, const T& object, const Fields& fields)
+    GetProperty(PropertyAtom primary, PropertyAtom alternative, const T& object, const Fields& fields)
     {
         if (auto value = ObjectAccess::GetProperty(primary, object, fields); value.index() != 0) {
             return value;
@@ -185,97 +213,77 @@ struct ObjectAccess final {
     }
 
     template <typename T, typename Args>
-    static std::vector<Property> GetProperties(const T* obj, const Args& args)
+    static bool SetProperty(T& object, PropertyAtom name, const PropertyValue& value, Args args)
     {
-        auto make_property = [](auto& kv) { return Property{ kv.first, kv.second }; };
-        auto view          = std::views::transform(obj->m_properties, make_property);
-        auto properties    = std::vector<Property>(view.begin(), view.end());
+        utils::throw_runtime_error_if(name.Empty(), "Cannot set property: property name is missing");
+        utils::throw_runtime_error_if(name.Name().starts_with('_'), "Cannot set property: builtin property");
 
-        properties.push_back({ "_class", std::string(obj->kClassName) });
-        properties.push_back({ "_name", std::string(obj->kDefaultName) });
-        properties.push_back({ "_id", obj->GetID().value });
+        if constexpr (std::is_base_of_v<Node, T> && std::tuple_size<Args>::value > 0) {
+            if (std::ranges::find(kFieldAtoms, name) != kFieldAtoms.end()) {
+                object.m_subtree_dirty = true;
+                MarkBoundsDirty(&object);
+            }
+        }
 
         if constexpr (std::tuple_size<Args>::value > 0) {
-            properties.push_back({ "field.1", std::get<0>(args) });
+            if (name == kFieldAtoms[0]) {
+                using Arg          = std::remove_pointer_t<std::tuple_element_t<0, Args>>;
+                *std::get<0>(args) = std::get<Arg>(value);
+                return true;
+            }
         }
         if constexpr (std::tuple_size<Args>::value > 1) {
-            properties.push_back({ "field.2", std::get<1>(args) });
+            if (name == kFieldAtoms[1]) {
+                using Arg          = std::remove_pointer_t<std::tuple_element_t<1, Args>>;
+                *std::get<1>(args) = std::get<Arg>(value);
+                return true;
+            }
         }
         if constexpr (std::tuple_size<Args>::value > 2) {
-            properties.push_back({ "field.3", std::get<2>(args) });
+            if (name == kFieldAtoms[2]) {
+                using Arg          = std::remove_pointer_t<std::tuple_element_t<2, Args>>;
+                *std::get<2>(args) = std::get<Arg>(value);
+                return true;
+            }
         }
         if constexpr (std::tuple_size<Args>::value > 3) {
-            properties.push_back({ "field.4", std::get<3>(args) });
+            if (name == kFieldAtoms[3]) {
+                using Arg          = std::remove_pointer_t<std::tuple_element_t<3, Args>>;
+                *std::get<3>(args) = std::get<Arg>(value);
+                return true;
+            }
         }
-        return properties;
-    }
 
-    template <typename T, typename Args>
-    static bool SetProperty(T& object, std::string_view name, const PropertyValue& value, Args args)
-    {
-        utils::throw_runtime_error_if(name.empty(), "Cannot set property: property name is missing");
-        utils::throw_runtime_error_if(name.starts_with('_'), "Cannot set property: builtin property");
-
-        if (name.starts_with("field.")) {
-            name.remove_prefix(strlen("field."));
-            if constexpr (std::tuple_size<Args>::value > 0) {
-                if (name == "1") {
-                    using Arg          = std::remove_pointer_t<std::tuple_element_t<0, Args>>;
-                    *std::get<0>(args) = std::get<Arg>(value);
-                    return true;
-                }
-            }
-            if constexpr (std::tuple_size<Args>::value > 1) {
-                if (name == "2") {
-                    using Arg          = std::remove_pointer_t<std::tuple_element_t<1, Args>>;
-                    *std::get<1>(args) = std::get<Arg>(value);
-                    return true;
-                }
-            }
-            if constexpr (std::tuple_size<Args>::value > 2) {
-                if (name == "3") {
-                    using Arg          = std::remove_pointer_t<std::tuple_element_t<2, Args>>;
-                    *std::get<2>(args) = std::get<Arg>(value);
-                    return true;
-                }
-            }
-            if constexpr (std::tuple_size<Args>::value > 3) {
-                if (name == "4") {
-                    using Arg          = std::remove_pointer_t<std::tuple_element_t<3, Args>>;
-                    *std::get<3>(args) = std::get<Arg>(value);
-                    return true;
-                }
+        auto inserted = object.m_properties.InsertOrAssign(name, value);
+
+        if constexpr (std::is_base_of_v<Node, T>) {
+            if (name == kNameAtom) {
+                ReindexNode(&object);
             }
         }
 
-        auto [it, inserted] = object.m_properties.insert_or_assign(std::string(name), value);
-
         return inserted;
     }
 
-    template <size_t Fields>
-    static bool RemoveProperty(Object& object, std::string_view name)
+    template <size_t Fields, typename T>
+    static bool RemoveProperty(T& object, PropertyAtom name)
     {
-        utils::throw_runtime_error_if(name.empty(), "Cannot remove property: property name is missing");
-        utils::throw_runtime_error_if(name.starts_with('_'), "Cannot remove property: builtin property");
+        utils::throw_runtime_error_if(name.Empty(), "Cannot remove property: property name is missing");
+        utils::throw_runtime_error_if(name.Name().starts_with('_'), "Cannot remove property: builtin property");
 
-        if (name.starts_with("field.")) {
-            name.remove_prefix(strlen("field."));
-            if constexpr (Fields > 0) {
-                utils::throw_runtime_error_if(name == "1", "Cannot remove property: builtin property");
-            }
-            if constexpr (Fields > 1) {
-                utils::throw_runtime_error_if(name == "2", "Cannot remove property: builtin property");
-            }
-            if constexpr (Fields > 2) {
-                utils::throw_runtime_error_if(name == "3", "Cannot remove property: builtin property");
-            }
-            if constexpr (Fields > 3) {
-                utils::throw_runtime_error_if(name == "4", "Cannot remove property: builtin property");
+        for (size_t i = 0; i != Fields; ++i) {
+            utils::throw_runtime_error_if(name == kFieldAtoms[i], "Cannot remove property: builtin property");
+        }
+
+        auto erased = object.m_properties.Erase(name);
+
+        if constexpr (std::is_base_of_v<Node, T>) {
+            if (erased && name == kNameAtom) {
+                ReindexNode(&object);
             }
         }
 
-        return object.m_properties.erase(std::string(name));
+        return erased;
     }
 
     template <typename T>
@@ -298,45 +306,336 @@ struct ObjectAccess final {
     static void AddInstancePtr(InstanceNodePtr instance_node, MaterialPtr material)
     {
         assert(instance_node && material);
+        instance_node->m_material_index = material->m_instances.size();
         material->AddInstanceNodePtr(instance_node);
     }
 
+    static bool RemoveInstancePtr(InstanceNodePtr instance_node, MaterialPtr material)
+    {
+        assert(instance_node && material);
+
+        auto& instances = material->m_instances;
+        auto  index     = instance_node->m_material_index;
+
+        if (index >= instances.size() || instances[index] != instance_node) {
+            return false;
+        }
+
+        instances[index]                   = instances.back();
+        instances[index]->m_material_index = index;
+        instances.pop_back();
+
+        return true;
+    }
+
+    // Unregisters every instance below node from its material. Each affected material is compacted once, which
+    // keeps the relative order of its remaining instances.
+    static void ReleaseInstances(NodePtr node)
+    {
+        constexpr auto kReleased = ~size_t{ 0 };
+
+        auto stack     = std::vector<NodePtr>{ node };
+        auto materials = std::vector<MaterialPtr>{};
+
+        while (!stack.empty()) {
+            auto current = stack.back();
+            stack.pop_back();
+
+            if (current->IsReference()) {
+                continue;
+            }
+
+            if (current->IsLeaf()) {
+                auto instance = static_cast<InstanceNodePtr>(current);
+                if (instance->m_material) {
+                    instance->m_material_index = kReleased;
+                    if (materials.empty() || materials.back() != instance->m_material) {
+                        materials.push_back(instance->m_material);
+                    }
+                    instance->m_material = nullptr;
+                }
+            } else {
+                for (const auto& child : static_cast<InnerNode*>(current)->m_children) {
+                    stack.push_back(child.get());
+                }
+            }
+        }
+
+        std::ranges::sort(materials);
+        materials.erase(std::unique(materials.begin(), materials.end()), materials.end());
+
+        for (auto material : materials) {
+            std::erase_if(material->m_instances, [](auto instance) { return instance->m_material_index == kReleased; });
+            for (size_t i = 0; i != material->m_instances.size(); ++i) {
+                material->m_instances[i]->m_material_index = i;
+            }
+        }
+    }
+
+    using BufferData = Buffer::UniqueData;
+
+    static void CheckMeshlets(std::span<const Meshlet> meshlets, size_t index_count)
+    {
+        auto next = size_t{ 0 };
+        for (const auto& meshlet : meshlets) {
+            utils::throw_runtime_error_if(
+                meshlet.first_index != next || meshlet.index_count % 3 != 0,
+                "Cannot create mesh: meshlets do not follow each other");
+            next += meshlet.index_count;
+        }
+        utils::throw_runtime_error_if(
+            !meshlets.empty() && next != index_count,
+            "Cannot create mesh: meshlets do not cover the mesh");
+    }
+
+    static void CheckPointNodes(std::span<const PointNode> nodes, size_t index_count)
+    {
+        utils::throw_runtime_error_if(nodes.empty(), "Cannot create point cloud: octree is empty");
+
+        auto points = size_t{ 0 };
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const auto& node = nodes[i];
+            utils::throw_runtime_error_if(
+                size_t{ node.first_index } + node.index_count > index_count,
+                "Cannot create point cloud: node is out of range");
+            utils::throw_runtime_error_if(
+                node.child_count != 0 && (node.first_child <= i || node.first_child + node.child_count > nodes.size()),
+                "Cannot create point cloud: node children are not valid");
+            points += node.index_count;
+        }
+        utils::throw_runtime_error_if(points != index_count, "Cannot create point cloud: nodes do not cover the mesh");
+    }
+
+    static auto GetEncodedData(const Buffer* buffer) noexcept -> const std::vector<std::byte>&
+    {
+        return buffer->m_encoded;
+    }
+
+    static auto CopyBufferData(const void* src, size_t size, std::align_val_t alignment) -> BufferData
+    {
+        auto data = Buffer::Allocate(size, alignment);
+        memcpy(data.get(), src, size);
+        return data;
+    }
+
+    // Use counts of meshes and buffers, kept by the objects that draw them.
+    template <typename T>
+    static void AddUse(T* asset) noexcept
+    {
+        if (asset) {
+            asset->m_use_count++;
+        }
+    }
+
+    template <typename T>
+    static void RemoveUse(T* asset) noexcept
+    {
+        if (asset) {
+            assert(asset->m_use_count > 0);
+            asset->m_use_count--;
+        }
+    }
+
+    static bool IsUnused(const Mesh* mesh) noexcept { return mesh->m_use_count == 0; }
+    static bool IsUnused(const Buffer* buffer) noexcept { return buffer->m_use_count == 0; }
+    static bool IsUnused(const Material* material) noexcept { return material->m_instances.empty(); }
+    static bool IsUnused(const Shader* shader) noexcept { return shader->m_materials.empty(); }
+    static bool IsUnused(const Prototype* prototype) noexcept { return prototype->m_references.empty(); }
+
+    static void RemoveMaterialPtrs(ShaderPtr shader)
+    {
+        std::erase_if(shader->m_materials, [](auto material) { return IsUnused(material); });
+    }
+
     static void AddMaterialPtr(ShaderPtr shader, MaterialPtr material)
     {
         assert(shader && material);
         shader->AddMaterialPtr(material);
     }
 
+    static void AddReferencePtr(ReferenceNodePtr reference_node, PrototypePtr prototype)
+    {
+        assert(reference_node && prototype);
+        reference_node->m_reference_index = prototype->m_references.size();
+        prototype->m_references.push_back(reference_node);
+    }
+
+    static void RemoveReferencePtr(ReferenceNodePtr reference_node, PrototypePtr prototype) noexcept
+    {
+        assert(reference_node && prototype);
+
+        auto& references = prototype->m_references;
+        auto  index      = reference_node->m_reference_index;
+
+        assert(index < references.size() && references[index] == reference_node);
+
+        references[index]                    = references.back();
+        references[index]->m_reference_index = index;
+        references.pop_back();
+    }
+
+    static void SealPrototype(PrototypePtr prototype)
+    {
+        auto root  = prototype->m_root.get();
+        auto stack  = std::vector<NodePtr>{ root };
+
+        while (!stack.empty()) {
+            auto current = stack.back();
+            stack.pop_back();
+
+            current->m_owner = prototype;
+
+            if (!current->IsLeaf()) {
+                for (const auto& child : static_cast<InnerNode*>(current)->m_children) {
+                    stack.push_back(child.get());
+                }
+            }
+        }
+
+        // The subtree is placed through references from now on, so its own space becomes the prototype space.
+        root->m_world_transform = glm::mat4(1.0f);
+        root->m_subtree_dirty   = true;
+        root->m_bounds_dirty    = true;
+    }
+
+    static void DestroyPrototypeGraph(PrototypePtr prototype) noexcept { prototype->m_root.reset(); }
+
+    // World transforms of every placement of each prototype. A prototype can only be referenced from prototypes
+    // created after it, so visiting them in reverse creation order sees all enclosing placements first.
+    static auto ComputePlacements(const RootNode* root, const std::vector<PrototypePtr>& prototypes)
+        -> std::unordered_map<PrototypePtr, std::vector<glm::mat4>>
+    {
+        auto placements = std::unordered_map<PrototypePtr, std::vector<glm::mat4>>{};
+
+        for (auto prototype : prototypes | std::views::reverse) {
+            auto& transforms = placements[prototype];
+            for (auto reference : prototype->m_references) {
+                if (auto owner = reference->m_owner) {
+                    for (const auto& placement : placements[owner]) {
+                        transforms.push_back(placement * reference->m_world_transform);
+                    }
+                } else if (GetSceneRoot(reference) == root) {
+                    transforms.push_back(reference->m_world_transform);
+                }
+            }
+        }
+
+        return placements;
+    }
+
     static NodePtr AttachNode(InnerNode* parent, UniqueNode child)
     {
         assert(parent && child);
-        auto child_ref  = child.get();
-        child->m_parent = parent;
+        utils::throw_runtime_error_if(
+            parent->m_owner || child->m_owner,
+            "Cannot attach node: prototype nodes cannot be changed");
+        auto child_ref         = child.get();
+        child->m_parent        = parent;
+        child->m_child_index   = parent->m_children.size();
+        child->m_attach_order  = parent->m_attach_count++;
+        child->m_subtree_dirty = true;
+        child->m_bounds_dirty  = true;
         parent->m_children.push_back(std::move(child));
+        MarkBoundsDirty(parent);
+        if (auto root = GetSceneRoot(parent)) {
+            root->m_structure_revision++;
+            UpdateIndex(root, child_ref, true);
+        }
         return child_ref;
     }
 
+    // Moves the last sibling into the vacated position, so the order of the remaining children may change; their
+    // attach order does not.
     static UniqueNode DetachNode(NodePtr node)
     {
         assert(node);
 
         auto parent = static_cast<InnerNode*>(node->m_parent);
 
+        utils::throw_runtime_error_if(node->m_owner, "Cannot detach node: prototype nodes cannot be changed");
         utils::throw_runtime_error_if(parent == nullptr, "Cannot detach node: node has no parent");
 
-        auto it = std::ranges::find_if(parent->m_children, [node](auto& child) { return child.get() == node; });
+        auto& children = parent->m_children;
+        auto  index    = node->m_child_index;
+
+        utils::throw_runtime_error_if(
+            index >= children.size() || children[index].get() != node,
+            "Cannot detach node: invariant violated");
+
+        if (auto root = GetSceneRoot(parent)) {
+            root->m_structure_revision++;
+            UpdateIndex(root, node, false);
+        }
+
+        MarkBoundsDirty(parent);
 
-        utils::throw_runtime_error_if(it == parent->m_children.end(), "Cannot detach node: invariant violated");
+        auto unique_node = std::move(children[index]);
 
-        auto unique_node = std::move(*it);
+        if (index + 1 != children.size()) {
+            children[index]                = std::move(children.back());
+            children[index]->m_child_index = index;
+        }
 
-        unique_node->m_parent = nullptr;
+        children.pop_back();
 
-        parent->m_children.erase(it);
+        unique_node->m_parent       = nullptr;
+        unique_node->m_child_index  = 0;
+        unique_node->m_attach_order = 0;
 
         return unique_node;
     }
 
+    // Subtrees that are not connected to a root are not part of any scene yet, so changes to them are not tracked.
+    static auto GetSceneRoot(NodePtr node) -> RootNode*
+    {
+        while (node->m_parent) {
+            node = node->m_parent;
+        }
+        return node->IsRoot() ? static_cast<RootNode*>(node) : nullptr;
+    }
+
+    static void IndexNode(RootNode* root, NodePtr node)
+    {
+        auto name       = std::get<std::string>(node->GetProperty(kNameAtom, kDefaultNameAtom));
+        auto class_name = std::get<std::string>(node->GetProperty(kClassAtom));
+
+        root->m_node_index.Insert(node->GetID().index, name + '\n' + class_name, node);
+    }
+
+    static void ReindexNode(NodePtr node)
+    {
+        if (auto root = GetSceneRoot(node); root && root != node) {
+            IndexNode(root, node);
+        }
+    }
+
+    static auto FindNodes(const RootNode* root, std::string_view query, size_t max_count) -> Nodes
+    {
+        return root->m_node_index.Search(query, max_count);
+    }
+
+    static void UpdateIndex(RootNode* root, NodePtr node, bool attached)
+    {
+        auto stack = std::vector<NodePtr>{ node };
+
+        while (!stack.empty()) {
+            auto current = stack.back();
+            stack.pop_back();
+
+            if (attached) {
+                IndexNode(root, current);
+            } else {
+                root->m_node_index.Erase(current->GetID().index);
+            }
+
+            if (!current->IsLeaf()) {
+                for (const auto& child : static_cast<InnerNode*>(current)->m_children) {
+                    stack.push_back(child.get());
+                }
+            }
+        }
+    }
+
     static bool IsAncestor(const Node* ancestor, const Node* node)
     {
         assert(node && ancestor);
@@ -349,7 +648,58 @@ struct ObjectAccess final {
         return false;
     }
 
-    static void ApplyTransform(NodePtr node, const glm::mat4& matrix) { node->ApplyTransform(matrix); }
+    static auto GetWorldBounds(const Node* node) noexcept { return node->m_world_bounds; }
+
+    // Every ancestor of a node with dirty bounds has dirty bounds too, so the walk can stop at the first one. The
+    // same holds for the references of a prototype whose root has dirty bounds.
+    static void MarkBoundsDirty(NodePtr node) noexcept
+    {
+        for (; node && !node->m_bounds_dirty; node = node->m_parent) {
+            node->m_bounds_dirty = true;
+            if (node->m_parent == nullptr && node->m_owner) {
+                for (auto reference : node->m_owner->m_references) {
+                    MarkBoundsDirty(reference);
+                }
+            }
+        }
+    }
+
+    // Expects the world transform of node to be current. Clean subtrees keep their cached bounds.
+    static void UpdateBounds(NodePtr node, bool force) noexcept
+    {
+        force = force || node->m_subtree_dirty;
+
+        if (!force && !node->m_bounds_dirty) {
+            return;
+        }
+
+        if (node->IsReference()) {
+            auto prototype_root = static_cast<ReferenceNodePtr>(node)->m_prototype->m_root.get();
+            UpdateBounds(prototype_root, false);
+            auto bounds          = prototype_root->m_world_bounds;
+            node->m_world_bounds = bounds.IsEmpty() ? bounds : TransformBoundingBox(node->m_world_transform, bounds);
+        } else if (node->IsLeaf()) {
+            auto mesh            = static_cast<InstanceNodePtr>(node)->m_mesh;
+            node->m_world_bounds = mesh ? TransformBoundingBox(node->m_world_transform, mesh->GetBoundingBox())
+                                        : AABB::Empty();
+        } else {
+            auto inner           = static_cast<InnerNode*>(node);
+            auto child_transform = node->m_world_transform * inner->GetLocalTransform();
+
+            node->m_world_bounds = AABB::Empty();
+
+            for (const auto& child : inner->m_children) {
+                if (force || child->m_subtree_dirty) {
+                    child->m_world_transform = child_transform;
+                }
+                UpdateBounds(child.get(), force);
+                node->m_world_bounds.Expand(child->m_world_bounds);
+            }
+        }
+
+        node->m_subtree_dirty = false;
+        node->m_bounds_dirty  = false;
+    }
 
     template <typename T>
     static void ThisToJson(const T* object, json& json)
@@ -364,156 +714,1249 @@ struct ObjectAccess final {
     {
         json["owns"] = children;
     }
-};
-
-json Mesh::ToJson() const
-{
-    json json;
 
-    ObjectAccess::ThisToJson(this, json);
-
-    json["value.first-index"]       = m_first_index;
-    json["value.index-count"]       = m_index_count;
-    json["value.ref.vertex-buffer"] = m_vertex_buffer->GetID();
-    json["value.ref.index-buffer"]  = m_index_buffer->GetID();
-
-    return json;
-}
-
-PropertyValue Mesh::GetProperty(std::string_view name) const
-{
-    auto triangles = utils::narrow_cast<int>(m_index_count / 3);
-    return ObjectAccess::GetProperty(name, *this, std::make_tuple(triangles, m_aabb.min, m_aabb.max));
-}
+    template <typename T>
+    static constexpr auto GetClassName() noexcept
+    {
+        return T::kClassName;
+    }
+};
 
-PropertyValue Mesh::GetProperty(std::string_view primary, std::string_view alternative) const
-{
-    auto triangles = utils::narrow_cast<int>(m_index_count / 3);
-    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(triangles, m_aabb.min, m_aabb.max));
-}
+class ObjectStorage final {
+  public:
+    template <typename T, typename... Args>
+    auto Create(Args&&... args) -> std::unique_ptr<T, ObjectDeleter>
+    {
+        auto& pool   = std::get<utils::ObjectPool<T>>(m_pools);
+        auto  handle = m_registry.Insert(nullptr);
+        auto  memory = pool.Allocate();
+        auto  id     = ID(handle.index, handle.generation);
+        auto  object = static_cast<T*>(nullptr);
+
+        try {
+            object = ObjectAccess::Construct<T>(memory, id, std::forward<Args>(args)...);
+        } catch (...) {
+            pool.Deallocate(memory);
+            m_registry.Erase(handle);
+            throw;
+        }
 
-std::vector<Property> Mesh::GetProperties() const
-{
-    auto triangles = utils::narrow_cast<int>(m_index_count / 3);
-    return ObjectAccess::GetProperties(this, std::make_tuple(triangles, m_aabb.min, m_aabb.max));
-}
+        *m_registry.Get(handle) = object;
 
-bool Mesh::SetProperty(std::string_view name, const PropertyValue& value)
-{
-    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
-}
+        return std::unique_ptr<T, ObjectDeleter>(object, ObjectDeleter{ this, &ObjectStorage::Destroy<T> });
+    }
 
-bool Mesh::RemoveProperty(std::string_view name)
-{
-    return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
-}
+    auto Find(ID id) const noexcept -> ObjectPtr
+    {
+        auto object = m_registry.Get({ id.index, id.generation });
+        return object ? *object : nullptr;
+    }
 
-NodePtr InnerNode::AttachNode(UniqueNode node)
-{
-    return ObjectAccess::AttachNode(this, std::move(node));
-}
+    auto Size() const noexcept { return m_registry.size(); }
 
-UniqueNode InnerNode::DetachNode()
-{
-    return ObjectAccess::DetachNode(this);
-}
+  private:
+    template <typename T>
+    static void Destroy(ObjectStorage* storage, Object* object) noexcept
+    {
+        auto typed = static_cast<T*>(object);
+        auto id    = typed->GetID();
 
-bool InnerNode::IsAncestor(NodePtr node) const
-{
-    return ObjectAccess::IsAncestor(this, node);
-}
+        typed->~T();
 
-bool InnerNode::HasChildren() const
-{
-    return ObjectAccess::HasChildren(this);
-}
+        std::get<utils::ObjectPool<T>>(storage->m_pools).Deallocate(typed);
+        storage->m_registry.Erase({ id.index, id.generation });
+    }
 
-Nodes InnerNode::GetChildren() const
-{
-    return ObjectAccess::GetChildren(this);
-}
+    using Pools = std::tuple<
+        utils::ObjectPool<RootNode>,
+        utils::ObjectPool<GroupNode>,
+        utils::ObjectPool<TranslateNode>,
+        utils::ObjectPool<RotateNode>,
+        utils::ObjectPool<ScaleNode>,
+        utils::ObjectPool<InstanceNode>,
+        utils::ObjectPool<ReferenceNode>,
+        utils::ObjectPool<Prototype>,
+        utils::ObjectPool<VertexBuffer>,
+        utils::ObjectPool<IndexBuffer>,
+        utils::ObjectPool<Shader>,
+        utils::ObjectPool<Material>,
+        utils::ObjectPool<Mesh>>;
+
+    Pools                     m_pools;
+    utils::SlotMap<ObjectPtr> m_registry;
+};
 
-Scene::Scene()
-{
-    m_root = ObjectAccess::MakeUnique<RootNode>(GetUniqueID(), NullParent);
-}
+static constexpr std::string_view kSceneFormat  = "vega.scene";
+static constexpr int              kSceneVersion = 2;
 
-DrawList Scene::ComputeDrawList() const
-{
-    using namespace std::ranges;
+// Writes one record per object without building a JSON document, not even for a single record. Property and field
+// values are written as [type, value], so that loading restores the same variant alternative rather than whatever
+// the JSON number happens to fit. Properties are [name, [type, value]].
+class SceneWriter final {
+  public:
+    SceneWriter(std::ostream& records, std::ostream& blob) noexcept : m_records(records), m_blob(blob) {}
 
-    ObjectAccess::ApplyTransform(m_root.get(), glm::identity<glm::mat4>());
+    void Begin()
+    {
+        Append(R"({"format":)");
+        String(kSceneFormat);
+        Append(R"(,"version":)");
+        Number(kSceneVersion);
+        Append(R"(,"objects":[)");
+    }
 
-    auto draw_list = DrawList{};
-    auto index     = size_t{ 0 };
+    void End()
+    {
+        Append("\n]}\n");
+        Flush();
+        utils::throw_runtime_error_if(!m_records || !m_blob, "Cannot save scene: write failed");
+    }
 
-    for (const auto& shader : m_shaders) {
-        for (auto material : shader->GetMaterials()) {
-            for (auto instance : material->GetInstanceNodes()) {
-                draw_list.push_back(
-                    { index++, instance->GetMeshPtr(), instance->GetMaterialPtr(), instance->GetTransform() });
+    // Opens a record with the class, the ID and the user properties of the object. The caller adds its own members
+    // with Member and the value functions, then closes the record.
+    void BeginRecord(const Object* object)
+    {
+        Append(m_record_count++ == 0 ? "\n{" : ",\n{");
+        Append(R"("class":)");
+        String(std::get<std::string>(object->GetProperty(kClassAtom)));
+        Append(R"(,"id":)");
+        Number(object->GetID().index);
+
+        if (auto properties = object->GetProperties(); !properties.empty()) {
+            Append(R"(,"properties":[)");
+            for (const auto& [name, value] : properties) {
+                Append(&name == &properties.front().first ? "[" : ",[");
+                String(name.Name());
+                Append(",");
+                TypedValue(value);
+                Append("]");
             }
+            Append("]");
         }
     }
 
-    return draw_list;
-}
-
-AABB Scene::ComputeAxisAlignedBoundingBox() const
-{
-    using namespace std::ranges;
-
-    if (m_root->GetChildren().empty()) {
-        return AABB{ { -1, -1, -1 }, { 1, 1, 1 } };
+    void EndRecord()
+    {
+        Append("}");
+        if (m_buffer.size() >= kFlushSize) {
+            Flush();
+        }
     }
 
-    ObjectAccess::ApplyTransform(m_root.get(), glm::identity<glm::mat4>());
+    void Member(std::string_view key)
+    {
+        Append(",");
+        String(key);
+        Append(":");
+    }
+
+    void Reference(const Object* object)
+    {
+        if (object) {
+            Number(object->GetID().index);
+        } else {
+            Append("null");
+        }
+    }
+
+    void Vector(Float3 value)
+    {
+        Append("[");
+        Number(value.x);
+        Append(",");
+        Number(value.y);
+        Append(",");
+        Number(value.z);
+        Append("]");
+    }
+
+    void Number(std::integral auto value)
+    {
+        char text[24];
+        auto result = std::to_chars(std::begin(text), std::end(text), value);
+        m_buffer.append(text, result.ptr);
+    }
+
+    // Floats are written at double precision, which reads back to exactly the same float.
+    void Number(float value)
+    {
+        char text[32];
+        auto result = std::to_chars(std::begin(text), std::end(text), static_cast<double>(value));
+        m_buffer.append(text, result.ptr);
+    }
+
+    void String(std::string_view text)
+    {
+        static constexpr char kHex[] = "0123456789abcdef";
+
+        m_buffer += '"';
+        for (auto c : text) {
+            auto byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                m_buffer += '\\';
+                m_buffer += c;
+            } else if (byte < 0x20) {
+                m_buffer += "\\u00";
+                m_buffer += kHex[byte >> 4];
+                m_buffer += kHex[byte & 15];
+            } else {
+                m_buffer += c;
+            }
+        }
+        m_buffer += '"';
+    }
+
+    void TypedValue(const PropertyValue& value)
+    {
+        std::visit([this](const auto& alternative) { Typed(alternative); }, value);
+    }
+
+    // Buffers are stored encoded with the stream codec. Compressed buffers are written as they are; the others are
+    // encoded on the way out, with the given stride or, if it is 0, the one that compresses best. Released buffers
+    // are fetched from their source first.
+    void WriteBuffer(const Buffer* buffer, size_t stride)
+    {
+        auto encoded   = std::span<const std::byte>(ObjectAccess::GetEncodedData(buffer));
+        auto residency = buffer->GetResidency();
+
+        if (residency != BufferResidency::Compressed) {
+            auto data = std::span(static_cast<const std::byte*>(buffer->Data()), buffer->Size());
+            if (residency == BufferResidency::Released) {
+                m_fetched.resize(buffer->Size());
+                buffer->CopyTo(m_fetched.data());
+                data = m_fetched;
+            }
+            m_encoded = utils::EncodeStream(data, stride ? stride : utils::FindStreamStride(data));
+            encoded   = m_encoded;
+        }
+
+        BeginRecord(buffer);
+        Member("blob");
+        Blob(encoded);
+        Member("alignment");
+        Number(static_cast<size_t>(buffer->Alignment()));
+        EndRecord();
+    }
+
+    // Writes an array of trivially copyable records to the blob, encoded with the record size as stride.
+    template <typename T>
+    void Records(std::span<const T> records)
+    {
+        m_encoded = utils::EncodeStream(std::as_bytes(records), sizeof(T));
+        Blob(m_encoded);
+    }
+
+    // Appends the data to the blob and writes its offset and size.
+    void Blob(std::span<const std::byte> encoded)
+    {
+        Append("[");
+        Number(m_blob_size);
+        Append(",");
+        Number(encoded.size());
+        Append("]");
+
+        auto bytes = reinterpret_cast<const char*>(encoded.data());
+        m_blob.write(bytes, utils::narrow_cast<std::streamsize>(encoded.size()));
+        m_blob_size += encoded.size();
+    }
+
+    // Pre-order, so that every parent is read before its children and the children are attached in their order.
+    void WriteGraph(NodePtr node)
+    {
+        auto stack = std::vector<NodePtr>{ node };
+
+        while (!stack.empty()) {
+            auto current = stack.back();
+            stack.pop_back();
+
+            WriteNode(current);
+
+            auto children = current->GetChildren();
+            stack.insert(stack.end(), children.rbegin(), children.rend());
+        }
+    }
+
+  private:
+    static constexpr size_t kFlushSize = 1 << 16;
+
+    void WriteNode(NodePtr node)
+    {
+        BeginRecord(node);
+        Member("parent");
+        Reference(node->GetParent());
+
+        // Only built-in fields have metadata, which tells them apart from user properties that share a field name.
+        auto field_count = size_t{ 0 };
+        while (field_count != kFieldAtoms.size() && node->GetProperty(kFieldMetaAtoms[field_count]).index() != 0) {
+            field_count++;
+        }
+
+        if (field_count != 0) {
+            Member("fields");
+            Append("[");
+            for (size_t i = 0; i != field_count; ++i) {
+                Append(i == 0 ? "" : ",");
+                TypedValue(node->GetProperty(kFieldAtoms[i]));
+            }
+            Append("]");
+        }
+
+        EndRecord();
+    }
+
+    void Typed(std::monostate) { Append("null"); }
+    void Typed(int32_t value) { Typed("int32", [&] { Number(value); }); }
+    void Typed(int64_t value) { Typed("int64", [&] { Number(value); }); }
+    void Typed(uint32_t value) { Typed("uint32", [&] { Number(value); }); }
+    void Typed(uint64_t value) { Typed("uint64", [&] { Number(value); }); }
+    void Typed(float value) { Typed("float", [&] { Number(value); }); }
+    void Typed(Float3 value) { Typed("float3", [&] { Vector(value); }); }
+    void Typed(const std::string& value) { Typed("string", [&] { String(value); }); }
+    void Typed(ObjectPtr value) { Typed("object", [&] { Reference(value); }); }
+
+    template <typename Write>
+    void Typed(std::string_view type, Write write)
+    {
+        Append("[");
+        String(type);
+        Append(",");
+        write();
+        Append("]");
+    }
+
+    void Append(std::string_view text) { m_buffer += text; }
+
+    void Flush()
+    {
+        m_records.write(m_buffer.data(), utils::narrow_cast<std::streamsize>(m_buffer.size()));
+        m_buffer.clear();
+    }
+
+    std::ostream&          m_records;
+    std::ostream&          m_blob;
+    std::string            m_buffer;
+    std::vector<std::byte> m_encoded;
+    std::vector<std::byte> m_fetched;
+    size_t                 m_record_count = 0;
+    size_t                 m_blob_size    = 0;
+};
+
+// Rebuilds objects from the record stream. The layout of a record is fixed, so the SAX callbacks flatten each record
+// into a reused list of scalars per member instead of building a document; nested arrays only group values and
+// their extent follows from the value types. Memory use does not grow with the size of the stream.
+class SceneReader final : public json::json_sax_t {
+  public:
+    SceneReader(Scene* scene, std::istream& blob) noexcept : m_scene(scene), m_blob(blob) {}
+
+    bool null() override { return AddScalar(Scalar::Kind::Null); }
+    bool boolean(bool /*value*/) override { return false; }
+    bool binary(binary_t& /*value*/) override { return false; }
+
+    bool number_integer(number_integer_t value) override
+    {
+        NextScalar(Scalar::Kind::Integer).integer = value;
+        return CommitScalar();
+    }
+
+    bool number_unsigned(number_unsigned_t value) override
+    {
+        NextScalar(Scalar::Kind::Unsigned).unsigned_integer = value;
+        return CommitScalar();
+    }
+
+    bool number_float(number_float_t value, const string_t& /*text*/) override
+    {
+        NextScalar(Scalar::Kind::Float).number = value;
+        return CommitScalar();
+    }
+
+    bool string(string_t& value) override
+    {
+        NextScalar(Scalar::Kind::String).text.assign(value);
+        return CommitScalar();
+    }
+
+    bool key(string_t& value) override
+    {
+        if (m_depth == 1) {
+            m_key = std::move(value);
+        } else if (m_depth == 3) {
+            if (m_member_count == m_members.size()) {
+                m_members.emplace_back();
+            }
+            m_members[m_member_count++] = { std::move(value), m_scalar_count };
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Depth 0 and 1 are the document and its object list, records start at depth 2 and only contain arrays.
+    bool start_object(size_t /*size*/) override
+    {
+        if (m_depth == 2) {
+            m_member_count = 0;
+            m_scalar_count = 0;
+        } else if (m_depth != 0) {
+            return false;
+        }
+        m_depth++;
+        return true;
+    }
+
+    bool end_object() override
+    {
+        if (--m_depth == 2) {
+            ReadRecord();
+        }
+        return true;
+    }
+
+    bool start_array(size_t /*size*/) override
+    {
+        if ((m_depth == 1 && m_key != "objects") || m_depth == 0 || m_depth == 2) {
+            return false;
+        }
+        m_depth++;
+        return true;
+    }
+
+    bool end_array() override
+    {
+        m_depth--;
+        return true;
+    }
+
+    bool parse_error(size_t /*position*/, const std::string& /*token*/, const nlohmann::detail::exception&) override
+    {
+        return false;
+    }
+
+    void Finish()
+    {
+        utils::throw_runtime_error_if(!m_detached.empty(), "Cannot load scene: node is not part of any graph");
+
+        // Object properties may refer to objects further down the stream. References to objects that were not
+        // saved, such as nodes detached from the scene, are dropped.
+        for (const auto& [object, name, id] : m_object_properties) {
+            if (id < m_objects.size() && m_objects[id].object) {
+                object->SetProperty(name, m_objects[id].object);
+            }
+        }
+    }
+
+  private:
+    struct Scalar final {
+        enum class Kind { Null, Integer, Unsigned, Float, String };
+
+        Kind        kind             = Kind::Null;
+        int64_t     integer          = 0;
+        uint64_t    unsigned_integer = 0;
+        double      number           = 0;
+        std::string text;
+    };
+
+    using Scalars = std::span<const Scalar>;
+
+    struct Member final {
+        std::string key;
+        size_t      first = 0;
+    };
+
+    struct Entry final {
+        ObjectPtr object = nullptr;
+        NodePtr   node   = nullptr;
+    };
+
+    struct ObjectProperty final {
+        ObjectPtr    object;
+        PropertyAtom name;
+        uint32_t     id;
+    };
+
+    auto NextScalar(Scalar::Kind kind) -> Scalar&
+    {
+        if (m_scalar_count == m_scalars.size()) {
+            m_scalars.emplace_back();
+        }
+        auto& scalar = m_scalars[m_scalar_count++];
+        scalar.kind  = kind;
+        return scalar;
+    }
+
+    bool AddScalar(Scalar::Kind kind)
+    {
+        NextScalar(kind);
+        return CommitScalar();
+    }
+
+    bool CommitScalar()
+    {
+        if (m_depth == 1) {
+            ReadHeader(m_scalars[--m_scalar_count]);
+            return true;
+        }
+        return m_depth > 2;
+    }
+
+    void ReadHeader(const Scalar& value)
+    {
+        if (m_key == "format") {
+            utils::throw_runtime_error_if(
+                value.kind != Scalar::Kind::String || value.text != kSceneFormat, "Cannot load scene: unknown format");
+            m_format_read = true;
+        } else if (m_key == "version") {
+            utils::throw_runtime_error_if(
+                value.kind != Scalar::Kind::Unsigned || value.unsigned_integer != kSceneVersion,
+                "Cannot load scene: unsupported version");
+            m_version_read = true;
+        }
+    }
+
+    auto Find(std::string_view key) const noexcept -> Scalars
+    {
+        for (size_t i = 0; i != m_member_count; ++i) {
+            if (m_members[i].key == key) {
+                auto last = i + 1 != m_member_count ? m_members[i + 1].first : m_scalar_count;
+                return Scalars(m_scalars.data() + m_members[i].first, last - m_members[i].first);
+            }
+        }
+        return {};
+    }
+
+    auto Require(std::string_view key) const -> Scalars
+    {
+        auto scalars = Find(key);
+        utils::throw_runtime_error_if(scalars.empty(), "Cannot load scene: record entry is missing");
+        return scalars;
+    }
+
+    void ReadRecord()
+    {
+        utils::throw_runtime_error_if(!m_format_read || !m_version_read, "Cannot load scene: header is missing");
+
+        const auto& class_name = ReadString(Require("class"), 0);
+
+        auto id     = ReadInteger<uint32_t>(Require("id"), 0);
+        auto object = ObjectPtr{};
+        auto node   = UniqueNode{};
+        auto ptr    = NodePtr{};
+
+        if (class_name == ObjectAccess::GetClassName<VertexBuffer>()) {
+            auto alignment    = std::align_val_t(ReadInteger<size_t>(Require("alignment"), 0));
+            auto [data, size] = ReadBlob(Require("blob"), alignment);
+            object            = m_scene->CreateVertexBuffer(std::move(data), size);
+        } else if (class_name == ObjectAccess::GetClassName<IndexBuffer>()) {
+            auto alignment    = std::align_val_t(ReadInteger<size_t>(Require("alignment"), 0));
+            auto [data, size] = ReadBlob(Require("blob"), alignment);
+            object            = m_scene->CreateIndexBuffer(std::move(data), size);
+        } else if (class_name == ObjectAccess::GetClassName<Shader>()) {
+            object = m_scene->CreateShader();
+        } else if (class_name == ObjectAccess::GetClassName<Material>()) {
+            object = m_scene->CreateMaterial(Resolve<Shader>(Require("shader"), 0));
+        } else if (class_name == ObjectAccess::GetClassName<Mesh>()) {
+            auto aabb          = AABB{ ReadFloat3(Require("min"), 0), ReadFloat3(Require("max"), 0) };
+            auto vertex_buffer = Resolve<VertexBuffer>(Require("vertex-buffer"), 0, false);
+            auto index_buffer  = Resolve<IndexBuffer>(Require("index-buffer"), 0, false);
+            auto first_index   = ReadInteger<size_t>(Require("first-index"), 0);
+            auto index_count   = ReadInteger<size_t>(Require("index-count"), 0);
+
+            if (auto nodes = ReadRecords<PointNode>("points"); !nodes.empty()) {
+                object = m_scene->CreatePointCloud(
+                    aabb,
+                    vertex_buffer,
+                    index_buffer,
+                    first_index,
+                    index_count,
+                    std::move(nodes));
+            } else {
+                object = m_scene->CreateMesh(
+                    aabb,
+                    vertex_buffer,
+                    index_buffer,
+                    first_index,
+                    index_count,
+                    ReadRecords<Meshlet>("meshlets"));
+            }
+        } else if (class_name == ObjectAccess::GetClassName<Prototype>()) {
+            auto iter = m_detached.find(ReadInteger<uint32_t>(Require("root"), 0));
+            utils::throw_runtime_error_if(iter == m_detached.end(), "Cannot load scene: prototype root is missing");
+            object = m_scene->CreatePrototype(std::move(iter->second));
+            m_detached.erase(iter);
+        } else if (class_name == ObjectAccess::GetClassName<RootNode>()) {
+            ptr    = m_scene->GetRootNode();
+            object = ptr;
+        } else {
+            node   = CreateNode(class_name);
+            ptr    = node.get();
+            object = ptr;
+        }
+
+        ReadProperties(object);
+
+        if (id >= m_objects.size()) {
+            m_objects.resize(size_t{ id } + 1);
+        }
+
+        utils::throw_runtime_error_if(m_objects[id].object != nullptr, "Cannot load scene: duplicate ID");
+
+        m_objects[id] = { object, ptr };
+
+        // Nodes are attached after their name is set, so that the search index sees each node once.
+        if (node) {
+            AttachNode(id, std::move(node));
+        }
+    }
+
+    auto CreateNode(const std::string& class_name) -> UniqueNode
+    {
+        auto fields = Find("fields");
+        auto node   = UniqueNode{};
+
+        if (class_name == ObjectAccess::GetClassName<GroupNode>()) {
+            node = m_scene->CreateGroupNode();
+        } else if (class_name == ObjectAccess::GetClassName<TranslateNode>()) {
+            node = m_scene->CreateTranslateNode(std::get<Float3>(ReadField(fields, 0)));
+        } else if (class_name == ObjectAccess::GetClassName<RotateNode>()) {
+            auto axis  = std::get<Float3>(ReadField(fields, 0));
+            auto angle = Radians(std::get<float>(ReadField(fields, 1)));
+            node       = m_scene->CreateRotateNode(axis, angle);
+        } else if (class_name == ObjectAccess::GetClassName<ScaleNode>()) {
+            node = m_scene->CreateScaleNode(std::get<float>(ReadField(fields, 0)));
+        } else if (class_name == ObjectAccess::GetClassName<InstanceNode>()) {
+            auto mesh     = Resolve<Mesh>(fields, FieldOffset(fields, 0) + 1, false);
+            auto material = Resolve<Material>(fields, FieldOffset(fields, 1) + 1);
+            node          = m_scene->CreateInstanceNode(mesh, material);
+        } else if (class_name == ObjectAccess::GetClassName<ReferenceNode>()) {
+            node = m_scene->CreateReferenceNode(Resolve<Prototype>(fields, FieldOffset(fields, 0) + 1));
+        } else {
+            utils::throw_runtime_error("Cannot load scene: unknown object class");
+        }
+
+        return node;
+    }
+
+    void AttachNode(uint32_t id, UniqueNode node)
+    {
+        auto parent = Require("parent");
+
+        if (parent[0].kind == Scalar::Kind::Null) {
+            m_detached.emplace(id, std::move(node));
+        } else {
+            auto parent_id = ReadInteger<uint32_t>(parent, 0);
+            utils::throw_runtime_error_if(
+                parent_id >= m_objects.size() || m_objects[parent_id].node == nullptr,
+                "Cannot load scene: parent node is missing");
+            m_objects[parent_id].node->AttachNode(std::move(node));
+        }
+    }
+
+    void ReadProperties(ObjectPtr object)
+    {
+        auto properties = Find("properties");
+
+        for (size_t i = 0; i < properties.size();) {
+            auto name = PropertyAtom(ReadString(properties, i));
+            if (ReadString(properties, i + 1) != "object") {
+                i++;
+                object->SetProperty(name, ReadValue(properties, i));
+            } else {
+                if (At(properties, i + 2).kind != Scalar::Kind::Null) {
+                    m_object_properties.push_back({ object, name, ReadInteger<uint32_t>(properties, i + 2) });
+                }
+                i += 3;
+            }
+        }
+    }
+
+    // Each field is a type followed by its value, which is three scalars for a vector and one otherwise.
+    static auto FieldOffset(Scalars fields, size_t index) -> size_t
+    {
+        auto offset = size_t{ 0 };
+        for (size_t i = 0; i != index; ++i) {
+            offset += ReadString(fields, offset) == "float3" ? size_t{ 4 } : size_t{ 2 };
+        }
+        return offset;
+    }
+
+    static auto ReadField(Scalars fields, size_t index) -> PropertyValue
+    {
+        auto offset = FieldOffset(fields, index);
+        return ReadValue(fields, offset);
+    }
+
+    // Reads a type and its value starting at offset, and moves offset past them.
+    static auto ReadValue(Scalars scalars, size_t& offset) -> PropertyValue
+    {
+        const auto& type = ReadString(scalars, offset);
+        auto        at   = offset + 1;
+
+        offset += type == "float3" ? size_t{ 4 } : size_t{ 2 };
+
+        if (type == "int32") {
+            return ReadInteger<int32_t>(scalars, at);
+        } else if (type == "int64") {
+            return ReadInteger<int64_t>(scalars, at);
+        } else if (type == "uint32") {
+            return ReadInteger<uint32_t>(scalars, at);
+        } else if (type == "uint64") {
+            return ReadInteger<uint64_t>(scalars, at);
+        } else if (type == "float") {
+            return ReadFloat(scalars, at);
+        } else if (type == "float3") {
+            return ReadFloat3(scalars, at);
+        } else if (type == "string") {
+            return ReadString(scalars, at);
+        }
+        utils::throw_runtime_error("Cannot load scene: unknown value type");
+        return {};
+    }
+
+    static auto At(Scalars scalars, size_t index) -> const Scalar&
+    {
+        utils::throw_runtime_error_if(index >= scalars.size(), "Cannot load scene: record entry is truncated");
+        return scalars[index];
+    }
+
+    static auto ReadString(Scalars scalars, size_t index) -> const std::string&
+    {
+        const auto& scalar = At(scalars, index);
+        utils::throw_runtime_error_if(scalar.kind != Scalar::Kind::String, "Cannot load scene: string expected");
+        return scalar.text;
+    }
+
+    template <typename T>
+    static auto ReadInteger(Scalars scalars, size_t index) -> T
+    {
+        const auto& scalar = At(scalars, index);
+        if (scalar.kind == Scalar::Kind::Unsigned) {
+            return utils::narrow_cast<T>(scalar.unsigned_integer);
+        }
+        utils::throw_runtime_error_if(scalar.kind != Scalar::Kind::Integer, "Cannot load scene: integer expected");
+        return utils::narrow_cast<T>(scalar.integer);
+    }
+
+    // Whole numbers are written without a fraction, so they come back as integers.
+    static auto ReadFloat(Scalars scalars, size_t index) -> float
+    {
+        const auto& scalar = At(scalars, index);
+        switch (scalar.kind) {
+        case Scalar::Kind::Float: return static_cast<float>(scalar.number);
+        case Scalar::Kind::Integer: return static_cast<float>(scalar.integer);
+        case Scalar::Kind::Unsigned: return static_cast<float>(scalar.unsigned_integer);
+        default: utils::throw_runtime_error("Cannot load scene: number expected");
+        }
+        return 0;
+    }
+
+    static auto ReadFloat3(Scalars scalars, size_t index) -> Float3
+    {
+        return Float3{ ReadFloat(scalars, index), ReadFloat(scalars, index + 1), ReadFloat(scalars, index + 2) };
+    }
+
+    template <typename T>
+    auto Resolve(Scalars scalars, size_t index, bool required = true) const -> T*
+    {
+        if (At(scalars, index).kind == Scalar::Kind::Null) {
+            utils::throw_runtime_error_if(required, "Cannot load scene: reference is missing");
+            return nullptr;
+        }
+
+        auto id = ReadInteger<uint32_t>(scalars, index);
+
+        utils::throw_runtime_error_if(
+            id >= m_objects.size() || m_objects[id].object == nullptr,
+            "Cannot load scene: referenced object is missing");
+        utils::throw_runtime_error_if(
+            std::get<std::string>(m_objects[id].object->GetProperty(kClassAtom)) != ObjectAccess::GetClassName<T>(),
+            "Cannot load scene: referenced object has the wrong class");
+
+        return static_cast<T*>(m_objects[id].object);
+    }
+
+    // Decodes the buffer contents straight into the memory the buffer adopts.
+    auto ReadBlob(Scalars blob, std::align_val_t alignment) -> std::pair<Buffer::UniqueData, size_t>
+    {
+        auto offset = ReadInteger<uint64_t>(blob, 0);
+        auto size   = ReadInteger<size_t>(blob, 1);
+
+        m_scratch.resize(size);
+        m_blob.seekg(utils::narrow_cast<std::streamoff>(offset));
+        m_blob.read(reinterpret_cast<char*>(m_scratch.data()), utils::narrow_cast<std::streamsize>(size));
+
+        utils::throw_runtime_error_if(!m_blob, "Cannot load scene: blob is truncated");
+
+        auto decoded_size = utils::GetDecodedStreamSize(m_scratch);
+        auto data         = Buffer::Allocate(decoded_size, alignment);
+
+        utils::DecodeStream(m_scratch, std::span(static_cast<std::byte*>(data.get()), decoded_size));
+
+        return { std::move(data), decoded_size };
+    }
+
+    template <typename T>
+    auto ReadRecords(std::string_view key) -> std::vector<T>
+    {
+        auto blob = Find(key);
+        if (blob.empty()) {
+            return {};
+        }
+
+        auto [data, size] = ReadBlob(blob, std::align_val_t(alignof(T)));
+        utils::throw_runtime_error_if(size % sizeof(T) != 0, "Cannot load scene: mesh records are not valid");
+
+        auto records = std::vector<T>(size / sizeof(T));
+        if (size) {
+            std::memcpy(records.data(), data.get(), size);
+        }
+        return records;
+    }
+
+    Scene*                                   m_scene = nullptr;
+    std::istream&                            m_blob;
+    std::string                              m_key;
+    std::vector<Member>                      m_members;
+    std::vector<Scalar>                      m_scalars;
+    size_t                                   m_member_count = 0;
+    size_t                                   m_scalar_count = 0;
+    int                                      m_depth        = 0;
+    bool                                     m_format_read  = false;
+    bool                                     m_version_read = false;
+    std::vector<Entry>                       m_objects;
+    std::unordered_map<uint32_t, UniqueNode> m_detached;
+    std::vector<ObjectProperty>              m_object_properties;
+    std::vector<std::byte>                   m_scratch;
+};
+
+struct BuilderVertexBuffer final {
+    ObjectAccess::BufferData data;
+    size_t                   size = 0;
+    Buffer::Source           source;
+};
+
+struct BuilderIndexBuffer final {
+    ObjectAccess::BufferData data;
+    size_t                   size = 0;
+    Buffer::Source           source;
+};
+
+struct BuilderShader final {};
+
+struct BuilderMaterial final {
+    SceneBuilder::Handle shader;
+};
+
+struct BuilderMesh final {
+    AABB                   aabb;
+    SceneBuilder::Handle   vertex_buffer;
+    SceneBuilder::Handle   index_buffer;
+    size_t                 first_index;
+    size_t                 index_count;
+    std::vector<Meshlet>   meshlets;
+    std::vector<PointNode> point_nodes;
+};
+
+struct BuilderGroupNode final {};
+
+struct BuilderTranslateNode final {
+    Float3 distance;
+};
+
+struct BuilderRotateNode final {
+    Float3  axis;
+    Radians angle;
+};
+
+struct BuilderScaleNode final {
+    float factor;
+};
+
+struct BuilderInstanceNode final {
+    SceneBuilder::Handle mesh;
+    SceneBuilder::Handle material;
+};
+
+struct BuilderRecord final {
+    using Value = std::variant<
+        BuilderVertexBuffer,
+        BuilderIndexBuffer,
+        BuilderShader,
+        BuilderMaterial,
+        BuilderMesh,
+        BuilderGroupNode,
+        BuilderTranslateNode,
+        BuilderRotateNode,
+        BuilderScaleNode,
+        BuilderInstanceNode>;
+
+    Value                 value;
+    SceneBuilder::Handle  parent = SceneBuilder::kNoParent;
+    std::vector<Property> properties{};
+};
+
+template <typename... T>
+static bool Holds(const std::vector<BuilderRecord>& records, SceneBuilder::Handle handle) noexcept
+{
+    return handle < records.size() && (std::holds_alternative<T>(records[handle].value) || ...);
+}
+
+// Creates the objects recorded by a scene builder without adding them to the scene. The objects are owned here until
+// the scene takes all of them over, so a commit that fails part way destroys what it created and leaves the scene as
+// it was. The graphs are declared after the assets, so that they are destroyed first and instances unregister from
+// meshes and materials that still exist.
+struct BuilderCommit final {
+    using Handle = SceneBuilder::Handle;
+
+    BuilderCommit(ObjectStorage* storage, std::span<const uint32_t> free_material_indices, size_t material_count)
+        : storage(storage), free_material_indices(free_material_indices), scene_material_count(material_count)
+    {}
+
+    void Create(BuilderRecord& record)
+    {
+        auto object = std::visit([&](auto& value) { return Create(value, record.parent); }, record.value);
+        for (const auto& [name, value] : record.properties) {
+            object->SetProperty(name, value);
+        }
+        objects.push_back(object);
+    }
+
+    auto Create(BuilderVertexBuffer& record, Handle) -> ObjectPtr
+    {
+        auto owner = storage->Create<VertexBuffer>(std::move(record.data), record.size);
+        owner->SetSource(std::move(record.source));
+        return Adopt(std::move(owner), vertex_buffers);
+    }
+
+    auto Create(BuilderIndexBuffer& record, Handle) -> ObjectPtr
+    {
+        auto owner = storage->Create<IndexBuffer>(std::move(record.data), record.size);
+        owner->SetSource(std::move(record.source));
+        return Adopt(std::move(owner), index_buffers);
+    }
+
+    auto Create(BuilderShader&, Handle) -> ObjectPtr { return Adopt(storage->Create<Shader>(), shaders); }
+
+    auto Create(BuilderMaterial& record, Handle) -> ObjectPtr
+    {
+        // Free indices are taken from the back, as Scene::CreateMaterial does. Once they run out, the indices
+        // continue past the materials of the scene and those created so far.
+        auto created  = materials.size();
+        auto free     = free_material_indices.size();
+        auto index    = created < free ? free_material_indices[free - 1 - created]
+                                       : utils::narrow_cast<uint32_t>(scene_material_count + created);
+        auto material = Adopt(storage->Create<Material>(index), materials);
+        ObjectAccess::AddMaterialPtr(static_cast<ShaderPtr>(objects[record.shader]), material);
+        return material;
+    }
+
+    auto Create(BuilderMesh& record, Handle) -> ObjectPtr
+    {
+        auto vertex_buffer = static_cast<VertexBufferPtr>(objects[record.vertex_buffer]);
+        auto index_buffer  = static_cast<IndexBufferPtr>(objects[record.index_buffer]);
+        auto mesh          = Adopt(
+            storage->Create<Mesh>(
+                record.aabb,
+                vertex_buffer,
+                index_buffer,
+                record.first_index,
+                record.index_count,
+                std::move(record.meshlets),
+                std::move(record.point_nodes)),
+            meshes);
+        ObjectAccess::AddUse(vertex_buffer);
+        ObjectAccess::AddUse(index_buffer);
+        return mesh;
+    }
+
+    auto Create(BuilderGroupNode&, Handle parent) -> ObjectPtr
+    {
+        return Place(storage->Create<GroupNode>(NullParent), parent);
+    }
+
+    auto Create(BuilderTranslateNode& record, Handle parent) -> ObjectPtr
+    {
+        return Place(storage->Create<TranslateNode>(NullParent, record.distance), parent);
+    }
+
+    auto Create(BuilderRotateNode& record, Handle parent) -> ObjectPtr
+    {
+        return Place(storage->Create<RotateNode>(NullParent, record.axis, record.angle), parent);
+    }
+
+    auto Create(BuilderScaleNode& record, Handle parent) -> ObjectPtr
+    {
+        return Place(storage->Create<ScaleNode>(NullParent, record.factor), parent);
+    }
+
+    auto Create(BuilderInstanceNode& record, Handle parent) -> ObjectPtr
+    {
+        auto mesh     = static_cast<MeshPtr>(objects[record.mesh]);
+        auto material = static_cast<MaterialPtr>(objects[record.material]);
+        return Place(storage->Create<InstanceNode>(NullParent, mesh, material), parent);
+    }
+
+    template <typename T>
+    auto Adopt(std::unique_ptr<T, ObjectDeleter> owner, std::vector<T*>& list) -> T*
+    {
+        auto object = owner.get();
+        assets.push_back(std::move(owner));
+        list.push_back(object);
+        return object;
+    }
+
+    auto Place(UniqueNode node, Handle parent) -> ObjectPtr
+    {
+        if (parent == SceneBuilder::kNoParent) {
+            graphs.push_back(std::move(node));
+            return graphs.back().get();
+        }
+        return ObjectAccess::AttachNode(static_cast<InnerNode*>(objects[parent]), std::move(node));
+    }
+
+    ObjectStorage*               storage = nullptr;
+    std::span<const uint32_t>    free_material_indices;
+    size_t                       scene_material_count = 0;
+    std::vector<ObjectPtr>       objects; // Indexed by handle
+    std::vector<UniqueObject>    assets;
+    std::vector<ShaderPtr>       shaders;
+    std::vector<MaterialPtr>     materials;
+    std::vector<MeshPtr>         meshes;
+    std::vector<VertexBufferPtr> vertex_buffers;
+    std::vector<IndexBufferPtr>  index_buffers;
+    std::vector<UniqueNode>      graphs;
+};
+
+json Mesh::ToJson() const
+{
+    json json;
+
+    ObjectAccess::ThisToJson(this, json);
+
+    json["value.first-index"]       = m_first_index;
+    json["value.index-count"]       = m_index_count;
+    json["value.ref.vertex-buffer"] = m_vertex_buffer->GetID();
+    json["value.ref.index-buffer"]  = m_index_buffer->GetID();
+
+    return json;
+}
+
+PropertyValue Mesh::GetProperty(PropertyAtom name) const
+{
+    auto triangles = GetTopology() == MeshTopology::Points ? 0 : utils::narrow_cast<int>(m_index_count / 3);
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple(triangles, m_aabb.min, m_aabb.max));
+}
+
+PropertyValue Mesh::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
+{
+    auto triangles = GetTopology() == MeshTopology::Points ? 0 : utils::narrow_cast<int>(m_index_count / 3);
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(triangles, m_aabb.min, m_aabb.max));
+}
+
+bool Mesh::SetProperty(PropertyAtom name, const PropertyValue& value)
+{
+    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
+}
+
+bool Mesh::RemoveProperty(PropertyAtom name)
+{
+    return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
+}
+
+NodePtr InnerNode::AttachNode(UniqueNode node)
+{
+    return ObjectAccess::AttachNode(this, std::move(node));
+}
+
+UniqueNode InnerNode::DetachNode()
+{
+    return ObjectAccess::DetachNode(this);
+}
+
+bool InnerNode::IsAncestor(NodePtr node) const
+{
+    return ObjectAccess::IsAncestor(this, node);
+}
+
+bool InnerNode::HasChildren() const
+{
+    return ObjectAccess::HasChildren(this);
+}
+
+Nodes InnerNode::GetChildren() const
+{
+    return ObjectAccess::GetChildren(this);
+}
+
+Scene::Scene() : m_storage(std::make_unique<ObjectStorage>())
+{
+    m_root = m_storage->Create<RootNode>(NullParent);
+}
+
+Scene::Scene(Scene&&) noexcept = default;
+
+// A defaulted move would free the storage first, while the objects being replaced still point into it.
+Scene& Scene::operator=(Scene&& other) noexcept
+{
+    if (this != &other) {
+        Destroy();
+
+        m_storage               = std::move(other.m_storage);
+        m_shaders               = std::move(other.m_shaders);
+        m_materials             = std::move(other.m_materials);
+        m_meshes                = std::move(other.m_meshes);
+        m_prototypes            = std::move(other.m_prototypes);
+        m_vertex_buffers        = std::move(other.m_vertex_buffers);
+        m_index_buffers         = std::move(other.m_index_buffers);
+        m_objects               = std::move(other.m_objects);
+        m_free_material_indices = std::move(other.m_free_material_indices);
+        m_root                  = std::move(other.m_root);
+    }
+
+    return *this;
+}
+
+ObjectPtr Scene::FindObject(ID id) const noexcept
+{
+    return m_storage->Find(id);
+}
+
+size_t Scene::GetObjectCount() const noexcept
+{
+    return m_storage->Size();
+}
+
+Nodes Scene::FindNodes(std::string_view query, size_t max_count) const
+{
+    return ObjectAccess::FindNodes(static_cast<const RootNode*>(m_root.get()), query, max_count);
+}
+
+void Scene::DestroySubtree(NodePtr node)
+{
+    utils::throw_runtime_error_if(node == nullptr, "Cannot destroy subtree: node is missing");
+    utils::throw_runtime_error_if(node->IsRoot(), "Cannot destroy subtree: cannot destroy root node");
+
+    auto subtree = node->DetachNode();
+
+    ObjectAccess::ReleaseInstances(subtree.get());
+}
+
+ReleasedAssets Scene::ReleaseUnusedAssets()
+{
+    auto released = ReleasedAssets{};
+    auto objects  = std::vector<ObjectPtr>{};
+    auto unused   = [](auto asset) { return ObjectAccess::IsUnused(asset); };
+
+    // A prototype is only referenced from prototypes created after it, so in reverse creation order a prototype
+    // that was only placed by released prototypes has already lost its references when it is visited.
+    for (auto prototype : m_prototypes | std::views::reverse) {
+        if (ObjectAccess::IsUnused(prototype)) {
+            ObjectAccess::DestroyPrototypeGraph(prototype);
+            objects.push_back(prototype);
+        }
+    }
+    std::erase_if(m_prototypes, unused);
+
+    for (auto mesh : m_meshes | std::views::filter(unused)) {
+        ObjectAccess::RemoveUse(mesh->GetVertexBuffer());
+        ObjectAccess::RemoveUse(mesh->GetIndexBuffer());
+        objects.push_back(mesh);
+    }
+    std::erase_if(m_meshes, unused);
+
+    for (auto material : m_materials | std::views::filter(unused)) {
+        if (auto texture = material->FindProperty<std::string>(kDiffuseTextureAtom)) {
+            released.textures.push_back(*texture);
+        }
+        released.materials.push_back(material->GetIndex());
+        objects.push_back(material);
+    }
+    std::erase_if(m_materials, unused);
+
+    for (auto shader : m_shaders) {
+        ObjectAccess::RemoveMaterialPtrs(shader);
+    }
+
+    m_free_material_indices.insert(m_free_material_indices.end(), released.materials.begin(), released.materials.end());
+
+    auto release_buffers = [&](auto& buffers) {
+        for (auto buffer : buffers | std::views::filter(unused)) {
+            released.buffers.push_back(buffer->GetID());
+            objects.push_back(buffer);
+        }
+        std::erase_if(buffers, unused);
+    };
+
+    release_buffers(m_vertex_buffers);
+    release_buffers(m_index_buffers);
+
+    for (auto shader : m_shaders | std::views::filter(unused)) {
+        objects.push_back(shader);
+    }
+    std::erase_if(m_shaders, unused);
+
+    // Every released asset has been unlinked from the assets that remain, so they can be destroyed in any order.
+    auto is_released = [&objects](const auto& owner) { return std::ranges::binary_search(objects, owner.get()); };
+
+    std::ranges::sort(objects);
+    std::erase_if(m_objects, is_released);
+
+    return released;
+}
+
+DrawList Scene::ComputeDrawList() const
+{
+    using namespace std::ranges;
+
+    ObjectAccess::UpdateBounds(m_root.get(), false);
 
-    auto out = AABB{ { FLT_MAX, FLT_MAX, FLT_MAX }, { FLT_MIN, FLT_MIN, FLT_MIN } };
+    auto root       = static_cast<const RootNode*>(m_root.get());
+    auto placements = ObjectAccess::ComputePlacements(root, m_prototypes);
+    auto draw_list  = DrawList{};
+    auto index      = size_t{ 0 };
 
     for (const auto& shader : m_shaders) {
         for (auto material : shader->GetMaterials()) {
             for (auto instance : material->GetInstanceNodes()) {
-                if (auto* mesh = instance->GetMeshPtr()) {
-                    auto model = instance->GetTransform();
-                    auto aabb  = mesh->GetBoundingBox();
-                    auto vec_a = model * glm::vec4(aabb.min.x, aabb.min.y, aabb.min.z, 1);
-                    auto vec_b = model * glm::vec4(aabb.max.x, aabb.max.y, aabb.max.z, 1);
-                    out.min.x  = std::min({ out.min.x, vec_a.x, vec_b.x });
-                    out.min.y  = std::min({ out.min.y, vec_a.y, vec_b.y });
-                    out.min.z  = std::min({ out.min.z, vec_a.z, vec_b.z });
-                    out.max.x  = std::max({ out.max.x, vec_a.x, vec_b.x });
-                    out.max.y  = std::max({ out.max.y, vec_a.y, vec_b.y });
-                    out.max.z  = std::max({ out.max.z, vec_a.z, vec_b.z });
+                auto mesh = instance->GetMeshPtr();
+                if (auto prototype = instance->GetPrototypePtr()) {
+                    for (const auto& placement : placements[prototype]) {
+                        draw_list.push_back({ index++, mesh, material, placement * instance->GetTransform() });
+                    }
+                } else {
+                    draw_list.push_back({ index++, mesh, material, instance->GetTransform() });
                 }
             }
         }
     }
 
-    return out;
+    return draw_list;
 }
 
-PropertyValue RootNode::GetProperty(std::string_view name) const
+AABB Scene::ComputeAxisAlignedBoundingBox() const
 {
-    return ObjectAccess::GetProperty(name, *this, std::make_tuple());
+    ObjectAccess::UpdateBounds(m_root.get(), false);
+
+    auto aabb = ObjectAccess::GetWorldBounds(m_root.get());
+
+    return aabb.IsEmpty() ? AABB{ { -1, -1, -1 }, { 1, 1, 1 } } : aabb;
 }
 
-PropertyValue RootNode::GetProperty(std::string_view primary, std::string_view alternative) const
+PropertyValue RootNode::GetProperty(PropertyAtom name) const
 {
-    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple());
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple());
 }
 
-std::vector<Property> RootNode::GetProperties() const
+PropertyValue RootNode::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
-    return ObjectAccess::GetProperties(this, std::make_tuple());
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple());
 }
 
-bool RootNode::SetProperty(std::string_view name, const PropertyValue& value)
+bool RootNode::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
     return ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
 }
 
-bool RootNode::RemoveProperty(std::string_view name)
+bool RootNode::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
@@ -534,149 +1977,212 @@ json RootNode::ToJson() const
     return json;
 }
 
-void RootNode::ApplyTransform(const glm::mat4& matrix) noexcept
+PropertyValue GroupNode::GetProperty(PropertyAtom name) const
+{
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple());
+}
+
+PropertyValue GroupNode::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
+{
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple());
+}
+
+bool GroupNode::SetProperty(PropertyAtom name, const PropertyValue& value)
+{
+    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
+}
+
+bool GroupNode::RemoveProperty(PropertyAtom name)
+{
+    return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
+}
+
+json GroupNode::ToJson() const
+{
+    json json;
+
+    ObjectAccess::ThisToJson(this, json);
+    ObjectAccess::ChildrenToJson(m_children, json);
+
+    return json;
+}
+
+bool InstanceNode::IsAncestor(NodePtr node) const
+{
+    return ObjectAccess::IsAncestor(this, node);
+}
+
+json InstanceNode::ToJson() const
+{
+    json json;
+
+    ObjectAccess::ThisToJson(this, json);
+
+    json["value.ref.mesh"]     = m_mesh->GetID();
+    json["value.ref.material"] = m_material->GetID();
+
+    return json;
+}
+
+InstanceNode::~InstanceNode() noexcept
 {
-    for (auto& node : m_children) {
-        ObjectAccess::ApplyTransform(static_cast<NodePtr>(node.get()), matrix);
+    if (m_material) {
+        m_material->RemoveInstance(this);
     }
+    ObjectAccess::RemoveUse(m_mesh);
 }
 
-PropertyValue GroupNode::GetProperty(std::string_view name) const
+PropertyValue InstanceNode::GetProperty(PropertyAtom name) const
 {
-    return ObjectAccess::GetProperty(name, *this, std::make_tuple());
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_mesh, m_material));
 }
 
-PropertyValue GroupNode::GetProperty(std::string_view primary, std::string_view alternative) const
+PropertyValue InstanceNode::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
-    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple());
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_mesh, m_material));
 }
 
-std::vector<Property> GroupNode::GetProperties() const
+bool InstanceNode::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
-    return ObjectAccess::GetProperties(this, std::make_tuple());
+    auto mesh     = static_cast<ObjectPtr>(m_mesh);
+    auto material = static_cast<ObjectPtr>(m_material);
+    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&mesh, &material));
 }
 
-bool GroupNode::SetProperty(std::string_view name, const PropertyValue& value)
+bool InstanceNode::RemoveProperty(PropertyAtom name)
 {
-    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
+    return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
 
-bool GroupNode::RemoveProperty(std::string_view name)
+NodePtr InstanceNode::AttachNode(UniqueNode /*node*/)
 {
-    return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
+    utils::throw_runtime_error("Cannot attach node: cannot attach to leaf node");
+    return nullptr;
 }
 
-json GroupNode::ToJson() const
+UniqueNode InstanceNode::DetachNode()
 {
-    json json;
-
-    ObjectAccess::ThisToJson(this, json);
-    ObjectAccess::ChildrenToJson(m_children, json);
-
-    return json;
+    return ObjectAccess::DetachNode(this);
 }
 
-void GroupNode::ApplyTransform(const glm::mat4& matrix) noexcept
+InstanceNode::InstanceNode(ID id, NodePtr parent, MeshPtr mesh, MaterialPtr material) noexcept
+    : Node(id, parent), m_mesh(mesh), m_material(material)
 {
-    for (auto& node : m_children) {
-        ObjectAccess::ApplyTransform(static_cast<NodePtr>(node.get()), matrix);
-    }
+    ObjectAccess::AddInstancePtr(this, material);
+    ObjectAccess::AddUse(mesh);
 }
 
-bool InstanceNode::IsAncestor(NodePtr node) const
+bool ReferenceNode::IsAncestor(NodePtr node) const
 {
     return ObjectAccess::IsAncestor(this, node);
 }
 
-json InstanceNode::ToJson() const
+json ReferenceNode::ToJson() const
 {
     json json;
 
     ObjectAccess::ThisToJson(this, json);
 
-    json["value.ref.mesh"]     = m_mesh->GetID();
-    json["value.ref.material"] = m_material->GetID();
+    json["value.ref.prototype"] = m_prototype->GetID();
 
     return json;
 }
 
-InstanceNode::~InstanceNode() noexcept
-{
-    if (m_material) {
-        m_material->RemoveInstance(this);
-    }
-}
-
-PropertyValue InstanceNode::GetProperty(std::string_view name) const
+ReferenceNode::~ReferenceNode() noexcept
 {
-    return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_mesh, m_material));
+    ObjectAccess::RemoveReferencePtr(this, m_prototype);
 }
 
-PropertyValue InstanceNode::GetProperty(std::string_view primary, std::string_view alternative) const
+PropertyValue ReferenceNode::GetProperty(PropertyAtom name) const
 {
-    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_mesh, m_material));
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_prototype));
 }
 
-std::vector<Property> InstanceNode::GetProperties() const
+PropertyValue ReferenceNode::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
-    return ObjectAccess::GetProperties(this, std::make_tuple(m_mesh, m_material));
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_prototype));
 }
 
-bool InstanceNode::SetProperty(std::string_view name, const PropertyValue& value)
+bool ReferenceNode::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
-    auto mesh     = static_cast<ObjectPtr>(m_mesh);
-    auto material = static_cast<ObjectPtr>(m_material);
-    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&mesh, &material));
+    auto prototype = static_cast<ObjectPtr>(m_prototype);
+    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&prototype));
 }
 
-bool InstanceNode::RemoveProperty(std::string_view name)
+bool ReferenceNode::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
 
-NodePtr InstanceNode::AttachNode(UniqueNode /*node*/)
+NodePtr ReferenceNode::AttachNode(UniqueNode /*node*/)
 {
     utils::throw_runtime_error("Cannot attach node: cannot attach to leaf node");
     return nullptr;
 }
 
-UniqueNode InstanceNode::DetachNode()
+UniqueNode ReferenceNode::DetachNode()
 {
     return ObjectAccess::DetachNode(this);
 }
 
-void InstanceNode::ApplyTransform(const glm::mat4& matrix) noexcept
+ReferenceNode::ReferenceNode(ID id, NodePtr parent, PrototypePtr prototype) noexcept
+    : Node(id, parent), m_prototype(prototype)
 {
-    m_transform = matrix;
+    ObjectAccess::AddReferencePtr(this, prototype);
 }
 
-InstanceNode::InstanceNode(ID id, NodePtr parent, MeshPtr mesh, MaterialPtr material) noexcept
-    : Node(id, parent), m_mesh(mesh), m_material(material)
+PropertyValue Prototype::GetProperty(PropertyAtom name) const
 {
-    ObjectAccess::AddInstancePtr(this, material);
+    auto references = utils::narrow_cast<int>(m_references.size());
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple(GetRootNode(), references));
 }
 
-PropertyValue TranslateNode::GetProperty(std::string_view name) const
+PropertyValue Prototype::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
-    return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_distance));
+    auto references = utils::narrow_cast<int>(m_references.size());
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(GetRootNode(), references));
 }
 
-PropertyValue TranslateNode::GetProperty(std::string_view primary, std::string_view alternative) const
+bool Prototype::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
-    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_distance));
+    auto root       = static_cast<ObjectPtr>(GetRootNode());
+    auto references = utils::narrow_cast<int>(m_references.size());
+    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&root, &references));
+}
+
+bool Prototype::RemoveProperty(PropertyAtom name)
+{
+    return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
+}
+
+json Prototype::ToJson() const
+{
+    json json;
+
+    ObjectAccess::ThisToJson(this, json);
+
+    json["graph"]                = m_root->ToJson();
+    json["value.ref.references"] = m_references;
+
+    return json;
 }
 
-std::vector<Property> TranslateNode::GetProperties() const
+PropertyValue TranslateNode::GetProperty(PropertyAtom name) const
 {
-    return ObjectAccess::GetProperties(this, std::make_tuple(m_distance));
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_distance));
+}
+
+PropertyValue TranslateNode::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
+{
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_distance));
 }
 
-bool TranslateNode::SetProperty(std::string_view name, const PropertyValue& value)
+bool TranslateNode::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
     return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&m_distance));
 }
 
-bool TranslateNode::RemoveProperty(std::string_view name)
+bool TranslateNode::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
@@ -693,36 +2199,27 @@ json TranslateNode::ToJson() const
     return json;
 }
 
-void TranslateNode::ApplyTransform(const glm::mat4& matrix) noexcept
+glm::mat4 TranslateNode::GetLocalTransform() const noexcept
 {
-    for (auto& node : m_children) {
-        auto node_ptr = static_cast<NodePtr>(node.get());
-        auto distance = glm::vec3(m_distance.x, m_distance.y, m_distance.z);
-        ObjectAccess::ApplyTransform(node_ptr, matrix * glm::translate(distance));
-    }
+    return glm::translate(glm::vec3(m_distance.x, m_distance.y, m_distance.z));
 }
 
-PropertyValue RotateNode::GetProperty(std::string_view name) const
+PropertyValue RotateNode::GetProperty(PropertyAtom name) const
 {
     return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_axis, m_angle.value));
 }
 
-PropertyValue RotateNode::GetProperty(std::string_view primary, std::string_view alternative) const
+PropertyValue RotateNode::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
     return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_axis, m_angle.value));
 }
 
-std::vector<Property> RotateNode::GetProperties() const
-{
-    return ObjectAccess::GetProperties(this, std::make_tuple(m_axis, m_angle.value));
-}
-
-bool RotateNode::SetProperty(std::string_view name, const PropertyValue& value)
+bool RotateNode::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
     return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&m_axis, &m_angle.value));
 }
 
-bool RotateNode::RemoveProperty(std::string_view name)
+bool RotateNode::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
@@ -739,36 +2236,27 @@ json RotateNode::ToJson() const
     return json;
 }
 
-void RotateNode::ApplyTransform(const glm::mat4& matrix) noexcept
+glm::mat4 RotateNode::GetLocalTransform() const noexcept
 {
-    for (auto& node : m_children) {
-        auto node_ptr = static_cast<NodePtr>(node.get());
-        auto axis     = glm::vec3(m_axis.x, m_axis.y, m_axis.z);
-        ObjectAccess::ApplyTransform(node_ptr, matrix * glm::rotate(m_angle.value, axis));
-    }
+    return glm::rotate(m_angle.value, glm::vec3(m_axis.x, m_axis.y, m_axis.z));
 }
 
-PropertyValue ScaleNode::GetProperty(std::string_view name) const
+PropertyValue ScaleNode::GetProperty(PropertyAtom name) const
 {
     return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_factor));
 }
 
-PropertyValue ScaleNode::GetProperty(std::string_view primary, std::string_view alternative) const
+PropertyValue ScaleNode::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
     return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_factor));
 }
 
-std::vector<Property> ScaleNode::GetProperties() const
-{
-    return ObjectAccess::GetProperties(this, std::make_tuple(m_factor));
-}
-
-bool ScaleNode::SetProperty(std::string_view name, const PropertyValue& value)
+bool ScaleNode::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
     return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&m_factor));
 }
 
-bool ScaleNode::RemoveProperty(std::string_view name)
+bool ScaleNode::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
@@ -785,12 +2273,9 @@ json ScaleNode::ToJson() const
     return json;
 }
 
-void ScaleNode::ApplyTransform(const glm::mat4& matrix) noexcept
+glm::mat4 ScaleNode::GetLocalTransform() const noexcept
 {
-    for (auto& node : m_children) {
-        auto node_ptr = static_cast<NodePtr>(node.get());
-        ObjectAccess::ApplyTransform(node_ptr, matrix * glm::scale(glm::vec3{ m_factor, m_factor, m_factor }));
-    }
+    return glm::scale(glm::vec3{ m_factor, m_factor, m_factor });
 }
 
 RootNodePtr Scene::GetRootNode() noexcept
@@ -800,84 +2285,361 @@ RootNodePtr Scene::GetRootNode() noexcept
 
 UniqueGroupNode Scene::CreateGroupNode()
 {
-    return ObjectAccess::MakeUnique<GroupNode>(GetUniqueID(), NullParent);
+    return m_storage->Create<GroupNode>(NullParent);
 }
 
 UniqueTranslateNode Scene::CreateTranslateNode(Float3 distance)
 {
-    return ObjectAccess::MakeUnique<TranslateNode>(GetUniqueID(), NullParent, distance);
+    return m_storage->Create<TranslateNode>(NullParent, distance);
 }
 
 UniqueRotateNode Scene::CreateRotateNode(Float3 axis, Radians angle)
 {
-    return ObjectAccess::MakeUnique<RotateNode>(GetUniqueID(), NullParent, axis, angle);
+    return m_storage->Create<RotateNode>(NullParent, axis, angle);
 }
 
 UniqueScaleNode Scene::CreateScaleNode(float factor)
 {
-    return ObjectAccess::MakeUnique<ScaleNode>(GetUniqueID(), NullParent, factor);
+    return m_storage->Create<ScaleNode>(NullParent, factor);
 }
 
 UniqueInstanceNode Scene::CreateInstanceNode(MeshPtr mesh, MaterialPtr material)
 {
-    return ObjectAccess::MakeUnique<InstanceNode>(GetUniqueID(), NullParent, mesh, material);
+    return m_storage->Create<InstanceNode>(NullParent, mesh, material);
+}
+
+UniqueReferenceNode Scene::CreateReferenceNode(PrototypePtr prototype)
+{
+    utils::throw_runtime_error_if(prototype == nullptr, "Cannot create reference node: prototype is missing");
+    return m_storage->Create<ReferenceNode>(NullParent, prototype);
+}
+
+PrototypePtr Scene::CreatePrototype(UniqueNode root)
+{
+    utils::throw_runtime_error_if(root == nullptr, "Cannot create prototype: root node is missing");
+    utils::throw_runtime_error_if(root->IsRoot(), "Cannot create prototype: scene root cannot be shared");
+    utils::throw_runtime_error_if(root->GetParent(), "Cannot create prototype: root node is attached");
+    utils::throw_runtime_error_if(root->GetPrototypePtr(), "Cannot create prototype: root node is already shared");
+
+    auto owner     = m_storage->Create<Prototype>(std::move(root));
+    auto prototype = owner.get();
+    m_objects.push_back(std::move(owner));
+    m_prototypes.push_back(prototype);
+    ObjectAccess::SealPrototype(prototype);
+    return prototype;
 }
 
 VertexBufferPtr Scene::CreateVertexBuffer(void* data, size_t size, std::align_val_t alignment)
 {
-    auto temp_owner    = ObjectAccess::MakeUnique<VertexBuffer>(GetUniqueID(), data, size, alignment);
-    auto vertex_buffer = temp_owner.release();
-    m_objects.insert({ vertex_buffer->GetID(), std::unique_ptr<Object>(vertex_buffer) });
+    auto owner         = m_storage->Create<VertexBuffer>(data, size, alignment);
+    auto vertex_buffer = owner.get();
+    m_objects.push_back(std::move(owner));
     m_vertex_buffers.push_back(vertex_buffer);
     return vertex_buffer;
 }
 
 IndexBufferPtr Scene::CreateIndexBuffer(void* data, size_t size, std::align_val_t alignment)
 {
-    auto temp_owner   = ObjectAccess::MakeUnique<IndexBuffer>(GetUniqueID(), data, size, alignment);
-    auto index_buffer = temp_owner.release();
-    m_objects.insert({ index_buffer->GetID(), std::unique_ptr<Object>(index_buffer) });
+    auto owner        = m_storage->Create<IndexBuffer>(data, size, alignment);
+    auto index_buffer = owner.get();
+    m_objects.push_back(std::move(owner));
+    m_index_buffers.push_back(index_buffer);
+    return index_buffer;
+}
+
+VertexBufferPtr Scene::CreateVertexBuffer(Buffer::UniqueData data, size_t size)
+{
+    auto owner         = m_storage->Create<VertexBuffer>(std::move(data), size);
+    auto vertex_buffer = owner.get();
+    m_objects.push_back(std::move(owner));
+    m_vertex_buffers.push_back(vertex_buffer);
+    return vertex_buffer;
+}
+
+IndexBufferPtr Scene::CreateIndexBuffer(Buffer::UniqueData data, size_t size)
+{
+    auto owner        = m_storage->Create<IndexBuffer>(std::move(data), size);
+    auto index_buffer = owner.get();
+    m_objects.push_back(std::move(owner));
     m_index_buffers.push_back(index_buffer);
     return index_buffer;
 }
 
 ShaderPtr Scene::CreateShader()
 {
-    auto temp_owner = ObjectAccess::MakeUnique<Shader>(GetUniqueID());
-    auto shader     = temp_owner.release();
-    m_objects.insert({ shader->GetID(), std::unique_ptr<Object>(shader) });
+    auto owner  = m_storage->Create<Shader>();
+    auto shader = owner.get();
+    m_objects.push_back(std::move(owner));
     m_shaders.push_back(shader);
     return shader;
 }
 
 MaterialPtr Scene::CreateMaterial(ShaderPtr shader)
 {
-    auto temp_owner = ObjectAccess::MakeUnique<Material>(GetUniqueID());
-    auto material   = temp_owner.release();
-    m_objects.insert({ material->GetID(), std::unique_ptr<Object>(material) });
+    auto index = utils::narrow_cast<uint32_t>(m_materials.size());
+
+    if (!m_free_material_indices.empty()) {
+        index = m_free_material_indices.back();
+        m_free_material_indices.pop_back();
+    }
+
+    auto owner    = m_storage->Create<Material>(index);
+    auto material = owner.get();
+    m_objects.push_back(std::move(owner));
     m_materials.push_back(material);
     ObjectAccess::AddMaterialPtr(shader, material);
     return material;
 }
 
 MeshPtr Scene::CreateMesh(
-    AABB            aabb,
-    VertexBufferPtr vertex_buffer,
-    IndexBufferPtr  index_buffer,
-    size_t          first_index,
-    size_t          index_count)
-{
-    auto unique_mesh =
-        ObjectAccess::MakeUnique<Mesh>(GetUniqueID(), aabb, vertex_buffer, index_buffer, first_index, index_count);
-    auto mesh = unique_mesh.release();
-    if (auto [it, success] = m_objects.insert({ mesh->GetID(), std::unique_ptr<Object>(mesh) }); !success) {
-        utils::throw_runtime_error("Cannot create mesh");
-        return {};
-    }
+    AABB                 aabb,
+    VertexBufferPtr      vertex_buffer,
+    IndexBufferPtr       index_buffer,
+    size_t               first_index,
+    size_t               index_count,
+    std::vector<Meshlet> meshlets)
+{
+    ObjectAccess::CheckMeshlets(meshlets, index_count);
+
+    auto owner = m_storage->Create<Mesh>(
+        aabb,
+        vertex_buffer,
+        index_buffer,
+        first_index,
+        index_count,
+        std::move(meshlets),
+        std::vector<PointNode>{});
+    auto mesh  = owner.get();
+    m_objects.push_back(std::move(owner));
+    m_meshes.push_back(mesh);
+    ObjectAccess::AddUse(vertex_buffer);
+    ObjectAccess::AddUse(index_buffer);
+    return mesh;
+}
+
+MeshPtr Scene::CreatePointCloud(
+    AABB                   aabb,
+    VertexBufferPtr        vertex_buffer,
+    IndexBufferPtr         index_buffer,
+    size_t                 first_index,
+    size_t                 index_count,
+    std::vector<PointNode> nodes)
+{
+    ObjectAccess::CheckPointNodes(nodes, index_count);
+
+    auto owner = m_storage->Create<Mesh>(
+        aabb,
+        vertex_buffer,
+        index_buffer,
+        first_index,
+        index_count,
+        std::vector<Meshlet>{},
+        std::move(nodes));
+    auto mesh  = owner.get();
+    m_objects.push_back(std::move(owner));
     m_meshes.push_back(mesh);
+    ObjectAccess::AddUse(vertex_buffer);
+    ObjectAccess::AddUse(index_buffer);
     return mesh;
 }
 
+Nodes Scene::Commit(SceneBuilder&& builder, NodePtr parent)
+{
+    parent = parent ? parent : m_root.get();
+
+    utils::throw_runtime_error_if(!parent->IsInner(), "Cannot commit scene builder: parent cannot have children");
+    utils::throw_runtime_error_if(
+        parent->GetPrototypePtr(),
+        "Cannot commit scene builder: prototype nodes cannot be changed");
+
+    auto records = std::exchange(builder.m_records, {});
+    auto commit  = BuilderCommit(m_storage.get(), m_free_material_indices, m_materials.size());
+
+    commit.objects.reserve(records.size());
+    for (auto& record : records) {
+        commit.Create(record);
+    }
+
+    // Every object exists, so the scene can take them over; after the reservations nothing below throws until the
+    // graphs are attached.
+    auto reserve = [](auto& to, const auto& from) { to.reserve(to.size() + from.size()); };
+    auto append  = [](auto& to, auto& from) { std::ranges::move(from, std::back_inserter(to)); };
+
+    reserve(m_objects, commit.assets);
+    reserve(m_shaders, commit.shaders);
+    reserve(m_materials, commit.materials);
+    reserve(m_meshes, commit.meshes);
+    reserve(m_vertex_buffers, commit.vertex_buffers);
+    reserve(m_index_buffers, commit.index_buffers);
+
+    auto nodes = Nodes();
+    nodes.reserve(commit.graphs.size());
+
+    append(m_objects, commit.assets);
+    append(m_shaders, commit.shaders);
+    append(m_materials, commit.materials);
+    append(m_meshes, commit.meshes);
+    append(m_vertex_buffers, commit.vertex_buffers);
+    append(m_index_buffers, commit.index_buffers);
+
+    auto reused = std::min(m_free_material_indices.size(), commit.materials.size());
+    m_free_material_indices.resize(m_free_material_indices.size() - reused);
+
+    for (auto& graph : commit.graphs) {
+        nodes.push_back(parent->AttachNode(std::move(graph)));
+    }
+
+    return nodes;
+}
+
+SceneBuilder::SceneBuilder() noexcept = default;
+
+SceneBuilder::SceneBuilder(SceneBuilder&&) noexcept = default;
+
+SceneBuilder& SceneBuilder::operator=(SceneBuilder&&) noexcept = default;
+
+SceneBuilder::~SceneBuilder() noexcept = default;
+
+SceneBuilder::Handle SceneBuilder::AddVertexBuffer(const void* data, size_t size, std::align_val_t alignment)
+{
+    return Add({ BuilderVertexBuffer{ ObjectAccess::CopyBufferData(data, size, alignment), size, {} } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddIndexBuffer(const void* data, size_t size, std::align_val_t alignment)
+{
+    return Add({ BuilderIndexBuffer{ ObjectAccess::CopyBufferData(data, size, alignment), size, {} } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddVertexBuffer(Buffer::UniqueData data, size_t size)
+{
+    return Add({ BuilderVertexBuffer{ std::move(data), size, {} } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddIndexBuffer(Buffer::UniqueData data, size_t size)
+{
+    return Add({ BuilderIndexBuffer{ std::move(data), size, {} } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddVertexBuffer(Buffer::Source source, size_t size, std::align_val_t alignment)
+{
+    return Add({ BuilderVertexBuffer{ { nullptr, Buffer::Deleter{ alignment } }, size, std::move(source) } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddIndexBuffer(Buffer::Source source, size_t size, std::align_val_t alignment)
+{
+    return Add({ BuilderIndexBuffer{ { nullptr, Buffer::Deleter{ alignment } }, size, std::move(source) } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddShader()
+{
+    return Add({ BuilderShader{} });
+}
+
+SceneBuilder::Handle SceneBuilder::AddMaterial(Handle shader)
+{
+    utils::throw_runtime_error_if(!Holds<BuilderShader>(m_records, shader), "Cannot add material: shader is missing");
+    return Add({ BuilderMaterial{ shader } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddMesh(
+    AABB                 aabb,
+    Handle               vertex_buffer,
+    Handle               index_buffer,
+    size_t               first_index,
+    size_t               index_count,
+    std::vector<Meshlet> meshlets)
+{
+    utils::throw_runtime_error_if(
+        !Holds<BuilderVertexBuffer>(m_records, vertex_buffer),
+        "Cannot add mesh: vertex buffer is missing");
+    utils::throw_runtime_error_if(
+        !Holds<BuilderIndexBuffer>(m_records, index_buffer),
+        "Cannot add mesh: index buffer is missing");
+    ObjectAccess::CheckMeshlets(meshlets, index_count);
+    return Add({ BuilderMesh{ aabb, vertex_buffer, index_buffer, first_index, index_count, std::move(meshlets), {} } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddPointCloud(
+    AABB                   aabb,
+    Handle                 vertex_buffer,
+    Handle                 index_buffer,
+    size_t                 first_index,
+    size_t                 index_count,
+    std::vector<PointNode> nodes)
+{
+    utils::throw_runtime_error_if(
+        !Holds<BuilderVertexBuffer>(m_records, vertex_buffer),
+        "Cannot add point cloud: vertex buffer is missing");
+    utils::throw_runtime_error_if(
+        !Holds<BuilderIndexBuffer>(m_records, index_buffer),
+        "Cannot add point cloud: index buffer is missing");
+    ObjectAccess::CheckPointNodes(nodes, index_count);
+    return Add({ BuilderMesh{ aabb, vertex_buffer, index_buffer, first_index, index_count, {}, std::move(nodes) } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddGroupNode(Handle parent)
+{
+    return AddNode(parent, { BuilderGroupNode{} });
+}
+
+SceneBuilder::Handle SceneBuilder::AddTranslateNode(Handle parent, Float3 distance)
+{
+    return AddNode(parent, { BuilderTranslateNode{ distance } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddRotateNode(Handle parent, Float3 axis, Radians angle)
+{
+    return AddNode(parent, { BuilderRotateNode{ axis, angle } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddScaleNode(Handle parent, float factor)
+{
+    return AddNode(parent, { BuilderScaleNode{ factor } });
+}
+
+SceneBuilder::Handle SceneBuilder::AddInstanceNode(Handle parent, Handle mesh, Handle material)
+{
+    utils::throw_runtime_error_if(!Holds<BuilderMesh>(m_records, mesh), "Cannot add instance node: mesh is missing");
+    utils::throw_runtime_error_if(
+        !Holds<BuilderMaterial>(m_records, material),
+        "Cannot add instance node: material is missing");
+    return AddNode(parent, { BuilderInstanceNode{ mesh, material } });
+}
+
+void SceneBuilder::SetProperty(Handle object, PropertyAtom name, PropertyValue value)
+{
+    utils::throw_runtime_error_if(object >= m_records.size(), "Cannot set property: object is missing");
+    utils::throw_runtime_error_if(
+        std::holds_alternative<ObjectPtr>(value),
+        "Cannot set property: builder objects cannot refer to scene objects");
+    m_records[object].properties.emplace_back(name, std::move(value));
+}
+
+size_t SceneBuilder::GetRecordCount() const noexcept
+{
+    return m_records.size();
+}
+
+SceneBuilder::Handle SceneBuilder::Add(BuilderRecord record)
+{
+    auto handle = utils::narrow_cast<Handle>(m_records.size());
+    utils::throw_runtime_error_if(handle == kNoParent, "Cannot add object: builder is full");
+    m_records.push_back(std::move(record));
+    return handle;
+}
+
+SceneBuilder::Handle SceneBuilder::AddNode(Handle parent, BuilderRecord record)
+{
+    auto is_inner = Holds<BuilderGroupNode, BuilderTranslateNode, BuilderRotateNode, BuilderScaleNode>;
+
+    utils::throw_runtime_error_if(
+        parent != kNoParent && !is_inner(m_records, parent),
+        "Cannot add node: parent cannot have children");
+
+    record.parent = parent;
+    return Add(std::move(record));
+}
+
 json Scene::ToJson() const
 {
     json json;
@@ -886,36 +2648,128 @@ json Scene::ToJson() const
     json["index-buffers"]  = nlohmann::json(m_index_buffers);
     json["materials"]      = nlohmann::json(m_materials);
     json["meshes"]         = nlohmann::json(m_meshes);
+    json["prototypes"]     = nlohmann::json(m_prototypes);
     json["shaders"]        = nlohmann::json(m_shaders);
     json["vertex-buffers"] = nlohmann::json(m_vertex_buffers);
 
     return json;
 }
 
+void Scene::Save(std::ostream& records, std::ostream& blob) const
+{
+    auto writer  = SceneWriter(records, blob);
+    auto shaders = std::unordered_map<MaterialPtr, ShaderPtr>{};
+
+    for (auto shader : m_shaders) {
+        for (auto material : shader->GetMaterials()) {
+            shaders[material] = shader;
+        }
+    }
+
+    writer.Begin();
+
+    for (auto vertex_buffer : m_vertex_buffers) {
+        writer.WriteBuffer(vertex_buffer, 0);
+    }
+    for (auto index_buffer : m_index_buffers) {
+        writer.WriteBuffer(index_buffer, sizeof(uint32_t));
+    }
+    for (auto shader : m_shaders) {
+        writer.BeginRecord(shader);
+        writer.EndRecord();
+    }
+    for (auto material : m_materials) {
+        writer.BeginRecord(material);
+        writer.Member("shader");
+        writer.Reference(shaders[material]);
+        writer.EndRecord();
+    }
+    for (auto mesh : m_meshes) {
+        writer.BeginRecord(mesh);
+        writer.Member("min");
+        writer.Vector(mesh->GetBoundingBox().min);
+        writer.Member("max");
+        writer.Vector(mesh->GetBoundingBox().max);
+        writer.Member("vertex-buffer");
+        writer.Reference(mesh->GetVertexBuffer());
+        writer.Member("index-buffer");
+        writer.Reference(mesh->GetIndexBuffer());
+        writer.Member("first-index");
+        writer.Number(mesh->GetFirstIndex());
+        writer.Member("index-count");
+        writer.Number(mesh->GetIndexCount());
+        if (!mesh->GetMeshlets().empty()) {
+            writer.Member("meshlets");
+            writer.Records(mesh->GetMeshlets());
+        }
+        if (!mesh->GetPointNodes().empty()) {
+            writer.Member("points");
+            writer.Records(mesh->GetPointNodes());
+        }
+        writer.EndRecord();
+    }
+    for (auto prototype : m_prototypes) {
+        writer.WriteGraph(prototype->GetRootNode());
+        writer.BeginRecord(prototype);
+        writer.Member("root");
+        writer.Reference(prototype->GetRootNode());
+        writer.EndRecord();
+    }
+
+    writer.WriteGraph(m_root.get());
+    writer.End();
+}
+
+void Scene::Load(std::istream& records, std::istream& blob)
+{
+    auto reader = SceneReader(this, blob);
+
+    utils::throw_runtime_error_if(!json::sax_parse(records, &reader), "Cannot load scene: records are not valid JSON");
+
+    reader.Finish();
+}
+
 Scene::~Scene()
-{}
+{
+    Destroy();
+}
 
-PropertyValue Shader::GetProperty(std::string_view /*name*/) const
+void Scene::Destroy() noexcept
 {
-    return {}; // TODO
+    // References unregister from their prototype and instances from their material, so the graphs go first and
+    // a prototype graph goes before the prototypes it references.
+    m_root.reset();
+    for (auto prototype : m_prototypes | std::views::reverse) {
+        ObjectAccess::DestroyPrototypeGraph(prototype);
+    }
+
+    m_objects.clear();
+    m_shaders.clear();
+    m_materials.clear();
+    m_meshes.clear();
+    m_prototypes.clear();
+    m_vertex_buffers.clear();
+    m_index_buffers.clear();
+    m_free_material_indices.clear();
+    m_storage.reset();
 }
 
-PropertyValue Shader::GetProperty(std::string_view /*primary*/, std::string_view /*alternative*/) const
+PropertyValue Shader::GetProperty(PropertyAtom name) const
 {
-    return {}; // TODO
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple());
 }
 
-std::vector<Property> Shader::GetProperties() const
+PropertyValue Shader::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
-    return {}; // TODO
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple());
 }
 
-bool Shader::SetProperty(std::string_view /*name*/, const PropertyValue& /*value*/)
+bool Shader::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
-    return false; // TODO
+    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
 }
 
-bool Shader::RemoveProperty(std::string_view name)
+bool Shader::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
@@ -943,29 +2797,30 @@ void Shader::AddMaterialPtr(MaterialPtr material)
     m_materials.push_back(material);
 }
 
-PropertyValue Material::GetProperty(std::string_view name) const
+PropertyValue Material::GetProperty(PropertyAtom name) const
 {
     return ObjectAccess::GetProperty(name, *this, std::make_tuple());
 }
 
-PropertyValue Material::GetProperty(std::string_view primary, std::string_view alternative) const
+PropertyValue Material::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
     return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple());
 }
 
-std::vector<Property> Material::GetProperties() const
+bool Material::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
-    return ObjectAccess::GetProperties(this, std::make_tuple());
+    auto inserted = ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
+    m_revision++;
+    return inserted;
 }
 
-bool Material::SetProperty(std::string_view name, const PropertyValue& value)
+bool Material::RemoveProperty(PropertyAtom name)
 {
-    return ObjectAccess::SetProperty(*this, name, value, std::make_tuple());
-}
-
-bool Material::RemoveProperty(std::string_view name)
-{
-    return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
+    auto removed = ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
+    if (removed) {
+        m_revision++;
+    }
+    return removed;
 }
 
 json Material::ToJson() const
@@ -981,11 +2836,7 @@ json Material::ToJson() const
 
 bool Material::RemoveInstance(InstanceNodePtr node)
 {
-    if (auto it = std::ranges::find(m_instances, node); it != m_instances.end()) {
-        m_instances.erase(it);
-        return true;
-    }
-    return false;
+    return ObjectAccess::RemoveInstancePtr(node, this);
 }
 
 void Material::AddInstanceNodePtr(InstanceNodePtr instance_node)
@@ -994,33 +2845,105 @@ void Material::AddInstanceNodePtr(InstanceNodePtr instance_node)
 }
 
 Buffer::Buffer(ID id, void* src, size_t size, std::align_val_t alignment)
-    : Object(id), m_size(size), m_deleter{ alignment }
+    : Object(id), m_data(ObjectAccess::CopyBufferData(src, size, alignment)), m_size(size), m_deleter{ alignment }
+{}
+
+Buffer::Buffer(ID id, UniqueData data, size_t size) noexcept
+    : Object(id), m_data(std::move(data)), m_size(size), m_deleter(m_data.get_deleter())
+{}
+
+auto Buffer::Allocate(size_t size, std::align_val_t alignment) -> UniqueData
 {
-    m_data.reset(::operator new(m_size, alignment));
-    memcpy(m_data.get(), src, size);
+    return UniqueData(::operator new(size, alignment), Deleter{ alignment });
 }
 
-PropertyValue VertexBuffer::GetProperty(std::string_view name) const
+BufferResidency Buffer::GetResidency() const noexcept
 {
-    return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_size));
+    if (!m_encoded.empty()) {
+        return BufferResidency::Compressed;
+    }
+    return m_data || !m_source ? BufferResidency::Resident : BufferResidency::Released;
 }
 
-PropertyValue VertexBuffer::GetProperty(std::string_view primary, std::string_view alternative) const
+void Buffer::SetResidency(BufferResidency residency)
 {
-    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_size));
+    switch (residency) {
+    case BufferResidency::Resident: MakeResident(); break;
+    case BufferResidency::Compressed: Compress(); break;
+    case BufferResidency::Released: m_source ? Release() : Compress(); break;
+    }
 }
 
-std::vector<Property> VertexBuffer::GetProperties() const
+void Buffer::Compress(size_t stride)
 {
-    return ObjectAccess::GetProperties(this, std::make_tuple(m_size));
+    auto residency = GetResidency();
+
+    if (residency == BufferResidency::Compressed) {
+        return;
+    }
+    if (residency == BufferResidency::Released) {
+        MakeResident();
+    }
+
+    auto data = std::span(static_cast<const std::byte*>(m_data.get()), m_size);
+
+    m_encoded = utils::EncodeStream(data, stride ? stride : utils::FindStreamStride(data));
+    m_data.reset();
+}
+
+void Buffer::Release()
+{
+    utils::throw_runtime_error_if(!m_source, "Cannot release buffer: it has no source");
+
+    m_data.reset();
+    m_encoded = {};
+}
+
+void Buffer::MakeResident()
+{
+    if (GetResidency() == BufferResidency::Resident) {
+        return;
+    }
+
+    auto data = Allocate(m_size, m_deleter.alignment);
+
+    CopyTo(data.get());
+
+    m_data    = std::move(data);
+    m_encoded = {};
 }
 
-bool VertexBuffer::SetProperty(std::string_view name, const PropertyValue& value)
+void Buffer::CopyTo(void* dst) const
+{
+    switch (GetResidency()) {
+    case BufferResidency::Resident:
+        if (m_size) {
+            memcpy(dst, m_data.get(), m_size);
+        }
+        break;
+    case BufferResidency::Compressed:
+        utils::DecodeStream(m_encoded, std::span(static_cast<std::byte*>(dst), m_size));
+        break;
+    case BufferResidency::Released: m_source(std::span(static_cast<std::byte*>(dst), m_size)); break;
+    }
+}
+
+PropertyValue VertexBuffer::GetProperty(PropertyAtom name) const
+{
+    return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_size));
+}
+
+PropertyValue VertexBuffer::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
+{
+    return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_size));
+}
+
+bool VertexBuffer::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
     return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&m_size));
 }
 
-bool VertexBuffer::RemoveProperty(std::string_view name)
+bool VertexBuffer::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
@@ -1035,27 +2958,22 @@ json VertexBuffer::ToJson() const
     return json;
 }
 
-PropertyValue IndexBuffer::GetProperty(std::string_view name) const
+PropertyValue IndexBuffer::GetProperty(PropertyAtom name) const
 {
     return ObjectAccess::GetProperty(name, *this, std::make_tuple(m_size));
 }
 
-PropertyValue IndexBuffer::GetProperty(std::string_view primary, std::string_view alternative) const
+PropertyValue IndexBuffer::GetProperty(PropertyAtom primary, PropertyAtom alternative) const
 {
     return ObjectAccess::GetProperty(primary, alternative, *this, std::make_tuple(m_size));
 }
 
-std::vector<Property> IndexBuffer::GetProperties() const
-{
-    return ObjectAccess::GetProperties(this, std::make_tuple(m_size));
-}
-
-bool IndexBuffer::SetProperty(std::string_view name, const PropertyValue& value)
+bool IndexBuffer::SetProperty(PropertyAtom name, const PropertyValue& value)
 {
     return ObjectAccess::SetProperty(*this, name, value, std::make_tuple(&m_size));
 }
 
-bool IndexBuffer::RemoveProperty(std::string_view name)
+bool IndexBuffer::RemoveProperty(PropertyAtom name)
 {
     return ObjectAccess::RemoveProperty<kFieldNames.size()>(*this, name);
 }
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "platform.hpp"
+#include "utils/atom.hpp"
 #include "utils/cast.hpp"
+#include "utils/flat_map.hpp"
 #include "utils/math.hpp"
 #include "utils/misc.hpp"
+#include "utils/text_index.hpp"
 #include "vertex.hpp"
 
 BEGIN_DISABLE_WARNINGS
@@ -16,8 +19,13 @@ END_DISABLE_WARNINGS
 
 #include <nlohmann/json.hpp>
 
+#include <array>
+#include <functional>
+#include <iosfwd>
+#include <limits>
 #include <map>
 #include <memory>
+#include <span>
 #include <string_view>
 #include <variant>
 #include <vector>
@@ -31,6 +39,8 @@ class Material;
 class Mesh;
 class Node;
 class Object;
+class Prototype;
+class ReferenceNode;
 class RootNode;
 class RotateNode;
 class ScaleNode;
@@ -48,6 +58,8 @@ using MaterialPtr      = Material*;
 using MeshPtr          = Mesh*;
 using NodePtr          = Node*;
 using ObjectPtr        = Object*;
+using PrototypePtr     = Prototype*;
+using ReferenceNodePtr = ReferenceNode*;
 using RootNodePtr      = RootNode*;
 using RotateNodePtr    = RotateNode*;
 using ScaleNodePtr     = ScaleNode*;
@@ -56,47 +68,88 @@ using ShaderPtr        = Shader*;
 using TranslateNodePtr = TranslateNode*;
 using VertexBufferPtr  = VertexBuffer*;
 
-using UniqueBuffer        = std::unique_ptr<Buffer>;
-using UniqueGroupNode     = std::unique_ptr<GroupNode>;
-using UniqueInstanceNode  = std::unique_ptr<InstanceNode>;
-using UniqueMaterial      = std::unique_ptr<Material>;
-using UniqueMesh          = std::unique_ptr<Mesh>;
-using UniqueNode          = std::unique_ptr<Node>;
-using UniqueObject        = std::unique_ptr<Object>;
-using UniqueRotateNode    = std::unique_ptr<RotateNode>;
-using UniqueScaleNode     = std::unique_ptr<ScaleNode>;
-using UniqueShader        = std::unique_ptr<Shader>;
-using UniqueTranslateNode = std::unique_ptr<TranslateNode>;
-
-using Instances = std::vector<InstanceNodePtr>;
-using Materials = std::vector<MaterialPtr>;
-using Meshes    = std::vector<MeshPtr>;
-using Nodes     = std::vector<NodePtr>;
-using Shaders   = std::vector<ShaderPtr>;
+class ObjectStorage;
 
+// Returns a scene object to the typed pool it was allocated from. The destroy function is instantiated for the
+// concrete type at creation, so a unique pointer to a base class still releases the right pool block.
+struct ObjectDeleter final {
+    using DestroyFunction = void (*)(ObjectStorage*, Object*) noexcept;
+
+    ObjectStorage*  storage = nullptr;
+    DestroyFunction destroy = nullptr;
+
+    void operator()(Object* object) const noexcept { destroy(storage, object); }
+};
+
+using UniqueBuffer        = std::unique_ptr<Buffer, ObjectDeleter>;
+using UniqueGroupNode     = std::unique_ptr<GroupNode, ObjectDeleter>;
+using UniqueInstanceNode  = std::unique_ptr<InstanceNode, ObjectDeleter>;
+using UniqueMaterial      = std::unique_ptr<Material, ObjectDeleter>;
+using UniqueMesh          = std::unique_ptr<Mesh, ObjectDeleter>;
+using UniqueNode          = std::unique_ptr<Node, ObjectDeleter>;
+using UniqueObject        = std::unique_ptr<Object, ObjectDeleter>;
+using UniqueReferenceNode = std::unique_ptr<ReferenceNode, ObjectDeleter>;
+using UniqueRotateNode    = std::unique_ptr<RotateNode, ObjectDeleter>;
+using UniqueScaleNode     = std::unique_ptr<ScaleNode, ObjectDeleter>;
+using UniqueShader        = std::unique_ptr<Shader, ObjectDeleter>;
+using UniqueTranslateNode = std::unique_ptr<TranslateNode, ObjectDeleter>;
+
+using Instances  = std::vector<InstanceNodePtr>;
+using Materials  = std::vector<MaterialPtr>;
+using Meshes     = std::vector<MeshPtr>;
+using Nodes      = std::vector<NodePtr>;
+using References = std::vector<ReferenceNodePtr>;
+using Shaders    = std::vector<ShaderPtr>;
+
+// Generational handle of a scene object. The index is unique among live objects of a scene and is what gets shown
+// and serialized; the generation changes whenever the slot is reused, so an ID of a destroyed object never resolves
+// to a newer one. The default ID is invalid.
 struct ID final {
-    int value = 0;
+    uint32_t index      = 0;
+    uint32_t generation = 0;
 
     constexpr ID() noexcept = default;
-    constexpr ID(int value) noexcept : value(value) {}
+    constexpr ID(uint32_t index, uint32_t generation) noexcept : index(index), generation(generation) {}
 
-    constexpr operator int() const noexcept { return value; }
+    constexpr bool IsValid() const noexcept { return generation != 0; }
 
     constexpr bool operator==(const ID&) const noexcept = default;
+    constexpr auto operator<=>(const ID&) const noexcept = default;
 
     struct Hash {
-        constexpr size_t operator()(ID id) const noexcept { return static_cast<size_t>(id.value); }
+        constexpr size_t operator()(ID id) const noexcept
+        {
+            return static_cast<size_t>((uint64_t{ id.generation } << 32) | id.index);
+        }
     };
 };
 
-using PropertyName = std::string;
+using PropertyAtom = utils::Atom;
 using PropertyValue =
     std::variant<std::monostate, int32_t, int64_t, uint32_t, uint64_t, float, Float3, std::string, ObjectPtr>;
-using PropertyStore = std::map<PropertyName, PropertyValue>;
+using PropertyStore = utils::FlatMap<PropertyAtom, PropertyValue>;
+using Property      = PropertyStore::value_type;
+using PropertyView  = std::span<const Property>;
+
+inline constexpr auto kClassAtom          = PropertyAtom("_class");
+inline constexpr auto kDefaultNameAtom    = PropertyAtom("_name");
+inline constexpr auto kIdAtom             = PropertyAtom("_id");
+inline constexpr auto kNameAtom           = PropertyAtom("name");
+inline constexpr auto kDiffuseColorAtom   = PropertyAtom("diffuse.color");
+inline constexpr auto kDiffuseTextureAtom = PropertyAtom("diffuse.texture");
+
+inline constexpr auto kFieldAtoms = std::array{
+    PropertyAtom("field.1"),
+    PropertyAtom("field.2"),
+    PropertyAtom("field.3"),
+    PropertyAtom("field.4"),
+};
 
-struct Property final {
-    PropertyName  name;
-    PropertyValue value;
+inline constexpr auto kFieldMetaAtoms = std::array{
+    PropertyAtom("_field.1.meta"),
+    PropertyAtom("_field.2.meta"),
+    PropertyAtom("_field.3.meta"),
+    PropertyAtom("_field.4.meta"),
 };
 
 using json = nlohmann::json;
@@ -105,15 +158,27 @@ class Object {
   public:
     virtual ~Object() noexcept = default;
 
-    virtual auto GetProperty(std::string_view name) const -> PropertyValue                                  = 0;
-    virtual auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue = 0;
-    virtual auto GetProperties() const -> std::vector<Property>                                             = 0;
+    virtual auto GetProperty(PropertyAtom name) const -> PropertyValue                              = 0;
+    virtual auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue = 0;
 
-    virtual bool SetProperty(std::string_view name, const PropertyValue& value) = 0;
-    virtual bool RemoveProperty(std::string_view name)                          = 0;
+    virtual bool SetProperty(PropertyAtom name, const PropertyValue& value) = 0;
+    virtual bool RemoveProperty(PropertyAtom name)                          = 0;
 
     virtual auto ToJson() const -> json = 0;
 
+    // User properties in atom order, without the built-in and field properties. Neither call copies any values.
+    auto GetProperties() const noexcept -> PropertyView { return { m_properties.data(), m_properties.size() }; }
+    auto FindProperty(PropertyAtom name) const noexcept { return m_properties.Find(name); }
+
+    // User property holding a T, or null if it is not set or holds another type. Unlike GetProperty, strings are not
+    // copied.
+    template <typename T>
+    auto FindProperty(PropertyAtom name) const noexcept -> const T*
+    {
+        auto value = m_properties.Find(name);
+        return value ? std::get_if<T>(value) : nullptr;
+    }
+
     ID GetID() const noexcept { return m_id; }
 
   protected:
@@ -130,24 +195,62 @@ inline ID GetID(const Object* object) noexcept
     return object->GetID();
 }
 
+// Where the CPU copy of a buffer lives. A released buffer keeps only its source and refills itself from there.
+enum class BufferResidency { Resident, Compressed, Released };
+
 class Buffer : public Object {
   public:
+    struct Deleter final {
+        void             operator()(void* data) { ::operator delete(data, alignment); };
+        std::align_val_t alignment{};
+    };
+
+    using UniqueData = std::unique_ptr<void, Deleter>;
+
+    // Writes the buffer contents to dst, e.g. by reading them again from the file they were loaded from.
+    using Source = std::function<void(std::span<std::byte> dst)>;
+
+    // Lets loaders write straight into memory that the scene then adopts instead of copying.
+    static auto Allocate(size_t size, std::align_val_t alignment) -> UniqueData;
+
     Buffer(ID id) noexcept : Object(id) {}
 
     auto Data() const noexcept { return m_data.get(); }
     auto Size() const noexcept { return m_size; }
+    auto Alignment() const noexcept { return m_deleter.alignment; }
+    auto GetUseCount() const noexcept { return m_use_count; }
+
+    // Data() is null unless the buffer is resident. The CPU copy is only read when a buffer is uploaded or saved, so
+    // once it is on the GPU it can be compressed or, if it has a source, released.
+    auto GetResidency() const noexcept -> BufferResidency;
+    auto CompressedSize() const noexcept { return m_encoded.size(); }
+    bool HasSource() const noexcept { return static_cast<bool>(m_source); }
+
+    void SetSource(Source source) { m_source = std::move(source); }
+
+    // Buffers without a source cannot be released and are compressed instead.
+    void SetResidency(BufferResidency residency);
+
+    // A stride of 0 picks the element size that compresses best.
+    void Compress(size_t stride = 0);
+    void Release();
+    void MakeResident();
+
+    // Writes Size() bytes to dst, whatever the residency: copied, decoded in place or read from the source.
+    void CopyTo(void* dst) const;
 
   protected:
     Buffer(ID id, void* src, size_t size, std::align_val_t alignment);
+    Buffer(ID id, UniqueData data, size_t size) noexcept;
 
-    struct Deleter final {
-        void             operator()(void* data) { ::operator delete(data, alignment); };
-        std::align_val_t alignment{};
-    };
+    friend struct ObjectAccess;
 
-    std::unique_ptr<void, Deleter> m_data{};
+    UniqueData                     m_data{};
     size_t                         m_size{};
     Deleter                        m_deleter;
+    std::vector<std::byte>         m_encoded;
+    Source                         m_source;
+    uint32_t                       m_use_count = 0; // Meshes that draw from the buffer
 };
 
 class VertexBuffer final : public Buffer {
@@ -158,12 +261,11 @@ class VertexBuffer final : public Buffer {
     VertexBuffer(VertexBuffer&&) noexcept = default;
     VertexBuffer& operator=(VertexBuffer&&) noexcept = default;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     json ToJson() const override;
 
@@ -176,6 +278,7 @@ class VertexBuffer final : public Buffer {
     static constexpr std::array<bool, 1>             kFieldWritable = { false };
 
     VertexBuffer(ID id, void* src, size_t size, std::align_val_t alignment) : Buffer(id, src, size, alignment) {}
+    VertexBuffer(ID id, UniqueData data, size_t size) noexcept : Buffer(id, std::move(data), size) {}
 };
 
 class IndexBuffer final : public Buffer {
@@ -186,12 +289,11 @@ class IndexBuffer final : public Buffer {
     IndexBuffer(IndexBuffer&&) noexcept = default;
     IndexBuffer& operator=(IndexBuffer&&) noexcept = default;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     json ToJson() const override;
 
@@ -204,8 +306,37 @@ class IndexBuffer final : public Buffer {
     static constexpr std::array<bool, 1>             kFieldWritable = { false };
 
     IndexBuffer(ID id, void* src, size_t size, std::align_val_t alignment) : Buffer(id, src, size, alignment) {}
+    IndexBuffer(ID id, UniqueData data, size_t size) noexcept : Buffer(id, std::move(data), size) {}
 };
 
+// A cluster of triangles whose indices are contiguous in the index range of its mesh, so that it can be culled on its
+// own and drawn as an index range. See BuildMeshlets.
+struct Meshlet final {
+    static constexpr size_t kMaxVertices  = 64;
+    static constexpr size_t kMaxTriangles = 124;
+
+    Float3   center;        // Bounding sphere, in mesh space
+    float    radius{};
+    Float3   cone_axis;     // Average facing of the triangles
+    float    cone_cutoff{}; // Sine of the cone half-angle; 1 if the triangles face too many ways to be culled as one
+    uint32_t first_index{}; // Relative to the first index of the mesh
+    uint32_t index_count{};
+};
+
+// A node of the octree of a point cloud. Every point belongs to exactly one node; a node holds an evenly spaced sample
+// of the points in its cube, and its children add the points in between. See BuildPointOctree.
+struct PointNode final {
+    Float3   center;        // Bounding sphere, in mesh space
+    float    radius{};
+    float    spacing{};     // Distance between neighbouring points of the node
+    uint32_t first_index{}; // Relative to the first index of the mesh
+    uint32_t index_count{};
+    uint32_t first_child{}; // Children are stored next to each other, after their parent
+    uint32_t child_count{};
+};
+
+enum class MeshTopology { Triangles, Points };
+
 class Mesh : public Object {
   public:
     Mesh(const Mesh&) = delete;
@@ -214,18 +345,21 @@ class Mesh : public Object {
     Mesh(Mesh&&) noexcept = default;
     Mesh& operator=(Mesh&&) noexcept = default;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     auto GetBoundingBox() const noexcept { return m_aabb; }
     auto GetVertexBuffer() const noexcept { return m_vertex_buffer; }
     auto GetIndexBuffer() const noexcept { return m_index_buffer; }
     auto GetFirstIndex() const noexcept { return m_first_index; }
     auto GetIndexCount() const noexcept { return m_index_count; }
+    auto GetMeshlets() const noexcept { return std::span<const Meshlet>(m_meshlets); }
+    auto GetPointNodes() const noexcept { return std::span<const PointNode>(m_point_nodes); }
+    auto GetTopology() const noexcept { return m_point_nodes.empty() ? MeshTopology::Triangles : MeshTopology::Points; }
+    auto GetUseCount() const noexcept { return m_use_count; }
 
     json ToJson() const;
 
@@ -238,21 +372,27 @@ class Mesh : public Object {
     static constexpr std::array<bool, 3>             kFieldWritable = { false, false, false };
 
     Mesh(
-        ID              id,
-        AABB            aabb,
-        VertexBufferPtr vertex_buffer,
-        IndexBufferPtr  index_buffer,
-        size_t          first_index,
-        size_t          index_count) noexcept
+        ID                     id,
+        AABB                   aabb,
+        VertexBufferPtr        vertex_buffer,
+        IndexBufferPtr         index_buffer,
+        size_t                 first_index,
+        size_t                 index_count,
+        std::vector<Meshlet>   meshlets,
+        std::vector<PointNode> point_nodes) noexcept
         : Object(id), m_aabb(aabb), m_vertex_buffer(vertex_buffer), m_index_buffer(index_buffer),
-          m_first_index(first_index), m_index_count(index_count)
+          m_first_index(first_index), m_index_count(index_count), m_meshlets(std::move(meshlets)),
+          m_point_nodes(std::move(point_nodes))
     {}
 
-    AABB            m_aabb{};
-    VertexBufferPtr m_vertex_buffer;
-    IndexBufferPtr  m_index_buffer;
-    size_t          m_first_index;
-    size_t          m_index_count;
+    AABB                   m_aabb{};
+    VertexBufferPtr        m_vertex_buffer;
+    IndexBufferPtr         m_index_buffer;
+    size_t                 m_first_index;
+    size_t                 m_index_count;
+    std::vector<Meshlet>   m_meshlets;      // Empty if the mesh is drawn as a whole
+    std::vector<PointNode> m_point_nodes;   // Not empty if the mesh is a point cloud
+    uint32_t               m_use_count = 0; // Instances that draw the mesh
 };
 
 class Shader : public Object {
@@ -263,12 +403,11 @@ class Shader : public Object {
     Shader(Shader&&) = default;
     Shader& operator=(Shader&&) = default;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     auto GetMaterials() const -> Materials;
 
@@ -294,17 +433,19 @@ class Material final : public Object {
     Material(const Material&) = delete;
     Material& operator=(const Material&) = delete;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     json ToJson() const override;
 
     auto GetInstanceNodes() const { return m_instances; }
 
+    auto GetIndex() const noexcept { return m_index; }
+    auto GetRevision() const noexcept { return m_revision; }
+
     bool RemoveInstance(InstanceNodePtr node);
 
   private:
@@ -315,11 +456,13 @@ class Material final : public Object {
     static constexpr std::array<std::string_view, 0> kFieldNames    = {};
     static constexpr std::array<bool, 0>             kFieldWritable = {};
 
-    Material(ID id) noexcept : Object(id) {}
+    Material(ID id, uint32_t index) noexcept : Object(id), m_index(index) {}
 
     void AddInstanceNodePtr(InstanceNodePtr mesh_instance_node);
 
     Instances m_instances;
+    uint32_t  m_index    = 0;
+    uint64_t  m_revision = 1;
 };
 
 class Node : public Object {
@@ -330,18 +473,34 @@ class Node : public Object {
     virtual bool IsRoot() const                 = 0;
     virtual bool IsInner() const                = 0;
     virtual bool IsLeaf() const                 = 0;
+    virtual bool IsReference() const            = 0;
     virtual bool IsAncestor(NodePtr node) const = 0;
     virtual bool HasChildren() const            = 0;
     virtual auto GetChildren() const -> Nodes   = 0;
 
+    auto GetParent() const noexcept { return m_parent; }
+    auto GetPrototypePtr() const noexcept { return m_owner; }
+
+    // Increases with every child attached to the parent. Detaching reorders children, so views that list them in a
+    // stable order sort by it.
+    auto GetAttachOrder() const noexcept { return m_attach_order; }
+
   protected:
     friend struct ObjectAccess;
 
     Node(ID id, NodePtr parent) noexcept : Object(id), m_parent(parent) {}
 
-    virtual void ApplyTransform(const glm::mat4& matrix) noexcept = 0;
-
-    NodePtr m_parent = nullptr;
+    NodePtr      m_parent          = nullptr;
+    PrototypePtr m_owner           = nullptr; // Prototype whose subtree contains the node
+    size_t       m_child_index     = 0; // Position in the parent's children, so that detaching does not search
+    uint64_t     m_attach_order    = 0;
+    glm::mat4    m_world_transform = glm::mat4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+    AABB         m_world_bounds    = AABB::Empty(); // Bounds of the whole subtree in world space
+
+    // Bounds are refreshed lazily. A dirty subtree has a new world transform or new content and is recomputed in
+    // full; dirty bounds only mean that something below changed, so the refresh descends along dirty nodes.
+    bool m_subtree_dirty = true;
+    bool m_bounds_dirty  = true;
 };
 
 class InnerNode : public Node {
@@ -352,6 +511,7 @@ class InnerNode : public Node {
     bool IsRoot() const override { return false; }
     bool IsInner() const override { return true; }
     bool IsLeaf() const override { return false; }
+    bool IsReference() const override { return false; }
     bool IsAncestor(NodePtr node) const override;
     bool HasChildren() const override;
     auto GetChildren() const -> Nodes override;
@@ -361,7 +521,11 @@ class InnerNode : public Node {
 
     InnerNode(ID id, NodePtr parent) noexcept : Node(id, parent) {}
 
+    // Transform applied to the children on top of the node's world transform.
+    virtual auto GetLocalTransform() const noexcept -> glm::mat4 { return glm::mat4(1.0f); }
+
     std::vector<UniqueNode> m_children;
+    uint64_t                m_attach_count = 0;
 };
 
 class RootNode final : public InnerNode {
@@ -369,12 +533,11 @@ class RootNode final : public InnerNode {
     RootNode(const RootNode&) = delete;
     RootNode& operator=(const RootNode&) = delete;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     auto DetachNode() -> UniqueNode override;
 
@@ -382,6 +545,9 @@ class RootNode final : public InnerNode {
 
     json ToJson() const override;
 
+    // Incremented whenever a node is attached to or detached from the tree below the root.
+    auto GetStructureRevision() const noexcept { return m_structure_revision; }
+
   private:
     friend struct ObjectAccess;
 
@@ -392,19 +558,20 @@ class RootNode final : public InnerNode {
 
     RootNode(ID id, NodePtr parent) noexcept : InnerNode(id, parent) {}
 
-    virtual void ApplyTransform(const glm::mat4& matrix) noexcept override;
+    // Name and class of every node in the tree, keyed by ID index.
+    utils::TextIndex<NodePtr> m_node_index;
+    uint64_t                  m_structure_revision = 0;
 };
 
 class GroupNode final : public InnerNode {
     GroupNode(const GroupNode&) = delete;
     GroupNode& operator=(const GroupNode&) = delete;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     json ToJson() const override;
 
@@ -417,20 +584,17 @@ class GroupNode final : public InnerNode {
     static constexpr std::array<bool, 0>             kFieldWritable = {};
 
     GroupNode(ID id, NodePtr parent) noexcept : InnerNode(id, parent) {}
-
-    virtual void ApplyTransform(const glm::mat4& matrix) noexcept override;
 };
 
 class TranslateNode final : public InnerNode {
     TranslateNode(const TranslateNode&) = delete;
     TranslateNode& operator=(const TranslateNode&) = delete;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     json ToJson() const override;
 
@@ -444,7 +608,7 @@ class TranslateNode final : public InnerNode {
 
     TranslateNode(ID id, NodePtr parent, Float3 distance) noexcept : InnerNode(id, parent), m_distance(distance) {}
 
-    virtual void ApplyTransform(const glm::mat4& matrix) noexcept override;
+    auto GetLocalTransform() const noexcept -> glm::mat4 override;
 
     Float3 m_distance;
 };
@@ -454,12 +618,11 @@ class RotateNode final : public InnerNode {
     RotateNode(const RotateNode&) = delete;
     RotateNode& operator=(const RotateNode&) = delete;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     json ToJson() const override;
 
@@ -475,7 +638,7 @@ class RotateNode final : public InnerNode {
         : InnerNode(id, parent), m_axis(axis), m_angle(angle)
     {}
 
-    virtual void ApplyTransform(const glm::mat4& matrix) noexcept override;
+    auto GetLocalTransform() const noexcept -> glm::mat4 override;
 
     Float3  m_axis;
     Radians m_angle;
@@ -486,12 +649,11 @@ class ScaleNode final : public InnerNode {
     ScaleNode(const ScaleNode&) = delete;
     ScaleNode& operator=(const ScaleNode&) = delete;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     json ToJson() const override;
 
@@ -505,7 +667,7 @@ class ScaleNode final : public InnerNode {
 
     ScaleNode(ID id, NodePtr parent, float factor) noexcept : InnerNode(id, parent), m_factor(factor) {}
 
-    virtual void ApplyTransform(const glm::mat4& matrix) noexcept override;
+    auto GetLocalTransform() const noexcept -> glm::mat4 override;
 
     float m_factor;
 };
@@ -517,12 +679,11 @@ class InstanceNode final : public Node {
 
     ~InstanceNode() noexcept;
 
-    auto GetProperty(std::string_view name) const -> PropertyValue override;
-    auto GetProperty(std::string_view primary, std::string_view alternative) const -> PropertyValue override;
-    auto GetProperties() const -> std::vector<Property> override;
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
 
-    bool SetProperty(std::string_view name, const PropertyValue& value) override;
-    bool RemoveProperty(std::string_view name) override;
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
 
     auto AttachNode(UniqueNode node) -> NodePtr override;
     auto DetachNode() -> UniqueNode override;
@@ -530,6 +691,7 @@ class InstanceNode final : public Node {
     bool IsRoot() const override { return false; }
     bool IsInner() const override { return false; }
     bool IsLeaf() const override { return true; }
+    bool IsReference() const override { return false; }
     bool IsAncestor(NodePtr node) const override;
     bool HasChildren() const override { return false; }
     auto GetChildren() const -> Nodes override { return Nodes{}; }
@@ -538,7 +700,7 @@ class InstanceNode final : public Node {
 
     auto GetMeshPtr() const noexcept { return m_mesh; }
     auto GetMaterialPtr() const noexcept { return m_material; }
-    auto GetTransform() const noexcept { return m_transform; }
+    auto GetTransform() const noexcept { return m_world_transform; }
 
   private:
     friend struct ObjectAccess;
@@ -550,11 +712,84 @@ class InstanceNode final : public Node {
 
     InstanceNode(ID id, NodePtr parent, MeshPtr mesh, MaterialPtr material) noexcept;
 
-    virtual void ApplyTransform(const glm::mat4& matrix) noexcept override;
+    MeshPtr     m_mesh           = nullptr;
+    MaterialPtr m_material       = nullptr;
+    size_t      m_material_index = 0; // Position in the material's instances, so that unregistering does not search
+};
+
+// Places a prototype subtree at this node. The prototype is shared, so any number of references cost one node each.
+class ReferenceNode final : public Node {
+  public:
+    ReferenceNode(const ReferenceNode&) = delete;
+    ReferenceNode& operator=(const ReferenceNode&) = delete;
+
+    ~ReferenceNode() noexcept;
+
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
+
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
+
+    auto AttachNode(UniqueNode node) -> NodePtr override;
+    auto DetachNode() -> UniqueNode override;
+
+    bool IsRoot() const override { return false; }
+    bool IsInner() const override { return false; }
+    bool IsLeaf() const override { return true; }
+    bool IsReference() const override { return true; }
+    bool IsAncestor(NodePtr node) const override;
+    bool HasChildren() const override { return false; }
+    auto GetChildren() const -> Nodes override { return Nodes{}; }
+
+    json ToJson() const override;
+
+    auto GetReferencedPrototypePtr() const noexcept { return m_prototype; }
+
+  private:
+    friend struct ObjectAccess;
+
+    static constexpr std::string_view                kClassName     = "reference.node";
+    static constexpr std::string_view                kDefaultName   = "Reference";
+    static constexpr std::array<std::string_view, 1> kFieldNames    = { "Prototype" };
+    static constexpr std::array<bool, 1>             kFieldWritable = { false };
+
+    ReferenceNode(ID id, NodePtr parent, PrototypePtr prototype) noexcept;
 
-    MeshPtr     m_mesh      = nullptr;
-    MaterialPtr m_material  = nullptr;
-    glm::mat4   m_transform = glm::mat4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+    PrototypePtr m_prototype       = nullptr;
+    size_t       m_reference_index = 0; // Position in the prototype's references
+};
+
+// A subtree that is stored once and placed by reference nodes. The subtree is sealed when the prototype is
+// created: its nodes can no longer be attached or detached, although their fields can still be edited.
+class Prototype final : public Object {
+  public:
+    Prototype(const Prototype&) = delete;
+    Prototype& operator=(const Prototype&) = delete;
+
+    auto GetProperty(PropertyAtom name) const -> PropertyValue override;
+    auto GetProperty(PropertyAtom primary, PropertyAtom alternative) const -> PropertyValue override;
+
+    bool SetProperty(PropertyAtom name, const PropertyValue& value) override;
+    bool RemoveProperty(PropertyAtom name) override;
+
+    json ToJson() const override;
+
+    auto GetRootNode() const noexcept -> NodePtr { return m_root.get(); }
+    auto GetReferenceNodes() const { return m_references; }
+
+  private:
+    friend struct ObjectAccess;
+
+    static constexpr std::string_view                kClassName     = "prototype";
+    static constexpr std::string_view                kDefaultName   = "Prototype";
+    static constexpr std::array<std::string_view, 2> kFieldNames    = { "Root", "References" };
+    static constexpr std::array<bool, 2>             kFieldWritable = { false, false };
+
+    Prototype(ID id, UniqueNode root) noexcept : Object(id), m_root(std::move(root)) {}
+
+    UniqueNode m_root;
+    References m_references;
 };
 
 struct DrawRecord final {
@@ -566,6 +801,87 @@ struct DrawRecord final {
 
 using DrawList = std::vector<DrawRecord>;
 
+// What Scene::ReleaseUnusedAssets destroyed, so that the renderer can release the resources it holds for it.
+struct ReleasedAssets final {
+    std::vector<ID>          buffers;
+    std::vector<uint32_t>    materials; // Material indices, which new materials reuse
+    std::vector<std::string> textures;  // Diffuse texture of each released material that had one
+};
+
+struct BuilderRecord;
+
+// Records a detached subgraph together with the buffers, shaders, materials and meshes it uses, without touching a
+// scene, so that files can be parsed on worker threads. A builder is used by one thread at a time; Scene::Commit then
+// adds what it recorded on the thread that owns the scene. Handles index the records of the builder and mean nothing
+// outside of it. Buffer contents are copied once, when they are added, and the scene takes them over on commit.
+class SceneBuilder {
+  public:
+    using Handle = uint32_t;
+
+    static constexpr Handle kNoParent = std::numeric_limits<Handle>::max();
+
+    SceneBuilder() noexcept;
+
+    SceneBuilder(const SceneBuilder&) = delete;
+    SceneBuilder& operator=(const SceneBuilder&) = delete;
+
+    SceneBuilder(SceneBuilder&&) noexcept;
+    SceneBuilder& operator=(SceneBuilder&&) noexcept;
+
+    ~SceneBuilder() noexcept;
+
+    auto AddVertexBuffer(const void* data, size_t size, std::align_val_t alignment) -> Handle;
+    auto AddIndexBuffer(const void* data, size_t size, std::align_val_t alignment) -> Handle;
+
+    // Memory from Buffer::Allocate is adopted as it is.
+    auto AddVertexBuffer(Buffer::UniqueData data, size_t size) -> Handle;
+    auto AddIndexBuffer(Buffer::UniqueData data, size_t size) -> Handle;
+
+    // The buffer is committed released: nothing is read until the source is asked to fill the upload memory.
+    auto AddVertexBuffer(Buffer::Source source, size_t size, std::align_val_t alignment) -> Handle;
+    auto AddIndexBuffer(Buffer::Source source, size_t size, std::align_val_t alignment) -> Handle;
+
+    auto AddShader() -> Handle;
+    auto AddMaterial(Handle shader) -> Handle;
+
+    auto AddMesh(
+        AABB                 aabb,
+        Handle               vertex_buffer,
+        Handle               index_buffer,
+        size_t               first_index,
+        size_t               index_count,
+        std::vector<Meshlet> meshlets = {}) -> Handle;
+
+    // The indices are the points, in the order of the nodes.
+    auto AddPointCloud(
+        AABB                   aabb,
+        Handle                 vertex_buffer,
+        Handle                 index_buffer,
+        size_t                 first_index,
+        size_t                 index_count,
+        std::vector<PointNode> nodes) -> Handle;
+
+    // Nodes without a parent are attached to the node the builder is committed to, in the order they were added.
+    auto AddGroupNode(Handle parent = kNoParent) -> Handle;
+    auto AddTranslateNode(Handle parent, Float3 distance) -> Handle;
+    auto AddRotateNode(Handle parent, Float3 axis, Radians angle) -> Handle;
+    auto AddScaleNode(Handle parent, float factor) -> Handle;
+    auto AddInstanceNode(Handle parent, Handle mesh, Handle material) -> Handle;
+
+    // Applied in order on commit. Values that refer to scene objects are rejected, since the builder has none.
+    void SetProperty(Handle object, PropertyAtom name, PropertyValue value);
+
+    auto GetRecordCount() const noexcept -> size_t;
+
+  private:
+    friend class Scene;
+
+    auto Add(BuilderRecord record) -> Handle;
+    auto AddNode(Handle parent, BuilderRecord record) -> Handle;
+
+    std::vector<BuilderRecord> m_records;
+};
+
 class Scene {
   public:
     Scene();
@@ -573,8 +889,8 @@ class Scene {
     Scene(const Scene&) = delete;
     Scene& operator=(const Scene&) = delete;
 
-    Scene(Scene&&) = default;
-    Scene& operator=(Scene&&) = default;
+    Scene(Scene&&) noexcept;
+    Scene& operator=(Scene&&) noexcept;
 
     ~Scene() noexcept;
 
@@ -585,32 +901,88 @@ class Scene {
     auto CreateRotateNode(Float3 axis, Radians angle) -> UniqueRotateNode;
     auto CreateScaleNode(float factor) -> UniqueScaleNode;
     auto CreateInstanceNode(MeshPtr mesh, MaterialPtr material) -> UniqueInstanceNode;
+    auto CreateReferenceNode(PrototypePtr prototype) -> UniqueReferenceNode;
+
+    // Seals a detached subtree into a prototype that reference nodes can place any number of times.
+    auto CreatePrototype(UniqueNode root) -> PrototypePtr;
 
     auto CreateVertexBuffer(void* data, size_t size, std::align_val_t alignment) -> VertexBufferPtr;
     auto CreateIndexBuffer(void* data, size_t size, std::align_val_t alignment) -> IndexBufferPtr;
 
+    // Take ownership of memory from Buffer::Allocate, keeping its alignment.
+    auto CreateVertexBuffer(Buffer::UniqueData data, size_t size) -> VertexBufferPtr;
+    auto CreateIndexBuffer(Buffer::UniqueData data, size_t size) -> IndexBufferPtr;
+
     auto CreateShader() -> ShaderPtr;
     auto CreateMaterial(ShaderPtr shader) -> MaterialPtr;
 
+    // Meshlets must cover the index range of the mesh, in order.
     auto CreateMesh(
-        AABB            aabb,
-        VertexBufferPtr vertex_buffer,
-        IndexBufferPtr  index_buffer,
-        size_t          first_index,
-        size_t          index_count) -> MeshPtr;
+        AABB                 aabb,
+        VertexBufferPtr      vertex_buffer,
+        IndexBufferPtr       index_buffer,
+        size_t               first_index,
+        size_t               index_count,
+        std::vector<Meshlet> meshlets = {}) -> MeshPtr;
+
+    // A mesh drawn as points. The nodes must hold every index of the mesh once, with the root node first.
+    auto CreatePointCloud(
+        AABB                   aabb,
+        VertexBufferPtr        vertex_buffer,
+        IndexBufferPtr         index_buffer,
+        size_t                 first_index,
+        size_t                 index_count,
+        std::vector<PointNode> nodes) -> MeshPtr;
+
+    // Adds everything the builder recorded and attaches its top-level nodes to the parent, the root by default, in
+    // one pass over the records. If creating the objects fails, nothing is added. Returns the top-level nodes.
+    auto Commit(SceneBuilder&& builder, NodePtr parent = nullptr) -> Nodes;
+
+    auto FindObject(ID id) const noexcept -> ObjectPtr;
+
+    // Detaches the node and destroys it with all of its descendants. Instances are unregistered from their
+    // materials in one pass per material rather than one removal per instance.
+    void DestroySubtree(NodePtr node);
+
+    // Returns up to max_count nodes in the tree whose name or class contains the query, ignoring case.
+    auto FindNodes(std::string_view query, size_t max_count) const -> Nodes;
+
+    auto GetObjectCount() const noexcept -> size_t;
+
+    // Destroys the assets that nothing uses any more: prototypes without references, meshes without instances,
+    // materials without instances, buffers without meshes and shaders without materials. Assets are counted by
+    // their users, so this includes assets that were created but never used.
+    auto ReleaseUnusedAssets() -> ReleasedAssets;
 
     auto ComputeDrawList() const -> DrawList;
 
+    // Refreshes the cached bounds where the scene changed and returns the bounds of the root.
     auto ComputeAxisAlignedBoundingBox() const -> AABB;
 
     json ToJson() const;
 
+    // Streams the scene as one JSON record per object and the buffer contents, encoded with the stream codec, as a
+    // sidecar blob, so neither output is assembled in memory. Nodes are written parent first, each prototype before
+    // the graph that uses it. Released buffers are read from their source.
+    void Save(std::ostream& records, std::ostream& blob) const;
+
+    // Adds the objects of a saved scene and attaches its top-level nodes to the root. Records are parsed one at a
+    // time; objects get new IDs in the order they appear in the stream.
+    void Load(std::istream& records, std::istream& blob);
+
   private:
-    std::vector<ShaderPtr>       m_shaders;
-    std::vector<MaterialPtr>     m_materials;
-    std::vector<MeshPtr>         m_meshes;
-    std::vector<VertexBufferPtr> m_vertex_buffers;
-    std::vector<IndexBufferPtr>  m_index_buffers;
-    std::map<ID, UniqueObject>   m_objects;
-    UniqueNode                   m_root;
+    // Destroys every object, in the order the deleters and back-references require, and then the storage.
+    void Destroy() noexcept;
+
+    // Declared first so that it outlives every object whose deleter refers to it.
+    std::unique_ptr<ObjectStorage> m_storage;
+    std::vector<ShaderPtr>         m_shaders;
+    std::vector<MaterialPtr>       m_materials;
+    std::vector<MeshPtr>           m_meshes;
+    std::vector<PrototypePtr>      m_prototypes;
+    std::vector<VertexBufferPtr>   m_vertex_buffers;
+    std::vector<IndexBufferPtr>    m_index_buffers;
+    std::vector<UniqueObject>      m_objects;
+    std::vector<uint32_t>          m_free_material_indices;
+    UniqueNode                     m_root;
 };
@@ -32,7 +32,11 @@ SwapchainManager::SwapchainManager(
         auto color_view      = device.CreateImageView(color_image, ImageAspect::Color);
         auto depth_view      = device.CreateImageView(*depth_image, ImageAspect::Depth);
         auto framebuffer     = device.CreateFramebuffer(renderpass, { *color_view, *depth_view }, extent);
-        auto gui_framebuffer = device.CreateFramebuffer(gui_renderpass, { *color_view }, extent);
+        auto gui_framebuffer = UniqueFramebuffer();
+
+        if (gui_renderpass) {
+            gui_framebuffer = device.CreateFramebuffer(gui_renderpass, { *color_view }, extent);
+        }
 
         m_surface_views.push_back(std::move(color_view));
         m_depth_images.push_back(std::move(depth_image));
@@ -1,7 +1,10 @@
 #include <texture_loader.hpp>
 
+#include "descriptor_manager.hpp"
 #include "utils/misc.hpp"
 
+#include <spdlog/spdlog.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
 
@@ -12,32 +15,44 @@ TextureLoader::TextureLoader(etna::Device device, etna::Queue transfer_queue)
 
     auto command_pool_flags = CommandPoolCreate::Transient | CommandPoolCreate::ResetCommandBuffer;
 
-    m_command_pool   = m_device.CreateCommandPool(m_transfer_queue.FamilyIndex(), command_pool_flags);
-    m_command_buffer = m_command_pool->AllocateCommandBuffer();
+    m_command_pool = m_device.CreateCommandPool(m_transfer_queue.FamilyIndex(), command_pool_flags);
 
     stbi_set_flip_vertically_on_load(true);
 
-    auto buffer = m_device.CreateBuffer(4, BufferUsage::TransferSrc, MemoryUsage::CpuOnly);
+    LoadSolidColor("__default", { 0xFF, 0xFF, 0xFF, 0xFF });
+}
+
+void TextureLoader::LoadAsync(const std::string& filepath)
+{
+    if (!AddUse(std::hash<std::string>{}(filepath))) {
+        return;
+    }
+
+    m_tasks.push_back(std::async(std::launch::async, &TextureLoader::LoadAsyncPrivate, this, filepath));
+}
 
-    uint8_t pixels[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+void TextureLoader::LoadSolidColor(const std::string& image, std::array<uint8_t, 4> rgba)
+{
+    using namespace etna;
+
+    if (!AddUse(std::hash<std::string>{}(image))) {
+        return;
+    }
+
+    auto buffer = m_device.CreateBuffer(rgba.size(), BufferUsage::TransferSrc, MemoryUsage::CpuOnly);
 
     auto mapped_data = buffer->MapMemory();
-    memcpy(mapped_data, pixels, 4);
+    memcpy(mapped_data, rgba.data(), rgba.size());
     buffer->UnmapMemory();
 
     auto promise = std::promise<StageBuffer>();
 
-    promise.set_value(StageBuffer{ std::move(buffer), std::hash<std::string>{}("__default"), 1, 1 });
+    promise.set_value(StageBuffer{ std::move(buffer), std::hash<std::string>{}(image), 1, 1 });
 
     m_tasks.push_back(promise.get_future());
 }
 
-void TextureLoader::LoadAsync(const std::string& filepath)
-{
-    m_tasks.push_back(std::async(std::launch::async, &TextureLoader::LoadAsyncPrivate, this, filepath));
-}
-
-void TextureLoader::UploadAsync()
+void TextureLoader::RecordUpload(etna::Queue::SubmitBatch& submit_batch)
 {
     using namespace etna;
 
@@ -45,65 +60,159 @@ void TextureLoader::UploadAsync()
         return;
     }
 
-    m_command_buffer->ResetCommandBuffer(CommandBufferReset::ReleaseResources);
+    auto stage_buffers = std::vector<StageBuffer>();
+    auto images        = std::vector<UniqueImage2D>();
 
-    m_command_buffer->Begin(CommandBufferUsage::OneTimeSubmit);
+    auto transfer_barriers = CommandBuffer::BarrierBatch();
+    auto sampled_barriers  = CommandBuffer::BarrierBatch();
 
     for (auto& task : m_tasks) {
-        task.wait();
+        auto loaded = task.get();
+        auto hash   = loaded.hash;
+
+        // An image released while it was loading is dropped, and so is a second load of it started after that.
+        auto is_batched = std::ranges::find(stage_buffers, hash, &StageBuffer::hash) != stage_buffers.end();
+
+        if (!m_use_counts.contains(hash) || is_batched) {
+            continue;
+        }
 
-        auto [buffer, hash, width, height] = task.get();
+        auto& stage_buffer = stage_buffers.emplace_back(std::move(loaded));
 
         auto image = m_device.CreateImage(
             Format::R8G8B8A8Srgb,
-            { width, height },
+            { stage_buffer.width, stage_buffer.height },
             ImageUsage::TransferDst | ImageUsage::Sampled,
             MemoryUsage::GpuOnly,
             ImageTiling::Optimal);
 
-        m_command_buffer->PipelineBarrier(
+        transfer_barriers.AddImageBarrier(
             *image,
             PipelineStage::TopOfPipe,
             PipelineStage::Transfer,
             {},
             Access::TransferWrite,
             ImageLayout::Undefined,
-            ImageLayout::TransferDstOptimal,
-            ImageAspect::Color);
-
-        auto region = BufferImageCopy{};
-
-        region.imageExtent = { width, height, 1 };
-
-        m_command_buffer->CopyBufferToImage(*buffer, *image, ImageLayout::TransferDstOptimal, { region });
+            ImageLayout::TransferDstOptimal);
 
-        m_command_buffer->PipelineBarrier(
+        sampled_barriers.AddImageBarrier(
             *image,
             PipelineStage::Transfer,
             PipelineStage::FragmentShader,
             Access::TransferWrite,
             Access::ShaderRead,
             ImageLayout::TransferDstOptimal,
-            ImageLayout::ShaderReadOnlyOptimal,
-            ImageAspect::Color);
+            ImageLayout::ShaderReadOnlyOptimal);
 
-        auto image_view = m_device.CreateImageView(*image, ImageAspect::Color);
+        images.push_back(std::move(image));
+    }
 
-        m_gpu_images.insert({ hash, ImageRecord{ std::move(image), std::move(image_view) } });
+    m_tasks.clear();
 
-        m_host_buffers.push_back(std::move(buffer));
+    if (images.empty()) {
+        return;
     }
 
-    m_command_buffer->End();
+    // The command buffer of an earlier upload may still be pending, so each upload takes one whose upload completed.
+    auto upload = Upload{};
 
-    m_transfer_queue.Submit(*m_command_buffer);
+    if (m_free_command_buffers.empty()) {
+        upload.command_buffer = m_command_pool->AllocateCommandBuffer();
+    } else {
+        upload.command_buffer = std::move(m_free_command_buffers.back());
+        m_free_command_buffers.pop_back();
+        upload.command_buffer->ResetCommandBuffer(CommandBufferReset::ReleaseResources);
+    }
 
-    m_tasks.clear();
+    upload.command_buffer->Begin(CommandBufferUsage::OneTimeSubmit);
+
+    upload.command_buffer->PipelineBarrier(transfer_barriers);
+
+    for (size_t i = 0; i != images.size(); ++i) {
+        const auto& [buffer, hash, width, height] = stage_buffers[i];
+
+        auto region = BufferImageCopy{};
+
+        region.imageExtent = { width, height, 1 };
+
+        upload.command_buffer->CopyBufferToImage(*buffer, *images[i], ImageLayout::TransferDstOptimal, { region });
+    }
+
+    upload.command_buffer->PipelineBarrier(sampled_barriers);
+
+    upload.command_buffer->End();
+
+    submit_batch.AddCommandBuffer(*upload.command_buffer);
+
+    auto unindexed_count = size_t{ 0 };
+
+    for (size_t i = 0; i != images.size(); ++i) {
+        auto image_view = m_device.CreateImageView(*images[i], ImageAspect::Color);
+
+        auto index  = AllocateIndex();
+        auto record = ImageRecord{ std::move(images[i]), std::move(image_view), index };
+        auto it     = m_gpu_images.emplace(stage_buffers[i].hash, std::move(record)).first;
+
+        m_uploaded_images.push_back({ index, it->second.view.get() });
+
+        upload.staging_buffers.push_back(std::move(stage_buffers[i].buffer));
+
+        unindexed_count += index == kNoImageIndex;
+    }
+
+    if (unindexed_count > 0) {
+        spdlog::warn(
+            "{} textures do not fit in the {} bindless texture slots and are drawn with the default image",
+            unindexed_count,
+            DescriptorManager::kMaxBindlessTextures);
+    }
+
+    m_uploads.push_back(std::move(upload));
 }
 
-void TextureLoader::CleanAfterUpload()
+void TextureLoader::UploadSubmitted(uint64_t timeline_value)
 {
-    m_host_buffers.clear();
+    for (auto& upload : m_uploads) {
+        if (upload.timeline_value == 0) {
+            upload.timeline_value = timeline_value;
+        }
+    }
+}
+
+void TextureLoader::Release(const std::string& image, uint64_t timeline_value)
+{
+    auto hash = std::hash<std::string>{}(image);
+
+    auto count = m_use_counts.find(hash);
+    if (count == m_use_counts.end() || --count->second != 0) {
+        return;
+    }
+
+    m_use_counts.erase(count);
+
+    if (auto it = m_gpu_images.find(hash); it != m_gpu_images.end()) {
+        m_deletion_queue.Push(timeline_value, std::move(it->second));
+        m_gpu_images.erase(it);
+    }
+}
+
+void TextureLoader::ReleaseRetiredImages(uint64_t completed_timeline_value)
+{
+    for (auto& upload : m_uploads) {
+        if (upload.timeline_value != 0 && upload.timeline_value <= completed_timeline_value) {
+            m_free_command_buffers.push_back(std::move(upload.command_buffer));
+        }
+    }
+
+    std::erase_if(m_uploads, [](const Upload& upload) { return !upload.command_buffer; });
+
+    // The index of a retired image is only reused once no pending submission can sample it through that index.
+    m_deletion_queue.Retire(completed_timeline_value, [this](const ImageRecord& record) {
+        if (record.index != kNoImageIndex) {
+            m_free_indices.push_back(record.index);
+        }
+        m_retired_images.push_back({ record.index, record.view.get() });
+    });
 }
 
 etna::ImageView2D TextureLoader::GetImage(const std::string& image)
@@ -120,6 +229,37 @@ etna::ImageView2D TextureLoader::GetDefaultImage()
     return GetImage("__default");
 }
 
+uint32_t TextureLoader::GetImageIndex(const std::string& image) const
+{
+    auto hash = std::hash<std::string>{}(image);
+    if (auto it = m_gpu_images.find(hash); it != m_gpu_images.end() && it->second.index != kNoImageIndex) {
+        return it->second.index;
+    }
+    return kDefaultImageIndex;
+}
+
+std::vector<TextureLoader::UploadedImage> TextureLoader::TakeUploadedImages()
+{
+    return std::exchange(m_uploaded_images, {});
+}
+
+std::vector<TextureLoader::UploadedImage> TextureLoader::TakeRetiredImages()
+{
+    return std::exchange(m_retired_images, {});
+}
+
+uint32_t TextureLoader::AllocateIndex()
+{
+    if (m_free_indices.empty()) {
+        return m_next_index < DescriptorManager::kMaxBindlessTextures ? m_next_index++ : kNoImageIndex;
+    }
+
+    auto index = m_free_indices.back();
+    m_free_indices.pop_back();
+
+    return index;
+}
+
 TextureLoader::StageBuffer TextureLoader::LoadAsyncPrivate(const std::string& filepath)
 {
     using namespace etna;
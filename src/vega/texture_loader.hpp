@@ -6,12 +6,26 @@
 #include "etna/image.hpp"
 #include "etna/queue.hpp"
 
+#include "utils/deletion_queue.hpp"
+
+#include <array>
 #include <future>
+#include <limits>
 #include <map>
 #include <string>
 
 class TextureLoader {
   public:
+    static constexpr uint32_t kDefaultImageIndex = 0;
+
+    // Index of the images that do not fit in the bindless texture array; they are sampled as the default image.
+    static constexpr uint32_t kNoImageIndex = std::numeric_limits<uint32_t>::max();
+
+    struct UploadedImage final {
+        uint32_t          index;
+        etna::ImageView2D view;
+    };
+
     TextureLoader(etna::Device device, etna::Queue transfer_queue);
 
     TextureLoader(const TextureLoader&) = delete;
@@ -20,16 +34,36 @@ class TextureLoader {
     TextureLoader(TextureLoader&&) = default;
     TextureLoader& operator=(TextureLoader&&) = default;
 
+    // Images are counted by their users: loading an image that is already loaded or loading only adds a use.
     void LoadAsync(const std::string& filepath);
 
-    void UploadAsync();
+    void LoadSolidColor(const std::string& image, std::array<uint8_t, 4> rgba);
+
+    // Drops a use of the image. The last use hands the image to the deletion queue; submissions up to
+    // timeline_value may still sample it.
+    void Release(const std::string& image, uint64_t timeline_value);
+
+    void RecordUpload(etna::Queue::SubmitBatch& submit_batch);
+
+    void UploadSubmitted(uint64_t timeline_value);
 
-    void CleanAfterUpload();
+    // Frees staging buffers of completed uploads and released images that no pending submission uses, and recycles
+    // the command buffers of completed uploads.
+    void ReleaseRetiredImages(uint64_t completed_timeline_value);
 
     auto GetImage(const std::string& image) -> etna::ImageView2D;
 
     auto GetDefaultImage() -> etna::ImageView2D;
 
+    auto GetImageIndex(const std::string& image) const -> uint32_t;
+
+    auto TakeUploadedImages() -> std::vector<UploadedImage>;
+
+    // Images freed since the last call. Their views are destroyed and their indices may be handed out again.
+    auto TakeRetiredImages() -> std::vector<UploadedImage>;
+
+    auto GetImageCount() const noexcept { return m_gpu_images.size(); }
+
   private:
     struct StageBuffer final {
         etna::UniqueBuffer buffer;
@@ -38,19 +72,36 @@ class TextureLoader {
         uint32_t           height;
     };
 
+    struct Upload final {
+        uint64_t                        timeline_value{};
+        etna::UniqueCommandBuffer       command_buffer{};
+        std::vector<etna::UniqueBuffer> staging_buffers;
+    };
+
     struct ImageRecord final {
         etna::UniqueImage2D     image;
         etna::UniqueImageView2D view;
+        uint32_t                index;
     };
 
     StageBuffer LoadAsyncPrivate(const std::string& filepath);
 
-    etna::Device              m_device;
-    etna::Queue               m_transfer_queue;
-    etna::UniqueCommandPool   m_command_pool;
-    etna::UniqueCommandBuffer m_command_buffer;
+    bool AddUse(size_t hash) { return m_use_counts[hash]++ == 0; }
+
+    auto AllocateIndex() -> uint32_t;
+
+    etna::Device            m_device;
+    etna::Queue             m_transfer_queue;
+    etna::UniqueCommandPool m_command_pool;
 
-    std::vector<std::future<StageBuffer>> m_tasks;
-    std::vector<etna::UniqueBuffer>       m_host_buffers;
-    std::map<size_t, ImageRecord>         m_gpu_images;
+    std::vector<std::future<StageBuffer>>  m_tasks;
+    std::vector<Upload>                    m_uploads;
+    std::vector<etna::UniqueCommandBuffer> m_free_command_buffers;
+    std::map<size_t, ImageRecord>          m_gpu_images;
+    std::map<size_t, uint32_t>             m_use_counts;
+    std::vector<UploadedImage>             m_uploaded_images;
+    std::vector<UploadedImage>             m_retired_images;
+    std::vector<uint32_t>                  m_free_indices;
+    uint32_t                               m_next_index = 0;
+    utils::DeletionQueue<ImageRecord>      m_deletion_queue;
 };
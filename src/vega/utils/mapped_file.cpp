@@ -0,0 +1,135 @@
+#include "mapped_file.hpp"
+
+#include "cast.hpp"
+#include "misc.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace utils {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    auto file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+
+    throw_runtime_error_if(file == INVALID_HANDLE_VALUE, "Cannot map file: file cannot be opened");
+
+    auto size = LARGE_INTEGER{};
+
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw_runtime_error("Cannot map file: file size cannot be read");
+    }
+
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    throw_runtime_error_if(mapping == nullptr, "Cannot map file: mapping cannot be created");
+
+    auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        throw_runtime_error("Cannot map file: view cannot be mapped");
+    }
+
+    m_data    = static_cast<const std::byte*>(data);
+    m_size    = narrow_cast<size_t>(size.QuadPart);
+    m_mapping = mapping;
+}
+
+void MappedFile::Unmap() noexcept
+{
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    auto file = open(path.c_str(), O_RDONLY);
+
+    throw_runtime_error_if(file == -1, "Cannot map file: file cannot be opened");
+
+    struct stat status {};
+
+    if (fstat(file, &status) != 0) {
+        close(file);
+        throw_runtime_error("Cannot map file: file size cannot be read");
+    }
+
+    if (status.st_size == 0) {
+        close(file);
+        return;
+    }
+
+    auto size = narrow_cast<size_t>(status.st_size);
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps its own reference to the file.
+    close(file);
+
+    throw_runtime_error_if(data == MAP_FAILED, "Cannot map file: view cannot be mapped");
+
+    m_data = static_cast<const std::byte*>(data);
+    m_size = size;
+}
+
+void MappedFile::Unmap() noexcept
+{
+    if (m_data) {
+        munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+      m_mapping(std::exchange(other.m_mapping, nullptr))
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Unmap();
+        m_data    = std::exchange(other.m_data, nullptr);
+        m_size    = std::exchange(other.m_size, 0);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() noexcept
+{
+    Unmap();
+}
+
+} // namespace utils
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace utils {
+
+// Read-only view of a whole file mapped into memory. Pages are read in by the OS when they are first touched, so
+// nothing is copied until the contents are used.
+class MappedFile {
+  public:
+    MappedFile() noexcept = default;
+    explicit MappedFile(const std::filesystem::path& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    ~MappedFile() noexcept;
+
+    auto Bytes() const noexcept -> std::span<const std::byte> { return { m_data, m_size }; }
+
+  private:
+    void Unmap() noexcept;
+
+    const std::byte* m_data    = nullptr;
+    size_t           m_size    = 0;
+    void*            m_mapping = nullptr; // Mapping handle on Windows
+};
+
+} // namespace utils
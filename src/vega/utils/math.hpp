@@ -1,6 +1,7 @@
 #pragma once
 
 #include <compare>
+#include <limits>
 
 struct Float3 final {
     constexpr Float3() noexcept : x(0), y(0), z(0) {}
@@ -32,6 +33,15 @@ struct AABB final {
     Float3 min;
     Float3 max;
 
+    // A box that contains nothing; expanding it by a point or box yields exactly that point or box.
+    static constexpr AABB Empty() noexcept
+    {
+        constexpr auto inf = std::numeric_limits<float>::infinity();
+        return AABB{ { inf, inf, inf }, { -inf, -inf, -inf } };
+    }
+
+    bool IsEmpty() const noexcept { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
     void Expand(const Float3& point) noexcept
     {
         if (point.x < min.x)
@@ -50,6 +60,14 @@ struct AABB final {
             max.z = point.z;
     }
 
+    void Expand(const AABB& aabb) noexcept
+    {
+        if (!aabb.IsEmpty()) {
+            Expand(aabb.min);
+            Expand(aabb.max);
+        }
+    }
+
     auto Center() const noexcept { return 0.5f * (min + max); }
     auto ExtentX() const noexcept { return max.x - min.x; }
     auto ExtentY() const noexcept { return max.y - min.y; }
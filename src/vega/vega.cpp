@@ -4,7 +4,9 @@
 #include "camera.hpp"
 #include "descriptor_manager.hpp"
 #include "frame_manager.hpp"
+#include "gpu_timeline.hpp"
 #include "gui.hpp"
+#include "model_loader.hpp"
 #include "render_context.hpp"
 #include "scene.hpp"
 #include "swapchain_manager.hpp"
@@ -14,9 +16,6 @@
 
 BEGIN_DISABLE_WARNINGS
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
-
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
@@ -29,41 +28,21 @@ BEGIN_DISABLE_WARNINGS
 END_DISABLE_WARNINGS
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <limits>
 #include <optional>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 enum class KhronosValidation { Disable, Enable };
 
-struct Vertex final {
-    constexpr Vertex(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv) noexcept
-        : position(position), normal(normal), uv(uv)
-    {}
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec2 uv;
-};
-
 DECLARE_VERTEX_ATTRIBUTE_TYPE(glm::vec2, etna::Format::R32G32Sfloat)
 DECLARE_VERTEX_ATTRIBUTE_TYPE(glm::vec3, etna::Format::R32G32B32Sfloat)
 
-DECLARE_VERTEX_TYPE(Vertex, Position3f | Normal3f)
-
-struct TinyIndex final {
-    struct Hash final {
-        size_t operator()(const tinyobj::index_t& index) const noexcept { return index.vertex_index; }
-    };
-    struct Equal final {
-        bool operator()(const tinyobj::index_t& lhs, const tinyobj::index_t& rhs) const noexcept
-        {
-            return (lhs.vertex_index == rhs.vertex_index) && (lhs.normal_index == rhs.normal_index) &&
-                   (lhs.texcoord_index == rhs.texcoord_index);
-        }
-    };
-};
-
-using IndexMap = std::unordered_map<tinyobj::index_t, size_t, TinyIndex::Hash, TinyIndex::Equal>;
+DECLARE_VERTEX_TYPE(ModelVertex, Position3f | Normal3f)
 
 struct GLFW {
     GLFW()
@@ -74,296 +53,6 @@ struct GLFW {
     ~GLFW() { glfwTerminate(); }
 } glfw;
 
-struct MeshRecord final {
-    AABB   aabb{};
-    int    material_id{};
-    size_t first_index{};
-    size_t index_count{};
-};
-
-using MeshRecords = std::vector<MeshRecord>;
-
-static MeshRecords GenerateMeshRecords(
-    const tinyobj::attrib_t& attributes,
-    const tinyobj::mesh_t&   mesh,
-    IndexMap*                index_map,
-    std::vector<Vertex>*     vertices,
-    std::vector<uint32_t>*   indices)
-{
-    const auto& [positions, normals, texcoords, colors] = attributes;
-
-    auto mesh_map = std::map<int, std::vector<uint32_t>>{};
-
-    for (size_t i = 0; i < mesh.indices.size(); ++i) {
-        const auto& index       = mesh.indices[i];
-        const auto  material_id = mesh.material_ids[i / 3];
-        const auto  pindex      = 3 * index.vertex_index;
-        const auto  nindex      = 3 * index.normal_index;
-        const auto  tindex      = 2 * index.texcoord_index;
-        const auto  position    = glm::vec3(positions[pindex + 0], positions[pindex + 1], positions[pindex + 2]);
-        const auto  normal      = glm::vec3(normals[nindex + 0], normals[nindex + 1], normals[nindex + 2]);
-        const auto  texcoord    = glm::vec2(texcoords[tindex + 0], texcoords[tindex + 1]);
-
-        auto new_index = vertices->size();
-
-        if (auto [it, success] = index_map->try_emplace(index, vertices->size()); success) {
-            vertices->emplace_back(position, normal, texcoord);
-        } else {
-            new_index = it->second;
-        }
-
-        auto& index_buffer = mesh_map[material_id];
-        if (index_buffer.empty()) {
-            index_buffer.reserve(mesh.indices.size());
-        }
-        index_buffer.push_back(utils::narrow_cast<uint32_t>(new_index));
-    }
-
-    auto mesh_records = MeshRecords{};
-
-    for (auto& [material_id, index_buffer] : mesh_map) {
-        auto record = MeshRecord{
-
-            .aabb        = AABB{ { FLT_MAX, FLT_MAX, FLT_MAX }, { FLT_MIN, FLT_MIN, FLT_MIN } },
-            .material_id = material_id,
-            .first_index = indices->size(),
-            .index_count = index_buffer.size()
-        };
-
-        for (uint32_t index : index_buffer) {
-            auto position = (*vertices)[index].position;
-
-            record.aabb.min = { std::min(record.aabb.min.x, position.x),
-                                std::min(record.aabb.min.y, position.y),
-                                std::min(record.aabb.min.z, position.z) };
-
-            record.aabb.max = { std::max(record.aabb.max.x, position.x),
-                                std::max(record.aabb.max.y, position.y),
-                                std::max(record.aabb.max.z, position.z) };
-
-            indices->push_back(index);
-        }
-
-        mesh_records.push_back(record);
-    }
-
-    return mesh_records;
-}
-
-static void GenerateNormals(tinyobj::attrib_t* attributes, std::vector<tinyobj::shape_t>* shapes)
-{
-    using namespace glm;
-    using utils::narrow_cast;
-
-    static constexpr float kMinDot = 0.999847695f;
-
-    auto& [positions, out_normals, texcoords, colors] = *attributes;
-
-    auto normals   = std::vector<tinyobj::real_t>{};
-    auto index_map = std::unordered_map<int, int>{};
-
-    index_map.reserve(positions.size());
-
-    for (auto& [name, mesh, path] : *shapes) {
-        for (size_t index = 0; index < mesh.indices.size(); index += 3) {
-            auto indices = std::array{ &mesh.indices[index + 0], &mesh.indices[index + 1], &mesh.indices[index + 2] };
-            auto pindex0 = 3 * narrow_cast<size_t>(indices[0]->vertex_index);
-            auto pindex1 = 3 * narrow_cast<size_t>(indices[1]->vertex_index);
-            auto pindex2 = 3 * narrow_cast<size_t>(indices[2]->vertex_index);
-            auto p0      = vec3(positions[pindex0 + 0], positions[pindex0 + 1], positions[pindex0 + 2]);
-            auto p1      = vec3(positions[pindex1 + 0], positions[pindex1 + 1], positions[pindex1 + 2]);
-            auto p2      = vec3(positions[pindex2 + 0], positions[pindex2 + 1], positions[pindex2 + 2]);
-            auto normal  = normalize(cross(p1 - p0, p2 - p0));
-
-            for (size_t i = 0; i < indices.size(); ++i) {
-                auto normal_index = narrow_cast<int>(normals.size());
-                if (auto [it, emplaced] = index_map.try_emplace(indices[i]->vertex_index, normal_index); emplaced) {
-                    normals.insert(normals.end(), { normal.x, normal.y, normal.z });
-                } else {
-                    auto current = vec3(normals[it->second + 0], normals[it->second + 1], normals[it->second + 2]);
-                    if (dot(normal, current) >= kMinDot) {
-                        normal_index = it->second;
-                    } else {
-                        normals.insert(normals.end(), { normal.x, normal.y, normal.z });
-                    }
-                }
-                indices[i]->normal_index = normal_index / 3;
-            }
-        }
-    }
-
-    out_normals = std::move(normals);
-}
-
-static void GenerateTexcoords(tinyobj::attrib_t* attributes, std::vector<tinyobj::shape_t>* shapes)
-{
-    attributes->texcoords.clear();
-    attributes->texcoords.push_back(0.0f);
-    attributes->texcoords.push_back(0.0f);
-
-    for (auto& [name, mesh, path] : *shapes) {
-        for (auto& index : mesh.indices) {
-            index.texcoord_index = 0;
-        }
-    }
-}
-
-static std::map<int, MaterialPtr> GenerateMaterials(
-    ScenePtr                                scene,
-    TextureLoader*                          texture_loader,
-    const std::vector<tinyobj::material_t>& tiny_materials,
-    const std::filesystem::path&            parent_dir)
-{
-    auto shader       = scene->CreateShader();
-    auto material_map = std::map<int, MaterialPtr>{};
-    {
-        auto default_material = scene->CreateMaterial(shader);
-        material_map[-1]      = default_material;
-
-        auto material_index = 0;
-        for (const auto& tiny_material : tiny_materials) {
-            auto material = scene->CreateMaterial(shader);
-            material->SetProperty("name", tiny_material.name);
-            if (tiny_material.diffuse[0] > 0 || tiny_material.diffuse[1] > 0 || tiny_material.diffuse[2] > 0) {
-                material->SetProperty("diffuse.color", Float3(tiny_material.diffuse));
-            }
-            if (false == tiny_material.diffuse_texname.empty()) {
-                auto filepath = (parent_dir / tiny_material.diffuse_texname).string();
-                texture_loader->LoadAsync(filepath);
-                material->SetProperty("diffuse.texture", filepath);
-            }
-
-            auto index          = utils::narrow_cast<int>(material_index);
-            material_map[index] = material;
-            ++material_index;
-        }
-    }
-
-    return material_map;
-}
-
-void LoadObj(ScenePtr scene, TextureLoader* texture_loader, std::filesystem::path filepath)
-{
-    namespace fs = std::filesystem;
-
-    if (false == fs::exists(filepath)) {
-        throw std::runtime_error("File does not exist");
-    }
-
-    auto parent_dir = fs::path(filepath).parent_path();
-
-    auto attributes = tinyobj::attrib_t{};
-    auto shapes     = std::vector<tinyobj::shape_t>{};
-    auto materials  = std::vector<tinyobj::material_t>{};
-    auto warning    = std::string{};
-    auto error      = std::string{};
-
-    spdlog::info("Parsing scene");
-
-    bool success = tinyobj::LoadObj(
-        &attributes,
-        &shapes,
-        &materials,
-        &warning,
-        &error,
-        filepath.string().c_str(),
-        parent_dir.string().c_str(),
-        true,
-        false);
-
-    if (!success || !error.empty()) {
-        spdlog::error("{}", error);
-        utils::throw_runtime_error("Failed to load object file");
-    }
-
-    auto extension = filepath.extension().string();
-    utils::to_lower(extension.data());
-
-    if (extension != ".obj") {
-        throw std::runtime_error("File is not an .obj file");
-    }
-
-    if (!warning.empty()) {
-        spdlog::warn("{}", warning);
-    }
-
-    if (attributes.normals.empty()) {
-        spdlog::info("Generating normals");
-        GenerateNormals(&attributes, &shapes);
-    }
-
-    if (attributes.texcoords.empty()) {
-        GenerateTexcoords(&attributes, &shapes);
-    }
-
-    auto material_map = GenerateMaterials(scene, texture_loader, materials, parent_dir);
-
-    spdlog::info("Generating scene");
-
-    auto root_node = scene->GetRootNode();
-    auto file_node = root_node->AttachNode(scene->CreateGroupNode());
-
-    file_node->SetProperty("name", filepath.filename().string());
-    file_node->SetProperty("Path", filepath.string());
-
-    auto mesh_map      = std::map<size_t, MeshRecords>{};
-    auto vertex_buffer = VertexBufferPtr{};
-    auto index_buffer  = IndexBufferPtr{};
-
-    {
-        auto index_count = size_t{ 0 };
-        for (auto& shape : shapes) {
-            index_count += shape.mesh.indices.size();
-        }
-
-        auto vertices = std::vector<Vertex>{};
-        vertices.reserve(2 * attributes.vertices.size());
-
-        auto indices = std::vector<uint32_t>{};
-        indices.reserve(index_count);
-
-        auto index_map = IndexMap{};
-        index_map.reserve(2 * attributes.vertices.size());
-
-        for (size_t shape_index = 0; shape_index < shapes.size(); ++shape_index) {
-            auto records = GenerateMeshRecords(attributes, shapes[shape_index].mesh, &index_map, &vertices, &indices);
-            mesh_map[shape_index] = std::move(records);
-        }
-
-        auto vertices_size = sizeof(vertices[0]) * vertices.size();
-        vertex_buffer      = scene->CreateVertexBuffer(vertices.data(), vertices_size, std::align_val_t(32));
-
-        auto indices_size = sizeof(indices[0]) * indices.size();
-        index_buffer      = scene->CreateIndexBuffer(indices.data(), indices_size, std::align_val_t(32));
-    }
-
-    auto shape_num = 1;
-
-    for (const auto& [shape_index, mesh_records] : mesh_map) {
-        auto parent = file_node;
-        auto name   = shapes[shape_index].name;
-        if (name.empty()) {
-            name = std::string("Mesh ") + std::to_string(shape_num++);
-        }
-        if (mesh_records.size() > 1) {
-            parent = file_node->AttachNode(scene->CreateGroupNode());
-            parent->SetProperty("name", name);
-        }
-        auto mesh_num = 1;
-        for (const auto& [aabb, material_id, first, count] : mesh_records) {
-            auto mesh     = scene->CreateMesh(aabb, vertex_buffer, index_buffer, first, count);
-            auto material = material_map[material_id];
-            auto instance = parent->AttachNode(scene->CreateInstanceNode(mesh, material));
-            if (mesh_records.size() == 1) {
-                instance->SetProperty("name", name);
-            } else {
-                auto suffix = std::string(" (") + std::to_string(mesh_num++) + (")");
-                instance->SetProperty("name", name + suffix);
-            }
-        }
-    }
-}
-
 struct QueueInfo final {
     uint32_t         family_index;
     etna::QueueFlags flags;
@@ -672,7 +361,39 @@ etna::UniqueSurfaceKHR CreateEtnaSurface(etna::Instance instance, GLFWwindow* gl
     return etna::UniqueSurfaceKHR(etna::SurfaceKHR(instance, vk_surface));
 }
 
-etna::UniqueDevice GetEtnaDevice(etna::Instance instance, etna::PhysicalDevice gpu, const QueueFamilies& queue_families)
+bool IsBindlessTexturingSupported(etna::PhysicalDevice gpu)
+{
+    auto extensions   = gpu.EnumerateDeviceExtensionProperties();
+    auto is_extension = [](const etna::ExtensionProperties& extension) {
+        return strcmp(extension.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0;
+    };
+
+    if (std::ranges::none_of(extensions, is_extension)) {
+        return false;
+    }
+
+    auto features = gpu.GetPhysicalDeviceDescriptorIndexingFeatures();
+
+    return features.descriptorBindingPartiallyBound && features.descriptorBindingSampledImageUpdateAfterBind &&
+           features.descriptorBindingUpdateUnusedWhilePending;
+}
+
+bool IsMemoryBudgetSupported(etna::PhysicalDevice gpu)
+{
+    auto extensions   = gpu.EnumerateDeviceExtensionProperties();
+    auto is_extension = [](const etna::ExtensionProperties& extension) {
+        return strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+    };
+
+    return std::ranges::any_of(extensions, is_extension);
+}
+
+etna::UniqueDevice GetEtnaDevice(
+    etna::Instance       instance,
+    etna::PhysicalDevice gpu,
+    const QueueFamilies& queue_families,
+    bool                 enable_descriptor_indexing,
+    bool                 enable_memory_budget)
 {
     auto queue_family_indices = RemoveDuplicates({
 
@@ -688,10 +409,55 @@ etna::UniqueDevice GetEtnaDevice(etna::Instance instance, etna::PhysicalDevice g
     }
 
     builder.AddEnabledExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    builder.EnableTimelineSemaphore();
+
+    if (enable_descriptor_indexing) {
+        builder.EnableDescriptorIndexing();
+    }
+
+    if (enable_memory_budget) {
+        builder.AddEnabledExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
     return instance.CreateDevice(gpu, builder.state);
 }
 
+std::vector<uint8_t>
+LoadPipelineCacheData(const std::filesystem::path& path, const etna::PhysicalDeviceProperties& gpu_properties)
+{
+    auto file = std::ifstream(path, std::ios::binary);
+
+    if (!file) {
+        spdlog::info("Pipeline cache {} not found, pipelines are compiled from scratch", path.string());
+        return {};
+    }
+
+    auto data = std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (!etna::PipelineCache::IsCompatible(data, gpu_properties)) {
+        spdlog::warn("Pipeline cache {} was created by a different GPU or driver, ignoring it", path.string());
+        return {};
+    }
+
+    spdlog::info("Pipeline cache {} loaded ({} bytes)", path.string(), data.size());
+
+    return data;
+}
+
+void SavePipelineCacheData(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+{
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    if (!file) {
+        spdlog::warn("Failed to save pipeline cache {}", path.string());
+        return;
+    }
+
+    spdlog::info("Pipeline cache {} saved ({} bytes)", path.string(), data.size());
+}
+
 etna::Extent2D ComputeEtnaExtent(etna::PhysicalDevice gpu, GLFWwindow* glfw_window, etna::SurfaceKHR surface)
 {
     int width{}, height{};
@@ -710,18 +476,39 @@ etna::Extent2D ComputeEtnaExtent(etna::PhysicalDevice gpu, GLFWwindow* glfw_wind
     return extent;
 }
 
+bool HasCommandLineSwitch(int argc, char* argv[], std::string_view name)
+{
+    return std::any_of(argv + 1, argv + argc, [name](const char* arg) { return arg == name; });
+}
+
+// Solid color textures that replace the textures of loaded materials when the bindless texture array is stressed.
+std::string StressTextureName(uint32_t index)
+{
+    return fmt::format("__stress_{}", index);
+}
+
+std::array<uint8_t, 4> StressTextureColor(uint32_t index)
+{
+    return { narrow_cast<uint8_t>(index & 0xFF), narrow_cast<uint8_t>(index >> 8), 0xFF, 0xFF };
+}
+
 class EventHandler {
   public:
     EventHandler(
-        etna::Device   device,
-        GLFWwindow*    glfw_window,
-        RenderContext* render_context,
-        Scene*         scene,
-        Camera*        camera,
-        BufferManager* buffer_manager,
-        TextureLoader* texture_loader)
-        : m_device(device), m_glfw_window(glfw_window), m_render_context(render_context), m_scene(scene),
-          m_camera(camera), m_buffer_manager(buffer_manager), m_texture_loader(texture_loader)
+        etna::Queue     graphics_queue,
+        GpuTimeline*    gpu_timeline,
+        GLFWwindow*     glfw_window,
+        RenderContext*  render_context,
+        Scene*          scene,
+        Camera*         camera,
+        BufferManager*  buffer_manager,
+        TextureLoader*  texture_loader,
+        BufferResidency buffer_residency,
+        uint32_t        stress_texture_count)
+        : m_graphics_queue(graphics_queue), m_gpu_timeline(gpu_timeline), m_glfw_window(glfw_window),
+          m_render_context(render_context), m_scene(scene), m_camera(camera), m_buffer_manager(buffer_manager),
+          m_texture_loader(texture_loader), m_buffer_residency(buffer_residency),
+          m_stress_texture_count(stress_texture_count)
     {}
 
     void ScheduleCloseWindow() noexcept
@@ -758,29 +545,94 @@ class EventHandler {
 
     void CloseWindow() { glfwSetWindowShouldClose(m_glfw_window, GLFW_TRUE); }
 
+    // Gives every drawn material one of the stress textures in turn. Each assignment adds a use of the texture, which
+    // the scene gives back when the material is released.
+    void AssignStressTextures(const DrawList& draw_list)
+    {
+        auto materials = std::vector<MaterialPtr>();
+
+        for (const DrawRecord& draw_record : draw_list) {
+            materials.push_back(draw_record.material);
+        }
+
+        std::ranges::sort(materials);
+        materials.erase(std::unique(materials.begin(), materials.end()), materials.end());
+
+        auto assigned_count = size_t{ 0 };
+
+        for (auto material : materials) {
+            // Materials of files loaded earlier already hold a stress texture.
+            if (auto texture = material->FindProperty<std::string>(kDiffuseTextureAtom)) {
+                if (texture->starts_with("__stress_")) {
+                    continue;
+                }
+            }
+
+            auto index = m_next_stress_texture++ % m_stress_texture_count;
+            auto name  = StressTextureName(index);
+
+            m_texture_loader->LoadSolidColor(name, StressTextureColor(index));
+            material->SetProperty(kDiffuseTextureAtom, name);
+
+            assigned_count++;
+        }
+
+        spdlog::info("Assigned stress textures to {} materials", assigned_count);
+    }
+
     void LoadFile()
     {
         spdlog::info("Loading file {}", m_load_file_parameters.filepath);
 
         auto start = std::chrono::system_clock::now();
 
-        LoadObj(m_scene, m_texture_loader, m_load_file_parameters.filepath);
+        auto filepaths = CollectModelFiles(m_load_file_parameters.filepath);
+        auto files     = LoadModelFiles(filepaths);
+
+        spdlog::info("Generating scene");
 
+        // Committed in path order, so the scene does not depend on which file finished parsing first.
+        // Stress textures take the place of the textures of the files, which are not loaded at all.
+        for (auto& file : files) {
+            m_scene->Commit(std::move(file.builder));
+            for (const auto& texture : file.textures) {
+                if (m_stress_texture_count == 0) {
+                    m_texture_loader->LoadAsync(texture);
+                }
+            }
+        }
+
+        // Buffers are copied from the scene when the renderer first draws them, and read back from the file or decoded
+        // again if they were evicted, so the scene can let go of its own copy now.
         auto draw_list = m_scene->ComputeDrawList();
+
+        if (m_stress_texture_count > 0) {
+            AssignStressTextures(draw_list);
+        }
+
         for (const DrawRecord& draw_record : draw_list) {
             m_buffer_manager->CreateBuffer(draw_record.mesh->GetVertexBuffer(), etna::BufferUsage::VertexBuffer);
             m_buffer_manager->CreateBuffer(draw_record.mesh->GetIndexBuffer(), etna::BufferUsage::IndexBuffer);
+            draw_record.mesh->GetVertexBuffer()->SetResidency(m_buffer_residency);
+            draw_record.mesh->GetIndexBuffer()->SetResidency(m_buffer_residency);
         }
 
         spdlog::info("Uploading data");
 
-        m_buffer_manager->UploadAsync();
-        m_texture_loader->UploadAsync();
+        auto upload_batch = etna::Queue::SubmitBatch();
+
+        m_texture_loader->RecordUpload(upload_batch);
+
+        if (!upload_batch.IsEmpty()) {
+            // The first frame that samples the new data waits on the upload on the GPU; the staging buffers are
+            // released by the render loop once the timeline passes the upload value.
+            auto upload_value = m_gpu_timeline->Submit(m_graphics_queue, upload_batch);
 
-        m_device.WaitIdle();
+            m_gpu_timeline->WaitOnNextSubmit(
+                upload_value, etna::PipelineStage::VertexInput | etna::PipelineStage::FragmentShader);
 
-        m_buffer_manager->CleanAfterUpload();
-        m_texture_loader->CleanAfterUpload();
+            m_texture_loader->UploadSubmitted(upload_value);
+        }
 
         auto elapsed = duration_cast<std::chrono::duration<double>>(std::chrono::system_clock::now() - start).count();
 
@@ -803,17 +655,21 @@ class EventHandler {
             aspect);
     }
 
-    etna::Device   m_device;
-    GLFWwindow*    m_glfw_window;
-    RenderContext* m_render_context;
-    Scene*         m_scene;
-    Camera*        m_camera;
-    BufferManager* m_buffer_manager;
-    TextureLoader* m_texture_loader;
-    Event          m_event = Event::None;
+    etna::Queue     m_graphics_queue;
+    GpuTimeline*    m_gpu_timeline;
+    GLFWwindow*     m_glfw_window;
+    RenderContext*  m_render_context;
+    Scene*          m_scene;
+    Camera*         m_camera;
+    BufferManager*  m_buffer_manager;
+    TextureLoader*  m_texture_loader;
+    BufferResidency m_buffer_residency;
+    uint32_t        m_stress_texture_count = 0;
+    uint32_t        m_next_stress_texture  = 0;
+    Event           m_event                = Event::None;
 };
 
-int main()
+int main(int argc, char* argv[])
 {
 #ifdef NDEBUG
     const KhronosValidation khronos_validation = KhronosValidation::Disable;
@@ -821,6 +677,36 @@ int main()
     const KhronosValidation khronos_validation = KhronosValidation::Enable;
 #endif
 
+    const RenderContext::GuiPass        gui_pass        = RenderContext::GuiPass::Merged;
+    const RenderContext::ModelTransform model_transform = RenderContext::ModelTransform::PushConstant;
+
+    // Cone culling drops meshlets that face away from the camera, which is only correct once the pipeline culls back
+    // faces as well; it draws both sides today.
+    const RenderContext::MeshletCulling meshlet_culling = RenderContext::MeshletCulling::Frustum;
+
+    // Records every frame's mesh draws once more with each model transform path into a command buffer that is never
+    // submitted, and logs the CPU time per draw of both. Needs per texture set binding.
+    const RenderContext::RecordingBenchmark recording_benchmark = RenderContext::RecordingBenchmark::Disable;
+
+    // Points drawn per frame across all point clouds; the octrees are refined until the budget is spent.
+    const size_t point_budget = 8'000'000;
+
+    // Creates the pipelines once more against an empty pipeline cache at startup and logs both timings, to compare
+    // cold pipeline creation with creation from the cache saved by the previous run.
+    const bool compare_pipeline_cache = false;
+
+    // With --stress-textures the bindless texture array is filled with generated textures, and the materials of every
+    // loaded file use them in place of their own. The textures are uploaded together with the next loaded file.
+    const bool stress_textures = HasCommandLineSwitch(argc, argv, "--stress-textures");
+
+    // What happens to the CPU copy of a buffer once it is uploaded. Released buffers are read again from their source,
+    // or kept compressed if they have none.
+    const BufferResidency buffer_residency = BufferResidency::Released;
+
+    // Device memory that mesh buffers may occupy, on top of the limit from VK_EXT_memory_budget. Buffers that do not
+    // fit are streamed in by visibility and evicted when unused; lower it to watch a scene stream.
+    const size_t geometry_memory_budget = std::numeric_limits<size_t>::max();
+
     using namespace etna;
 
     auto instance       = CreateEtnaInstance(khronos_validation);
@@ -828,6 +714,22 @@ int main()
     auto gpu_properties = gpu.GetPhysicalDeviceProperties();
 
     spdlog::info("GPU Info: {}, {}", gpu_properties.deviceName, to_string(gpu_properties.deviceType));
+
+    auto texture_binding = RenderContext::TextureBinding::Bindless;
+
+    if (!IsBindlessTexturingSupported(gpu)) {
+        spdlog::warn("Descriptor indexing is not supported, using a descriptor set per texture");
+        texture_binding = RenderContext::TextureBinding::PerTextureSet;
+    }
+
+    auto is_bindless = texture_binding == RenderContext::TextureBinding::Bindless;
+
+    auto has_memory_budget = IsMemoryBudgetSupported(gpu);
+
+    if (!has_memory_budget) {
+        spdlog::warn("Memory budget is not supported, streaming geometry against the configured budget only");
+    }
+
     spdlog::info("GLFW Version: {}", glfwGetVersionString());
 
     glfwSetErrorCallback(GlfwErrorCallback);
@@ -847,7 +749,7 @@ int main()
     spdlog::info("Surface Format: {}, {}", to_string(surface_format.format), to_string(surface_format.colorSpace));
 
     auto queue_families = GetQueueFamilyInfo(gpu, surface.get());
-    auto device         = GetEtnaDevice(instance.get(), gpu, queue_families);
+    auto device         = GetEtnaDevice(instance.get(), gpu, queue_families, is_bindless, has_memory_budget);
     auto queues         = Queues{};
     {
         queues.graphics     = device->GetQueue(queue_families.graphics.family_index);
@@ -861,12 +763,15 @@ int main()
     {
         auto builder = RenderPass::Builder();
 
+        auto is_merged          = gui_pass == RenderContext::GuiPass::Merged;
+        auto color_final_layout = is_merged ? ImageLayout::PresentSrcKHR : ImageLayout::ColorAttachmentOptimal;
+
         auto color_attachment = builder.AddAttachmentDescription(
             surface_format.format,
             AttachmentLoadOp::Clear,
             AttachmentStoreOp::Store,
             ImageLayout::Undefined,
-            ImageLayout::ColorAttachmentOptimal);
+            color_final_layout);
 
         auto depth_attachment = builder.AddAttachmentDescription(
             depth_format,
@@ -898,7 +803,7 @@ int main()
 
     // Create gui pipeline renderpass
     auto gui_renderpass = UniqueRenderPass();
-    {
+    if (gui_pass == RenderContext::GuiPass::Separate) {
         auto builder = RenderPass::Builder();
 
         auto color_attachment = builder.AddAttachmentDescription(
@@ -921,8 +826,8 @@ int main()
             subpass_id,
             PipelineStage::ColorAttachmentOutput,
             PipelineStage::ColorAttachmentOutput,
-            Access::ColorAttachmentRead,
-            Access::ColorAttachmentWrite);
+            Access::ColorAttachmentWrite,
+            Access::ColorAttachmentRead | Access::ColorAttachmentWrite);
 
         gui_renderpass = device->CreateRenderPass(builder.state);
     }
@@ -954,21 +859,64 @@ int main()
         textures_set_layout = device->CreateDescriptorSetLayout(builder.state);
     }
 
+    // Create bindless textures set layout
+    auto bindless_textures_set_layout = UniqueDescriptorSetLayout();
+    if (is_bindless) {
+        auto builder = DescriptorSetLayout::Builder();
+
+        builder.AddDescriptorSetLayoutBinding(
+            Binding{ 10 },
+            DescriptorType::CombinedImageSampler,
+            DescriptorManager::kMaxBindlessTextures,
+            ShaderStage::Fragment,
+            DescriptorBindingFlags::UpdateAfterBind | DescriptorBindingFlags::UpdateUnusedWhilePending |
+                DescriptorBindingFlags::PartiallyBound);
+
+        bindless_textures_set_layout = device->CreateDescriptorSetLayout(builder.state);
+    }
+
     // Create pipeline layout
     auto pipeline_layout = UniquePipelineLayout();
     {
-        auto builder = PipelineLayout::Builder();
+        // The recording benchmark pushes the model matrix whatever path the frame itself uses.
+        auto is_model_pushed = model_transform == RenderContext::ModelTransform::PushConstant ||
+                               recording_benchmark == RenderContext::RecordingBenchmark::Enable;
+        auto builder         = PipelineLayout::Builder();
         builder.AddDescriptorSetLayout(*transforms_set_layout);
-        builder.AddDescriptorSetLayout(*textures_set_layout);
+        builder.AddDescriptorSetLayout(is_bindless ? *bindless_textures_set_layout : *textures_set_layout);
+        if (is_bindless) {
+            builder.AddPushConstantRange(ShaderStage::Vertex | ShaderStage::Fragment, 0, sizeof(DrawConstants));
+        } else if (is_model_pushed) {
+            builder.AddPushConstantRange(ShaderStage::Vertex, 0, sizeof(ModelUniform));
+        }
         pipeline_layout = device->CreatePipelineLayout(builder.state);
     }
 
-    // Create pipeline
-    auto pipeline = UniquePipeline();
+    auto pipeline_cache_path = std::filesystem::path("pipeline_cache.bin");
+    auto pipeline_cache_size = size_t{ 0 };
+    auto pipeline_cache      = UniquePipelineCache();
+    {
+        auto data           = LoadPipelineCacheData(pipeline_cache_path, gpu_properties);
+        pipeline_cache_size = data.size();
+        pipeline_cache      = device->CreatePipelineCache(data);
+    }
+
+    // Create pipelines; point clouds share everything with meshes but the topology.
+    auto pipeline       = UniquePipeline();
+    auto point_pipeline = UniquePipeline();
     {
+        auto is_push_constant   = model_transform == RenderContext::ModelTransform::PushConstant;
+        auto vs_name            = is_push_constant ? "shaders/shader_push_constants.vert" : "shaders/shader.vert";
+        auto fs_name            = "shaders/shader.frag";
         auto builder            = Pipeline::Builder(*pipeline_layout, *renderpass);
-        auto [vs_data, vs_size] = GetResource("shaders/shader.vert");
-        auto [fs_data, fs_size] = GetResource("shaders/shader.frag");
+
+        if (is_bindless) {
+            vs_name = "shaders/shader_bindless.vert";
+            fs_name = "shaders/shader_bindless.frag";
+        }
+
+        auto [vs_data, vs_size] = GetResource(vs_name);
+        auto [fs_data, fs_size] = GetResource(fs_name);
         auto vertex_shader      = device->CreateShaderModule(vs_data, vs_size);
         auto fragment_shader    = device->CreateShaderModule(fs_data, fs_size);
         auto width              = narrow_cast<float>(extent.width);
@@ -978,39 +926,91 @@ int main()
 
         builder.AddShaderStage(*vertex_shader, ShaderStage::Vertex);
         builder.AddShaderStage(*fragment_shader, ShaderStage::Fragment);
-        builder.AddVertexInputBindingDescription(Binding{ 0 }, sizeof(Vertex));
+        builder.AddVertexInputBindingDescription(Binding{ 0 }, sizeof(ModelVertex));
         builder.AddVertexInputAttributeDescription(
             Location{ 0 },
             Binding{ 0 },
-            formatof(Vertex, position),
-            offsetof(Vertex, position));
+            formatof(ModelVertex, position),
+            offsetof(ModelVertex, position));
         builder.AddVertexInputAttributeDescription(
             Location{ 1 },
             Binding{ 0 },
-            formatof(Vertex, normal),
-            offsetof(Vertex, normal));
+            formatof(ModelVertex, normal),
+            offsetof(ModelVertex, normal));
         builder.AddVertexInputAttributeDescription(
             Location{ 2 },
             Binding{ 0 },
-            formatof(Vertex, uv),
-            offsetof(Vertex, uv));
+            formatof(ModelVertex, uv),
+            offsetof(ModelVertex, uv));
         builder.AddViewport(viewport);
         builder.AddScissor(scissor);
         builder.AddDynamicStates({ DynamicState::Viewport, DynamicState::Scissor });
         builder.SetDepthState(DepthTest::Enable, DepthWrite::Enable, CompareOp::Less);
         builder.AddColorBlendAttachmentState();
 
-        pipeline = device->CreateGraphicsPipeline(builder.state);
+        auto create_pipelines = [&](PipelineCache cache) {
+            auto start = std::chrono::steady_clock::now();
+
+            builder.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+            pipeline = device->CreateGraphicsPipeline(builder.state, cache);
+
+            builder.SetPrimitiveTopology(PrimitiveTopology::PointList);
+            point_pipeline = device->CreateGraphicsPipeline(builder.state, cache);
+
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        if (compare_pipeline_cache) {
+            auto empty_cache = device->CreatePipelineCache();
+            auto elapsed     = create_pipelines(*empty_cache);
+
+            spdlog::info("Graphics pipelines created in {:.3f} ms (cold, empty pipeline cache)", elapsed);
+        }
+
+        auto elapsed = create_pipelines(*pipeline_cache);
+
+        spdlog::info(
+            "Graphics pipelines created in {:.3f} ms ({}, {} bytes of pipeline cache data)",
+            elapsed,
+            pipeline_cache_size ? "warm" : "cold",
+            pipeline_cache_size);
     }
 
+    // Uploads share the graphics queue so they can be batched into a single submit and need no queue family
+    // ownership transfer before rendering.
     auto texture_loader = TextureLoader(*device, queues.graphics);
-    auto buffer_manager = BufferManager(*device, queues.transfer);
+    auto buffer_manager = BufferManager(
+        *device,
+        queues.graphics,
+        has_memory_budget ? gpu : PhysicalDevice(),
+        geometry_memory_budget);
 
     uint32_t image_count = 3;
     uint32_t frame_count = 2;
 
-    auto descriptor_manager =
-        DescriptorManager(*device, frame_count, *transforms_set_layout, *textures_set_layout, gpu_properties.limits);
+    auto timestamp_period = gpu_properties.limits.timestampComputeAndGraphics ? gpu_properties.limits.timestampPeriod
+                                                                              : 0.0f;
+
+    auto descriptor_manager = DescriptorManager(
+        *device,
+        frame_count,
+        *transforms_set_layout,
+        *textures_set_layout,
+        *bindless_textures_set_layout,
+        gpu_properties.limits);
+
+    // One more texture than the array holds, counting the default image, so that the last one falls back to it.
+    auto stress_texture_count = uint32_t{ 0 };
+
+    if (stress_textures && !is_bindless) {
+        spdlog::warn("Texture stress test needs bindless textures, ignoring --stress-textures");
+    } else if (stress_textures) {
+        stress_texture_count = DescriptorManager::kMaxBindlessTextures;
+    }
+
+    for (uint32_t i = 0; i < stress_texture_count; ++i) {
+        texture_loader.LoadSolidColor(StressTextureName(i), StressTextureColor(i));
+    }
 
     auto render_context = RenderContext();
 
@@ -1038,14 +1038,19 @@ int main()
         lights.FillRef().AzimuthRef()    = ToRadians(25_deg).value;
     }
 
+    auto gpu_timeline = GpuTimeline(*device);
+
     auto event_handler = EventHandler(
-        device.get(),
+        queues.graphics,
+        &gpu_timeline,
         glfw_window.get(),
         &render_context,
         &scene,
         &camera,
         &buffer_manager,
-        &texture_loader);
+        &texture_loader,
+        buffer_residency,
+        stress_texture_count);
 
     auto parameters = Gui::Parameters{
 
@@ -1053,7 +1058,8 @@ int main()
         .gpu            = gpu,
         .device         = *device,
         .graphics_queue = queues.graphics,
-        .renderpass     = *gui_renderpass,
+        .renderpass     = gui_renderpass ? *gui_renderpass : *renderpass,
+        .pipeline_cache = *pipeline_cache,
         .extent         = extent
     };
 
@@ -1063,8 +1069,14 @@ int main()
         .OnFileOpen = [&event_handler](std::string filepath) { event_handler.ScheduleLoadFile(std::move(filepath)); }
     };
 
+    auto gui_start = std::chrono::steady_clock::now();
+
     auto gui = Gui(parameters, callbacks, glfw_window.get(), image_count, image_count, &camera, &scene, &lights);
 
+    auto gui_elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - gui_start).count();
+
+    spdlog::info("GUI initialized in {:.3f} ms", gui_elapsed);
+
     bool running = true;
 
     while (running) {
@@ -1080,14 +1092,23 @@ int main()
             queues.presentation,
             PresentModeKHR::Fifo);
 
-        auto frame_manager = FrameManager(*device, queue_families.graphics.family_index, frame_count);
+        auto frame_manager = FrameManager(*device, queue_families.graphics.family_index, frame_count, &gpu_timeline);
 
         render_context = RenderContext(
             *device,
             queues.graphics,
             *pipeline,
+            *point_pipeline,
             *pipeline_layout,
+            gui_pass,
+            model_transform,
+            texture_binding,
+            meshlet_culling,
+            recording_benchmark,
+            point_budget,
+            timestamp_period,
             glfw_window.get(),
+            &gpu_timeline,
             &swapchain_manager,
             &frame_manager,
             &descriptor_manager,
@@ -1130,5 +1151,7 @@ int main()
         }
     }
 
+    SavePipelineCacheData(pipeline_cache_path, pipeline_cache->GetPipelineCacheData());
+
     return 0;
 }
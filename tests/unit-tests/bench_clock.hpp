@@ -0,0 +1,21 @@
+#pragma once
+
+#include <chrono>
+
+// Clock and conversions shared by the benchmarks in the unit tests.
+using BenchClock = std::chrono::steady_clock;
+
+inline double ToSeconds(BenchClock::duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+inline double ToMilliseconds(BenchClock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+inline double ToNanoseconds(BenchClock::duration duration)
+{
+    return std::chrono::duration<double, std::nano>(duration).count();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Memory resource that counts the allocations made through it, so that a test can check that a code path does not
+// allocate by handing the containers it exercises a polymorphic allocator over this resource.
+class CountingResource final : public std::pmr::memory_resource {
+  public:
+    auto AllocationCount() const noexcept { return m_allocation_count; }
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        m_allocation_count++;
+        return m_upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+    {
+        m_upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource* m_upstream         = std::pmr::new_delete_resource();
+    size_t                     m_allocation_count = 0;
+};
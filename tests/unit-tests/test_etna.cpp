@@ -1,10 +1,19 @@
+#include "etna/buffer.hpp"
+#include "etna/command.hpp"
 #include "etna/core.hpp"
+#include "etna/image.hpp"
 
 #include <array>
 #include <doctest/doctest.h>
+#include <vector>
 
 using etna::narrow_cast;
 
+using etna::Access;
+using etna::CommandBuffer;
+using etna::ImageLayout;
+using etna::PipelineStage;
+
 TEST_CASE("testing etna::narrow_cast function")
 {
     CHECK_NOTHROW(narrow_cast<char>(0));
@@ -36,3 +45,123 @@ TEST_CASE("testing etna::narrow_cast function")
 
     CHECK_THROWS(narrow_cast<float>(1'000'000'001));
 }
+
+// Stands in for vkCmdPipelineBarrier and records what each call passed.
+struct PipelineBarrierCall final {
+    VkCommandBuffer       command_buffer;
+    VkPipelineStageFlags  src_stage_mask;
+    VkPipelineStageFlags  dst_stage_mask;
+    uint32_t              memory_barrier_count;
+    uint32_t              buffer_barrier_count;
+    uint32_t              image_barrier_count;
+    VkImageMemoryBarrier  last_image_barrier;
+    VkBufferMemoryBarrier first_buffer_barrier;
+};
+
+static std::vector<PipelineBarrierCall> g_pipeline_barrier_calls;
+
+static VKAPI_ATTR void VKAPI_CALL CountPipelineBarrier(
+    VkCommandBuffer              command_buffer,
+    VkPipelineStageFlags         src_stage_mask,
+    VkPipelineStageFlags         dst_stage_mask,
+    VkDependencyFlags            /*dependency_flags*/,
+    uint32_t                     memory_barrier_count,
+    const VkMemoryBarrier*       /*memory_barriers*/,
+    uint32_t                     buffer_barrier_count,
+    const VkBufferMemoryBarrier* buffer_barriers,
+    uint32_t                     image_barrier_count,
+    const VkImageMemoryBarrier*  image_barriers)
+{
+    g_pipeline_barrier_calls.push_back({ command_buffer,
+                                         src_stage_mask,
+                                         dst_stage_mask,
+                                         memory_barrier_count,
+                                         buffer_barrier_count,
+                                         image_barrier_count,
+                                         image_barriers[image_barrier_count - 1],
+                                         buffer_barriers[0] });
+}
+
+TEST_CASE("testing etna::CommandBuffer::BarrierBatch")
+{
+    auto barrier_batch = CommandBuffer::BarrierBatch();
+
+    CHECK(barrier_batch.IsEmpty());
+
+    constexpr size_t image_count = 500;
+
+    for (size_t i = 0; i != image_count; ++i) {
+        barrier_batch.AddImageBarrier(
+            etna::Image2D{},
+            PipelineStage::TopOfPipe,
+            PipelineStage::Transfer,
+            {},
+            Access::TransferWrite,
+            ImageLayout::Undefined,
+            ImageLayout::TransferDstOptimal,
+            { etna::ImageAspect::Color, 0, 4, 0, 6 });
+    }
+
+    barrier_batch.AddBufferBarrier(
+        etna::Buffer{},
+        PipelineStage::Transfer,
+        PipelineStage::VertexInput,
+        Access::TransferWrite,
+        Access::VertexAttributeRead,
+        0,
+        VK_WHOLE_SIZE,
+        0,
+        1);
+
+    barrier_batch.AddMemoryBarrier(
+        PipelineStage::Transfer,
+        PipelineStage::FragmentShader,
+        Access::TransferWrite,
+        Access::ShaderRead);
+
+    CHECK(!barrier_batch.IsEmpty());
+    CHECK(barrier_batch.ImageBarrierCount() == image_count);
+    CHECK(barrier_batch.BufferBarrierCount() == 1);
+    CHECK(barrier_batch.MemoryBarrierCount() == 1);
+    CHECK(barrier_batch.BarrierCount() == image_count + 2);
+
+    CHECK(barrier_batch.SrcStageMask() == (PipelineStage::TopOfPipe | PipelineStage::Transfer));
+    CHECK(
+        barrier_batch.DstStageMask() ==
+        (PipelineStage::Transfer | PipelineStage::VertexInput | PipelineStage::FragmentShader));
+
+    // The whole batch is recorded with one vkCmdPipelineBarrier call.
+    auto command_buffer_storage = int{};
+    auto command_buffer         = reinterpret_cast<VkCommandBuffer>(&command_buffer_storage);
+
+    g_pipeline_barrier_calls.clear();
+    barrier_batch.Record(command_buffer, CountPipelineBarrier);
+
+    REQUIRE(g_pipeline_barrier_calls.size() == 1);
+
+    const auto& call = g_pipeline_barrier_calls.front();
+
+    CHECK(call.command_buffer == command_buffer);
+    CHECK(call.src_stage_mask == VkEnum(PipelineStage::TopOfPipe | PipelineStage::Transfer));
+    CHECK(
+        call.dst_stage_mask ==
+        VkEnum(PipelineStage::Transfer | PipelineStage::VertexInput | PipelineStage::FragmentShader));
+    CHECK(call.memory_barrier_count == 1);
+    CHECK(call.buffer_barrier_count == 1);
+    CHECK(call.image_barrier_count == image_count);
+    CHECK(call.last_image_barrier.newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    CHECK(call.last_image_barrier.subresourceRange.layerCount == 6);
+    CHECK(call.first_buffer_barrier.dstAccessMask == VkEnum(Access::VertexAttributeRead));
+
+    barrier_batch.Clear();
+
+    CHECK(barrier_batch.IsEmpty());
+    CHECK(barrier_batch.BarrierCount() == 0);
+    CHECK(!barrier_batch.SrcStageMask());
+    CHECK(!barrier_batch.DstStageMask());
+
+    // An empty batch records nothing.
+    barrier_batch.Record(command_buffer, CountPipelineBarrier);
+
+    CHECK(g_pipeline_barrier_calls.size() == 1);
+}
@@ -0,0 +1,794 @@
+#include "bench_clock.hpp"
+#include "meshlet.hpp"
+#include "model_loader.hpp"
+#include "point_cloud.hpp"
+#include "utils/cast.hpp"
+#include "utils/stream_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct Grid final {
+    std::vector<ModelVertex> vertices;
+    std::vector<uint32_t>    indices;
+};
+
+// A unit square in the XY plane, split into size x size cells of two triangles each.
+static Grid MakeGrid(uint32_t size)
+{
+    auto grid = Grid{};
+    auto step = 1.0f / static_cast<float>(size);
+
+    for (uint32_t j = 0; j <= size; ++j) {
+        for (uint32_t i = 0; i <= size; ++i) {
+            auto u = static_cast<float>(i) * step;
+            auto v = static_cast<float>(j) * step;
+            grid.vertices.emplace_back(glm::vec3(u, v, 0), glm::vec3(0, 0, 1), glm::vec2(u, v));
+        }
+    }
+
+    for (uint32_t j = 0; j < size; ++j) {
+        for (uint32_t i = 0; i < size; ++i) {
+            auto a = j * (size + 1) + i;
+            auto b = a + 1;
+            auto c = a + size + 1;
+            auto d = c + 1;
+            grid.indices.insert(grid.indices.end(), { a, b, d, a, d, c });
+        }
+    }
+
+    return grid;
+}
+
+static void WriteObj(const fs::path& filepath, const Grid& grid)
+{
+    auto file = std::ofstream(filepath);
+
+    for (const auto& vertex : grid.vertices) {
+        file << "v " << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n';
+        file << "vn " << vertex.normal.x << ' ' << vertex.normal.y << ' ' << vertex.normal.z << '\n';
+        file << "vt " << vertex.uv.x << ' ' << vertex.uv.y << '\n';
+    }
+
+    for (size_t i = 0; i < grid.indices.size(); i += 3) {
+        file << 'f';
+        for (size_t k = 0; k < 3; ++k) {
+            auto index = grid.indices[i + k] + 1;
+            file << ' ' << index << '/' << index << '/' << index;
+        }
+        file << '\n';
+    }
+}
+
+static void WriteU32(std::ofstream& file, uint32_t value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Vertices are stored interleaved in the ModelVertex layout, so the loader can take them as they are.
+static auto WriteGlb(const fs::path& filepath, const Grid& grid, const std::string& nodes) -> std::vector<std::byte>
+{
+    auto vertices_size = grid.vertices.size() * sizeof(ModelVertex);
+    auto indices_size  = grid.indices.size() * sizeof(uint32_t);
+
+    auto bin = std::vector<std::byte>(vertices_size + indices_size);
+    std::memcpy(bin.data(), grid.vertices.data(), vertices_size);
+    std::memcpy(bin.data() + vertices_size, grid.indices.data(), indices_size);
+
+    auto count = std::to_string(grid.vertices.size());
+    auto json  = std::string() + R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],"nodes":)" + nodes +
+                R"(,"meshes":[{"name":"Grid","primitives":[{"attributes":{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2},)" +
+                R"("indices":3,"material":0}]}],"materials":[{"name":"Paint","pbrMetallicRoughness":)" +
+                R"({"baseColorFactor":[1,0.5,0.25,1]}}],"buffers":[{"byteLength":)" + std::to_string(bin.size()) +
+                R"(}],"bufferViews":[{"buffer":0,"byteLength":)" + std::to_string(vertices_size) +
+                R"(,"byteStride":32},{"buffer":0,"byteOffset":)" + std::to_string(vertices_size) +
+                R"(,"byteLength":)" + std::to_string(indices_size) + R"(}],"accessors":[)" +
+                R"({"bufferView":0,"componentType":5126,"type":"VEC3","count":)" + count +
+                R"(,"min":[0,0,0],"max":[1,1,0]},)" +
+                R"({"bufferView":0,"byteOffset":12,"componentType":5126,"type":"VEC3","count":)" + count + "}," +
+                R"({"bufferView":0,"byteOffset":24,"componentType":5126,"type":"VEC2","count":)" + count + "}," +
+                R"({"bufferView":1,"componentType":5125,"type":"SCALAR","count":)" +
+                std::to_string(grid.indices.size()) + "}]}";
+
+    json.resize((json.size() + 3) / 4 * 4, ' ');
+    bin.resize((bin.size() + 3) / 4 * 4);
+
+    auto file = std::ofstream(filepath, std::ios::binary);
+
+    WriteU32(file, 0x46546C67);
+    WriteU32(file, 2);
+    WriteU32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    WriteU32(file, static_cast<uint32_t>(json.size()));
+    WriteU32(file, 0x4E4F534A);
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    WriteU32(file, static_cast<uint32_t>(bin.size()));
+    WriteU32(file, 0x004E4942);
+    file.write(reinterpret_cast<const char*>(bin.data()), static_cast<std::streamsize>(bin.size()));
+
+    return bin;
+}
+
+static bool IsClose(const AABB& lhs, const AABB& rhs)
+{
+    auto close = [](Float3 a, Float3 b) {
+        return std::abs(a.x - b.x) < 1e-5f && std::abs(a.y - b.y) < 1e-5f && std::abs(a.z - b.z) < 1e-5f;
+    };
+    return close(lhs.min, rhs.min) && close(lhs.max, rhs.max);
+}
+
+// Triangles in a canonical order, to compare index buffers whose triangles were reordered.
+static auto SortTriangles(std::span<const uint32_t> indices)
+{
+    auto triangles = std::vector<std::array<uint32_t, 3>>{};
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static auto GetName(NodePtr node)
+{
+    return std::get<std::string>(node->GetProperty(kNameAtom));
+}
+
+TEST_CASE("testing glb loader")
+{
+    auto dir = fs::temp_directory_path() / "vega-test-glb";
+    fs::create_directories(dir);
+
+    auto grid  = MakeGrid(4);
+    auto nodes = std::string(R"([{"name":"Root","translation":[10,0,0],"rotation":[0,0,0.70710678,0.70710678],)") +
+                 R"("scale":[2,2,2],"children":[1]},{"name":"Holder","mesh":0}])";
+    auto bin   = WriteGlb(dir / "grid.glb", grid, nodes);
+
+    auto file = LoadModel(dir / "grid.glb");
+    CHECK(file.textures.empty());
+
+    auto scene     = Scene();
+    auto committed = scene.Commit(std::move(file.builder));
+    REQUIRE(committed.size() == 1);
+    CHECK(GetName(committed.front()) == "grid.glb");
+
+    // Translation, rotation and scale become a chain of nodes, outermost first.
+    auto translate = committed.front()->GetChildren().at(0);
+    auto rotate    = translate->GetChildren().at(0);
+    auto scale     = rotate->GetChildren().at(0);
+    auto holder    = scale->GetChildren().at(0);
+    auto instance  = holder->GetChildren().at(0);
+
+    CHECK(dynamic_cast<TranslateNode*>(translate) != nullptr);
+    CHECK(dynamic_cast<RotateNode*>(rotate) != nullptr);
+    CHECK(dynamic_cast<ScaleNode*>(scale) != nullptr);
+    CHECK(dynamic_cast<GroupNode*>(holder) != nullptr);
+    CHECK(dynamic_cast<InstanceNode*>(instance) != nullptr);
+    CHECK(GetName(translate) == "Root");
+    CHECK(GetName(holder) == "Holder");
+    CHECK(GetName(instance) == "Grid");
+
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { 8, 0, 0 }, { 10, 2, 0 } }));
+
+    auto draw_list = scene.ComputeDrawList();
+    std::erase_if(draw_list, [](const DrawRecord& record) { return record.mesh == nullptr; });
+    REQUIRE(draw_list.size() == 1);
+
+    // The interleaved vertices are not read at load time; they are copied from the binary chunk byte for byte when the
+    // buffer is first used. The indices are read, since meshlets reorder their triangles.
+    auto mesh          = draw_list.front().mesh;
+    auto vertex_buffer = mesh->GetVertexBuffer();
+    auto index_buffer  = mesh->GetIndexBuffer();
+    auto vertices_size = grid.vertices.size() * sizeof(ModelVertex);
+
+    REQUIRE(vertex_buffer->Size() == vertices_size);
+    REQUIRE(index_buffer->Size() == grid.indices.size() * sizeof(uint32_t));
+    CHECK(vertex_buffer->GetResidency() == BufferResidency::Released);
+    CHECK(index_buffer->GetResidency() == BufferResidency::Resident);
+
+    auto data = std::vector<std::byte>(vertices_size);
+    vertex_buffer->CopyTo(data.data());
+    CHECK(std::memcmp(data.data(), bin.data(), data.size()) == 0);
+
+    // A file rewritten after loading, even at the same size, is no longer read from.
+    fs::last_write_time(dir / "grid.glb", fs::last_write_time(dir / "grid.glb") + std::chrono::seconds(1));
+    CHECK_THROWS(vertex_buffer->CopyTo(data.data()));
+
+    auto indices = std::span(static_cast<const uint32_t*>(index_buffer->Data()), grid.indices.size());
+    CHECK(SortTriangles(indices) == SortTriangles(grid.indices));
+    CHECK(mesh->GetIndexCount() == grid.indices.size());
+    CHECK(mesh->GetMeshlets().size() == 1);
+    CHECK(std::get<std::string>(draw_list.front().material->GetProperty(kNameAtom)) == "Paint");
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("testing gltf loader")
+{
+    auto dir = fs::temp_directory_path() / "vega-test-gltf";
+    fs::create_directories(dir);
+
+    // One triangle with 16-bit indices and no normals, stored as a base64 data URI:
+    // positions (0,0,0) (1,0,0) (0,1,0), then indices 0 1 2 and two bytes of padding.
+    auto json = std::string(R"({"asset":{"version":"2.0"},"nodes":[{"matrix":[0,3,0,0,-3,0,0,0,0,0,3,0,1,2,3,1],)") +
+                R"("mesh":0}],"meshes":[{"primitives":[{"attributes":{"POSITION":0},"indices":1}]}],)" +
+                R"("buffers":[{"byteLength":44,"uri":"data:application/octet-stream;base64,)" +
+                R"(AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAAAAABAAIAAAA="}],)" +
+                R"("bufferViews":[{"buffer":0,"byteLength":36},{"buffer":0,"byteOffset":36,"byteLength":6}],)" +
+                R"("accessors":[{"bufferView":0,"componentType":5126,"type":"VEC3","count":3},)" +
+                R"({"bufferView":1,"componentType":5123,"type":"SCALAR","count":3}]})";
+
+    std::ofstream(dir / "triangle.gltf") << json;
+
+    auto file = LoadModel(dir / "triangle.gltf");
+
+    auto scene     = Scene();
+    auto committed = scene.Commit(std::move(file.builder));
+    REQUIRE(committed.size() == 1);
+
+    // The matrix is decomposed into translation, a quarter turn about Z and a scale of 3.
+    auto translate = committed.front()->GetChildren().at(0);
+    auto rotate    = translate->GetChildren().at(0);
+    auto scale     = rotate->GetChildren().at(0);
+
+    CHECK(dynamic_cast<TranslateNode*>(translate) != nullptr);
+    CHECK(dynamic_cast<RotateNode*>(rotate) != nullptr);
+    CHECK(dynamic_cast<ScaleNode*>(scale) != nullptr);
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { -2, 2, 3 }, { 1, 5, 3 } }));
+
+    auto draw_list = scene.ComputeDrawList();
+    std::erase_if(draw_list, [](const DrawRecord& record) { return record.mesh == nullptr; });
+    REQUIRE(draw_list.size() == 1);
+
+    // Indices are widened to 32 bits and the missing normals generated from the face. Data URIs have no file to read
+    // again, so their buffers stay resident.
+    auto mesh     = draw_list.front().mesh;
+    auto indices  = static_cast<const uint32_t*>(mesh->GetIndexBuffer()->Data());
+    auto vertices = static_cast<const ModelVertex*>(mesh->GetVertexBuffer()->Data());
+
+    REQUIRE(mesh->GetIndexBuffer()->Size() == 3 * sizeof(uint32_t));
+    CHECK(mesh->GetVertexBuffer()->GetResidency() == BufferResidency::Resident);
+    CHECK((indices[0] == 0 && indices[1] == 1 && indices[2] == 2));
+    CHECK(std::abs(vertices[0].normal.z - 1.0f) < 1e-5f);
+
+    CHECK_THROWS(LoadModel(dir / "missing.gltf"));
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("benchmarking glb and obj loaders" * doctest::skip())
+{
+    auto dir = fs::temp_directory_path() / "vega-bench-loaders";
+    fs::create_directories(dir);
+
+    auto grid = MakeGrid(512);
+
+    WriteObj(dir / "grid.obj", grid);
+    WriteGlb(dir / "grid.glb", grid, R"([{"mesh":0}])");
+
+    auto obj_start = BenchClock::now();
+    auto obj       = LoadModel(dir / "grid.obj");
+    auto obj_end   = BenchClock::now();
+    auto glb       = LoadModel(dir / "grid.glb");
+    auto glb_end   = BenchClock::now();
+
+    MESSAGE(
+        grid.vertices.size() << " vertices: obj " << ToMilliseconds(obj_end - obj_start) << " ms, glb "
+                             << ToMilliseconds(glb_end - obj_end) << " ms");
+
+    auto obj_scene = Scene();
+    auto glb_scene = Scene();
+
+    obj_scene.Commit(std::move(obj.builder));
+    glb_scene.Commit(std::move(glb.builder));
+
+    auto obj_draw_list = obj_scene.ComputeDrawList();
+    auto glb_draw_list = glb_scene.ComputeDrawList();
+
+    REQUIRE(obj_draw_list.size() == 1);
+    REQUIRE(glb_draw_list.size() == 1);
+    auto obj_mesh = obj_draw_list.front().mesh;
+    auto glb_mesh = glb_draw_list.front().mesh;
+
+    CHECK(obj_mesh->GetIndexCount() == glb_mesh->GetIndexCount());
+    CHECK(obj_mesh->GetVertexBuffer()->Size() == glb_mesh->GetVertexBuffer()->Size());
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("testing meshlets")
+{
+    auto grid     = MakeGrid(64);
+    auto indices  = grid.indices;
+    auto vertices = std::as_bytes(std::span(grid.vertices));
+    auto meshlets = BuildMeshlets(vertices, sizeof(ModelVertex), indices);
+
+    REQUIRE(!meshlets.empty());
+    CHECK(SortTriangles(indices) == SortTriangles(grid.indices));
+
+    auto next = size_t{ 0 };
+    for (const auto& meshlet : meshlets) {
+        CHECK(meshlet.first_index == next);
+        CHECK(meshlet.index_count % 3 == 0);
+        CHECK(meshlet.index_count / 3 <= Meshlet::kMaxTriangles);
+
+        auto unique = std::set<uint32_t>{};
+        for (auto i = meshlet.first_index; i != meshlet.first_index + meshlet.index_count; ++i) {
+            auto position = grid.vertices[indices[i]].position;
+            auto offset   = position - glm::vec3(meshlet.center.x, meshlet.center.y, meshlet.center.z);
+            CHECK(glm::length(offset) <= meshlet.radius + 1e-5f);
+            unique.insert(indices[i]);
+        }
+        CHECK(unique.size() <= Meshlet::kMaxVertices);
+        CHECK(meshlet.cone_cutoff < 1e-3f); // The grid is flat, so every cone is a line along +Z
+
+        next += meshlet.index_count;
+    }
+    CHECK(next == indices.size());
+
+    // The grid spans the unit square at z = 0 and faces +Z.
+    auto projection = glm::perspectiveRH(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+    auto front      = glm::lookAtRH(glm::vec3(0.5f, 0.5f, 2), glm::vec3(0.5f, 0.5f, 0), glm::vec3(0, 1, 0));
+    auto back       = glm::lookAtRH(glm::vec3(0.5f, 0.5f, -2), glm::vec3(0.5f, 0.5f, 0), glm::vec3(0, 1, 0));
+    auto away       = glm::lookAtRH(glm::vec3(0.5f, 0.5f, 2), glm::vec3(0.5f, 0.5f, 4), glm::vec3(0, 1, 0));
+    auto model      = glm::mat4(1);
+
+    auto culled = [&](const glm::mat4& view, bool cull_backfaces) {
+        auto ranges = std::vector<IndexRange>{};
+        auto count  = CullMeshlets(meshlets, MeshletView::Create(projection, view, model, cull_backfaces), &ranges);
+        auto drawn  = size_t{ 0 };
+        for (const auto& range : ranges) {
+            drawn += range.index_count;
+        }
+        CHECK(count + drawn == indices.size());
+        return count;
+    };
+
+    CHECK(culled(front, true) == 0);
+    CHECK(culled(back, false) == 0);
+    CHECK(culled(back, true) == indices.size());
+    CHECK(culled(away, false) == indices.size());
+
+    // Visible neighbours are drawn as one range.
+    auto ranges = std::vector<IndexRange>{};
+    CullMeshlets(meshlets, MeshletView::Create(projection, front, model, false), &ranges);
+    CHECK(ranges.size() == 1);
+
+    auto out_of_range = std::vector<uint32_t>{ 0, 1, utils::narrow_cast<uint32_t>(grid.vertices.size()) };
+    CHECK_THROWS(BuildMeshlets(vertices, sizeof(ModelVertex), out_of_range));
+}
+
+TEST_CASE("benchmarking meshlet culling" * doctest::skip())
+{
+    // A 1000 x 1000 terrain of two million triangles, seen by a walker standing in the middle of it.
+    auto grid = MakeGrid(1024);
+    for (auto& vertex : grid.vertices) {
+        auto x          = vertex.position.x * 1000.0f;
+        auto y          = vertex.position.y * 1000.0f;
+        vertex.position = glm::vec3(x, y, 4.0f * std::sin(x / 25.0f) * std::cos(y / 30.0f));
+    }
+
+    auto indices    = grid.indices;
+    auto vertices   = std::as_bytes(std::span(grid.vertices));
+    auto start      = BenchClock::now();
+    auto meshlets   = BuildMeshlets(vertices, sizeof(ModelVertex), indices);
+    auto build_time = BenchClock::now() - start;
+
+    MESSAGE(
+        indices.size() / 3 << " triangles into " << meshlets.size() << " meshlets in " << ToMilliseconds(build_time)
+                           << " ms");
+
+    auto projection = glm::perspectiveRH(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+    auto model      = glm::mat4(1);
+    auto eye        = glm::vec3(500, 500, 6);
+
+    for (auto [name, target] : { std::pair{ "level", glm::vec3(900, 620, 6) }, { "down", glm::vec3(540, 510, 0) } }) {
+        auto view = glm::lookAtRH(eye, target, glm::vec3(0, 0, 1));
+
+        for (auto cull_backfaces : { false, true }) {
+            auto ranges     = std::vector<IndexRange>{};
+            auto cull_start = BenchClock::now();
+            auto culled = CullMeshlets(meshlets, MeshletView::Create(projection, view, model, cull_backfaces), &ranges);
+            auto cull_time  = BenchClock::now() - cull_start;
+
+            CHECK(culled < indices.size());
+
+            MESSAGE(
+                "looking " << name << (cull_backfaces ? ", frustum and cone: " : ", frustum: ")
+                           << 100.0 * static_cast<double>(culled) / static_cast<double>(indices.size())
+                           << "% of triangles culled in " << ToMilliseconds(cull_time) << " ms, " << ranges.size()
+                           << " draws");
+        }
+    }
+}
+
+TEST_CASE("testing point cloud loader")
+{
+    auto dir = fs::temp_directory_path() / "vega-test-points";
+    fs::create_directories(dir);
+
+    // A scan lists vertices only.
+    auto grid = MakeGrid(150);
+    {
+        auto file = std::ofstream(dir / "scan.obj");
+        for (const auto& vertex : grid.vertices) {
+            file << "v " << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n';
+        }
+    }
+
+    auto file  = LoadModel(dir / "scan.obj");
+    auto scene = Scene();
+    scene.Commit(std::move(file.builder));
+
+    auto draw_list = scene.ComputeDrawList();
+    std::erase_if(draw_list, [](const DrawRecord& record) { return record.mesh == nullptr; });
+    REQUIRE(draw_list.size() == 1);
+
+    auto mesh        = draw_list.front().mesh;
+    auto nodes       = mesh->GetPointNodes();
+    auto point_count = grid.vertices.size();
+    auto indices     = std::span(static_cast<const uint32_t*>(mesh->GetIndexBuffer()->Data()), point_count);
+    auto vertices    = static_cast<const ModelVertex*>(mesh->GetVertexBuffer()->Data());
+
+    REQUIRE(mesh->GetTopology() == MeshTopology::Points);
+    REQUIRE(mesh->GetIndexCount() == point_count);
+    REQUIRE(nodes.size() > 1);
+
+    // Every point is listed once, inside the node that holds it.
+    auto sorted = std::vector<uint32_t>(indices.begin(), indices.end());
+    std::sort(sorted.begin(), sorted.end());
+    CHECK(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    CHECK(sorted.back() == point_count - 1);
+
+    auto outside = size_t{ 0 };
+    for (const auto& node : nodes) {
+        auto center = glm::vec3(node.center.x, node.center.y, node.center.z);
+        for (auto i = node.first_index; i != node.first_index + node.index_count; ++i) {
+            outside += glm::length(vertices[indices[i]].position - center) > node.radius * 1.0001f;
+        }
+        CHECK(node.child_count <= 8);
+    }
+    CHECK(outside == 0);
+
+    // A budget caps the points drawn, and a distant view needs fewer points than a close one.
+    auto projection  = glm::perspectiveRH(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+    auto near_view   = glm::lookAtRH(glm::vec3(0.5f, 0.5f, 0.3f), glm::vec3(0.5f, 0.5f, 0), glm::vec3(0, 1, 0));
+    auto far_view    = glm::lookAtRH(glm::vec3(0.5f, 0.5f, 50), glm::vec3(0.5f, 0.5f, 0), glm::vec3(0, 1, 0));
+    auto model       = glm::mat4(1);
+    auto pixel_scale = 1000.0f;
+
+    auto select = [&](const glm::mat4& view, size_t budget) {
+        auto ranges  = std::vector<IndexRange>{};
+        auto frustum = MeshletView::Create(projection, view, model, false);
+        auto points  = SelectPointNodes(nodes, frustum, pixel_scale, budget, &ranges);
+        auto drawn   = size_t{ 0 };
+        for (const auto& range : ranges) {
+            drawn += range.index_count;
+        }
+        CHECK(drawn == points);
+        return points;
+    };
+
+    auto near_points = select(near_view, point_count);
+    auto far_points  = select(far_view, point_count);
+
+    CHECK(near_points > far_points);
+    CHECK(far_points > 0);
+    CHECK(select(near_view, nodes[0].index_count) == nodes[0].index_count);
+    CHECK(select(near_view, nodes[0].index_count - 1) == 0);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("benchmarking point octree" * doctest::skip())
+{
+    // Sixteen million points of a 1000 x 1000 terrain, seen from above its middle.
+    auto grid = MakeGrid(4095);
+    for (auto& vertex : grid.vertices) {
+        auto x          = vertex.position.x * 1000.0f;
+        auto y          = vertex.position.y * 1000.0f;
+        vertex.position = glm::vec3(x, y, 4.0f * std::sin(x / 25.0f) * std::cos(y / 30.0f));
+    }
+
+    auto indices = std::vector<uint32_t>(grid.vertices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = utils::narrow_cast<uint32_t>(i);
+    }
+
+    auto start      = BenchClock::now();
+    auto nodes      = BuildPointOctree(std::as_bytes(std::span(grid.vertices)), sizeof(ModelVertex), indices);
+    auto build_time = BenchClock::now() - start;
+
+    MESSAGE(indices.size() << " points into " << nodes.size() << " nodes in " << ToMilliseconds(build_time) << " ms");
+
+    auto projection  = glm::perspectiveRH(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 5000.0f);
+    auto view        = glm::lookAtRH(glm::vec3(500, 500, 60), glm::vec3(700, 600, 0), glm::vec3(0, 0, 1));
+    auto frustum     = MeshletView::Create(projection, view, glm::mat4(1), false);
+    auto pixel_scale = projection[1][1] * 1080.0f / 2;
+
+    for (auto budget : { size_t{ 1'000'000 }, size_t{ 4'000'000 }, size_t{ 16'000'000 } }) {
+        auto ranges       = std::vector<IndexRange>{};
+        auto select_start = BenchClock::now();
+        auto points       = SelectPointNodes(nodes, frustum, pixel_scale, budget, &ranges);
+        auto select_time  = BenchClock::now() - select_start;
+
+        CHECK(points <= budget);
+
+        MESSAGE(
+            "budget " << budget << ": " << points << " points in " << ranges.size() << " draws, selected in "
+                      << ToMilliseconds(select_time) << " ms");
+    }
+}
+
+TEST_CASE("testing instancing of duplicated shapes")
+{
+    auto dir = fs::temp_directory_path() / "vega-test-instancing";
+    fs::create_directories(dir);
+
+    // A bent bracket, whose principal axes are distinct, and a turned pin, whose two equal spreads leave it to the
+    // vertex order to orient it.
+    auto bracket = MakeGrid(6);
+    for (auto& vertex : bracket.vertices) {
+        vertex.position.z = 0.4f * vertex.position.x * vertex.position.x + 0.1f * vertex.position.y;
+        vertex.position.x = 2 * vertex.position.x;
+    }
+
+    auto pin = Grid{};
+    for (uint32_t j = 0; j <= 4; ++j) {
+        for (uint32_t i = 0; i < 12; ++i) {
+            auto angle = 2 * glm::pi<float>() * static_cast<float>(i) / 12;
+            auto ring  = glm::vec3(std::cos(angle), std::sin(angle), 0);
+            auto uv    = glm::vec2(static_cast<float>(i) / 12, static_cast<float>(j) / 4);
+            pin.vertices.emplace_back(0.3f * ring + glm::vec3(0, 0, 0.5f * static_cast<float>(j)), ring, uv);
+        }
+    }
+    for (uint32_t j = 0; j < 4; ++j) {
+        for (uint32_t i = 0; i < 12; ++i) {
+            auto a = j * 12 + i;
+            auto b = j * 12 + (i + 1) % 12;
+            pin.indices.insert(pin.indices.end(), { a, b, b + 12, a, b + 12, a + 12 });
+        }
+    }
+
+    struct Part final {
+        const Grid* grid;
+        glm::mat4   transform;
+    };
+
+    auto turned  = glm::translate(glm::vec3(5, 0, 0)) * glm::rotate(0.7f, glm::vec3(1, 2, 3)) *
+                   glm::scale(glm::vec3(2));
+    auto tilted  = glm::translate(glm::vec3(3, 3, 3)) * glm::rotate(2.5f, glm::vec3(1, 0, 0)) *
+                   glm::scale(glm::vec3(0.5f));
+    auto flipped = glm::translate(glm::vec3(-5, 0, 0)) * glm::rotate(glm::pi<float>(), glm::vec3(0, 1, 0));
+
+    auto parts = std::vector<Part>{
+        { &bracket, glm::mat4(1) },
+        { &bracket, turned },
+        { &pin, glm::translate(glm::vec3(0, 5, 0)) },
+        { &bracket, glm::translate(glm::vec3(0, 0, 5)) },
+        { &pin, tilted },
+        { &bracket, flipped },
+        { &bracket, glm::scale(glm::vec3(-1, 1, 1)) }, // A mirror image is not a copy
+    };
+
+    auto placed = [](const Part& part) {
+        auto vertices = part.grid->vertices;
+        for (auto& vertex : vertices) {
+            vertex.position = glm::vec3(part.transform * glm::vec4(vertex.position, 1));
+            vertex.normal   = glm::normalize(glm::vec3(part.transform * glm::vec4(vertex.normal, 0)));
+        }
+        return vertices;
+    };
+
+    {
+        auto file   = std::ofstream(dir / "parts.obj");
+        auto offset = size_t{ 1 };
+        for (size_t i = 0; i < parts.size(); ++i) {
+            file << "o part" << i << '\n';
+            for (const auto& vertex : placed(parts[i])) {
+                file << "v " << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n';
+                file << "vn " << vertex.normal.x << ' ' << vertex.normal.y << ' ' << vertex.normal.z << '\n';
+                file << "vt " << vertex.uv.x << ' ' << vertex.uv.y << '\n';
+            }
+            const auto& indices = parts[i].grid->indices;
+            for (size_t k = 0; k < indices.size(); k += 3) {
+                file << 'f';
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    auto index = indices[k + corner] + offset;
+                    file << ' ' << index << '/' << index << '/' << index;
+                }
+                file << '\n';
+            }
+            offset += parts[i].grid->vertices.size();
+        }
+    }
+
+    auto file  = LoadModel(dir / "parts.obj");
+    auto scene = Scene();
+    scene.Commit(std::move(file.builder));
+
+    auto draw_list = scene.ComputeDrawList();
+    std::erase_if(draw_list, [](const DrawRecord& record) { return record.mesh == nullptr; });
+    REQUIRE(draw_list.size() == parts.size());
+
+    // Only the bracket, the pin and the mirrored bracket keep their geometry.
+    auto meshes = std::set<MeshPtr>{};
+    for (const auto& record : draw_list) {
+        meshes.insert(record.mesh);
+    }
+    CHECK(meshes.size() == 3);
+
+    auto vertex_buffer = draw_list.front().mesh->GetVertexBuffer();
+    auto index_buffer  = draw_list.front().mesh->GetIndexBuffer();
+    CHECK(vertex_buffer->Size() == sizeof(ModelVertex) * (2 * bracket.vertices.size() + pin.vertices.size()));
+    CHECK(index_buffer->Size() == sizeof(uint32_t) * (2 * bracket.indices.size() + pin.indices.size()));
+
+    // Every draw puts its shape back where one of the parts was.
+    auto covered = std::vector<size_t>(parts.size(), 0);
+    for (const auto& record : draw_list) {
+        auto mesh     = record.mesh;
+        auto vertices = static_cast<const ModelVertex*>(vertex_buffer->Data());
+        auto indices  = static_cast<const uint32_t*>(index_buffer->Data()) + mesh->GetFirstIndex();
+        auto drawn    = std::vector<glm::vec3>{};
+        for (uint32_t i = 0; i < mesh->GetIndexCount(); ++i) {
+            drawn.push_back(glm::vec3(record.transform * glm::vec4(vertices[indices[i]].position, 1)));
+        }
+
+        auto near = [](std::span<const glm::vec3> points, const glm::vec3& point) {
+            return std::any_of(points.begin(), points.end(), [&](const glm::vec3& other) {
+                return glm::length(other - point) < 2e-3f;
+            });
+        };
+
+        for (size_t i = 0; i < parts.size(); ++i) {
+            auto expected = std::vector<glm::vec3>{};
+            for (const auto& vertex : placed(parts[i])) {
+                expected.push_back(vertex.position);
+            }
+            auto matches = drawn.size() == parts[i].grid->indices.size() &&
+                           std::all_of(drawn.begin(), drawn.end(), [&](auto& p) { return near(expected, p); }) &&
+                           std::all_of(expected.begin(), expected.end(), [&](auto& p) { return near(drawn, p); });
+            covered[i] += matches;
+        }
+    }
+    CHECK(covered == std::vector<size_t>(parts.size(), 1));
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("benchmarking stream codec on bundled models" * doctest::skip())
+{
+    constexpr auto kDecodeRounds = 20;
+
+    for (auto model : { "cube/cube.obj", "suzanne/suzanne.obj", "teapot/teapot.obj", "mario/mario.obj" }) {
+        auto file  = LoadModel(fs::path(VEGA_DATA_DIR) / "models" / model);
+        auto scene = Scene();
+        scene.Commit(std::move(file.builder));
+
+        // Vertex buffers are split into ModelVertex elements, index buffers into single indices.
+        auto streams = std::set<std::pair<const Buffer*, size_t>>{};
+        for (const auto& record : scene.ComputeDrawList()) {
+            streams.emplace(record.mesh->GetVertexBuffer(), sizeof(ModelVertex));
+            streams.emplace(record.mesh->GetIndexBuffer(), sizeof(uint32_t));
+        }
+
+        auto raw_size     = size_t{ 0 };
+        auto encoded_size = size_t{ 0 };
+        auto decode_time  = BenchClock::duration{};
+
+        for (const auto& [buffer, stride] : streams) {
+            auto copy = std::vector<std::byte>(buffer->Size());
+            buffer->CopyTo(copy.data());
+
+            auto data    = std::span<const std::byte>(copy);
+            auto encoded = utils::EncodeStream(data, stride);
+            auto decoded = std::vector<std::byte>(data.size());
+
+            auto decode_start = BenchClock::now();
+            for (int round = 0; round != kDecodeRounds; ++round) {
+                utils::DecodeStream(encoded, decoded);
+            }
+            decode_time += BenchClock::now() - decode_start;
+
+            CHECK(std::memcmp(decoded.data(), data.data(), data.size()) == 0);
+
+            raw_size += data.size();
+            encoded_size += encoded.size();
+        }
+
+        CHECK(encoded_size < raw_size);
+
+        auto ratio     = static_cast<double>(raw_size) / static_cast<double>(encoded_size);
+        auto gigabytes = static_cast<double>(raw_size) * kDecodeRounds / 1e9;
+
+        MESSAGE(
+            model << ": " << static_cast<double>(raw_size) / 1e6 << " MB, ratio " << ratio << ", decode "
+                  << gigabytes / ToSeconds(decode_time) << " GB/s");
+    }
+}
+
+#ifdef __linux__
+
+#include <malloc.h>
+
+// VmRSS and VmHWM, the current and peak resident set size, in bytes.
+static size_t ReadMemoryStatus(std::string_view key)
+{
+    auto file = std::ifstream("/proc/self/status");
+    auto line = std::string();
+    while (std::getline(file, line)) {
+        if (line.starts_with(key)) {
+            return std::stoul(line.substr(key.size() + 1)) * 1024;
+        }
+    }
+    return 0;
+}
+
+// Loads a glb, uploads every buffer through a staging copy the way BufferManager does, and applies the residency
+// policy afterwards. Set VEGA_RSS_BENCH_MB to measure larger models, e.g. 2048.
+TEST_CASE("benchmarking buffer residency" * doctest::skip())
+{
+    auto megabytes = size_t{ 64 };
+    if (auto value = std::getenv("VEGA_RSS_BENCH_MB")) {
+        megabytes = std::stoul(value);
+    }
+
+    auto dir = fs::temp_directory_path() / "vega-bench-residency";
+    fs::create_directories(dir);
+
+    // A grid cell takes one vertex and six indices, 56 bytes.
+    auto size = static_cast<uint32_t>(std::sqrt(static_cast<double>(megabytes) * 1e6 / 56.0));
+    WriteGlb(dir / "grid.glb", MakeGrid(size), R"([{"mesh":0}])");
+    auto file_size = fs::file_size(dir / "grid.glb");
+
+    for (auto residency : { BufferResidency::Resident, BufferResidency::Compressed, BufferResidency::Released }) {
+        // Freed memory that the allocator keeps would be counted in the baseline or the steady state.
+        malloc_trim(0);
+        std::ofstream("/proc/self/clear_refs") << "5"; // Resets the peak
+
+        auto baseline = ReadMemoryStatus("VmRSS:");
+        auto scene    = Scene();
+        scene.Commit(LoadModel(dir / "grid.glb").builder);
+
+        auto buffers = std::set<Buffer*>{};
+        for (const auto& record : scene.ComputeDrawList()) {
+            buffers.insert(record.mesh->GetVertexBuffer());
+            buffers.insert(record.mesh->GetIndexBuffer());
+        }
+        for (auto buffer : buffers) {
+            auto staging = std::vector<std::byte>(buffer->Size());
+            buffer->CopyTo(staging.data());
+            buffer->SetResidency(residency);
+        }
+
+        malloc_trim(0);
+
+        auto steady = std::max(ReadMemoryStatus("VmRSS:"), baseline) - baseline;
+        auto peak   = std::max(ReadMemoryStatus("VmHWM:"), baseline) - baseline;
+        auto names  = std::array{ "resident", "compressed", "released" };
+
+        MESSAGE(
+            static_cast<double>(file_size) / 1e6 << " MB glb, " << names[static_cast<size_t>(residency)] << ": peak "
+                                                  << static_cast<double>(peak) / 1e6 << " MB, steady state "
+                                                  << static_cast<double>(steady) / 1e6 << " MB");
+
+        if (residency == BufferResidency::Released) {
+            CHECK(steady < file_size / 4);
+        }
+    }
+
+    fs::remove_all(dir);
+}
+
+#endif
@@ -0,0 +1,1133 @@
+#include "bench_clock.hpp"
+#include "counting_resource.hpp"
+#include "gpu_residency.hpp"
+#include "scene.hpp"
+#include "utils/parallel.hpp"
+#include "utils/revision_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+static bool IsClose(const AABB& lhs, const AABB& rhs)
+{
+    auto close = [](Float3 a, Float3 b) {
+        return std::abs(a.x - b.x) < 1e-5f && std::abs(a.y - b.y) < 1e-5f && std::abs(a.z - b.z) < 1e-5f;
+    };
+    return close(lhs.min, rhs.min) && close(lhs.max, rhs.max);
+}
+
+TEST_CASE("testing node detach")
+{
+    auto scene = Scene();
+    auto root  = scene.GetRootNode();
+    auto group = root->AttachNode(scene.CreateGroupNode());
+
+    auto a = group->AttachNode(scene.CreateGroupNode());
+    auto b = group->AttachNode(scene.CreateGroupNode());
+    auto c = group->AttachNode(scene.CreateGroupNode());
+
+    auto detached = a->DetachNode();
+
+    CHECK(detached.get() == a);
+    CHECK(group->GetChildren().size() == 2);
+
+    // The scene tree lists children in the order they were attached.
+    auto children = group->GetChildren();
+    std::ranges::sort(children, {}, &Node::GetAttachOrder);
+    CHECK((children == Nodes{ b, c }));
+
+    // The last child takes the place of the detached one and can itself be detached afterwards.
+    c->DetachNode();
+    CHECK((group->GetChildren() == Nodes{ b }));
+    b->DetachNode();
+    CHECK(group->GetChildren().empty());
+
+    group->AttachNode(std::move(detached));
+    CHECK((group->GetChildren() == Nodes{ a }));
+}
+
+TEST_CASE("testing subtree destruction")
+{
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto shader   = scene.CreateShader();
+    auto material = scene.CreateMaterial(shader);
+    auto mesh     = scene.CreateMesh(AABB{}, nullptr, nullptr, 0, 0);
+
+    auto attach_instance = [&](NodePtr parent) {
+        auto instance = scene.CreateInstanceNode(mesh, material);
+        auto ptr      = instance.get();
+        parent->AttachNode(std::move(instance));
+        return ptr;
+    };
+
+    auto kept    = attach_instance(root);
+    auto group   = root->AttachNode(scene.CreateGroupNode());
+    auto nested  = group->AttachNode(scene.CreateGroupNode());
+    auto removed = attach_instance(nested);
+    auto last    = attach_instance(root);
+
+    auto group_id   = group->GetID();
+    auto removed_id = removed->GetID();
+    auto count      = scene.GetObjectCount();
+
+    scene.DestroySubtree(group);
+
+    CHECK(scene.GetObjectCount() == count - 3);
+    CHECK(scene.FindObject(group_id) == nullptr);
+    CHECK(scene.FindObject(removed_id) == nullptr);
+    CHECK((material->GetInstanceNodes() == Instances{ kept, last }));
+
+    // Instances registered after a bulk removal are still unregistered individually.
+    last->DetachNode();
+    CHECK((material->GetInstanceNodes() == Instances{ kept }));
+
+    CHECK_THROWS(scene.DestroySubtree(root));
+}
+
+TEST_CASE("testing asset release")
+{
+    constexpr auto kCycleCount = 100;
+
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto vertices  = std::vector<float>(300, 1.0f);
+    auto indices   = std::vector<uint32_t>(300, 0);
+    auto alignment = std::align_val_t(16);
+
+    // Assets that stay in use by an instance outside the loaded model.
+    auto kept_shader   = scene.CreateShader();
+    auto kept_material = scene.CreateMaterial(kept_shader);
+    auto kept_mesh     = scene.CreateMesh(AABB{}, nullptr, nullptr, 0, 0);
+    root->AttachNode(scene.CreateInstanceNode(kept_mesh, kept_material));
+
+    auto baseline = scene.GetObjectCount();
+
+    // Mirrors what the OBJ loader creates, including a material that no shape uses and a shared prototype.
+    auto load_model = [&] {
+        auto vertex_buffer = scene.CreateVertexBuffer(vertices.data(), sizeof(float) * vertices.size(), alignment);
+        auto index_buffer  = scene.CreateIndexBuffer(indices.data(), sizeof(uint32_t) * indices.size(), alignment);
+        auto shader        = scene.CreateShader();
+        auto brick         = scene.CreateMaterial(shader);
+        auto unused        = scene.CreateMaterial(shader);
+        auto wall          = scene.CreateMesh(AABB{}, vertex_buffer, index_buffer, 0, 150);
+        auto door          = scene.CreateMesh(AABB{}, vertex_buffer, index_buffer, 150, 150);
+
+        brick->SetProperty(kDiffuseTextureAtom, std::string("brick.png"));
+        unused->SetProperty(kDiffuseTextureAtom, std::string("unused.png"));
+
+        auto part = scene.CreateGroupNode();
+        part->AttachNode(scene.CreateInstanceNode(door, brick));
+        auto prototype = scene.CreatePrototype(std::move(part));
+
+        auto file = root->AttachNode(scene.CreateGroupNode());
+        file->AttachNode(scene.CreateInstanceNode(wall, brick));
+        file->AttachNode(scene.CreateInstanceNode(wall, kept_material));
+        file->AttachNode(scene.CreateReferenceNode(prototype));
+        file->AttachNode(scene.CreateReferenceNode(prototype));
+
+        return file;
+    };
+
+    auto max_material_index = uint32_t{ 0 };
+
+    for (int cycle = 0; cycle != kCycleCount; ++cycle) {
+        auto file = load_model();
+
+        // Nothing is released while the model is in the scene, apart from the material that no shape uses.
+        auto in_use = scene.ReleaseUnusedAssets();
+        CHECK(in_use.buffers.empty());
+        CHECK(in_use.materials.size() == 1);
+        CHECK((in_use.textures == std::vector<std::string>{ "unused.png" }));
+        CHECK(scene.ComputeDrawList().size() == 5);
+
+        scene.DestroySubtree(file);
+
+        auto released = scene.ReleaseUnusedAssets();
+        CHECK(released.buffers.size() == 2);
+        CHECK(released.materials.size() == 1);
+        CHECK((released.textures == std::vector<std::string>{ "brick.png" }));
+        CHECK(scene.GetObjectCount() == baseline);
+
+        for (auto index : released.materials) {
+            max_material_index = std::max(max_material_index, index);
+        }
+    }
+
+    // Released material indices are reused, so the renderer's per-material caches stay as small as the scene.
+    CHECK(max_material_index <= 2);
+    CHECK(kept_mesh->GetUseCount() == 1);
+    CHECK(kept_material->GetInstanceNodes().size() == 1);
+    CHECK(scene.ComputeDrawList().size() == 1);
+    CHECK(scene.ReleaseUnusedAssets().buffers.empty());
+}
+
+// Follows the draw loop of RenderContext, which looks up the compiled record of each drawn material every frame.
+TEST_CASE("testing material compilation")
+{
+    struct GpuMaterial final {
+        uint32_t texture_index = 0;
+    };
+
+    constexpr auto kMaterialCount = uint32_t{ 16 };
+    constexpr auto kFrameCount    = 100;
+
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto shader   = scene.CreateShader();
+    auto mesh     = scene.CreateMesh(AABB{}, nullptr, nullptr, 0, 0);
+    auto textures = std::unordered_map<std::string, uint32_t>();
+
+    for (uint32_t i = 0; i != kMaterialCount; ++i) {
+        auto material = scene.CreateMaterial(shader);
+        auto texture  = "texture" + std::to_string(i) + ".png";
+        material->SetProperty(kDiffuseTextureAtom, texture);
+        textures.emplace(texture, i + 1);
+        root->AttachNode(scene.CreateInstanceNode(mesh, material));
+        root->AttachNode(scene.CreateInstanceNode(mesh, material));
+    }
+
+    // Resolves the diffuse texture the way RenderContext::CompileMaterial does in bindless mode.
+    auto compile = [&](const Material* material) {
+        auto texture = material->FindProperty<std::string>(kDiffuseTextureAtom);
+        return GpuMaterial{ texture ? textures.at(*texture) : 0 };
+    };
+
+    auto resource  = CountingResource();
+    auto cache     = utils::RevisionCache<GpuMaterial, std::pmr::polymorphic_allocator<GpuMaterial>>(&resource);
+    auto draw_list = scene.ComputeDrawList();
+
+    auto draw_frame = [&] {
+        auto sum = uint32_t{ 0 };
+        for (const auto& draw : draw_list) {
+            auto material = draw.material;
+
+            const auto& gpu_material = cache.Get(
+                material->GetIndex(),
+                material->GetRevision(),
+                [&] { return compile(material); });
+
+            sum += gpu_material.texture_index;
+        }
+        return sum;
+    };
+
+    CHECK(draw_frame() == kMaterialCount * (kMaterialCount + 1));
+    CHECK(cache.CompileCount() == kMaterialCount);
+
+    auto allocations = resource.AllocationCount();
+
+    for (int frame = 0; frame != kFrameCount; ++frame) {
+        CHECK(draw_frame() == kMaterialCount * (kMaterialCount + 1));
+    }
+    CHECK(cache.CompileCount() == kMaterialCount);
+    CHECK(resource.AllocationCount() == allocations);
+
+    // Setting a property recompiles that material alone, once.
+    auto changed = draw_list.front().material;
+    auto before  = textures.at(*changed->FindProperty<std::string>(kDiffuseTextureAtom));
+    CHECK(changed->FindProperty<float>(kDiffuseTextureAtom) == nullptr);
+    textures.emplace("changed.png", 100);
+    changed->SetProperty(kDiffuseTextureAtom, std::string("changed.png"));
+
+    for (int frame = 0; frame != kFrameCount; ++frame) {
+        CHECK(draw_frame() == kMaterialCount * (kMaterialCount + 1) + 2 * (100 - before));
+    }
+    CHECK(cache.CompileCount() == kMaterialCount + 1);
+    CHECK(resource.AllocationCount() == allocations);
+}
+
+TEST_CASE("testing node search")
+{
+    auto scene = Scene();
+    auto root  = scene.GetRootNode();
+
+    auto wheels = scene.CreateGroupNode();
+    auto left   = wheels->AttachNode(scene.CreateScaleNode(1.0f));
+    left->SetProperty(kNameAtom, std::string("Left Wheel"));
+
+    // Nodes become searchable once their subtree is attached to the scene.
+    CHECK(scene.FindNodes("wheel", 10).empty());
+    auto group = root->AttachNode(std::move(wheels));
+    CHECK(scene.FindNodes("wheel", 10) == Nodes{ left });
+    CHECK(scene.FindNodes("scale.node", 10) == Nodes{ left });
+
+    left->SetProperty(kNameAtom, std::string("Spare Tyre"));
+    CHECK(scene.FindNodes("wheel", 10).empty());
+    CHECK(scene.FindNodes("TYRE", 10) == Nodes{ left });
+
+    left->RemoveProperty(kNameAtom);
+    CHECK(scene.FindNodes("tyre", 10).empty());
+
+    scene.DestroySubtree(group);
+    CHECK(scene.FindNodes("scale", 10).empty());
+}
+
+TEST_CASE("testing scene bounds")
+{
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto shader   = scene.CreateShader();
+    auto material = scene.CreateMaterial(shader);
+    auto cube     = scene.CreateMesh(AABB{ { -1, -1, -1 }, { 1, 1, 1 } }, nullptr, nullptr, 0, 0);
+    auto slab     = scene.CreateMesh(AABB{ { 0, 0, 0 }, { 2, 1, 1 } }, nullptr, nullptr, 0, 0);
+
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { -1, -1, -1 }, { 1, 1, 1 } }));
+
+    auto translate = root->AttachNode(scene.CreateTranslateNode(Float3{ 10, 0, 0 }));
+    auto rotate    = translate->AttachNode(scene.CreateRotateNode(Float3{ 0, 0, 1 }, Radians::HalfPi));
+    rotate->AttachNode(scene.CreateInstanceNode(slab, material));
+
+    // A quarter turn around z maps x to y and y to -x, so all corners of the box move, not just min and max.
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { 9, 0, 0 }, { 10, 2, 1 } }));
+
+    auto angle = Radians(Radians::HalfPi.value / 2);
+    rotate->SetProperty(kFieldAtoms[1], angle.value);
+    auto half_diagonal = std::sqrt(2.0f) / 2;
+    auto bounds        = scene.ComputeAxisAlignedBoundingBox();
+    CHECK(IsClose(bounds, AABB{ { 10 - half_diagonal, 0, 0 }, { 10 + 2 * half_diagonal, 3 * half_diagonal, 1 } }));
+
+    auto spinning = root->AttachNode(scene.CreateRotateNode(Float3{ 0, 0, 1 }, angle));
+    spinning->AttachNode(scene.CreateInstanceNode(cube, material));
+    auto extent = std::sqrt(2.0f);
+    bounds      = scene.ComputeAxisAlignedBoundingBox();
+    CHECK(IsClose(bounds, AABB{ { -extent, -extent, -1 }, { 10 + 2 * half_diagonal, 3 * half_diagonal, 1 } }));
+
+    // Editing a transform or the structure refreshes the cached bounds of the affected branch.
+    translate->SetProperty(kFieldAtoms[0], Float3{ -10, 0, 0 });
+    bounds = scene.ComputeAxisAlignedBoundingBox();
+    CHECK(IsClose(bounds, AABB{ { -10 - half_diagonal, -extent, -1 }, { extent, 3 * half_diagonal, 1 } }));
+
+    translate->DetachNode();
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { -extent, -extent, -1 }, { extent, extent, 1 } }));
+    CHECK(scene.ComputeDrawList().size() == 1);
+}
+
+TEST_CASE("testing prototype references")
+{
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto shader   = scene.CreateShader();
+    auto material = scene.CreateMaterial(shader);
+    auto cube     = scene.CreateMesh(AABB{ { -1, -1, -1 }, { 1, 1, 1 } }, nullptr, nullptr, 0, 0);
+
+    auto part   = scene.CreateTranslateNode(Float3{ 0, 1, 0 });
+    auto offset = static_cast<NodePtr>(part.get());
+    part->AttachNode(scene.CreateInstanceNode(cube, material));
+
+    auto prototype = scene.CreatePrototype(std::move(part));
+
+    auto place = [&](Float3 distance) {
+        auto translate = root->AttachNode(scene.CreateTranslateNode(distance));
+        return translate->AttachNode(scene.CreateReferenceNode(prototype));
+    };
+
+    place(Float3{ -5, 0, 0 });
+    auto right = place(Float3{ 5, 0, 0 });
+
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { -6, 0, -1 }, { 6, 2, 1 } }));
+    CHECK(scene.ComputeDrawList().size() == 2);
+    CHECK(prototype->GetReferenceNodes().size() == 2);
+
+    // Editing the prototype moves every placement.
+    offset->SetProperty(kFieldAtoms[0], Float3{ 0, 0, 3 });
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { -6, -1, 2 }, { 6, 1, 4 } }));
+
+    CHECK_THROWS(offset->AttachNode(scene.CreateGroupNode()));
+    CHECK_THROWS(offset->DetachNode());
+    CHECK(prototype->ToJson()["value.ref.references"].size() == 2);
+
+    right->DetachNode();
+    CHECK(prototype->GetReferenceNodes().size() == 1);
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { -6, -1, 2 }, { -4, 1, 4 } }));
+    CHECK(scene.ComputeDrawList().size() == 1);
+}
+
+TEST_CASE("testing scene move assignment")
+{
+    auto populate = [](Scene* scene) {
+        auto material  = scene->CreateMaterial(scene->CreateShader());
+        auto cube      = scene->CreateMesh(AABB{ { -1, -1, -1 }, { 1, 1, 1 } }, nullptr, nullptr, 0, 0);
+        auto part      = scene->CreateGroupNode();
+        part->AttachNode(scene->CreateInstanceNode(cube, material));
+        auto prototype = scene->CreatePrototype(std::move(part));
+        scene->GetRootNode()->AttachNode(scene->CreateInstanceNode(cube, material));
+        scene->GetRootNode()->AttachNode(scene->CreateReferenceNode(prototype));
+    };
+
+    auto scene = Scene();
+    populate(&scene);
+
+    // The replaced scene tears down its graphs and prototypes before the storage they live in.
+    auto other = Scene();
+    populate(&other);
+    other.GetRootNode()->AttachNode(other.CreateGroupNode());
+    auto object_count = other.GetObjectCount();
+
+    scene = std::move(other);
+    CHECK(scene.GetObjectCount() == object_count);
+    CHECK(scene.ComputeDrawList().size() == 2);
+
+    scene = Scene();
+    CHECK(scene.ComputeDrawList().empty());
+}
+
+TEST_CASE("benchmarking prototype references" * doctest::skip())
+{
+    constexpr auto kBranchCount    = 100;
+    constexpr auto kBranchDepth    = 8;
+    constexpr auto kReferenceCount = 10'000;
+
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto shader   = scene.CreateShader();
+    auto material = scene.CreateMaterial(shader);
+    auto cube     = scene.CreateMesh(AABB{ { -1, -1, -1 }, { 1, 1, 1 } }, nullptr, nullptr, 0, 0);
+
+    // A prototype of 1001 nodes: a group with branches of a translation, a chain of groups and an instance.
+    auto model = scene.CreateGroupNode();
+    for (int i = 0; i != kBranchCount; ++i) {
+        auto node = model->AttachNode(scene.CreateTranslateNode(Float3{ static_cast<float>(i), 0, 0 }));
+        for (int j = 0; j != kBranchDepth; ++j) {
+            node = node->AttachNode(scene.CreateGroupNode());
+        }
+        node->AttachNode(scene.CreateInstanceNode(cube, material));
+    }
+
+    auto build_start = BenchClock::now();
+    auto prototype   = scene.CreatePrototype(std::move(model));
+    for (int i = 0; i != kReferenceCount; ++i) {
+        auto translate = root->AttachNode(scene.CreateTranslateNode(Float3{ 0, static_cast<float>(i), 0 }));
+        translate->AttachNode(scene.CreateReferenceNode(prototype));
+    }
+    auto build_end = BenchClock::now();
+
+    auto bounds     = scene.ComputeAxisAlignedBoundingBox();
+    auto bounds_end = BenchClock::now();
+    auto draw_list  = scene.ComputeDrawList();
+    auto draw_end   = BenchClock::now();
+
+    auto expanded = size_t{ kReferenceCount } * (1 + kBranchCount * (kBranchDepth + 2));
+
+    CHECK(IsClose(bounds, AABB{ { -1, -1, -1 }, { kBranchCount, kReferenceCount, 1 } }));
+    CHECK(draw_list.size() == size_t{ kReferenceCount } * kBranchCount);
+
+    MESSAGE("scene objects: " << scene.GetObjectCount() << ", expanded nodes: " << expanded);
+    MESSAGE("build: " << ToMilliseconds(build_end - build_start) << " ms");
+    MESSAGE("bounds: " << ToMilliseconds(bounds_end - build_end) << " ms");
+    MESSAGE("draw list: " << ToMilliseconds(draw_end - bounds_end) << " ms");
+}
+
+TEST_CASE("testing scene save and load")
+{
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto vertices = std::vector<float>{ 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+    auto indices  = std::vector<uint32_t>{ 0, 1, 2 };
+    auto aabb     = AABB{ { -1, -1, -1 }, { 1, 1, 1 } };
+    auto meshlets = std::vector<Meshlet>{ { { 0.5f, 0.5f, 0 }, 0.75f, { 0, 0, 1 }, 0.5f, 0, 3 } };
+
+    // Objects are created in the order the loader recreates them, so that the loaded scene has the same IDs.
+    auto alignment     = std::align_val_t(32);
+    auto vertex_buffer = scene.CreateVertexBuffer(vertices.data(), sizeof(float) * vertices.size(), alignment);
+    auto index_buffer  = scene.CreateIndexBuffer(indices.data(), sizeof(uint32_t) * indices.size(), alignment);
+    auto shader        = scene.CreateShader();
+    auto red           = scene.CreateMaterial(shader);
+    auto blue          = scene.CreateMaterial(shader);
+    auto mesh          = scene.CreateMesh(aabb, vertex_buffer, index_buffer, 0, 3, meshlets);
+
+    red->SetProperty(kDiffuseColorAtom, Float3{ 1, 0, 0 });
+    blue->SetProperty(kDiffuseTextureAtom, std::string("textures/blue.png"));
+
+    auto part = scene.CreateScaleNode(2.0f);
+    part->AttachNode(scene.CreateInstanceNode(mesh, blue));
+    auto prototype = scene.CreatePrototype(std::move(part));
+
+    root->SetProperty(kNameAtom, std::string("Root"));
+    auto group = root->AttachNode(scene.CreateGroupNode());
+    group->SetProperty(kNameAtom, std::string("Group \"quoted\""));
+    group->SetProperty("count", uint64_t{ 1 } << 40);
+    group->SetProperty("offset", int32_t{ -7 });
+    auto rotate = group->AttachNode(scene.CreateRotateNode(Float3{ 0, 0, 1 }, Radians(0.25f)));
+    rotate->AttachNode(scene.CreateInstanceNode(mesh, red));
+    auto translate = group->AttachNode(scene.CreateTranslateNode(Float3{ 1.5f, -2, 0.1f }));
+    translate->AttachNode(scene.CreateReferenceNode(prototype));
+    group->SetProperty("link", static_cast<ObjectPtr>(translate));
+
+    auto records = std::stringstream();
+    auto blob    = std::stringstream();
+    scene.Save(records, blob);
+
+    auto loaded = Scene();
+    loaded.Load(records, blob);
+
+    CHECK(loaded.ToJson() == scene.ToJson());
+    CHECK(loaded.GetObjectCount() == scene.GetObjectCount());
+    CHECK(IsClose(loaded.ComputeAxisAlignedBoundingBox(), scene.ComputeAxisAlignedBoundingBox()));
+
+    auto loaded_group = loaded.FindNodes("quoted", 1);
+    REQUIRE(loaded_group.size() == 1);
+    CHECK(std::holds_alternative<uint64_t>(loaded_group[0]->GetProperty("count")));
+
+    auto draw_list = loaded.ComputeDrawList();
+    REQUIRE(draw_list.size() == 2);
+    auto loaded_vertices = draw_list[0].mesh->GetVertexBuffer();
+    REQUIRE(loaded_vertices->Size() == sizeof(float) * vertices.size());
+    CHECK(loaded_vertices->Alignment() == alignment);
+    CHECK(std::memcmp(loaded_vertices->Data(), vertices.data(), loaded_vertices->Size()) == 0);
+
+    auto loaded_meshlets = draw_list[0].mesh->GetMeshlets();
+    REQUIRE(loaded_meshlets.size() == 1);
+    CHECK(std::memcmp(loaded_meshlets.data(), meshlets.data(), sizeof(Meshlet)) == 0);
+
+    // Meshlets must cover the indices of the mesh, in whole triangles.
+    CHECK_THROWS(scene.CreateMesh(aabb, vertex_buffer, index_buffer, 0, 3, { Meshlet{ {}, 0, {}, 1, 0, 2 } }));
+    CHECK_THROWS(scene.CreateMesh(aabb, vertex_buffer, index_buffer, 0, 3, { Meshlet{ {}, 0, {}, 1, 3, 3 } }));
+
+    auto wrong_format = std::stringstream(R"({"format":"other","version":2,"objects":[]})");
+    CHECK_THROWS(Scene().Load(wrong_format, blob));
+    auto truncated = std::stringstream(R"({"format":"vega.scene","version":2,"objects":[)");
+    CHECK_THROWS(Scene().Load(truncated, blob));
+}
+
+TEST_CASE("testing buffer compression")
+{
+    auto scene    = Scene();
+    auto vertices = std::vector<float>(3000);
+    auto indices  = std::vector<uint32_t>(1000);
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i] = static_cast<float>(i % 3) + static_cast<float>(i / 3) * 0.01f;
+    }
+    for (uint32_t i = 0; i < indices.size(); ++i) {
+        indices[i] = i;
+    }
+
+    auto alignment     = std::align_val_t(32);
+    auto vertex_buffer = scene.CreateVertexBuffer(vertices.data(), sizeof(float) * vertices.size(), alignment);
+    auto index_buffer  = scene.CreateIndexBuffer(indices.data(), sizeof(uint32_t) * indices.size(), alignment);
+    auto mesh          = scene.CreateMesh(AABB{ { 0, 0, 0 }, { 1, 1, 1 } }, vertex_buffer, index_buffer, 0, 1000);
+    auto material      = scene.CreateMaterial(scene.CreateShader());
+
+    scene.GetRootNode()->AttachNode(scene.CreateInstanceNode(mesh, material));
+
+    vertex_buffer->Compress();
+    index_buffer->Compress(sizeof(uint32_t));
+
+    CHECK(vertex_buffer->GetResidency() == BufferResidency::Compressed);
+    CHECK(vertex_buffer->Data() == nullptr);
+    CHECK(vertex_buffer->Size() == sizeof(float) * vertices.size());
+    CHECK(vertex_buffer->CompressedSize() < vertex_buffer->Size() * 3 / 4);
+    CHECK(index_buffer->CompressedSize() < index_buffer->Size() / 8);
+
+    // Compressed buffers can still be read out, and are saved without being decoded.
+    auto copy = std::vector<float>(vertices.size());
+    vertex_buffer->CopyTo(copy.data());
+    CHECK(copy == vertices);
+
+    auto records = std::stringstream();
+    auto blob    = std::stringstream();
+    scene.Save(records, blob);
+
+    CHECK(static_cast<size_t>(blob.tellp()) == vertex_buffer->CompressedSize() + index_buffer->CompressedSize());
+
+    auto loaded = Scene();
+    loaded.Load(records, blob);
+
+    auto draw_list = loaded.ComputeDrawList();
+    REQUIRE(draw_list.size() == 1);
+    auto loaded_indices = draw_list[0].mesh->GetIndexBuffer();
+    CHECK(loaded_indices->GetResidency() == BufferResidency::Resident);
+    CHECK(std::memcmp(loaded_indices->Data(), indices.data(), loaded_indices->Size()) == 0);
+
+    vertex_buffer->MakeResident();
+
+    CHECK(vertex_buffer->GetResidency() == BufferResidency::Resident);
+    CHECK(vertex_buffer->Alignment() == alignment);
+    CHECK(std::memcmp(vertex_buffer->Data(), vertices.data(), vertex_buffer->Size()) == 0);
+}
+
+TEST_CASE("testing buffer residency")
+{
+    auto vertices  = std::vector<float>(300);
+    auto indices   = std::vector<uint32_t>{ 0, 1, 2 };
+    auto alignment = std::align_val_t(16);
+    auto fetches   = 0;
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i] = static_cast<float>(i) * 0.5f;
+    }
+
+    auto source = [&](std::span<std::byte> dst) {
+        REQUIRE(dst.size() == sizeof(float) * vertices.size());
+        std::memcpy(dst.data(), vertices.data(), dst.size());
+        fetches++;
+    };
+
+    auto index_data = Buffer::Allocate(sizeof(uint32_t) * indices.size(), alignment);
+    auto index_ptr  = index_data.get();
+    std::memcpy(index_ptr, indices.data(), sizeof(uint32_t) * indices.size());
+
+    auto builder       = SceneBuilder();
+    auto vertex_buffer = builder.AddVertexBuffer(source, sizeof(float) * vertices.size(), alignment);
+    auto index_buffer  = builder.AddIndexBuffer(std::move(index_data), sizeof(uint32_t) * indices.size());
+    auto mesh          = builder.AddMesh(AABB{ { 0, 0, 0 }, { 1, 1, 1 } }, vertex_buffer, index_buffer, 0, 3);
+    builder.AddInstanceNode(SceneBuilder::kNoParent, mesh, builder.AddMaterial(builder.AddShader()));
+
+    auto scene = Scene();
+    scene.Commit(std::move(builder), scene.GetRootNode());
+
+    auto draw_list = scene.ComputeDrawList();
+    REQUIRE(draw_list.size() == 1);
+    auto vertices_in = draw_list[0].mesh->GetVertexBuffer();
+    auto indices_in  = draw_list[0].mesh->GetIndexBuffer();
+
+    // Adopted memory is used as it is, and sourced buffers read nothing until asked.
+    CHECK(indices_in->Data() == index_ptr);
+    CHECK(indices_in->GetResidency() == BufferResidency::Resident);
+    CHECK(vertices_in->GetResidency() == BufferResidency::Released);
+    CHECK(vertices_in->Data() == nullptr);
+    CHECK(vertices_in->Alignment() == alignment);
+    CHECK(fetches == 0);
+
+    auto copy = std::vector<float>(vertices.size());
+    vertices_in->CopyTo(copy.data());
+    CHECK(copy == vertices);
+    CHECK(fetches == 1);
+
+    vertices_in->MakeResident();
+    CHECK(vertices_in->GetResidency() == BufferResidency::Resident);
+    CHECK(std::memcmp(vertices_in->Data(), vertices.data(), vertices_in->Size()) == 0);
+
+    vertices_in->SetResidency(BufferResidency::Released);
+    CHECK(vertices_in->Data() == nullptr);
+
+    // Buffers without a source fall back to compression.
+    indices_in->SetResidency(BufferResidency::Released);
+    CHECK(indices_in->GetResidency() == BufferResidency::Compressed);
+    CHECK_THROWS(indices_in->Release());
+
+    auto records = std::stringstream();
+    auto blob    = std::stringstream();
+    scene.Save(records, blob);
+
+    auto loaded = Scene();
+    loaded.Load(records, blob);
+
+    auto loaded_list = loaded.ComputeDrawList();
+    REQUIRE(loaded_list.size() == 1);
+    auto loaded_vertices = loaded_list[0].mesh->GetVertexBuffer();
+    CHECK(loaded_vertices->GetResidency() == BufferResidency::Resident);
+    CHECK(std::memcmp(loaded_vertices->Data(), vertices.data(), loaded_vertices->Size()) == 0);
+}
+
+TEST_CASE("testing point clouds")
+{
+    auto scene    = Scene();
+    auto vertices = std::vector<float>(4 * 8, 0.5f);
+    auto indices  = std::vector<uint32_t>{ 0, 1, 2, 3 };
+    auto aabb     = AABB{ { 0, 0, 0 }, { 1, 1, 1 } };
+
+    // A root with one point and two children with the rest.
+    auto nodes = std::vector<PointNode>{ { { 0.5f, 0.5f, 0.5f }, 0.9f, 0.25f, 0, 1, 1, 2 },
+                                         { { 0.25f, 0.5f, 0.5f }, 0.45f, 0.125f, 1, 2, 0, 0 },
+                                         { { 0.75f, 0.5f, 0.5f }, 0.45f, 0.125f, 3, 1, 0, 0 } };
+
+    auto alignment     = std::align_val_t(32);
+    auto vertex_buffer = scene.CreateVertexBuffer(vertices.data(), sizeof(float) * vertices.size(), alignment);
+    auto index_buffer  = scene.CreateIndexBuffer(indices.data(), sizeof(uint32_t) * indices.size(), alignment);
+    auto material      = scene.CreateMaterial(scene.CreateShader());
+    auto point_cloud   = scene.CreatePointCloud(aabb, vertex_buffer, index_buffer, 0, 4, nodes);
+
+    scene.GetRootNode()->AttachNode(scene.CreateInstanceNode(point_cloud, material));
+
+    CHECK(point_cloud->GetTopology() == MeshTopology::Points);
+    CHECK(std::get<int>(point_cloud->GetProperty(kFieldAtoms[0])) == 0);
+
+    auto records = std::stringstream();
+    auto blob    = std::stringstream();
+    scene.Save(records, blob);
+
+    auto loaded = Scene();
+    loaded.Load(records, blob);
+
+    auto draw_list = loaded.ComputeDrawList();
+    REQUIRE(draw_list.size() == 1);
+    auto loaded_nodes = draw_list[0].mesh->GetPointNodes();
+    REQUIRE(loaded_nodes.size() == nodes.size());
+    CHECK(std::memcmp(loaded_nodes.data(), nodes.data(), sizeof(PointNode) * nodes.size()) == 0);
+
+    // Nodes must hold every index once and keep their children after them.
+    auto missing = std::vector<PointNode>(nodes.begin(), nodes.begin() + 2);
+    auto cyclic  = nodes;
+
+    cyclic[1].first_child = 0;
+    cyclic[1].child_count = 1;
+
+    CHECK_THROWS(scene.CreatePointCloud(aabb, vertex_buffer, index_buffer, 0, 4, {}));
+    CHECK_THROWS(scene.CreatePointCloud(aabb, vertex_buffer, index_buffer, 0, 4, missing));
+    CHECK_THROWS(scene.CreatePointCloud(aabb, vertex_buffer, index_buffer, 0, 4, cyclic));
+}
+
+TEST_CASE("testing gpu residency")
+{
+    auto residency = GpuResidency(100);
+    auto a         = ID(1, 1);
+    auto b         = ID(2, 1);
+    auto c         = ID(3, 1);
+
+    // Missing buffers are admitted largest priority first, as far as the budget goes.
+    CHECK_FALSE(residency.Request(a, 40, 1));
+    CHECK_FALSE(residency.Request(b, 40, 2));
+    CHECK_FALSE(residency.Request(c, 40, 3));
+    CHECK_FALSE(residency.Request(a, 40, 0.5f));
+
+    auto plan = residency.Update(1000);
+    CHECK((plan.uploads == std::vector<ID>{ c, b }));
+    CHECK(plan.evictions.empty());
+    CHECK(residency.GetResidentBytes() == 80);
+
+    // Buffers wanted in the current frame stay; the least recently used of the others makes room.
+    CHECK(residency.Request(c, 40, 1));
+    CHECK_FALSE(residency.Request(a, 40, 1));
+
+    plan = residency.Update(1000);
+    CHECK((plan.uploads == std::vector<ID>{ a }));
+    CHECK((plan.evictions == std::vector<ID>{ b }));
+
+    CHECK(residency.Request(a, 40, 1));
+    CHECK_FALSE(residency.Request(b, 40, 9));
+    CHECK(residency.Request(c, 40, 1));
+
+    plan = residency.Update(1000);
+    CHECK(plan.uploads.empty());
+    CHECK(plan.evictions.empty());
+
+    // The upload limit defers the rest to later frames, but never blocks the first upload.
+    residency.SetBudget(200);
+    CHECK_FALSE(residency.Request(b, 40, 1));
+    CHECK_FALSE(residency.Request(ID(4, 1), 40, 2));
+    CHECK(residency.Update(10).uploads.size() == 1);
+    CHECK(residency.Update(10).uploads.empty());
+
+    // A lower budget evicts down to it, and removed buffers give their memory back.
+    residency.SetBudget(60);
+    plan = residency.Update(1000);
+    CHECK((plan.evictions == std::vector<ID>{ a, c }));
+    CHECK(residency.GetResidentBytes() == 40);
+
+    residency.Remove(ID(4, 1));
+    CHECK(residency.GetResidentBytes() == 0);
+    CHECK(residency.GetEvictionCount() == 3);
+}
+
+TEST_CASE("testing streaming a scene larger than the budget")
+{
+    constexpr int    kTiles       = 8;
+    constexpr size_t kTileFloats  = 3 * 1024;
+    constexpr size_t kTileIndices = 3 * 512;
+
+    auto scene     = Scene();
+    auto material  = scene.CreateMaterial(scene.CreateShader());
+    auto alignment = std::align_val_t(16);
+    auto contents  = std::unordered_map<ID, std::vector<std::byte>, ID::Hash>{};
+    auto total     = size_t{ 0 };
+
+    // An 8 x 8 grid of unit tiles, each with buffers of its own. The scene keeps only compressed copies, as it would
+    // keep only the file it read them from.
+    for (int j = 0; j < kTiles; ++j) {
+        for (int i = 0; i < kTiles; ++i) {
+            auto vertices = std::vector<float>(kTileFloats);
+            auto indices  = std::vector<uint32_t>(kTileIndices);
+            for (size_t k = 0; k < vertices.size(); ++k) {
+                vertices[k] = static_cast<float>(k % 3 == 2 ? 0 : k % 97) / 97.0f + static_cast<float>(i + j);
+            }
+            for (size_t k = 0; k < indices.size(); ++k) {
+                indices[k] = static_cast<uint32_t>((k * 7 + static_cast<size_t>(i)) % 1024);
+            }
+
+            auto vertex_size   = sizeof(float) * vertices.size();
+            auto index_size    = sizeof(uint32_t) * indices.size();
+            auto vertex_buffer = scene.CreateVertexBuffer(vertices.data(), vertex_size, alignment);
+            auto index_buffer  = scene.CreateIndexBuffer(indices.data(), index_size, alignment);
+            auto tile          = AABB{ { 0, 0, 0 }, { 1, 1, 0 } };
+            auto mesh          = scene.CreateMesh(tile, vertex_buffer, index_buffer, 0, kTileIndices);
+
+            auto position  = Float3{ 2.0f * static_cast<float>(i), 2.0f * static_cast<float>(j), 0 };
+            auto translate = scene.GetRootNode()->AttachNode(scene.CreateTranslateNode(position));
+            translate->AttachNode(scene.CreateInstanceNode(mesh, material));
+
+            contents[vertex_buffer->GetID()].resize(vertex_size);
+            contents[index_buffer->GetID()].resize(index_size);
+            std::memcpy(contents[vertex_buffer->GetID()].data(), vertices.data(), vertex_size);
+            std::memcpy(contents[index_buffer->GetID()].data(), indices.data(), index_size);
+
+            vertex_buffer->SetResidency(BufferResidency::Released);
+            index_buffer->SetResidency(BufferResidency::Released);
+
+            total += vertex_size + index_size;
+        }
+    }
+
+    auto budget     = total / 4;
+    auto residency  = GpuResidency(budget);
+    auto draw_list  = scene.ComputeDrawList();
+    auto projection = glm::perspectiveRH(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+    auto uploaded   = size_t{ 0 };
+    auto mismatches = 0;
+    auto visible    = size_t{ 0 };
+    auto drawn      = size_t{ 0 };
+
+    // Renders one frame from above the grid; a draw is skipped until both of its buffers are resident.
+    auto render = [&](glm::vec3 eye) {
+        auto view = glm::lookAtRH(eye, glm::vec3(eye.x, eye.y, 0), glm::vec3(0, 1, 0));
+
+        visible = 0;
+        drawn   = 0;
+
+        for (const auto& record : draw_list) {
+            auto frustum  = MeshletView::Create(projection, view, record.transform, false);
+            auto priority = ComputeScreenRadius(record.mesh->GetBoundingBox(), frustum, 500.0f);
+            if (priority == 0) {
+                continue;
+            }
+
+            auto vertex_buffer = record.mesh->GetVertexBuffer();
+            auto index_buffer  = record.mesh->GetIndexBuffer();
+            auto has_vertices  = residency.Request(vertex_buffer->GetID(), vertex_buffer->Size(), priority);
+            auto has_indices   = residency.Request(index_buffer->GetID(), index_buffer->Size(), priority);
+
+            visible++;
+            drawn += has_vertices && has_indices;
+        }
+
+        auto plan = residency.Update(budget / 8);
+
+        // Uploads page the buffers back in from the compressed copies.
+        for (auto id : plan.uploads) {
+            auto buffer = static_cast<Buffer*>(scene.FindObject(id));
+            auto staged = std::vector<std::byte>(buffer->Size());
+            buffer->CopyTo(staged.data());
+            mismatches += staged != contents[id];
+            uploaded += staged.size();
+        }
+
+        CHECK(residency.GetResidentBytes() <= budget);
+    };
+
+    // Fly over every row of the grid and back; each view sees a few tiles only.
+    for (int row = 0; row < kTiles; ++row) {
+        for (int step = 0; step <= 28; ++step) {
+            auto x = row % 2 == 0 ? 0.5f * static_cast<float>(step) : 14.0f - 0.5f * static_cast<float>(step);
+            render(glm::vec3(x + 0.5f, 2.0f * static_cast<float>(row) + 0.5f, 2.5f));
+        }
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(uploaded > total);
+    CHECK(residency.GetEvictionCount() > 0);
+
+    // Once the camera rests, everything in view streams in within a few frames.
+    for (int frame = 0; frame < 4; ++frame) {
+        render(glm::vec3(7.5f, 7.5f, 2.5f));
+    }
+
+    CHECK(visible > 1);
+    CHECK(drawn == visible);
+}
+
+TEST_CASE("benchmarking scene save and load" * doctest::skip())
+{
+    constexpr auto kGroupCount    = 1000;
+    constexpr auto kInstanceCount = 999;
+
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto vertices = std::vector<float>(4 << 20, 1.0f);
+    auto buffer   = scene.CreateVertexBuffer(vertices.data(), sizeof(float) * vertices.size(), std::align_val_t(32));
+    auto shader   = scene.CreateShader();
+    auto material = scene.CreateMaterial(shader);
+    auto mesh     = scene.CreateMesh(AABB{ { -1, -1, -1 }, { 1, 1, 1 } }, buffer, nullptr, 0, 0);
+
+    // A million nodes: translations with instances below them.
+    auto build_start = BenchClock::now();
+    for (int i = 0; i != kGroupCount; ++i) {
+        auto translate = root->AttachNode(scene.CreateTranslateNode(Float3{ static_cast<float>(i), 0, 0 }));
+        for (int j = 0; j != kInstanceCount; ++j) {
+            auto instance = translate->AttachNode(scene.CreateInstanceNode(mesh, material));
+            instance->SetProperty(kNameAtom, std::string("Part ") + std::to_string(j));
+        }
+    }
+
+    auto records = std::stringstream();
+    auto blob    = std::stringstream();
+
+    auto save_start = BenchClock::now();
+    auto build_time = ToSeconds(save_start - build_start);
+    scene.Save(records, blob);
+    auto save_end = BenchClock::now();
+
+    auto loaded = Scene();
+    loaded.Load(records, blob);
+    auto load_end = BenchClock::now();
+
+    CHECK(loaded.GetObjectCount() == scene.GetObjectCount());
+
+    auto records_megabytes = static_cast<double>(records.tellp()) / 1e6;
+    auto blob_megabytes    = static_cast<double>(blob.tellp()) / 1e6;
+    auto megabytes         = records_megabytes + blob_megabytes;
+
+    MESSAGE("records: " << records_megabytes << " MB, blob: " << blob_megabytes << " MB");
+    MESSAGE("save: " << megabytes / ToSeconds(save_end - save_start) << " MB/s");
+    MESSAGE("load: " << megabytes / ToSeconds(load_end - save_end) << " MB/s");
+    MESSAGE("load time: " << ToSeconds(load_end - save_end) << " s, building the same scene: " << build_time << " s");
+}
+
+TEST_CASE("benchmarking node creation" * doctest::skip())
+{
+    constexpr auto kNodeCount = 1'000'000;
+
+    auto scene    = Scene();
+    auto shader   = scene.CreateShader();
+    auto material = scene.CreateMaterial(shader);
+    auto mesh     = scene.CreateMesh(AABB{}, nullptr, nullptr, 0, 0);
+    auto baseline = scene.GetObjectCount();
+    auto nodes    = std::vector<UniqueNode>();
+
+    nodes.reserve(kNodeCount);
+
+    // Each kind of node comes from its own pool; the first round adds the slabs and the second reuses their blocks.
+    for (auto round : { "first", "second" }) {
+        auto create_start = BenchClock::now();
+        for (int i = 0; i != kNodeCount; ++i) {
+            switch (i % 4) {
+            case 0: nodes.push_back(scene.CreateGroupNode()); break;
+            case 1: nodes.push_back(scene.CreateTranslateNode(Float3{ 1, 0, 0 })); break;
+            case 2: nodes.push_back(scene.CreateScaleNode(2.0f)); break;
+            default: nodes.push_back(scene.CreateInstanceNode(mesh, material)); break;
+            }
+        }
+        auto create_end = BenchClock::now();
+
+        CHECK(scene.GetObjectCount() == baseline + kNodeCount);
+
+        nodes.clear();
+        auto destroy_end = BenchClock::now();
+
+        CHECK(scene.GetObjectCount() == baseline);
+        CHECK(material->GetInstanceNodes().empty());
+
+        MESSAGE(
+            round << " round: create " << ToNanoseconds(create_end - create_start) / kNodeCount << " ns, destroy "
+                  << ToNanoseconds(destroy_end - create_end) / kNodeCount << " ns per node");
+    }
+}
+
+TEST_CASE("benchmarking instance deletion" * doctest::skip())
+{
+    constexpr auto kInstanceCount = 100'000;
+
+    auto scene    = Scene();
+    auto root     = scene.GetRootNode();
+    auto shader   = scene.CreateShader();
+    auto material = scene.CreateMaterial(shader);
+    auto mesh     = scene.CreateMesh(AABB{}, nullptr, nullptr, 0, 0);
+
+    auto populate = [&](NodePtr parent) {
+        auto instances = std::vector<NodePtr>();
+        instances.reserve(kInstanceCount);
+        for (int i = 0; i != kInstanceCount; ++i) {
+            instances.push_back(parent->AttachNode(scene.CreateInstanceNode(mesh, material)));
+        }
+        return instances;
+    };
+
+    // Instances deleted one at a time, in creation order.
+    auto group        = root->AttachNode(scene.CreateGroupNode());
+    auto instances    = populate(group);
+    auto single_start = BenchClock::now();
+    for (auto instance : instances) {
+        instance->DetachNode();
+    }
+    auto single_end = BenchClock::now();
+
+    CHECK(material->GetInstanceNodes().empty());
+    CHECK(group->GetChildren().empty());
+
+    // The same instances deleted together with their parent.
+    populate(group);
+    auto subtree_start = BenchClock::now();
+    scene.DestroySubtree(group);
+    auto subtree_end = BenchClock::now();
+
+    CHECK(material->GetInstanceNodes().empty());
+    CHECK(root->GetChildren().empty());
+
+    MESSAGE("detach each instance: " << ToMilliseconds(single_end - single_start) << " ms");
+    MESSAGE("destroy subtree: " << ToMilliseconds(subtree_end - subtree_start) << " ms");
+}
+
+TEST_CASE("testing scene builder")
+{
+    auto scene     = Scene();
+    auto root      = scene.GetRootNode();
+    auto vertices  = std::vector<float>{ 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+    auto indices   = std::vector<uint32_t>{ 0, 1, 2 };
+    auto alignment = std::align_val_t(64);
+
+    auto shader_in_use   = scene.CreateShader();
+    auto material_in_use = scene.CreateMaterial(shader_in_use);
+    auto group           = root->AttachNode(scene.CreateGroupNode());
+    auto instance_leaf   = root->AttachNode(scene.CreateInstanceNode(nullptr, material_in_use));
+
+    // Leaves free material indices behind, which the commit should reuse.
+    scene.CreateMaterial(shader_in_use);
+    scene.CreateMaterial(shader_in_use);
+    auto released = scene.ReleaseUnusedAssets();
+    REQUIRE(released.materials.size() == 2);
+
+    auto builder       = SceneBuilder();
+    auto vertex_buffer = builder.AddVertexBuffer(vertices.data(), sizeof(float) * vertices.size(), alignment);
+    auto index_buffer  = builder.AddIndexBuffer(indices.data(), sizeof(uint32_t) * indices.size(), alignment);
+    auto shader        = builder.AddShader();
+    auto material      = builder.AddMaterial(shader);
+    auto mesh          = builder.AddMesh(AABB{ { 0, 0, 0 }, { 1, 1, 1 } }, vertex_buffer, index_buffer, 0, 3);
+    auto file          = builder.AddGroupNode();
+    auto translate     = builder.AddTranslateNode(file, Float3{ 2, 0, 0 });
+    auto instance      = builder.AddInstanceNode(translate, mesh, material);
+
+    builder.SetProperty(file, kNameAtom, std::string("model.obj"));
+    builder.SetProperty(instance, kNameAtom, std::string("Handle"));
+    builder.SetProperty(material, kDiffuseTextureAtom, std::string("handle.png"));
+
+    // Handles are checked as they are recorded, so a bad record never reaches the scene.
+    CHECK_THROWS(builder.AddMesh(AABB{}, shader, index_buffer, 0, 3));
+    CHECK_THROWS(builder.AddInstanceNode(instance, mesh, material));
+    CHECK_THROWS(builder.AddMaterial(SceneBuilder::kNoParent));
+    CHECK_THROWS(builder.SetProperty(file, kNameAtom, static_cast<ObjectPtr>(root)));
+
+    auto object_count = scene.GetObjectCount();
+
+    CHECK_THROWS(scene.Commit(std::move(builder), instance_leaf));
+    CHECK(scene.GetObjectCount() == object_count);
+    CHECK(builder.GetRecordCount() == 8);
+
+    auto nodes = scene.Commit(std::move(builder), group);
+
+    CHECK(builder.GetRecordCount() == 0);
+    REQUIRE(nodes.size() == 1);
+    CHECK(nodes.front()->GetParent() == group);
+    CHECK(scene.GetObjectCount() == object_count + 8);
+    CHECK(scene.FindNodes("handle", 10).size() == 1);
+    CHECK(IsClose(scene.ComputeAxisAlignedBoundingBox(), AABB{ { 2, 0, 0 }, { 3, 1, 1 } }));
+
+    auto draw_list = scene.ComputeDrawList();
+    std::erase_if(draw_list, [](const DrawRecord& record) { return record.mesh == nullptr; });
+    REQUIRE(draw_list.size() == 1);
+
+    auto committed = draw_list.front().mesh;
+    auto buffer    = committed->GetVertexBuffer();
+
+    CHECK(committed->GetUseCount() == 1);
+    CHECK(buffer->GetUseCount() == 1);
+    CHECK(buffer->Alignment() == alignment);
+    CHECK(std::memcmp(buffer->Data(), vertices.data(), buffer->Size()) == 0);
+    CHECK(draw_list.front().material->GetIndex() == released.materials.back());
+    CHECK(std::get<std::string>(draw_list.front().material->GetProperty(kDiffuseTextureAtom)) == "handle.png");
+
+    // Committed objects are ordinary scene objects and are released like any other.
+    scene.DestroySubtree(nodes.front());
+    CHECK(scene.ReleaseUnusedAssets().buffers.size() == 2);
+    CHECK(scene.GetObjectCount() == object_count);
+}
+
+// Stands in for parsing a model file: computes a height field and records it with its materials and named parts.
+static SceneBuilder BuildModel(int model, int grid_size, int part_count)
+{
+    auto builder   = SceneBuilder();
+    auto vertices  = std::vector<Float3>();
+    auto indices   = std::vector<uint32_t>();
+    auto size      = static_cast<uint32_t>(grid_size);
+    auto alignment = std::align_val_t(16);
+
+    for (uint32_t y = 0; y != size; ++y) {
+        for (uint32_t x = 0; x != size; ++x) {
+            auto u = static_cast<float>(x) / static_cast<float>(size);
+            auto v = static_cast<float>(y) / static_cast<float>(size);
+            vertices.emplace_back(u, v, std::sin(10 * u + static_cast<float>(model)) * std::cos(10 * v));
+        }
+    }
+
+    for (uint32_t y = 0; y + 1 < size; ++y) {
+        for (uint32_t x = 0; x + 1 < size; ++x) {
+            auto corner = y * size + x;
+            indices.insert(indices.end(), { corner, corner + 1, corner + size });
+            indices.insert(indices.end(), { corner + 1, corner + size + 1, corner + size });
+        }
+    }
+
+    auto vertex_buffer = builder.AddVertexBuffer(vertices.data(), sizeof(Float3) * vertices.size(), alignment);
+    auto index_buffer  = builder.AddIndexBuffer(indices.data(), sizeof(uint32_t) * indices.size(), alignment);
+    auto shader        = builder.AddShader();
+    auto file          = builder.AddGroupNode();
+    auto part_indices  = indices.size() / static_cast<size_t>(part_count);
+
+    builder.SetProperty(file, kNameAtom, std::string("Model ") + std::to_string(model));
+
+    for (int part = 0; part != part_count; ++part) {
+        auto material  = builder.AddMaterial(shader);
+        auto first     = part_indices * static_cast<size_t>(part);
+        auto mesh      = builder.AddMesh(AABB{ { 0, 0, -1 }, { 1, 1, 1 } }, vertex_buffer, index_buffer, first, 3);
+        auto translate = builder.AddTranslateNode(file, Float3{ static_cast<float>(model), 0, 0 });
+        auto instance  = builder.AddInstanceNode(translate, mesh, material);
+        builder.SetProperty(instance, kNameAtom, std::string("Part ") + std::to_string(part));
+        builder.SetProperty(material, kDiffuseColorAtom, Float3{ 0.5f, 0.5f, 0.5f });
+    }
+
+    return builder;
+}
+
+TEST_CASE("benchmarking scene builder" * doctest::skip())
+{
+    constexpr auto kModelCount = 200;
+    constexpr auto kGridSize   = 256;
+    constexpr auto kPartCount  = 100;
+
+    auto object_counts = std::vector<size_t>();
+
+    MESSAGE("hardware threads: " << utils::HardwareThreadCount());
+
+    for (auto thread_count : { size_t{ 1 }, size_t{ 4 }, size_t{ 16 } }) {
+        auto scene    = Scene();
+        auto builders = std::vector<SceneBuilder>(kModelCount);
+
+        auto build_start = BenchClock::now();
+        utils::ParallelFor(builders.size(), thread_count, [&](size_t index) {
+            builders[index] = BuildModel(static_cast<int>(index), kGridSize, kPartCount);
+        });
+        auto build_end = BenchClock::now();
+
+        for (auto& builder : builders) {
+            scene.Commit(std::move(builder));
+        }
+        auto commit_end = BenchClock::now();
+
+        object_counts.push_back(scene.GetObjectCount());
+
+        MESSAGE(
+            thread_count << " threads: build " << ToMilliseconds(build_end - build_start) << " ms, commit "
+                         << ToMilliseconds(commit_end - build_end) << " ms, total "
+                         << ToMilliseconds(commit_end - build_start) << " ms");
+    }
+
+    CHECK(std::ranges::all_of(object_counts, [&](size_t count) { return count == object_counts.front(); }));
+    CHECK(object_counts.front() == static_cast<size_t>(1 + kModelCount * (4 + 4 * kPartCount)));
+}
@@ -1,8 +1,29 @@
+#include "bench_clock.hpp"
+#include "counting_resource.hpp"
+#include "utils/atom.hpp"
+#include "utils/deletion_queue.hpp"
+#include "utils/flat_map.hpp"
+#include "utils/object_pool.hpp"
+#include "utils/parallel.hpp"
 #include "utils/resource.hpp"
+#include "utils/revision_cache.hpp"
+#include "utils/slot_map.hpp"
+#include "utils/stream_codec.hpp"
+#include "utils/text_index.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstring>
 #include <doctest/doctest.h>
+#include <memory_resource>
+#include <random>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
 
 using data_view = std::basic_string_view<unsigned char>;
 
@@ -17,3 +38,453 @@ TEST_CASE("testing resource manager")
 
     CHECK(view == resource_view);
 }
+
+TEST_CASE("testing revision cache")
+{
+    struct Record final {
+        uint32_t texture_index = 0;
+    };
+
+    constexpr auto kSlotCount  = size_t{ 64 };
+    constexpr auto kFrameCount = 16;
+
+    auto resource  = CountingResource();
+    auto cache     = utils::RevisionCache<Record, std::pmr::polymorphic_allocator<Record>>(&resource);
+    auto revisions = std::vector<uint64_t>(kSlotCount, 1);
+    auto compile   = [](size_t slot) { return Record{ static_cast<uint32_t>(slot) }; };
+
+    for (size_t slot = 0; slot != kSlotCount; ++slot) {
+        CHECK(cache.Get(slot, revisions[slot], [&] { return compile(slot); }).texture_index == slot);
+    }
+    CHECK(cache.Size() == kSlotCount);
+    CHECK(cache.CompileCount() == kSlotCount);
+
+    auto allocations = resource.AllocationCount();
+    auto sum         = size_t{ 0 };
+
+    for (int frame = 0; frame != kFrameCount; ++frame) {
+        for (size_t slot = 0; slot != kSlotCount; ++slot) {
+            sum += cache.Get(slot, revisions[slot], [&] { return compile(slot); }).texture_index;
+        }
+    }
+
+    CHECK(resource.AllocationCount() == allocations);
+    CHECK(sum == kFrameCount * kSlotCount * (kSlotCount - 1) / 2);
+    CHECK(cache.CompileCount() == kSlotCount);
+
+    revisions[7]++;
+    CHECK(cache.Get(7, revisions[7], [] { return Record{ 42 }; }).texture_index == 42);
+    CHECK(cache.Get(8, revisions[8], [] { return Record{ 42 }; }).texture_index == 8);
+    CHECK(cache.CompileCount() == kSlotCount + 1);
+
+    cache.Invalidate();
+    CHECK(cache.Get(8, revisions[8], [] { return Record{ 42 }; }).texture_index == 42);
+    CHECK(cache.CompileCount() == kSlotCount + 2);
+
+    // A single slot is invalidated when its source is destroyed and the slot may be reused.
+    cache.Get(9, revisions[9], [] { return Record{ 9 }; });
+    cache.Invalidate(9);
+    CHECK(cache.Get(9, revisions[9], [] { return Record{ 43 }; }).texture_index == 43);
+    CHECK(cache.Get(8, revisions[8], [] { return Record{ 43 }; }).texture_index == 42);
+}
+
+TEST_CASE("testing atoms")
+{
+    static constexpr auto kClass = utils::Atom("_class");
+    static_assert(kClass.Name() == "_class");
+    static_assert(kClass == utils::Atom("_class"));
+    static_assert(kClass != utils::Atom("_name"));
+    static_assert(utils::Atom().Empty());
+
+    auto name = std::string("_") + "class";
+    auto atom = utils::Atom(name);
+
+    name = "overwritten";
+
+    CHECK(atom == kClass);
+    CHECK(atom.Name() == "_class");
+    CHECK(utils::Atom("diffuse.texture").Name() == "diffuse.texture");
+
+    // A name that is already interned refers to the stored string instead of registering another copy.
+    auto texture = std::string("diffuse.") + "texture";
+    CHECK(utils::Atom(texture) == utils::Atom("diffuse.texture"));
+    CHECK(utils::Atom(texture).Name().data() == utils::Atom(std::string_view("diffuse.texture")).Name().data());
+
+    // Names are checked against the stored name, since atoms with the same hash compare equal.
+    CHECK_THROWS(detail::intern_atom(utils::Atom(texture).Hash(), "diffuse.color"));
+    CHECK(utils::Atom("diffuse.color").Name() == "diffuse.color");
+}
+
+TEST_CASE("testing flat map")
+{
+    auto map = utils::FlatMap<utils::Atom, int>();
+
+    CHECK(map.InsertOrAssign("b", 2));
+    CHECK(map.InsertOrAssign("a", 1));
+    CHECK(map.InsertOrAssign("c", 3));
+    CHECK(!map.InsertOrAssign("b", 20));
+    CHECK(map.size() == 3);
+
+    REQUIRE(map.Find("b"));
+    CHECK(*map.Find("b") == 20);
+    CHECK(map.Find("d") == nullptr);
+
+    for (auto it = map.begin(); it + 1 != map.end(); ++it) {
+        CHECK(it->first < (it + 1)->first);
+    }
+
+    CHECK(map.Erase("a"));
+    CHECK(!map.Erase("a"));
+    CHECK(map.size() == 2);
+    CHECK(!map.Contains("a"));
+}
+
+TEST_CASE("benchmarking property store" * doctest::skip())
+{
+    using Value = std::variant<std::monostate, int, float, std::string>;
+    using Store = utils::FlatMap<utils::Atom, Value, std::pmr::polymorphic_allocator<std::pair<utils::Atom, Value>>>;
+    constexpr auto kIterations = 100'000;
+
+    static constexpr utils::Atom kNames[] = { "name", "diffuse.color", "diffuse.texture", "Path", "specular" };
+
+    auto resource = CountingResource();
+    auto store    = Store(&resource);
+    for (auto name : kNames) {
+        store.InsertOrAssign(name, std::string(name.Name()));
+    }
+
+    auto allocations = resource.AllocationCount();
+    auto found       = size_t{ 0 };
+    auto get_start   = BenchClock::now();
+    for (int i = 0; i != kIterations; ++i) {
+        found += store.Find(kNames[i % std::size(kNames)]) != nullptr;
+    }
+    auto get_end = BenchClock::now();
+    CHECK(resource.AllocationCount() == allocations);
+    CHECK(found == kIterations);
+
+    allocations       = resource.AllocationCount();
+    auto lookup_start = BenchClock::now();
+    for (int i = 0; i != kIterations; ++i) {
+        found += store.Find(utils::Atom(std::string_view("diffuse.texture"))) != nullptr;
+    }
+    auto lookup_end = BenchClock::now();
+    CHECK(resource.AllocationCount() == allocations);
+
+    auto set_start = BenchClock::now();
+    for (int i = 0; i != kIterations; ++i) {
+        store.InsertOrAssign(kNames[i % std::size(kNames)], i);
+    }
+    auto set_end = BenchClock::now();
+
+    allocations     = resource.AllocationCount();
+    auto ints       = size_t{ 0 };
+    auto enum_start = BenchClock::now();
+    for (int i = 0; i != kIterations; ++i) {
+        for (const auto& [name, value] : store) {
+            ints += std::holds_alternative<int>(value);
+        }
+    }
+    auto enum_end = BenchClock::now();
+    CHECK(resource.AllocationCount() == allocations);
+    CHECK(ints == kIterations * std::size(kNames));
+
+    MESSAGE("get by atom: " << ToNanoseconds(get_end - get_start) / kIterations << " ns");
+    MESSAGE("get by string: " << ToNanoseconds(lookup_end - lookup_start) / kIterations << " ns");
+    MESSAGE("set: " << ToNanoseconds(set_end - set_start) / kIterations << " ns");
+    MESSAGE(
+        "enumerate " << std::size(kNames) << " properties: " << ToNanoseconds(enum_end - enum_start) / kIterations
+                     << " ns");
+}
+
+TEST_CASE("testing slot map")
+{
+    auto map = utils::SlotMap<int>();
+
+    auto a = map.Insert(1);
+    auto b = map.Insert(2);
+    auto c = map.Insert(3);
+
+    CHECK(map.size() == 3);
+    CHECK(*map.Get(b) == 2);
+
+    CHECK(map.Erase(a));
+    CHECK(!map.Erase(a));
+    CHECK(map.Get(a) == nullptr);
+    CHECK(*map.Get(b) == 2);
+    CHECK(*map.Get(c) == 3);
+
+    auto d = map.Insert(4);
+    CHECK(d.index == a.index);
+    CHECK(d.generation != a.generation);
+    CHECK(map.Get(a) == nullptr);
+    CHECK(*map.Get(d) == 4);
+
+    auto sum = 0;
+    for (auto value : map) {
+        sum += value;
+    }
+    CHECK(sum == 9);
+    CHECK(!map.Contains(utils::SlotHandle{}));
+}
+
+TEST_CASE("testing deletion queue")
+{
+    struct Resource final {
+        Resource(int& live) : live(&live) { live++; }
+        Resource(Resource&& other) noexcept : live(std::exchange(other.live, nullptr)) {}
+        ~Resource()
+        {
+            if (live) {
+                (*live)--;
+            }
+        }
+        int* live;
+    };
+
+    constexpr auto kCycleCount     = 100;
+    constexpr auto kResourceCount  = 8;
+    constexpr auto kFramesInFlight = uint64_t{ 2 };
+    constexpr auto kFramesPerCycle = uint64_t{ 5 };
+
+    auto live      = 0;
+    auto queue     = utils::DeletionQueue<Resource>();
+    auto submitted = uint64_t{ 0 };
+    auto max_live  = 0;
+
+    // Each cycle loads a model, draws it for a few frames and releases it while the last frames are in flight.
+    for (int cycle = 0; cycle != kCycleCount; ++cycle) {
+        auto resources = std::vector<Resource>();
+        for (int i = 0; i != kResourceCount; ++i) {
+            resources.emplace_back(live);
+        }
+
+        for (uint64_t frame = 0; frame != kFramesPerCycle; ++frame) {
+            submitted++;
+            queue.Retire(submitted - std::min(submitted, kFramesInFlight));
+            max_live = std::max(max_live, live);
+        }
+
+        for (auto& resource : resources) {
+            queue.Push(submitted, std::move(resource));
+        }
+
+        // Only the resources of the cycle just released are still waiting.
+        CHECK(live == kResourceCount);
+    }
+
+    // Resources of a cycle are never destroyed while their frames are in flight, and never kept much longer.
+    CHECK(max_live <= 2 * kResourceCount);
+
+    auto retired = 0;
+    queue.Retire(submitted - 1, [&](Resource&) { retired++; });
+    CHECK(retired == 0);
+    queue.Retire(submitted, [&](Resource&) { retired++; });
+    CHECK(retired == kResourceCount);
+    CHECK(queue.Empty());
+    CHECK(live == 0);
+}
+
+TEST_CASE("testing parallel for")
+{
+    constexpr auto kItemCount = size_t{ 1000 };
+
+    for (size_t thread_count : { 1, 4, 16 }) {
+        auto visits = std::vector<std::atomic_int>(kItemCount);
+
+        utils::ParallelFor(kItemCount, thread_count, [&](size_t index) { visits[index]++; });
+
+        CHECK(std::ranges::all_of(visits, [](const std::atomic_int& count) { return count == 1; }));
+    }
+
+    // An exception reaches the caller after every thread has finished, and items that have not started are skipped.
+    auto started = std::atomic_size_t(0);
+    auto work    = [&](size_t index) {
+        started++;
+        if (index == 10) {
+            throw std::runtime_error("item failed");
+        }
+    };
+
+    CHECK_THROWS(utils::ParallelFor(kItemCount, 4, work));
+
+    started = 0;
+    CHECK_THROWS(utils::ParallelFor(kItemCount, 1, work));
+    CHECK(started == 11);
+
+    auto visited = false;
+    utils::ParallelFor(0, 4, [&](size_t) { visited = true; });
+    CHECK(!visited);
+}
+
+TEST_CASE("testing object pool")
+{
+    struct Counted final {
+        Counted(int& live) : live(live) { live++; }
+        ~Counted() { live--; }
+        int& live;
+    };
+
+    auto live = 0;
+    auto pool = utils::ObjectPool<Counted, 4>();
+    auto ptrs = std::vector<Counted*>();
+
+    for (int i = 0; i != 10; ++i) {
+        ptrs.push_back(pool.Create(live));
+    }
+    CHECK(live == 10);
+    CHECK(pool.Size() == 10);
+    CHECK(pool.Capacity() == 12);
+
+    for (auto ptr : ptrs) {
+        pool.Destroy(ptr);
+    }
+    CHECK(live == 0);
+    CHECK(pool.Size() == 0);
+
+    // Freed blocks are reused before another slab is added.
+    for (int i = 0; i != 12; ++i) {
+        ptrs[static_cast<size_t>(i % 10)] = pool.Create(live);
+    }
+    CHECK(pool.Capacity() == 12);
+
+    // A moved-from pool owns nothing and starts over with a slab of its own.
+    auto moved = std::move(pool);
+    CHECK(moved.Size() == 12);
+    CHECK(moved.Capacity() == 12);
+    CHECK(pool.Size() == 0);
+    CHECK(pool.Capacity() == 0);
+
+    auto extra = pool.Create(live);
+    CHECK(pool.Capacity() == 4);
+    CHECK(live == 13);
+    pool.Destroy(extra);
+
+    pool = std::move(moved);
+    CHECK(pool.Size() == 12);
+    CHECK(moved.Capacity() == 0);
+    moved.Destroy(moved.Create(live));
+    CHECK(moved.Capacity() == 4);
+}
+
+TEST_CASE("testing text index")
+{
+    auto index = utils::TextIndex<int>();
+
+    index.Insert(0, "Left Wheel", 10);
+    index.Insert(1, "Right Wheel", 11);
+    index.Insert(2, "Chassis", 12);
+
+    auto sorted = [](std::vector<int> values) {
+        std::ranges::sort(values);
+        return values;
+    };
+
+    CHECK((sorted(index.Search("wheel")) == std::vector{ 10, 11 }));
+    CHECK(index.Search("RIGHT") == std::vector{ 11 });
+    CHECK(index.Search("is") == std::vector{ 12 });
+    CHECK(index.Search("wheels").empty());
+    CHECK(index.Search("wheel", 1).size() == 1);
+
+    index.Insert(1, "Spare Wheel", 11);
+    CHECK(index.Search("right").empty());
+    CHECK((sorted(index.Search("wheel")) == std::vector{ 10, 11 }));
+
+    CHECK(index.Erase(0));
+    CHECK_FALSE(index.Erase(0));
+    CHECK(index.Search("wheel") == std::vector{ 11 });
+    CHECK(index.Size() == 2);
+
+    // Repeated trigrams within one text must not produce duplicate matches.
+    index.Insert(3, "aaaaaa", 13);
+    CHECK(index.Search("aaa") == std::vector{ 13 });
+}
+
+TEST_CASE("benchmarking text index" * doctest::skip())
+{
+    constexpr auto kTextCount = uint32_t{ 1'000'000 };
+    constexpr auto kEditCount = uint32_t{ 100'000 };
+
+    auto index = utils::TextIndex<uint32_t>();
+
+    auto build_start = BenchClock::now();
+    for (uint32_t i = 0; i != kTextCount; ++i) {
+        index.Insert(i, "Part " + std::to_string(i) + "\ninstance.node", i);
+    }
+    auto build_end = BenchClock::now();
+
+    auto query_start = BenchClock::now();
+    auto matches     = index.Search("part 123456");
+    auto query_end   = BenchClock::now();
+
+    CHECK(matches == std::vector{ uint32_t{ 123456 } });
+
+    auto edit_start = BenchClock::now();
+    for (uint32_t i = 0; i != kEditCount; ++i) {
+        index.Insert(i, "Bolt " + std::to_string(i) + "\ninstance.node", i);
+    }
+    auto edit_end = BenchClock::now();
+
+    CHECK(index.Search("bolt 99999") == std::vector{ uint32_t{ 99999 } });
+    CHECK(index.Search("part 5\n").empty());
+
+    MESSAGE("index " << kTextCount << " texts: " << ToMilliseconds(build_end - build_start) << " ms");
+    MESSAGE("query: " << ToMilliseconds(query_end - query_start) << " ms");
+    MESSAGE("edit: " << 1000.0 * ToMilliseconds(edit_end - edit_start) / kEditCount << " us per text");
+}
+
+TEST_CASE("testing stream codec")
+{
+    struct Vertex {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    // A strip of vertices along a curve, as a loader would produce them.
+    auto vertices = std::vector<Vertex>(10000);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto t      = static_cast<float>(i) * 0.001f;
+        vertices[i] = { { t, t * t, 1 }, { 0, 0, 1 }, { t, 0.5f } };
+    }
+
+    auto bytes  = std::as_bytes(std::span(vertices));
+    auto random = std::vector<std::byte>(5003);
+    auto engine = std::mt19937(7);
+    for (auto& byte : random) {
+        byte = static_cast<std::byte>(engine());
+    }
+
+    auto round_trip = [](std::span<const std::byte> data, size_t stride) {
+        auto encoded = utils::EncodeStream(data, stride);
+        auto decoded = std::vector<std::byte>(utils::GetDecodedStreamSize(encoded));
+        utils::DecodeStream(encoded, decoded);
+        return decoded.size() == data.size() && std::ranges::equal(decoded, data);
+    };
+
+    // Any stride decodes losslessly, including data that is not a whole number of elements.
+    for (size_t stride : { 4, 12, 20, 32, 64 }) {
+        CHECK(round_trip(bytes, stride));
+        CHECK(round_trip(bytes.first(bytes.size() - 6), stride));
+        CHECK(round_trip(random, stride));
+    }
+    CHECK(round_trip({}, 4));
+
+    CHECK(utils::FindStreamStride(bytes) == sizeof(Vertex));
+    CHECK(utils::EncodeStream(bytes, sizeof(Vertex)).size() < bytes.size() / 4);
+    CHECK(utils::EncodeStream(random, 4).size() < random.size() + random.size() / 32 + 32);
+
+    CHECK_THROWS(utils::EncodeStream(bytes, 6));
+    CHECK_THROWS(utils::EncodeStream(bytes, 0));
+
+    // Truncated or corrupted streams are rejected instead of being read past their end.
+    auto encoded = utils::EncodeStream(bytes, sizeof(Vertex));
+    auto decoded = std::vector<std::byte>(bytes.size());
+
+    CHECK_THROWS(utils::DecodeStream(std::span(encoded).first(encoded.size() - 1), decoded));
+    CHECK_THROWS(utils::DecodeStream(std::span(encoded).first(8), decoded));
+    CHECK_THROWS(utils::DecodeStream(encoded, std::span(decoded).first(16)));
+
+    encoded[0] = std::byte{ 0 };
+    CHECK_THROWS(utils::GetDecodedStreamSize(encoded));
+}